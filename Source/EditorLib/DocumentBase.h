@@ -4,6 +4,7 @@
 #include <EditorLib/Selectron.h>
 #include <EditorLib/Commands/SmartUndoStack.h>
 
+#include <QByteArray>
 #include <QObject>
 #include <QFileInfo>
 
@@ -37,6 +38,17 @@ public:
     virtual QString DocumentTypeName() const = 0;
 };
 
+/// State of a document captured on the main thread, for the DocumentManager to write as a backup from a worker thread.
+struct DocumentBackup
+{
+    /// Name of the file within the backup directory.
+    QString fileName_;
+    /// Written first as is, such as a file ID.
+    QByteArray header_;
+    /// Written after the header, compressed with qCompress.
+    QByteArray data_;
+};
+
 /// Abstracts the handling (save/load/dirty) of a document type
 /// Registered documents appear as optional "New" files, intent is to facilitate
 //  both multi-function software and to easily create spin off programs (ie. limited to 1 document type)
@@ -68,6 +80,9 @@ public:
     virtual bool Save() = 0;
     /// Write into the backup directory a save.
     virtual bool DoBackup(const QString& backupDir) = 0;
+    /// Captures the document for an automatic backup as cheaply as possible, compressing and writing it is left to a worker thread.
+    /// Returns false if the document does not support this, DoBackup is then called on the main thread instead.
+    virtual bool SnapshotBackup(DocumentBackup& backup) { return false; }
     /// Returns true if the document is dirty.
     virtual bool IsDirty() { return dirty_; }
     /// Force the dirty flags to a given state.
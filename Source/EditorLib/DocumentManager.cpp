@@ -7,17 +7,104 @@
 #include <EditorLib/Selectron.h>
 #include <EditorLib/Settings/Settings.h>
 #include <EditorLib/Settings/SettingsValue.h>
+#include <EditorLib/TaskProcessor.h>
 
 #include <QApplication>
+#include <QCryptographicHash>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QSaveFile>
 #include <QString>
 #include <QTimer>
 
+/// Compresses and writes a backup captured on the main thread, unless it is the same as the last one written to the file.
+/// Backups are incremental per document only: an unchanged document is skipped, a changed one replaces its backup whole rather than
+/// appending a delta to it, so that every backup opens on its own and a lost or torn file never takes later changes with it.
+class DocumentBackupTask : public Task
+{
+public:
+    DocumentBackupTask(DocumentManager* manager, const DocumentBackup& backup, const QString& path, const QString& documentName) :
+        Task(0x0),
+        manager_(manager),
+        backup_(backup),
+        path_(path),
+        documentName_(documentName),
+        previousHash_(manager->backupHashes_.value(path))
+    {
+    }
+
+    virtual QString GetName() const override { return QString("Backing up %1").arg(documentName_); }
+
+    virtual bool ExecuteTask() override
+    {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(backup_.header_);
+        hash.addData(backup_.data_);
+        hash_ = hash.result();
+        if (hash_ == previousHash_)
+        {
+            result_ = Unchanged;
+            return true;
+        }
+
+        // QSaveFile writes to a temporary file and renames it, a crash while writing leaves the previous backup intact
+        const QByteArray compressed = qCompress(backup_.data_);
+        QSaveFile file(path_);
+        if (file.open(QIODevice::WriteOnly) && file.write(backup_.header_) == backup_.header_.size() && file.write(compressed) == compressed.size() && file.commit())
+            result_ = Written;
+        else
+        {
+            file.cancelWriting();
+            result_ = Failed;
+        }
+        backup_ = DocumentBackup();
+        return result_ != Failed;
+    }
+
+    virtual void FinishTask() override
+    {
+        if (result_ == Written)
+        {
+            manager_->backupHashes_[path_] = hash_;
+            LOGINFO(QString("Wrote backup of %1 to %2").arg(documentName_, path_));
+        }
+        else if (result_ == Unchanged)
+            LOGDEBUG(QString("Skipped backup of %1, unchanged since the last one").arg(documentName_));
+        else
+            LOGERROR(QString("Failed to write backup of file %1 to %2").arg(documentName_, path_));
+    }
+
+    virtual bool Supercedes(Task* other) override
+    {
+        if (DocumentBackupTask* rhs = dynamic_cast<DocumentBackupTask*>(other))
+            return rhs->path_ == path_;
+        return false;
+    }
+
+private:
+    enum Result
+    {
+        Failed,
+        Unchanged,
+        Written
+    };
+
+    DocumentManager* manager_;
+    DocumentBackup backup_;
+    QString path_;
+    QString documentName_;
+    QByteArray previousHash_;
+    QByteArray hash_;
+    Result result_ = Failed;
+};
+
 DocumentManager::DocumentManager() :
     activeDocument_(0x0),
-    selectron_(new Selectron())
+    selectron_(new Selectron()),
+    backupProcessor_(new TaskProcessor(true))
 {
+    backupProcessor_->start();
+
     autoSaveTimer_ = new QTimer(this);
     autoSaveTimer_->setSingleShot(false);
 
@@ -223,7 +310,14 @@ void DocumentManager::OnAutoSaveTimer()
     {
         if (documents_[i]->IsDirty())
         {
-            if (documents_[i]->DoBackup(backupDir))
+            // Only capturing the document happens here, the rest is done by the backup processor
+            DocumentBackup backup;
+            if (documents_[i]->SnapshotBackup(backup))
+            {
+                const QString path = QDir::cleanPath(backupDir + QDir::separator() + backup.fileName_);
+                backupProcessor_->AddTask(std::make_shared<DocumentBackupTask>(this, backup, path, documents_[i]->GetFileName()));
+            }
+            else if (documents_[i]->DoBackup(backupDir))
                 LOGINFO(QString("Wrote backup of %1 to %2").arg(documents_[i]->GetFileName(), backupDir));
             else
                 LOGERROR(QString("Failed to write backup of file %1 to %2").arg(documents_[i]->GetFileName(), backupDir));
@@ -2,6 +2,8 @@
 
 #include <EditorLib/editorlib_global.h>
 
+#include <QByteArray>
+#include <QMap>
 #include <QObject>
 
 class QTimer;
@@ -10,6 +12,7 @@ class DocumentBase;
 class DocumentHandler;
 class Selectron;
 class Settings;
+class TaskProcessor;
 
 /// Manages document behaviour
 /// Also places all IO core logic in one place
@@ -17,6 +20,7 @@ class Settings;
 /// ApplicationCore fulfills this constraint
 class EDITORLIB_EXPORT DocumentManager : public QObject
 {
+    friend class DocumentBackupTask;
     Q_OBJECT
 public:
     DocumentManager();
@@ -69,4 +73,8 @@ private:
     DocumentBase* activeDocument_ = 0x0;
     QTimer* autoSaveTimer_ = 0x0;
     std::vector<DocumentBase*> documents_;
+    /// Compresses and writes automatic backups so that the editor does not wait on them.
+    TaskProcessor* backupProcessor_ = 0x0;
+    /// Hash of the content of the last backup written to each path, unchanged documents are not written again.
+    QMap<QString, QByteArray> backupHashes_;
 };
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "ThumbnailService.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QTimer>
+
+/// Bytes of thumbnails kept in memory.
+#define THUMBNAIL_MEMORY (64 * 1024 * 1024)
+
+ThumbnailService::ThumbnailService(int size) :
+    size_(size),
+    pixmaps_(THUMBNAIL_MEMORY)
+{
+    timer_ = new QTimer();
+    timer_->start(50);
+    QObject::connect(timer_, &QTimer::timeout, [=]() {
+        Update();
+    });
+
+    for (unsigned i = 0; i < WorkerCount; ++i)
+        workers_.push_back(std::thread(&ThumbnailService::WorkerLoop, this));
+}
+
+ThumbnailService::~ThumbnailService()
+{
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        stopping_ = true;
+        queue_.clear();
+    }
+    queued_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+    delete timer_;
+}
+
+void ThumbnailService::AddGenerator(const QStringList& suffixes, Generator generator)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    for (const QString& suffix : suffixes)
+        generators_[suffix.toLower()] = generator;
+}
+
+void ThumbnailService::SetCacheDirectory(const QString& path)
+{
+    QString directory = path;
+    if (!directory.isEmpty() && !QDir().mkpath(directory))
+        directory.clear();
+    std::lock_guard<std::mutex> lock(lock_);
+    cacheDirectory_ = directory;
+}
+
+QPixmap ThumbnailService::GetPixmap(const QFileInfo& file)
+{
+    const QString key = MakeKey(file);
+    if (QPixmap* found = pixmaps_.object(key))
+        return *found;
+    if (pending_.contains(key) || failed_.contains(key))
+        return QPixmap();
+
+    pending_.insert(key);
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        // Most recently asked for first, that is what is on screen after scrolling
+        queue_.push_front(Job{ key, file.absoluteFilePath(), file.suffix().toLower(), QImage() });
+    }
+    queued_.notify_one();
+    return QPixmap();
+}
+
+void ThumbnailService::CancelPending()
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    for (const Job& job : queue_)
+        pending_.remove(job.key_);
+    queue_.clear();
+}
+
+QString ThumbnailService::MakeKey(const QFileInfo& file)
+{
+    return QString("%1|%2|%3").arg(file.absoluteFilePath()).arg(file.lastModified().toMSecsSinceEpoch()).arg(file.size());
+}
+
+void ThumbnailService::WorkerLoop()
+{
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(lock_);
+            queued_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_)
+                return;
+            job = queue_.front();
+            queue_.pop_front();
+        }
+
+        Process(job);
+
+        std::lock_guard<std::mutex> lock(lock_);
+        finished_.push_back(job);
+    }
+}
+
+void ThumbnailService::Process(Job& job)
+{
+    QString cachePath;
+    Generator generator;
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (!cacheDirectory_.isEmpty())
+        {
+            const QByteArray hash = QCryptographicHash::hash((job.key_ + QString("|%1").arg(size_)).toUtf8(), QCryptographicHash::Sha1);
+            cachePath = QDir(cacheDirectory_).filePath(QString::fromLatin1(hash.toHex()) + ".png");
+        }
+        auto found = generators_.find(job.suffix_);
+        if (found != generators_.end())
+            generator = found.value();
+    }
+
+    if (!cachePath.isEmpty() && QFileInfo(cachePath).exists())
+    {
+        job.image_ = QImage(cachePath);
+        if (!job.image_.isNull())
+            return;
+    }
+
+    job.image_ = generator ? generator(job.filePath_, size_) : ReadImage(job.filePath_, size_);
+    if (job.image_.isNull() || cachePath.isEmpty())
+        return;
+
+    // QSaveFile writes to a temporary file and renames it, a reader never sees it half written
+    QSaveFile file(cachePath);
+    if (file.open(QIODevice::WriteOnly) && job.image_.save(&file, "PNG"))
+        file.commit();
+    else
+        file.cancelWriting();
+}
+
+QImage ThumbnailService::ReadImage(const QString& filePath, int size)
+{
+    QImageReader reader(filePath);
+    if (!reader.canRead())
+        return QImage();
+
+    // Formats such as JPEG decode straight to the smaller size, the rest are scaled once read
+    const QSize fullSize = reader.size();
+    if (fullSize.isValid() && (fullSize.width() > size || fullSize.height() > size))
+        reader.setScaledSize(fullSize.scaled(size, size, Qt::KeepAspectRatio));
+
+    QImage image = reader.read();
+    if (!image.isNull() && (image.width() > size || image.height() > size))
+        image = image.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    return image;
+}
+
+void ThumbnailService::Update()
+{
+    std::vector<Job> finished;
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        finished.swap(finished_);
+    }
+
+    // Pixmaps may only be made on the main thread
+    for (Job& job : finished)
+    {
+        pending_.remove(job.key_);
+        if (job.image_.isNull())
+        {
+            failed_.insert(job.key_);
+            continue;
+        }
+        QPixmap* pixmap = new QPixmap(QPixmap::fromImage(job.image_));
+        pixmaps_.insert(job.key_, pixmap, pixmap->width() * pixmap->height() * 4);
+        if (readyCallback_)
+            readyCallback_(job.filePath_);
+    }
+}
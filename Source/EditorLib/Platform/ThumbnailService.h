@@ -0,0 +1,91 @@
+#pragma once
+
+#include <EditorLib/editorlib_global.h>
+
+#include <QCache>
+#include <QFileInfo>
+#include <QImage>
+#include <QMap>
+#include <QPixmap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class QTimer;
+
+/// Produces file thumbnails on worker threads so that views never wait for a file to be decoded while painting.
+/// Thumbnails are kept in memory and in a folder on disk, keyed by the path, modification time and size of the file so an edited file gets a new one.
+/// Requests return whatever is ready, the view shows a placeholder meanwhile and repaints when told that the thumbnail arrived.
+class EDITORLIB_EXPORT ThumbnailService
+{
+    /// Prevent copy.
+    ThumbnailService(const ThumbnailService&);
+public:
+    /// Makes a thumbnail no larger than size x size from the file, called on a worker thread. Returns a null image if it cannot.
+    typedef std::function<QImage(const QString& filePath, int size)> Generator;
+
+    /// Worker threads making thumbnails.
+    static const unsigned WorkerCount = 2;
+
+    ThumbnailService(int size = 64);
+    ~ThumbnailService();
+
+    /// Uses the generator for files with any of the suffixes (lower case, without the dot) instead of decoding them as images.
+    void AddGenerator(const QStringList& suffixes, Generator generator);
+    /// Folder thumbnails are kept in between sessions, which is created if missing. Empty keeps them in memory only.
+    void SetCacheDirectory(const QString& path);
+    /// Called on the main thread with the path of the file whenever a thumbnail arrives.
+    void SetReadyCallback(std::function<void(const QString&)> callback) { readyCallback_ = callback; }
+
+    /// Returns the thumbnail of the file if it is ready, otherwise queues it and returns a null pixmap. Main thread only.
+    QPixmap GetPixmap(const QFileInfo& file);
+    /// Drops queued requests that have not started, those asked for most recently are made first anyway.
+    void CancelPending();
+
+    int GetSize() const { return size_; }
+
+    /// Decodes an image at reduced resolution where the format allows it.
+    static QImage ReadImage(const QString& filePath, int size);
+
+private:
+    struct Job
+    {
+        QString key_;
+        QString filePath_;
+        QString suffix_;
+        QImage image_;
+    };
+
+    static QString MakeKey(const QFileInfo& file);
+    void WorkerLoop();
+    /// Makes the thumbnail of the job, from the disk cache if it is there.
+    void Process(Job& job);
+    /// Hands finished thumbnails to the main thread.
+    void Update();
+
+    int size_;
+    QString cacheDirectory_;
+    QMap<QString, Generator> generators_;
+    std::function<void(const QString&)> readyCallback_;
+
+    /// Main thread state.
+    QCache<QString, QPixmap> pixmaps_;
+    QSet<QString> pending_;
+    QSet<QString> failed_;
+    QTimer* timer_;
+
+    /// Shared with the workers.
+    std::mutex lock_;
+    std::condition_variable queued_;
+    std::deque<Job> queue_;
+    std::vector<Job> finished_;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+};
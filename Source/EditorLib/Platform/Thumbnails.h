@@ -8,7 +8,7 @@
 
 
 /// Handles the platform specific task of fetching file preview thumbnails from the filesystem.
-/// TODO: add OBJ and FBX quick renders and a cache
+/// Synchronous, views listing many files should use ThumbnailService instead.
 class EDITORLIB_EXPORT Thumbnails : public QFileIconProvider
 {
     /// Prevent copy.
@@ -0,0 +1,88 @@
+#include "CPUComputeBuffer.h"
+
+#include "CPUComputeDevice.h"
+#include "CPUComputeKernel.h"
+
+#include "../../FString.h"
+#include "../../Logging.h"
+
+#include <cstring>
+
+namespace SprueEngine
+{
+
+CPUComputeBuffer::CPUComputeBuffer(const std::string& name, CPUComputeDevice* device, unsigned size, unsigned settings) :
+    base(name, device, size, settings)
+{
+    Allocate(size);
+}
+
+CPUComputeBuffer::CPUComputeBuffer(const std::string& name, CPUComputeDevice* device, unsigned width, unsigned height, unsigned settings) :
+    base(name, device, width, height, settings)
+{
+    DetermineElementSize(settings);
+    Allocate(width * height * elementSize_);
+}
+
+CPUComputeBuffer::CPUComputeBuffer(const std::string& name, CPUComputeDevice* device, unsigned width, unsigned height, unsigned depth, unsigned settings) :
+    base(name, device, width, height, depth, settings)
+{
+    DetermineElementSize(settings);
+    Allocate(width * height * depth * elementSize_);
+}
+
+CPUComputeBuffer::~CPUComputeBuffer()
+{
+
+}
+
+void CPUComputeBuffer::Allocate(unsigned size)
+{
+    size_ = size;
+    storage_.resize((size + sizeof(Block) - 1) / sizeof(Block));
+    if (!storage_.empty())
+        memset(storage_.data(), 0, storage_.size() * sizeof(Block));
+}
+
+void CPUComputeBuffer::SetData(void* data, unsigned offset, unsigned len)
+{
+    if (offset + len > size_)
+    {
+        SPRUE_LOG_ERROR(FString("Attempted to write %1 bytes past the end of CPU buffer: %2", offset + len - size_, name_).str());
+        return;
+    }
+    memcpy((unsigned char*)GetData() + offset, data, len);
+}
+
+void CPUComputeBuffer::ReadData(void* data, unsigned offset, unsigned len)
+{
+    if (offset + len > size_)
+    {
+        SPRUE_LOG_ERROR(FString("Attempted to read %1 bytes past the end of CPU buffer: %2", offset + len - size_, name_).str());
+        return;
+    }
+    memcpy(data, (unsigned char*)GetData() + offset, len);
+}
+
+void CPUComputeBuffer::Bind(ComputeKernel* kernel, unsigned index)
+{
+    if (!kernel)
+    {
+        SPRUE_LOG_ERROR(FString("Attempted to bind CPU buffer %1 to a null kernel", name_).str());
+        return;
+    }
+    ((CPUComputeKernel*)kernel)->SetBuffer(index, this);
+}
+
+void CPUComputeBuffer::DetermineElementSize(unsigned settings)
+{
+    const unsigned channelSize = (settings & CBS_FloatData) ? sizeof(float) : sizeof(unsigned char);
+    if (settings & CBS_RGB)
+        elementSize_ = channelSize * 3;
+    else if (settings & CBS_RGBA)
+        elementSize_ = channelSize * 4;
+    else
+        elementSize_ = channelSize;
+}
+
+}
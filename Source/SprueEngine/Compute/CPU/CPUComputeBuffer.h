@@ -0,0 +1,55 @@
+#pragma once
+
+#include <SprueEngine/Compute/ComputeBuffer.h>
+
+#include <vector>
+
+namespace SprueEngine
+{
+
+    class CPUComputeDevice;
+
+    /// Host memory buffer for the CPU compute device.
+    /// Storage is 16 byte aligned and tightly packed with x varying fastest, so kernels walking a row read contiguous memory
+    /// that vectorizes, images use the same element sizes OpenCL would give them.
+    class SPRUE CPUComputeBuffer : public ComputeBuffer
+    {
+        NOCOPYDEF(CPUComputeBuffer);
+        BASECLASSDEF(CPUComputeBuffer, ComputeBuffer);
+    public:
+        /// Construct a buffer of size bytes.
+        CPUComputeBuffer(const std::string& name, CPUComputeDevice*, unsigned size, unsigned settings);
+        /// Construct a 2d image.
+        CPUComputeBuffer(const std::string& name, CPUComputeDevice*, unsigned width, unsigned height, unsigned settings);
+        /// Construct a 3d image.
+        CPUComputeBuffer(const std::string& name, CPUComputeDevice*, unsigned width, unsigned height, unsigned depth, unsigned settings);
+        /// Destruct.
+        virtual ~CPUComputeBuffer();
+
+        /// Copies data into the buffer.
+        virtual void SetData(void* data, unsigned offset, unsigned len) override;
+        /// Copies data out of the buffer.
+        virtual void ReadData(void* data, unsigned offset, unsigned len) override;
+
+        /// Binds the buffer to a given kernel with a target argument index.
+        virtual void Bind(ComputeKernel* kernel, unsigned index) override;
+
+        /// Direct access to the storage, kernels read and write this.
+        void* GetData() { return storage_.data(); }
+        /// Size of the storage in bytes.
+        unsigned GetSize() const { return size_; }
+
+    private:
+        /// Determines the size of an image element from the generic buffer settings, as OpenCL image formats would.
+        void DetermineElementSize(unsigned settings);
+        void Allocate(unsigned size);
+
+        struct alignas(16) Block
+        {
+            unsigned char bytes_[16];
+        };
+        std::vector<Block> storage_;
+        unsigned size_ = 0;
+    };
+
+}
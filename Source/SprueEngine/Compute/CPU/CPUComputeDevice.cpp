@@ -0,0 +1,123 @@
+#include "CPUComputeDevice.h"
+
+#include "CPUComputeBuffer.h"
+#include "CPUComputeShader.h"
+
+#include <SprueEngine/FString.h>
+#include <SprueEngine/Logging.h>
+#include <SprueEngine/ParallelFor.h>
+
+namespace SprueEngine
+{
+
+CPUComputeDevice::CPUComputeDevice(unsigned workerCount) :
+    requestedWorkers_(workerCount),
+    nextIndex_(0)
+{
+
+}
+
+CPUComputeDevice::~CPUComputeDevice()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+    workers_.clear();
+}
+
+bool CPUComputeDevice::Initialize()
+{
+    if (initialized_)
+        return true;
+
+    // The thread calling Dispatch is one of the workers
+    const unsigned threadCt = requestedWorkers_ > 0 ? requestedWorkers_ : GetParallelWorkerCount();
+    for (unsigned i = 1; i < threadCt; ++i)
+        workers_.push_back(std::thread(&CPUComputeDevice::WorkerLoop, this));
+
+    SPRUE_LOG_INFO(FString("CPU compute initialized with %1 threads", threadCt).str());
+    initialized_ = true;
+    return true;
+}
+
+ComputeBuffer* CPUComputeDevice::CreateBuffer(const std::string& name, unsigned size, unsigned bufferType)
+{
+    return new CPUComputeBuffer(name, this, size, bufferType);
+}
+
+ComputeBuffer* CPUComputeDevice::CreateBuffer(const std::string& name, unsigned width, unsigned height, unsigned bufferType)
+{
+    return new CPUComputeBuffer(name, this, width, height, bufferType);
+}
+
+ComputeBuffer* CPUComputeDevice::CreateBuffer(const std::string& name, unsigned width, unsigned height, unsigned depth, unsigned bufferType)
+{
+    return new CPUComputeBuffer(name, this, width, height, depth, bufferType);
+}
+
+ComputeShader* CPUComputeDevice::CreateShader(const std::string& name)
+{
+    return new CPUComputeShader(name, this);
+}
+
+void CPUComputeDevice::Dispatch(unsigned count, const std::function<void(unsigned)>& func)
+{
+    if (count == 0)
+        return;
+    if (workers_.empty() || count == 1)
+    {
+        for (unsigned i = 0; i < count; ++i)
+            func(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> dispatchLock(dispatchMutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &func;
+        jobCount_ = count;
+        nextIndex_ = 0;
+        busyWorkers_ = (unsigned)workers_.size();
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    RunJob();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]() { return busyWorkers_ == 0; });
+    job_ = 0x0;
+}
+
+void CPUComputeDevice::WorkerLoop()
+{
+    unsigned seenGeneration = 0;
+    for (;;)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [&]() { return stop_ || generation_ != seenGeneration; });
+        if (stop_)
+            return;
+        seenGeneration = generation_;
+        lock.unlock();
+
+        RunJob();
+
+        lock.lock();
+        if (--busyWorkers_ == 0)
+            done_.notify_all();
+    }
+}
+
+void CPUComputeDevice::RunJob()
+{
+    // Rows are handed out one at a time so uneven work balances itself
+    for (unsigned i = nextIndex_++; i < jobCount_; i = nextIndex_++)
+        (*job_)(i);
+}
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <SprueEngine/Compute/ComputeDevice.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace SprueEngine
+{
+
+/// Runs compute kernels as native functions on a pool of worker threads, for hosts without an OpenCL device.
+/// Kernels execute synchronously: Execute returns once every work item has run, so Finish and Barrier have nothing to wait on.
+class SPRUE CPUComputeDevice : public ComputeDevice
+{
+    NOCOPYDEF(CPUComputeDevice);
+public:
+    /// Construct, workerCount of 0 uses every hardware thread.
+    CPUComputeDevice(unsigned workerCount = 0);
+    /// Destruct, stops the worker threads.
+    virtual ~CPUComputeDevice();
+
+    /// Starts the worker threads.
+    virtual bool Initialize() override;
+    /// Returns true once initialized.
+    virtual bool IsValid() const override { return initialized_; }
+    /// Kernels complete inside Execute, nothing to do.
+    virtual void Finish() override { }
+    /// Kernels complete inside Execute, nothing to do.
+    virtual void Barrier() override { }
+
+    /// Construct a buffer for this device with the given identifier.
+    virtual ComputeBuffer* CreateBuffer(const std::string& name, unsigned size, unsigned bufferType) override;
+    /// Construct a 2d image for this device with the given identifier.
+    virtual ComputeBuffer* CreateBuffer(const std::string& name, unsigned width, unsigned height, unsigned bufferType) override;
+    /// Construct a 3d image for this device with the given identifier.
+    virtual ComputeBuffer* CreateBuffer(const std::string& name, unsigned width, unsigned height, unsigned depth, unsigned bufferType) override;
+    /// Construct a shader for this device with the given identifier.
+    virtual ComputeShader* CreateShader(const std::string& name) override;
+
+    /// Runs func(index) for every index in [0, count) across the pool, the calling thread participates. Blocks until done.
+    void Dispatch(unsigned count, const std::function<void(unsigned)>& func);
+    /// Number of threads working on a dispatch, including the caller.
+    unsigned GetThreadCount() const { return (unsigned)workers_.size() + 1; }
+
+private:
+    void WorkerLoop();
+    void RunJob();
+
+    std::vector<std::thread> workers_;
+    unsigned requestedWorkers_;
+    bool initialized_ = false;
+
+    /// Serializes dispatches from different threads.
+    std::mutex dispatchMutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(unsigned)>* job_ = 0x0;
+    unsigned jobCount_ = 0;
+    std::atomic<unsigned> nextIndex_;
+    unsigned generation_ = 0;
+    unsigned busyWorkers_ = 0;
+    bool stop_ = false;
+};
+
+}
@@ -0,0 +1,117 @@
+#include "CPUComputeKernel.h"
+
+#include "../ComputeBuffer.h"
+
+#include "CPUComputeBuffer.h"
+#include "CPUComputeDevice.h"
+#include "CPUComputeShader.h"
+
+#include "../../FString.h"
+#include "../../Logging.h"
+
+#include <cstring>
+
+namespace SprueEngine
+{
+
+    CPUComputeKernel::CPUComputeKernel(const std::string& name, CPUComputeShader* shader, CPUComputeDevice* device) :
+        ComputeKernel(name, device),
+        shader_(shader)
+    {
+        def_ = GetCPUKernel(name_);
+        if (!def_)
+            SPRUE_LOG_ERROR(FString("No native implementation for CPU kernel: %1", name_).str());
+        else
+            args_.resize(def_->params_.size());
+    }
+
+    CPUComputeKernel::~CPUComputeKernel()
+    {
+    }
+
+    void CPUComputeKernel::Bind(ComputeBuffer* buffer, unsigned index)
+    {
+        buffer->Bind(this, index);
+    }
+
+    void CPUComputeKernel::SetBuffer(unsigned index, CPUComputeBuffer* buffer)
+    {
+        if (index >= args_.size())
+        {
+            SPRUE_LOG_ERROR(FString("CPU kernel %1 has no argument %2", name_, index).str());
+            return;
+        }
+        args_[index].buffer_ = buffer;
+        args_[index].value_.clear();
+    }
+
+    void CPUComputeKernel::SetArg(unsigned index, void* value, unsigned sz)
+    {
+        if (index >= args_.size())
+        {
+            SPRUE_LOG_ERROR(FString("CPU kernel %1 has no argument %2", name_, index).str());
+            return;
+        }
+        args_[index].buffer_ = 0x0;
+        args_[index].value_.resize(sz);
+        if (sz > 0)
+            memcpy(args_[index].value_.data(), value, sz);
+    }
+
+    bool CPUComputeKernel::ValidateArgs() const
+    {
+        for (unsigned i = 0; i < def_->params_.size(); ++i)
+        {
+            const CPUKernelParam& param = def_->params_[i];
+            const CPUKernelArg& arg = args_[i];
+            if (param.isBuffer_ != (arg.buffer_ != 0x0))
+            {
+                SPRUE_LOG_ERROR(FString("CPU kernel %1: argument %2 must be %3", name_, i, std::string(param.isBuffer_ ? "a bound buffer" : "a value")).str());
+                return false;
+            }
+            const unsigned size = arg.buffer_ ? arg.buffer_->GetSize() : (unsigned)arg.value_.size();
+            if (size < param.minSize_)
+            {
+                SPRUE_LOG_ERROR(FString("CPU kernel %1: argument %2 holds %3 bytes, %4 required", name_, i, size, param.minSize_).str());
+                return false;
+            }
+        }
+
+        // DensityFunc reads shape parameters and one transform per shape
+        const CPUDensityProgram& density = shader_->GetDensityProgram();
+        if (def_->needsDensity_ && def_->shapeDataParam_ >= 0 && args_[def_->shapeDataParam_].buffer_->GetSize() < density.GetParameterCount() * sizeof(float))
+        {
+            SPRUE_LOG_ERROR(FString("CPU kernel %1: shape data holds fewer than the %2 parameters DensityFunc reads", name_, density.GetParameterCount()).str());
+            return false;
+        }
+        if (def_->needsDensity_ && def_->transformParam_ >= 0)
+        {
+            const unsigned transformSize = args_[def_->transformParam_].buffer_->GetSize();
+            if (transformSize > 0 && transformSize < density.GetOperations().size() * 12 * sizeof(float))
+            {
+                SPRUE_LOG_ERROR(FString("CPU kernel %1: transform data holds fewer than %2 transforms", name_, (unsigned)density.GetOperations().size()).str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void CPUComputeKernel::Execute(unsigned x, unsigned y, unsigned z)
+    {
+        if (!def_)
+        {
+            SPRUE_LOG_ERROR(FString("Attempted to execute uncompiled CPU kernel: %1", name_).str());
+            return;
+        }
+        if (!ValidateArgs())
+            return;
+
+        y = y > 0 ? y : 1;
+        z = z > 0 ? z : 1;
+        const CPUKernelArgs args(args_, &shader_->GetDensityProgram());
+        const CPUKernelFunction function = def_->function_;
+        ((CPUComputeDevice*)device_)->Dispatch(y * z, [&](unsigned row) {
+            function(args, row % y, row / y, x);
+        });
+    }
+}
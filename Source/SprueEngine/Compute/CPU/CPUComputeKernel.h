@@ -0,0 +1,41 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+#include <SprueEngine/Compute/ComputeKernel.h>
+#include <SprueEngine/Compute/CPU/CPUKernels.h>
+
+#include <vector>
+
+namespace SprueEngine
+{
+    class CPUComputeBuffer;
+    class CPUComputeDevice;
+    class CPUComputeShader;
+
+    /// Native kernel from a CPU compute shader.
+    /// Execute runs one row of x work items per task on the device's thread pool, after checking every argument the kernel reads is set and large enough.
+    class SPRUE CPUComputeKernel : public ComputeKernel
+    {
+        NOCOPYDEF(CPUComputeKernel);
+    public:
+        CPUComputeKernel(const std::string& name, CPUComputeShader* shader, CPUComputeDevice* device);
+        virtual ~CPUComputeKernel();
+
+        virtual void Bind(ComputeBuffer* buffer, unsigned index) override;
+        virtual void Execute(unsigned x, unsigned y, unsigned z) override;
+        virtual void SetArg(unsigned index, void* value, unsigned sz) override;
+        virtual bool IsExecutable() const override { return def_ != 0x0; }
+
+        /// Sets the buffer argument at index, called by CPUComputeBuffer::Bind.
+        void SetBuffer(unsigned index, CPUComputeBuffer* buffer);
+
+    protected:
+        /// Returns false with the problem logged if the arguments do not satisfy the kernel.
+        bool ValidateArgs() const;
+
+        const CPUKernelDef* def_ = 0x0;
+        CPUComputeShader* shader_ = 0x0;
+        std::vector<CPUKernelArg> args_;
+    };
+
+}
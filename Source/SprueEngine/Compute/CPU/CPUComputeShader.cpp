@@ -0,0 +1,118 @@
+#include "CPUComputeShader.h"
+
+#include "CPUComputeDevice.h"
+#include "CPUComputeKernel.h"
+
+#include "../../FString.h"
+#include "../../Logging.h"
+
+#include <cctype>
+
+namespace SprueEngine
+{
+
+/// Collects the names of every 'kernel void Name(' declaration.
+static void FindKernelDeclarations(const std::string& source, std::set<std::string>& names)
+{
+    size_t pos = 0;
+    while ((pos = source.find("kernel", pos)) != std::string::npos)
+    {
+        const bool wordStart = pos == 0 || !(isalnum((unsigned char)source[pos - 1]) || source[pos - 1] == '_');
+        pos += 6;
+        if (!wordStart)
+            continue;
+
+        size_t cursor = source.find_first_not_of(" \t\r\n", pos);
+        if (cursor == std::string::npos || source.compare(cursor, 4, "void") != 0)
+            continue;
+        cursor = source.find_first_not_of(" \t\r\n", cursor + 4);
+        if (cursor == std::string::npos)
+            continue;
+
+        size_t nameEnd = cursor;
+        while (nameEnd < source.length() && (isalnum((unsigned char)source[nameEnd]) || source[nameEnd] == '_'))
+            ++nameEnd;
+        if (nameEnd > cursor && source.find_first_not_of(" \t\r\n", nameEnd) != std::string::npos && source[source.find_first_not_of(" \t\r\n", nameEnd)] == '(')
+            names.insert(source.substr(cursor, nameEnd - cursor));
+    }
+}
+
+CPUComputeShader::CPUComputeShader(const std::string& name, CPUComputeDevice* device) :
+    base(name, device)
+{
+    isCompiled_ = false;
+}
+
+CPUComputeShader::~CPUComputeShader()
+{
+
+}
+
+bool CPUComputeShader::CompileShader(const std::vector<std::string>& sources, const std::string& defines)
+{
+    isCompiled_ = false;
+    kernels_.clear();
+
+    std::string combined;
+    for (auto& source : sources)
+        combined += source;
+
+    std::string error;
+    if (!density_.Parse(combined, error))
+    {
+        SPRUE_LOG_ERROR(FString("Failed to read DensityFunc of CPU compute shader %1: %2", name_, error).str());
+        return false;
+    }
+
+    FindKernelDeclarations(combined, kernels_);
+    bool missing = false;
+    for (auto& kernel : kernels_)
+    {
+        const CPUKernelDef* def = GetCPUKernel(kernel);
+        if (!def)
+        {
+            SPRUE_LOG_ERROR(FString("CPU compute shader %1: kernel %2 has no native implementation", name_, kernel).str());
+            missing = true;
+        }
+        else if (def->needsDensity_ && density_.IsEmpty())
+        {
+            SPRUE_LOG_ERROR(FString("CPU compute shader %1: kernel %2 requires a DensityFunc", name_, kernel).str());
+            missing = true;
+        }
+    }
+    if (missing)
+        return false;
+
+    isCompiled_ = true;
+    return true;
+}
+
+bool CPUComputeShader::CompileShader(const std::string& source, const std::string& defines)
+{
+    std::vector<std::string> srcs;
+    srcs.push_back(source);
+    return CompileShader(srcs, defines);
+}
+
+ComputeKernel* CPUComputeShader::GetKernel(const std::string& name)
+{
+    if (!IsCompiled())
+    {
+        SPRUE_LOG_ERROR(FString("Attempting to get kernel for uncompiled compute shader: %1", name).str());
+        return 0x0;
+    }
+    if (kernels_.find(name) == kernels_.end())
+    {
+        SPRUE_LOG_ERROR(FString("Compute shader %1 does not declare kernel: %2", name_, name).str());
+        return 0x0;
+    }
+
+    ComputeKernel* kernel = new CPUComputeKernel(name, this, (CPUComputeDevice*)device_);
+    if (kernel->IsExecutable())
+        return kernel;
+    delete kernel;
+    SPRUE_LOG_ERROR(FString("Kernel for compute shader: %1 is not executable", name).str());
+    return 0x0;
+}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <SprueEngine/Compute/ComputeShader.h>
+#include <SprueEngine/Compute/CPU/CPUKernels.h>
+
+#include <set>
+
+namespace SprueEngine
+{
+    class CPUComputeDevice;
+    class ComputeKernel;
+
+    /// CPU counterpart of an OpenCL program, takes the same sources.
+    /// Every kernel the sources declare is resolved to its native implementation (see GetCPUKernel), compilation fails if one has none.
+    /// A DensityFunc in the sources, as written by OpenCLDensityShaderBuilder, is read into a CPUDensityProgram for the kernels that call it.
+    class SPRUE CPUComputeShader : public ComputeShader
+    {
+        NOCOPYDEF(CPUComputeShader);
+        BASECLASSDEF(CPUComputeShader, ComputeShader);
+    public:
+        /// Construct for the given compute device with an identifying name.
+        CPUComputeShader(const std::string& name, CPUComputeDevice*);
+        /// Destruct.
+        virtual ~CPUComputeShader();
+
+        /// Resolves the kernels declared by the sources, defines are ignored as the native kernels are already compiled.
+        virtual bool CompileShader(const std::vector<std::string>& sources, const std::string& defines = std::string()) override;
+        /// Resolves the kernels declared by the source.
+        virtual bool CompileShader(const std::string& source, const std::string& defines = std::string()) override;
+        /// Gets a kernel (if it exists) by name from the compiled shader.
+        virtual ComputeKernel* GetKernel(const std::string& name) override;
+
+        /// Returns the density function read from the sources, empty if they have none.
+        const CPUDensityProgram& GetDensityProgram() const { return density_; }
+
+    private:
+        /// Names of the kernels declared by the sources.
+        std::set<std::string> kernels_;
+        /// DensityFunc of the sources.
+        CPUDensityProgram density_;
+    };
+
+}
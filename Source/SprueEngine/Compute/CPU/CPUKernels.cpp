@@ -0,0 +1,346 @@
+#include "CPUKernels.h"
+
+#include "CPUComputeBuffer.h"
+
+#include "../../FString.h"
+
+#include <cfloat>
+#include <cmath>
+#include <unordered_map>
+
+namespace SprueEngine
+{
+
+static const struct { const char* name_; CPUDensityShape shape_; unsigned paramCount_; } DensityShapes[] = {
+    { "SphereDensity", CDS_Sphere, 1 },
+    { "BoxDensity", CDS_Box, 3 },
+    { "EllipsoidDensity", CDS_Ellipsoid, 3 },
+    { "CylinderDensity", CDS_Cylinder, 2 },
+    { "CapsuleDensity", CDS_Capsule, 2 },
+    { "PlaneDensity", CDS_Plane, 4 },
+    { "TorusDensity", CDS_Torus, 2 },
+};
+
+static std::string TrimStatement(const std::string& text)
+{
+    const size_t start = text.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos)
+        return std::string();
+    const size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(start, end - start + 1);
+}
+
+bool CPUDensityProgram::Parse(const std::string& source, std::string& error)
+{
+    operations_.clear();
+
+    const size_t funcStart = source.find("float DensityFunc(");
+    if (funcStart == std::string::npos)
+        return true;
+    const size_t bodyStart = source.find('{', funcStart);
+    const size_t bodyEnd = source.find("return density", funcStart);
+    if (bodyStart == std::string::npos || bodyEnd == std::string::npos || bodyEnd < bodyStart)
+    {
+        error = "DensityFunc has no body ending in 'return density'";
+        return false;
+    }
+
+    const std::string body = source.substr(bodyStart + 1, bodyEnd - bodyStart - 1);
+    size_t statementStart = 0;
+    while (statementStart < body.length())
+    {
+        size_t statementEnd = body.find(';', statementStart);
+        if (statementEnd == std::string::npos)
+            statementEnd = body.length();
+        const std::string statement = TrimStatement(body.substr(statementStart, statementEnd - statementStart));
+        statementStart = statementEnd + 1;
+
+        // The paramIndex/transformIndex declarations
+        if (statement.empty() || statement.compare(0, 4, "int ") == 0)
+            continue;
+
+        Operation op;
+        if (statement.compare(0, 13, "float density") == 0)
+            op.combine_ = CDC_First;
+        else if (statement.find("CSGAdd(") != std::string::npos)
+            op.combine_ = CDC_Add;
+        else if (statement.find("CSGSubtract(") != std::string::npos)
+            op.combine_ = CDC_Subtract;
+        else if (statement.find("CSGIntersect(") != std::string::npos)
+            op.combine_ = CDC_Intersect;
+        else
+        {
+            error = FString("Unsupported DensityFunc statement: %1", statement).str();
+            return false;
+        }
+
+        if ((op.combine_ == CDC_First) != operations_.empty())
+        {
+            error = FString("DensityFunc combines shapes before declaring the density: %1", statement).str();
+            return false;
+        }
+
+        bool found = false;
+        for (auto& shape : DensityShapes)
+        {
+            if (statement.find(std::string(shape.name_) + "(") != std::string::npos)
+            {
+                op.shape_ = shape.shape_;
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+        {
+            if (statement.find("Segment(") != std::string::npos)
+                error = "Spinal pieces (Segment) have no native density function";
+            else
+                error = FString("Unknown density function in: %1", statement).str();
+            return false;
+        }
+        operations_.push_back(op);
+    }
+    return true;
+}
+
+float CPUDensityProgram::Evaluate(const float* pos, const float* shapeData, const float* transforms) const
+{
+    float density = FLT_MAX;
+    unsigned paramIndex = 0;
+    for (unsigned i = 0; i < operations_.size(); ++i)
+    {
+        const Operation& op = operations_[i];
+
+        // Shapes are evaluated in their own space, through the inverse world transform written for every piece
+        float p[3] = { pos[0], pos[1], pos[2] };
+        if (transforms)
+        {
+            const float* m = transforms + i * 12;
+            for (unsigned row = 0; row < 3; ++row)
+                p[row] = m[row * 4] * pos[0] + m[row * 4 + 1] * pos[1] + m[row * 4 + 2] * pos[2] + m[row * 4 + 3];
+        }
+
+        const float* data = shapeData + paramIndex;
+        float value = 0.0f;
+        switch (op.shape_)
+        {
+        case CDS_Sphere:
+            value = sqrtf(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]) - data[0];
+            break;
+        case CDS_Box: {
+            const float dx = fabsf(p[0]) - data[0];
+            const float dy = fabsf(p[1]) - data[1];
+            const float dz = fabsf(p[2]) - data[2];
+            const float ox = dx > 0.0f ? dx : 0.0f;
+            const float oy = dy > 0.0f ? dy : 0.0f;
+            const float oz = dz > 0.0f ? dz : 0.0f;
+            const float inside = fmaxf(dx, fmaxf(dy, dz));
+            value = fminf(inside, 0.0f) + sqrtf(ox * ox + oy * oy + oz * oz);
+        } break;
+        case CDS_Ellipsoid:
+            value = (p[0] / data[0]) * (p[0] / data[0]) + (p[1] / data[1]) * (p[1] / data[1]) + (p[2] / data[2]) * (p[2] / data[2]) - 1.0f;
+            break;
+        case CDS_Cylinder:
+            value = fmaxf(sqrtf(p[0] * p[0] + p[2] * p[2]) - data[0], fabsf(p[1]) - data[1]);
+            break;
+        case CDS_Capsule: {
+            // Segment along Z of the given length, closest point clamped to it
+            const float halfLength = data[0] * 0.5f;
+            const float t = halfLength > 0.0f ? fminf(fmaxf((p[2] + halfLength) / (2.0f * halfLength), 0.0f), 1.0f) : 0.5f;
+            const float dz = p[2] - (-halfLength + t * 2.0f * halfLength);
+            value = sqrtf(p[0] * p[0] + p[1] * p[1] + dz * dz) - data[1];
+        } break;
+        case CDS_Plane:
+            value = p[0] * data[0] + p[1] * data[1] + p[2] * data[2] + data[3];
+            break;
+        case CDS_Torus: {
+            const float qx = sqrtf(p[0] * p[0] + p[2] * p[2]) - data[0];
+            value = sqrtf(qx * qx + p[1] * p[1]) - data[1];
+        } break;
+        }
+        paramIndex += DensityShapes[op.shape_].paramCount_;
+
+        switch (op.combine_)
+        {
+        case CDC_First:
+            density = value;
+            break;
+        case CDC_Add:
+            density = fminf(density, value);
+            break;
+        case CDC_Subtract:
+            density = fmaxf(density, -value);
+            break;
+        case CDC_Intersect:
+            density = fmaxf(density, value);
+            break;
+        }
+    }
+    return density;
+}
+
+unsigned CPUDensityProgram::GetParameterCount() const
+{
+    unsigned ret = 0;
+    for (auto& op : operations_)
+        ret += DensityShapes[op.shape_].paramCount_;
+    return ret;
+}
+
+void* CPUKernelArgs::GetBufferData(unsigned index) const
+{
+    CPUComputeBuffer* buffer = args_[index].buffer_;
+    return buffer->GetSize() > 0 ? buffer->GetData() : 0x0;
+}
+
+static inline unsigned ClampedIndex(int x, int y, int z, int edge)
+{
+    x = x < 0 ? 0 : (x >= edge ? edge - 1 : x);
+    y = y < 0 ? 0 : (y >= edge ? edge - 1 : y);
+    z = z < 0 ? 0 : (z >= edge ? edge - 1 : z);
+    return (unsigned)(z * edge * edge + y * edge + x);
+}
+
+/// BasicDensityKernel.cl
+static void GenerateDefaultField(const CPUKernelArgs& args, unsigned y, unsigned z, unsigned width)
+{
+    const int* offset = args.GetValue<int>(0);
+    float* densities = args.GetBuffer<float>(2);
+    const float* transforms = args.GetBuffer<float>(3);
+    const float* shapeData = args.GetBuffer<float>(4);
+    const CPUDensityProgram* density = args.GetDensity();
+
+    float pos[3] = { 0.0f, (float)((int)y + offset[1]), (float)((int)z + offset[2]) };
+    for (unsigned x = 0; x < width; ++x)
+    {
+        pos[0] = (float)((int)x + offset[0]);
+        densities[ClampedIndex(x, y, z, CPU_DENSITY_EDGE)] = density->Evaluate(pos, shapeData, transforms);
+    }
+}
+
+/// IdentifyVoxels.cl
+static void ScanVoxels(const CPUKernelArgs& args, unsigned y, unsigned z, unsigned width)
+{
+    static const int ChildOffsets[8][3] = {
+        { 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 }, { 0, 1, 1 },
+        { 1, 0, 0 }, { 1, 0, 1 }, { 1, 1, 0 }, { 1, 1, 1 }
+    };
+
+    const char* densities = args.GetBuffer<const char>(0);
+    int* voxelIndices = args.GetBuffer<int>(1);
+    for (unsigned x = 0; x < width; ++x)
+    {
+        int corners = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            if (densities[ClampedIndex(x + ChildOffsets[i][0], y + ChildOffsets[i][1], z + ChildOffsets[i][2], CPU_DENSITY_EDGE)] < 0)
+                corners |= 1 << i;
+        }
+        voxelIndices[ClampedIndex(x, y, z, CPU_VOXEL_EDGE)] = corners;
+    }
+}
+
+static const unsigned FIND_EDGE_INFO_STEPS = 8;
+
+/// FindEdgeIntersections.cl
+static void FindEdgeIntersections(const CPUKernelArgs& args, unsigned y, unsigned z, unsigned width)
+{
+    static const float EdgePoints[4][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+    const float h = 0.001f;
+
+    char* density = args.GetBuffer<char>(0);
+    const float* paramData = args.GetBuffer<float>(1);
+    const float* transformData = args.GetBuffer<float>(2);
+    CPUEdgeData* edgeValues = args.GetBuffer<CPUEdgeData>(3);
+    const CPUDensityProgram* program = args.GetDensity();
+
+    for (unsigned x = 0; x < width; ++x)
+    {
+        const float pos[3] = { (float)x, (float)y, (float)z };
+        const unsigned index = ClampedIndex(x, y, z, CPU_DENSITY_EDGE);
+        const float lhs = program->Evaluate(pos, paramData, transformData);
+
+        for (unsigned i = 1; i < 4; ++i)
+        {
+            // Step along the edge for the sample closest to zero
+            float minValue = FLT_MAX;
+            float t = 0.0f;
+            for (unsigned step = 0; step <= FIND_EDGE_INFO_STEPS; ++step)
+            {
+                const float currentT = step / (float)FIND_EDGE_INFO_STEPS;
+                const float p[3] = { pos[0] + EdgePoints[i][0] * currentT, pos[1] + EdgePoints[i][1] * currentT, pos[2] + EdgePoints[i][2] * currentT };
+                const float d = fabsf(program->Evaluate(p, paramData, transformData));
+                if (d < minValue)
+                {
+                    t = currentT;
+                    minValue = d;
+                }
+            }
+            const float crossing[3] = { pos[0] + EdgePoints[i][0] * t, pos[1] + EdgePoints[i][1] * t, pos[2] + EdgePoints[i][2] * t };
+
+            float normal[3];
+            for (unsigned axis = 0; axis < 3; ++axis)
+            {
+                float plus[3] = { crossing[0], crossing[1], crossing[2] };
+                float minus[3] = { crossing[0], crossing[1], crossing[2] };
+                plus[axis] += h;
+                minus[axis] -= h;
+                normal[axis] = program->Evaluate(plus, paramData, transformData) - program->Evaluate(minus, paramData, transformData);
+            }
+            const float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            const float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+
+            CPUEdgeData& edge = edgeValues[index * 3 + i - 1];
+            edge.normal[0] = normal[0] * invLength;
+            edge.normal[1] = normal[1] * invLength;
+            edge.normal[2] = normal[2] * invLength;
+            edge.normal[3] = 0.0f;
+            edge.distance = t;
+        }
+
+        density[index] = lhs < 0 ? -1 : 1;
+    }
+}
+
+static std::unordered_map<std::string, CPUKernelDef>& GetCPUKernelTable()
+{
+    static std::unordered_map<std::string, CPUKernelDef> table = []() {
+        const unsigned densityCells = CPU_DENSITY_EDGE * CPU_DENSITY_EDGE * CPU_DENSITY_EDGE;
+        const unsigned voxelCells = CPU_VOXEL_EDGE * CPU_VOXEL_EDGE * CPU_VOXEL_EDGE;
+
+        std::unordered_map<std::string, CPUKernelDef> ret;
+        CPUKernelDef& generate = ret["GenerateDefaultField"];
+        generate.function_ = GenerateDefaultField;
+        generate.params_ = { { false, sizeof(int) * 4 }, { false, sizeof(int) }, { true, densityCells * sizeof(float) }, { true, 0 }, { true, 0 } };
+        generate.needsDensity_ = true;
+        generate.transformParam_ = 3;
+        generate.shapeDataParam_ = 4;
+
+        CPUKernelDef& scan = ret["ScanVoxels"];
+        scan.function_ = ScanVoxels;
+        scan.params_ = { { true, densityCells }, { true, voxelCells * sizeof(int) } };
+
+        CPUKernelDef& edges = ret["FindEdgeIntersections"];
+        edges.function_ = FindEdgeIntersections;
+        edges.params_ = { { true, densityCells }, { true, 0 }, { true, 0 }, { true, densityCells * 3 * (unsigned)sizeof(CPUEdgeData) } };
+        edges.needsDensity_ = true;
+        edges.shapeDataParam_ = 1;
+        edges.transformParam_ = 2;
+        return ret;
+    }();
+    return table;
+}
+
+const CPUKernelDef* GetCPUKernel(const std::string& name)
+{
+    auto& table = GetCPUKernelTable();
+    auto found = table.find(name);
+    return found != table.end() ? &found->second : 0x0;
+}
+
+void RegisterCPUKernel(const std::string& name, const CPUKernelDef& def)
+{
+    GetCPUKernelTable()[name] = def;
+}
+
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+
+#include <string>
+#include <vector>
+
+namespace SprueEngine
+{
+    class CPUComputeBuffer;
+
+    /// Edge length of the density field written by GenerateDefaultField and FindEdgeIntersections.
+    static const unsigned CPU_DENSITY_EDGE = 65;
+    /// Edge length of the voxel grid written by ScanVoxels.
+    static const unsigned CPU_VOXEL_EDGE = 64;
+
+    /// Matches struct EdgeData of FindEdgeIntersections.cl, where a float3 occupies 16 bytes.
+    struct CPUEdgeData
+    {
+        float normal[4];
+        float distance;
+        float padding[3];
+    };
+
+    /// Shapes of DensityFunctions.cl.
+    enum CPUDensityShape
+    {
+        CDS_Sphere,
+        CDS_Box,
+        CDS_Ellipsoid,
+        CDS_Cylinder,
+        CDS_Capsule,
+        CDS_Plane,
+        CDS_Torus
+    };
+
+    /// How a shape is combined with the density before it.
+    enum CPUDensityCombine
+    {
+        CDC_First,
+        CDC_Add,
+        CDC_Subtract,
+        CDC_Intersect
+    };
+
+    /// Native equivalent of the DensityFunc an OpenCLDensityShaderBuilder writes.
+    /// The generated statements are read back into a list of shapes and CSG operations, the shape parameters and inverse transforms
+    /// come from the same buffers the OpenCL kernels receive.
+    class SPRUE CPUDensityProgram
+    {
+    public:
+        struct Operation
+        {
+            CPUDensityShape shape_;
+            CPUDensityCombine combine_;
+        };
+
+        /// Reads the DensityFunc out of shader sources, returns false with a reason if one is found that cannot be evaluated natively.
+        bool Parse(const std::string& source, std::string& error);
+        /// Evaluates the density at a position, transforms holds one row-major Mat3x4 per shape and may be null.
+        float Evaluate(const float* pos, const float* shapeData, const float* transforms) const;
+
+        /// Number of floats of shape data the program reads.
+        unsigned GetParameterCount() const;
+        bool IsEmpty() const { return operations_.empty(); }
+        const std::vector<Operation>& GetOperations() const { return operations_; }
+
+    private:
+        std::vector<Operation> operations_;
+    };
+
+    /// A value or buffer set on a CPUComputeKernel.
+    struct CPUKernelArg
+    {
+        std::vector<unsigned char> value_;
+        CPUComputeBuffer* buffer_ = 0x0;
+    };
+
+    /// Arguments handed to a native kernel, indexed in the order of the OpenCL kernel's parameters.
+    class SPRUE CPUKernelArgs
+    {
+    public:
+        CPUKernelArgs(const std::vector<CPUKernelArg>& args, const CPUDensityProgram* density) :
+            args_(args), density_(density)
+        {
+        }
+
+        /// Returns the data of the buffer bound at index, null for an empty buffer. The kernel's signature has been validated before it runs.
+        template<typename T>
+        T* GetBuffer(unsigned index) const { return (T*)GetBufferData(index); }
+        /// Returns the value set at index.
+        template<typename T>
+        const T* GetValue(unsigned index) const { return (const T*)args_[index].value_.data(); }
+
+        const CPUDensityProgram* GetDensity() const { return density_; }
+
+    private:
+        void* GetBufferData(unsigned index) const;
+
+        const std::vector<CPUKernelArg>& args_;
+        const CPUDensityProgram* density_;
+    };
+
+    /// Processes one row of the dispatch: every x in [0, width) at the given y and z.
+    typedef void(*CPUKernelFunction)(const CPUKernelArgs& args, unsigned y, unsigned z, unsigned width);
+
+    /// Parameter of a native kernel, checked before every dispatch.
+    struct CPUKernelParam
+    {
+        /// Bound with Bind rather than SetArg.
+        bool isBuffer_;
+        /// Bytes the buffer or value must hold at least.
+        unsigned minSize_;
+    };
+
+    /// Native implementation of an OpenCL kernel.
+    struct CPUKernelDef
+    {
+        CPUKernelFunction function_ = 0x0;
+        std::vector<CPUKernelParam> params_;
+        /// The kernel calls DensityFunc.
+        bool needsDensity_ = false;
+        /// Parameter holding the shape data DensityFunc reads, -1 if none.
+        int shapeDataParam_ = -1;
+        /// Parameter holding the inverse shape transforms DensityFunc reads, -1 if none.
+        int transformParam_ = -1;
+    };
+
+    /// Returns the native implementation of an OpenCL kernel by name, null if there is none.
+    SPRUE const CPUKernelDef* GetCPUKernel(const std::string& name);
+    /// Registers a native implementation for a kernel name, replacing any previous one.
+    SPRUE void RegisterCPUKernel(const std::string& name, const CPUKernelDef& def);
+}
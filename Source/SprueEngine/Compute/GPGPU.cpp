@@ -6,7 +6,9 @@ namespace SprueEngine
 ComputeDevice* CreateComputeDevice()
 {
     #if defined(CPU_COMPUTE)
-        return 0x0;
+        CPUComputeDevice* ret = new CPUComputeDevice();
+        ret->Initialize();
+        return ret;
     #elif defined(DX11_COMPUTE)
         return 0x0;
     #elif defined(OGL_COMPUTE)
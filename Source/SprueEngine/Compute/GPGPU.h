@@ -1,7 +1,6 @@
 #pragma once
 
 #if defined(CPU_COMPUTE)        // Purely on the CPU, abstract now has cost
-    // NOT IMPLEMENTED
     #include <SprueEngine/Compute/CPU/CPUComputeBuffer.h>
     #include <SprueEngine/Compute/CPU/CPUComputeDevice.h>
     #include <SprueEngine/Compute/CPU/CPUComputeShader.h>
@@ -4,6 +4,9 @@
 #include <fstream>
 #include <sstream>
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
 #ifdef WIN32
     #include <Windows.h>
     #include <shellapi.h>
@@ -42,6 +45,15 @@ namespace SprueEngine
         return strm.good();
     }
 
+    uint64_t GetFileStamp(const std::string& file)
+    {
+        struct stat info;
+        if (stat(file.c_str(), &info) != 0)
+            return 0;
+        uint64_t stamp = HashBytes64(&info.st_mtime, sizeof(info.st_mtime));
+        return HashBytes64(&info.st_size, sizeof(info.st_size), stamp);
+    }
+
     std::string ReadFile(const std::string& file)
     {
         std::ifstream strm(file);
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <ctype.h>
+#include <cstdint>
 #include <set>
 #include <string>
 #include <sstream>
@@ -140,6 +141,9 @@ std::vector<std::string> Split(const std::string& s, char delim);
 
 bool FileAccessible(const std::string& file);
 
+/// Hash of the modification time and size of a file, changes whenever the file is rewritten. 0 if the file cannot be found.
+uint64_t GetFileStamp(const std::string& file);
+
 /// Reads a file into a single string (using STL).
 std::string ReadFile(const std::string& file);
 
@@ -170,4 +174,13 @@ bool IsPathRooted(const std::string& path);
 
 std::string ReplaceString(const std::string& src, const std::string& term, const std::string& replacement);
 
+/// 64 bit FNV-1a, for content hashes where the 32 bits of StringHash collide too easily.
+inline uint64_t HashBytes64(const void* data, size_t size, uint64_t hash = 0xCBF29CE484222325ull)
+{
+    const unsigned char* ptr = (const unsigned char*)data;
+    while (size--)
+        hash = (hash ^ *ptr++) * 0x100000001B3ull;
+    return hash;
+}
+
 }
\ No newline at end of file
@@ -2,11 +2,17 @@
 
 #include <SprueEngine/Core/Context.h>
 #include <SprueEngine/Deserializer.h>
+#include <SprueEngine/FString.h>
 #include <SprueEngine/Graph/GraphSocket.h>
 #include <SprueEngine/Serializer.h>
 #include <SprueEngine/Logging.h>
+#include <SprueEngine/Property.h>
+#include <SprueEngine/ResourceStore.h>
+#include <SprueEngine/VectorBuffer.h>
 
-#define GRAPH_VERSION 1
+// 1: nodes and edges refer to each other by ID, every edge is written in both directions
+// 2: indexed, a table of node block sizes followed by the nodes, edges refer to nodes by position and sockets by flat index
+#define GRAPH_VERSION 2
 
 namespace SprueEngine
 {
@@ -23,6 +29,19 @@ namespace SprueEngine
 
 GraphSocket* FindSocket(const std::vector<GraphNode*>& nodes, unsigned nodeID, unsigned socketID);
 
+/// Loads the resources a graph deserialized with deferResources_ refers to, all at once rather than one node at a time.
+static void LoadDeferredResources(const SerializationContext& deferred, const SerializationContext& context)
+{
+    if (ResourceStore* store = Context::GetInstance()->GetService<ResourceStore>())
+        store->LoadDeferred(deferred);
+    else
+    {
+        for (const SerializationContext::DeferredResource& resource : deferred.deferredResources_)
+            resource.property_->Set(resource.object_, ResourceHandle(resource.type_, resource.name_));
+    }
+    context.pathErrors_ = deferred.pathErrors_;
+}
+
 Graph::Graph() :
     masterNode_(0x0),
     currentExecutionContext_(0)
@@ -47,6 +66,7 @@ void Graph::AddNode(GraphNode* node, bool entryPoint)
         node->graph->RemoveNode(node);
     node->graph = this;
     nodes_.push_back(node);
+    nodeIndexDirty_ = true;
     if (entryPoint)
         entryNodes_.push_back(node);
     SprueEngine::Context::GetInstance()->GetCallbacks().GraphNodeAdded(node);
@@ -58,6 +78,7 @@ void Graph::RemoveNode(GraphNode* node)
     auto found = std::find(nodes_.begin(), nodes_.end(), node);
     if (found != nodes_.end())
         nodes_.erase(found);
+    nodeIndexDirty_ = true;
     found = std::find(entryNodes_.begin(), entryNodes_.end(), node);
     if (found != entryNodes_.end())
         entryNodes_.erase(found);
@@ -66,18 +87,34 @@ void Graph::RemoveNode(GraphNode* node)
 
 GraphNode* Graph::GetNode(unsigned id)
 {
-    for (GraphNode* node : nodes_)
-        if (node->id == id)
-            return node;
-    return 0x0;
+    return const_cast<GraphNode*>(static_cast<const Graph*>(this)->GetNode(id));
 }
 
 const GraphNode* Graph::GetNode(unsigned id) const
 {
+    if (nodeIndexDirty_)
+        BuildNodeIndex();
+
+    // A miss is final, so the dangling IDs older files carry cost a lookup rather than a pass over every node.
+    // IDs are public, a hit on a node renumbered behind the graph's back rebuilds the index and looks once more
+    auto found = nodeIndex_.find(id);
+    if (found == nodeIndex_.end())
+        return 0x0;
+    if (found->second->id == id)
+        return found->second;
+
+    BuildNodeIndex();
+    found = nodeIndex_.find(id);
+    return found != nodeIndex_.end() ? found->second : 0x0;
+}
+
+void Graph::BuildNodeIndex() const
+{
+    nodeIndex_.clear();
+    nodeIndex_.reserve(nodes_.size());
     for (GraphNode* node : nodes_)
-        if (node->id == id)
-            return node;
-    return 0x0;
+        nodeIndex_.emplace(node->id, node);
+    nodeIndexDirty_ = false;
 }
 
 GraphNode* Graph::GetNodeBySourceID(unsigned id)
@@ -264,6 +301,16 @@ bool Graph::CanConnect(GraphSocket* from, GraphSocket* to)
 
 bool Graph::Deserialize(Deserializer* src, const SerializationContext& context)
 {
+    // Opening a graph, clones find the resources of their source already loaded
+    if (!context.isClone_ && !context.deferResources_)
+    {
+        SerializationContext deferred = context;
+        deferred.deferResources_ = true;
+        const bool ret = Deserialize(src, deferred);
+        LoadDeferredResources(deferred, context);
+        return ret;
+    }
+
     bool success = true;
     //if (src->ReadFileID().compare("GRPH") != 0)
     //{
@@ -272,7 +319,8 @@ bool Graph::Deserialize(Deserializer* src, const SerializationContext& context)
     //}
 
     unsigned version = src->ReadUShort();
-    //TODO: as new versions come along add the necessary handling to update old files
+    if (version >= 2)
+        return DeserializeIndexed(src, context);
 
     // Nodes
     unsigned nodeCt = src->ReadUInt();
@@ -286,6 +334,7 @@ bool Graph::Deserialize(Deserializer* src, const SerializationContext& context)
         }
         --nodeCt;
     }
+    nodeIndexDirty_ = true;
 
     // Master node
     unsigned masterID = src->ReadUInt();
@@ -349,6 +398,80 @@ bool Graph::Deserialize(Deserializer* src, const SerializationContext& context)
     return success;
 }
 
+bool Graph::DeserializeIndexed(Deserializer* src, const SerializationContext& context)
+{
+    bool success = true;
+
+    // Node table
+    const unsigned nodeCt = src->ReadUInt();
+    std::vector<unsigned> blockSizes(nodeCt);
+    if (nodeCt > 0 && src->Read(blockSizes.data(), nodeCt * sizeof(unsigned)) != nodeCt * sizeof(unsigned))
+        return false;
+
+    // Nodes, by their position in the table
+    std::vector<GraphNode*> table(nodeCt, 0x0);
+    nodes_.reserve(nodes_.size() + nodeCt);
+    for (unsigned i = 0; i < nodeCt; ++i)
+    {
+        const unsigned blockEnd = src->GetPosition() + blockSizes[i];
+        if (GraphNode* newNode = Context::GetInstance()->Deserialize<GraphNode>(src, context))
+        {
+            nodes_.push_back(newNode);
+            newNode->graph = this;
+            table[i] = newNode;
+        }
+
+        // A node of an unknown type, or one that read more or less than it wrote, costs only itself
+        if (src->GetPosition() != blockEnd)
+        {
+            SPRUE_LOG_WARNING(FString("Graph node %1 did not read back as written", i).c_str());
+            src->Seek(blockEnd);
+            success = false;
+        }
+    }
+    nodeIndexDirty_ = true;
+
+    // Master node
+    const unsigned masterIndex = src->ReadUInt();
+    if (masterIndex < nodeCt)
+        masterNode_ = table[masterIndex];
+
+    // Entry points
+    const unsigned entryCt = src->ReadUInt();
+    for (unsigned i = 0; i < entryCt; ++i)
+    {
+        const unsigned index = src->ReadUInt();
+        if (index < nodeCt && table[index])
+            entryNodes_.push_back(table[index]);
+    }
+
+    // Edges, the downstream edges are the same edges reversed
+    const unsigned edgeCt = src->ReadUInt();
+    upstreamEdges_.reserve(upstreamEdges_.size() + edgeCt);
+    downstreamEdges_.reserve(downstreamEdges_.size() + edgeCt);
+    for (unsigned i = 0; i < edgeCt; ++i)
+    {
+        unsigned edge[4];
+        if (src->Read(edge, sizeof(edge)) != sizeof(edge))
+            return false;
+
+        GraphNode* fromNode = edge[0] < nodeCt ? table[edge[0]] : 0x0;
+        GraphNode* toNode = edge[2] < nodeCt ? table[edge[2]] : 0x0;
+        if (fromNode && toNode)
+        {
+            GraphSocket* fromSocket = fromNode->GetSocketByFlatIndex(edge[1]);
+            GraphSocket* toSocket = toNode->GetSocketByFlatIndex(edge[3]);
+            if (fromSocket && toSocket)
+            {
+                upstreamEdges_.insert(std::make_pair(fromSocket, toSocket));
+                downstreamEdges_.insert(std::make_pair(toSocket, fromSocket));
+            }
+        }
+    }
+
+    return success;
+}
+
 bool Graph::Serialize(Serializer* dest, const SerializationContext& context) const
 {
     bool success = true;
@@ -359,39 +482,45 @@ bool Graph::Serialize(Serializer* dest, const SerializationContext& context) con
     success &= dest->WriteStringHash(GetTypeHash());
     success &= dest->WriteUShort(GRAPH_VERSION);
 
-    // Write all the ndoes
-    success &= dest->WriteUInt((unsigned)nodes_.size());
+    // Nodes are written into a buffer first so that the table of their sizes can lead. Property hashes stay in every node's block rather than
+    // in a table per type, each block has to read back on its own for a node of an unknown type to be skipped
+    std::unordered_map<const GraphNode*, unsigned> positions;
+    positions.reserve(nodes_.size());
+    std::vector<unsigned> blockSizes;
+    blockSizes.reserve(nodes_.size());
+    VectorBuffer blocks;
     for (GraphNode* node : nodes_)
-        success &= node->Serialize(dest, context);
+    {
+        const unsigned start = blocks.GetSize();
+        success &= node->Serialize(&blocks, context);
+        blockSizes.push_back(blocks.GetSize() - start);
+        positions[node] = (unsigned)positions.size();
+    }
+
+    success &= dest->WriteUInt((unsigned)nodes_.size());
+    if (!blockSizes.empty())
+        success &= dest->Write(blockSizes.data(), blockSizes.size() * sizeof(unsigned)) == blockSizes.size() * sizeof(unsigned);
+    if (blocks.GetSize() > 0)
+        success &= dest->Write(blocks.GetData(), blocks.GetSize()) == blocks.GetSize();
 
     // Write the master node
-    if (masterNode_)
-        success &= dest->WriteUInt(masterNode_->id);
-    else
-        success &= dest->WriteUInt(-1);
+    auto master = masterNode_ ? positions.find(masterNode_) : positions.end();
+    success &= dest->WriteUInt(master != positions.end() ? master->second : -1);
 
     // Write the entry points
     success &= dest->WriteUInt((unsigned)entryNodes_.size());
     for (GraphNode* node : entryNodes_)
-        success &= dest->WriteUInt(node->id);
+        success &= dest->WriteUInt(positions[node]);
 
-    // write the edge connections
+    // Write the edge connections, only upstream as the downstream edges mirror them
     success &= dest->WriteUInt((unsigned)upstreamEdges_.size());
     for (auto edge = upstreamEdges_.begin(); edge != upstreamEdges_.end(); ++edge)
     {
-        success &= dest->WriteUInt(edge->first->node->id);
-        success &= dest->WriteUInt(edge->first->socketID);
-        success &= dest->WriteUInt(edge->second->node->id);
-        success &= dest->WriteUInt(edge->second->socketID);
-    }
-
-    success &= dest->WriteUInt((unsigned)downstreamEdges_.size());
-    for (auto edge = downstreamEdges_.begin(); edge != downstreamEdges_.end(); ++edge)
-    {
-        success &= dest->WriteUInt(edge->first->node->id);
-        success &= dest->WriteUInt(edge->first->socketID);
-        success &= dest->WriteUInt(edge->second->node->id);
-        success &= dest->WriteUInt(edge->second->socketID);
+        const unsigned record[4] = {
+            positions[edge->first->node], edge->first->node->GetSocketFlatIndex(edge->first),
+            positions[edge->second->node], edge->second->node->GetSocketFlatIndex(edge->second)
+        };
+        success &= dest->Write(record, sizeof(record)) == sizeof(record);
     }
 
     return success;
@@ -400,6 +529,15 @@ bool Graph::Serialize(Serializer* dest, const SerializationContext& context) con
 #ifndef SPRUE_NO_XML
 bool Graph::Deserialize(tinyxml2::XMLElement* parentElement, const SerializationContext& context)
 {
+    if (!context.deferResources_)
+    {
+        SerializationContext deferred = context;
+        deferred.deferResources_ = true;
+        const bool ret = Deserialize(parentElement, deferred);
+        LoadDeferredResources(deferred, context);
+        return ret;
+    }
+
     if (tinyxml2::XMLElement* child = parentElement->FirstChildElement("nodes"))
     {
         tinyxml2::XMLElement* nodeElem = child->FirstChildElement();
@@ -412,6 +550,7 @@ bool Graph::Deserialize(tinyxml2::XMLElement* parentElement, const Serialization
             }
             nodeElem = nodeElem->NextSiblingElement();
         }
+        nodeIndexDirty_ = true;
     }
 
     if (tinyxml2::XMLElement* master = parentElement->FirstChildElement("master"))
@@ -619,6 +758,7 @@ void Graph::AssignIDs() const
         if (node->inputFlowSocket)
             node->inputFlowSocket->socketID = ++startID;
     }
+    nodeIndexDirty_ = true;
 }
 
 void Graph::ResetData()
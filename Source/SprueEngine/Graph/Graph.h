@@ -23,6 +23,7 @@ class Graph : public IEditable
 {
     friend struct GraphSocket;
     friend class GraphNode;
+    friend class GraphOptimizer;
 public:    
     Graph();
     virtual ~Graph();
@@ -114,6 +115,12 @@ public:
 
     const std::unordered_multimap<GraphSocket*, GraphSocket*>& GetUpstreamEdges() const { return upstreamEdges_; }
 
+    /// Call before rendering an image (or a region of one) from the graph. Nodes holding images materialized from upstream check
+    /// them for edits once per pass, regions and tiles do not necessarily contain any particular pixel to check at.
+    void BeginRenderPass() { ++renderPass_; }
+    /// Number of render passes begun so far.
+    unsigned GetRenderPass() const { return renderPass_; }
+
     class SPRUE NodeVisitor
     {
     public:
@@ -132,9 +139,14 @@ public:
 private:
     void WriteSocketConnectivity(GraphSocket* socket, const std::vector<GraphNode*>& withNodes, Serializer* dest) const;
 
-    /// Internal get a node for use in deserialization
+    /// Internal get a node for use in deserialization, through an index of the node IDs. Returns null for IDs the index does not hold,
+    /// IDs are only expected to change through AddNode, deserialization and AssignIDs, which rebuild it.
     GraphNode* GetNode(unsigned id);
     const GraphNode* GetNode(unsigned id) const;
+    /// Rebuilds the index of node IDs, the first node with an ID wins as it did for the linear search.
+    void BuildNodeIndex() const;
+    /// Reads the indexed format of GRAPH_VERSION 2 onwards, nodes and sockets are referred to by their position rather than by ID.
+    bool DeserializeIndexed(Deserializer* src, const SerializationContext& context);
 
     void* userData_ = 0x0;
     GraphNode* masterNode_;
@@ -143,6 +155,10 @@ private:
     std::unordered_multimap<GraphSocket*, GraphSocket*> upstreamEdges_;   // link edges that go right->left, input -> output, we only ever allow a single upstream edge - except for with flowControl
     std::unordered_multimap<GraphSocket*, GraphSocket*> downstreamEdges_; // link edges that go left->right, output -> input, flow control sockets can only have 1 downstream edge
     unsigned currentExecutionContext_;
+    unsigned renderPass_ = 0;
+    /// Node by ID, built on demand and dropped whenever nodes are added, removed or renumbered.
+    mutable std::unordered_map<unsigned, GraphNode*> nodeIndex_;
+    mutable bool nodeIndexDirty_ = true;
 };
 
 }
\ No newline at end of file
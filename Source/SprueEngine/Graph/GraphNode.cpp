@@ -2,6 +2,7 @@
 
 #include <SprueEngine/Core/Context.h>
 #include <SprueEngine/Graph/Graph.h>
+#include <SprueEngine/Graph/GraphProfiler.h>
 #include <SprueEngine/Graph/GraphSocket.h>
 
 namespace SprueEngine
@@ -347,11 +348,38 @@ void GraphNode::PropogateValues(bool down)
     }
 }
 
+std::shared_ptr<FilterableBlockMap<RGBA> > GraphNode::GetPreviewRegion(unsigned width, unsigned height, unsigned left, unsigned top, unsigned regionWidth, unsigned regionHeight)
+{
+    std::shared_ptr<FilterableBlockMap<RGBA> > preview = GetPreview(width, height);
+    if (!preview || (left == 0 && top == 0 && preview->getWidth() == regionWidth && preview->getHeight() == regionHeight))
+        return preview;
+
+    // Previews are not required to honour the requested size, sample them in proportion
+    std::shared_ptr<FilterableBlockMap<RGBA> > ret(new FilterableBlockMap<RGBA>(regionWidth, regionHeight));
+    for (unsigned y = 0; y < regionHeight; ++y)
+    {
+        const unsigned sourceY = SprueMin((unsigned)((top + y) * (unsigned long long)preview->getHeight() / SprueMax(height, 1u)), preview->getHeight() - 1);
+        for (unsigned x = 0; x < regionWidth; ++x)
+        {
+            const unsigned sourceX = SprueMin((unsigned)((left + x) * (unsigned long long)preview->getWidth() / SprueMax(width, 1u)), preview->getWidth() - 1);
+            ret->set(preview->get(sourceX, sourceY), x, y);
+        }
+    }
+    return ret;
+}
+
 void GraphNode::ExecuteUpstream(unsigned& executionContext, const Variant& parameter, unsigned ignoringNode)
 {
-    if (executionContext != -1 && lastExecutionContext == executionContext || id == ignoringNode)
+    if (id == ignoringNode)
         return;
+    if (executionContext != -1 && lastExecutionContext == executionContext)
+    {
+        // Already evaluated during this walk, the stored socket values are reused
+        GraphProfiler::NoteCacheHit(this);
+        return;
+    }
 
+    GraphProfiler::Scope profileScope(this);
     Variant param = FilterParameter(parameter);
 
     do {
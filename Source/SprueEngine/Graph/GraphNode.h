@@ -48,6 +48,9 @@ namespace SprueEngine
         virtual bool CanPreview() const { return false; }
 
         virtual std::shared_ptr<FilterableBlockMap<RGBA> > GetPreview(unsigned width = 128, unsigned height = 128) { return std::shared_ptr<FilterableBlockMap<RGBA> >(); }
+        /// Returns the regionWidth x regionHeight pixels starting at left, top of the width x height preview, for viewing large previews a tile at a time.
+        /// The default renders the whole preview and copies the region out, nodes that evaluate per pixel only evaluate the region.
+        virtual std::shared_ptr<FilterableBlockMap<RGBA> > GetPreviewRegion(unsigned width, unsigned height, unsigned left, unsigned top, unsigned regionWidth, unsigned regionHeight);
 
         /// Intercept and modify the parameter, example usage: transform nodes that manipulate the parameter
         virtual Variant FilterParameter(const Variant& param) const { return param; }
@@ -55,6 +58,10 @@ namespace SprueEngine
         /// Override if this node will manually force execute it's upstream nodes (prevents automatic up/down stream evaluation)
         virtual bool WillForceExecute() const { return false; }
 
+        /// Override to return true if outputs depend only on the input socket values and properties, never on the evaluation parameter or neighbouring samples.
+        /// Pointwise nodes with constant inputs can be folded into constants by the GraphOptimizer.
+        virtual bool IsPointwise() const { return false; }
+
         /// Optional OVERRIDE to perform prep work before the graph can be executed
         virtual void Prepare(const Variant& parameter) { }
 
@@ -72,7 +79,8 @@ namespace SprueEngine
         virtual bool Serialize(tinyxml2::XMLElement* parentElement, const SerializationContext& context) const override;
     #endif
 
-        virtual bool Compile(class VectorBuffer* buffer) const { return true; }
+        /// Override to write bytecode performing this node's computation, returns false if the node cannot be compiled.
+        virtual bool Compile(class VectorBuffer* buffer) const { return false; }
 
         // Methods for getting sockets by ID
         /// Returns a socket at the given "flat" index (all sockets counted)
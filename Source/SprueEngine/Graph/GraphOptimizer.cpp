@@ -0,0 +1,486 @@
+#include "GraphOptimizer.h"
+
+#include <SprueEngine/Core/Context.h>
+#include <SprueEngine/FString.h>
+#include <SprueEngine/GeneralUtility.h>
+#include <SprueEngine/Graph/Graph.h>
+#include <SprueEngine/Graph/GraphNode.h>
+#include <SprueEngine/Graph/GraphSocket.h>
+#include <SprueEngine/Property.h>
+#include <SprueEngine/VectorBuffer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <typeinfo>
+#include <unordered_map>
+
+namespace SprueEngine
+{
+    std::string GraphOptimizationStats::ToString() const
+    {
+        return FString("%1 -> %2 nodes, %3 dead, %4 folded into %5 constants, %6 merged", NodesBefore, NodesAfter, DeadNodes, FoldedNodes, ConstantsCreated, MergedNodes);
+    }
+
+    template<typename T>
+    static void AppendBytes(std::string& signature, const T& value)
+    {
+        signature.append((const char*)&value, sizeof(T));
+    }
+
+    /// Appends an exact encoding of the value, floats are compared bitwise as text conversion would round them.
+    static bool AppendValue(std::string& signature, const Variant& value)
+    {
+        AppendBytes(signature, (unsigned char)value.getType());
+        switch (value.getType())
+        {
+        case VT_None:
+            return true;
+        case VT_Byte:
+            AppendBytes(signature, value.getByte());
+            return true;
+        case VT_Bool:
+            AppendBytes(signature, value.getBool());
+            return true;
+        case VT_Int:
+            AppendBytes(signature, value.getInt());
+            return true;
+        case VT_UInt:
+            AppendBytes(signature, value.getUInt());
+            return true;
+        case VT_Float:
+            AppendBytes(signature, value.getFloat());
+            return true;
+        case VT_StringHash:
+            AppendBytes(signature, value.getStringHash().value_);
+            return true;
+        case VT_RangedInt: {
+            const RangedInt range = value.getRangedInt();
+            AppendBytes(signature, range.getLowerBound());
+            AppendBytes(signature, range.getUpperBound());
+            } return true;
+        case VT_RangedFloat: {
+            const RangedFloat range = value.getRangedFloat();
+            AppendBytes(signature, range.getLowerBound());
+            AppendBytes(signature, range.getUpperBound());
+            } return true;
+        case VT_IntVec2:
+            AppendBytes(signature, value.getIntVec2());
+            return true;
+        case VT_Vec2:
+            AppendBytes(signature, value.getVec2());
+            return true;
+        case VT_Vec3:
+            AppendBytes(signature, value.getVec3());
+            return true;
+        case VT_Vec4:
+            AppendBytes(signature, value.getVec4());
+            return true;
+        case VT_Quat:
+            AppendBytes(signature, value.getQuat());
+            return true;
+        case VT_Color:
+            AppendBytes(signature, value.getRGBA());
+            return true;
+        case VT_Mat3:
+            AppendBytes(signature, value.getMat3x3());
+            return true;
+        case VT_Mat3x4:
+            AppendBytes(signature, value.getMat3x4());
+            return true;
+        case VT_String: {
+            const std::string text = value.getString();
+            AppendBytes(signature, (unsigned)text.size());
+            signature.append(text);
+            } return true;
+        case VT_ColorCurves:
+        case VT_ColorRamp:
+        case VT_ResourceHandle: {
+            VectorBuffer buffer;
+            if (!value.Write(&buffer))
+                return false;
+            AppendBytes(signature, buffer.GetSize());
+            if (buffer.GetSize())
+                signature.append((const char*)buffer.GetData(), buffer.GetSize());
+            } return true;
+        }
+        return false;
+    }
+
+    GraphOptimizer::GraphOptimizer(unsigned passes) :
+        passes_(passes)
+    {
+
+    }
+
+    GraphOptimizer::~GraphOptimizer()
+    {
+
+    }
+
+    GraphOptimizationStats GraphOptimizer::Optimize(Graph* graph)
+    {
+        // The master node is always added as a root
+        std::vector<GraphNode*> roots;
+        if (graph)
+            roots = graph->GetEntryNodes();
+        return Optimize(graph, roots);
+    }
+
+    GraphOptimizationStats GraphOptimizer::Optimize(Graph* graph, const std::vector<GraphNode*>& roots)
+    {
+        GraphOptimizationStats stats;
+        if (!graph)
+            return stats;
+
+        stats.NodesBefore = stats.NodesAfter = graph->GetNodes().size();
+
+        // Without roots everything would be dead
+        std::vector<GraphNode*> liveRoots;
+        for (GraphNode* root : roots)
+            if (root && root->graph == graph)
+                liveRoots.push_back(root);
+        if (graph->masterNode_ && std::find(liveRoots.begin(), liveRoots.end(), graph->masterNode_) == liveRoots.end())
+            liveRoots.push_back(graph->masterNode_);
+        if (liveRoots.empty())
+            return stats;
+
+        if (passes_ & GOP_DeadNodes)
+            stats.DeadNodes = RemoveDeadNodes(graph, liveRoots);
+        if (passes_ & GOP_ConstantFolding)
+            FoldConstants(graph, liveRoots, stats);
+        if (passes_ & GOP_CommonSubexpressions)
+            stats.MergedNodes = MergeDuplicates(graph, liveRoots);
+
+        stats.NodesAfter = graph->GetNodes().size();
+        return stats;
+    }
+
+    std::vector<GraphNode*> GraphOptimizer::CollectLiveNodes(Graph* graph, const std::vector<GraphNode*>& roots) const
+    {
+        std::unordered_set<GraphNode*> visited;
+        std::vector<GraphNode*> order;
+        for (GraphNode* root : roots)
+            CollectLiveNodes(graph, root, visited, order);
+        return order;
+    }
+
+    void GraphOptimizer::CollectLiveNodes(Graph* graph, GraphNode* node, std::unordered_set<GraphNode*>& visited, std::vector<GraphNode*>& order) const
+    {
+        if (!node || !visited.insert(node).second)
+            return;
+
+        for (GraphSocket* socket : node->inputSockets)
+        {
+            auto edges = graph->upstreamEdges_.equal_range(socket);
+            for (auto edge = edges.first; edge != edges.second; ++edge)
+                CollectLiveNodes(graph, edge->second->node, visited, order);
+        }
+
+        // Flow control may also pull in nodes, for hybrid graphs
+        if (node->inputFlowSocket)
+        {
+            auto edges = graph->upstreamEdges_.equal_range(node->inputFlowSocket);
+            for (auto edge = edges.first; edge != edges.second; ++edge)
+                CollectLiveNodes(graph, edge->second->node, visited, order);
+        }
+        for (GraphSocket* socket : node->outputFlowSockets)
+        {
+            auto edges = graph->downstreamEdges_.equal_range(socket);
+            for (auto edge = edges.first; edge != edges.second; ++edge)
+                CollectLiveNodes(graph, edge->second->node, visited, order);
+        }
+
+        order.push_back(node);
+    }
+
+    std::vector<GraphSocket*> GraphOptimizer::GetConsumers(Graph* graph, GraphSocket* output) const
+    {
+        std::vector<GraphSocket*> ret;
+        auto edges = graph->downstreamEdges_.equal_range(output);
+        for (auto edge = edges.first; edge != edges.second; ++edge)
+            ret.push_back(edge->second);
+        return ret;
+    }
+
+    unsigned GraphOptimizer::RemoveDeadNodes(Graph* graph, const std::vector<GraphNode*>& roots)
+    {
+        const std::vector<GraphNode*> live = CollectLiveNodes(graph, roots);
+        const std::unordered_set<GraphNode*> liveSet(live.begin(), live.end());
+
+        std::vector<GraphNode*> dead;
+        for (GraphNode* node : graph->GetNodes())
+            if (liveSet.find(node) == liveSet.end())
+                dead.push_back(node);
+
+        for (GraphNode* node : dead)
+        {
+            graph->RemoveNode(node);
+            delete node;
+        }
+        return dead.size();
+    }
+
+    void GraphOptimizer::FoldConstants(Graph* graph, const std::vector<GraphNode*>& roots, GraphOptimizationStats& stats)
+    {
+        const std::vector<GraphNode*> order = CollectLiveNodes(graph, roots);
+        const std::unordered_set<GraphNode*> rootSet(roots.begin(), roots.end());
+
+        // Upstream nodes come first, so constness of every input is known when a node is reached
+        std::unordered_set<GraphNode*> constants;
+        for (GraphNode* node : order)
+        {
+            if (rootSet.find(node) != rootSet.end())
+                continue;
+            if (!node->IsPointwise() || node->WillForceExecute() || node->inputFlowSocket || !node->outputFlowSockets.empty())
+                continue;
+
+            bool isConstant = true;
+            for (GraphSocket* socket : node->inputSockets)
+            {
+                auto edges = graph->upstreamEdges_.equal_range(socket);
+                for (auto edge = edges.first; edge != edges.second && isConstant; ++edge)
+                    isConstant = constants.find(edge->second->node) != constants.end();
+                if (!isConstant)
+                    break;
+            }
+            if (isConstant)
+                constants.insert(node);
+        }
+
+        const Variant evaluationPoint(Vec4(0.0f, 0.0f, 1.0f, 1.0f));
+        for (GraphNode* node : order)
+        {
+            if (constants.find(node) == constants.end())
+                continue;
+
+            // Value nodes are already as cheap as it gets
+            bool hasInputs = false;
+            for (GraphSocket* socket : node->inputSockets)
+                hasInputs |= socket->typeID != 0;
+            if (!hasInputs)
+                continue;
+
+            bool evaluated = false;
+            for (GraphSocket* output : node->outputSockets)
+            {
+                std::vector<GraphSocket*> consumers;
+                for (GraphSocket* consumer : GetConsumers(graph, output))
+                    if (constants.find(consumer->node) == constants.end())
+                        consumers.push_back(consumer);
+                if (consumers.empty())
+                    continue;
+
+                if (!evaluated)
+                {
+                    unsigned executionContext = -1;
+                    node->ExecuteUpstream(executionContext, evaluationPoint);
+                    evaluated = true;
+                }
+
+                const Variant value = output->GetValue();
+                if (value.getType() == VT_None)
+                    continue;
+
+                GraphNode* constant = CreateConstantNode(graph, output, value);
+                if (!constant)
+                    continue;
+
+                GraphSocket* constantOutput = constant->outputSockets.empty() ? 0x0 : constant->outputSockets[0];
+                bool canConnect = constantOutput != 0x0;
+                for (GraphSocket* consumer : consumers)
+                    canConnect &= graph->CanConnect(constantOutput, consumer);
+                if (!canConnect)
+                {
+                    graph->RemoveNode(constant);
+                    delete constant;
+                    continue;
+                }
+
+                constant->name = node->name;
+                constant->XPos = node->XPos;
+                constant->YPos = node->YPos;
+                for (GraphSocket* consumer : consumers)
+                    graph->Connect(constantOutput, consumer);
+                ++stats.ConstantsCreated;
+            }
+        }
+
+        // Whatever the constants replaced is no longer reachable
+        if (stats.ConstantsCreated)
+            stats.FoldedNodes = RemoveDeadNodes(graph, roots);
+    }
+
+    bool GraphOptimizer::BuildSignature(Graph* graph, GraphNode* node, std::string& signature) const
+    {
+        signature.clear();
+        if (!AppendNodeSignature(node, signature))
+            return false;
+
+        for (GraphSocket* socket : node->inputSockets)
+        {
+            auto edges = graph->upstreamEdges_.equal_range(socket);
+            if (edges.first == edges.second)
+            {
+                signature.push_back('v');
+                if (!AppendValue(signature, socket->GetValue()))
+                    return false;
+                continue;
+            }
+
+            for (auto edge = edges.first; edge != edges.second; ++edge)
+            {
+                GraphNode* upstream = edge->second->node;
+                const unsigned outputIndex = std::find(upstream->outputSockets.begin(), upstream->outputSockets.end(), edge->second) - upstream->outputSockets.begin();
+                signature.push_back('e');
+                AppendBytes(signature, upstream);
+                AppendBytes(signature, outputIndex);
+            }
+        }
+        return true;
+    }
+
+    bool GraphOptimizer::AppendNodeSignature(GraphNode* node, std::string& signature, bool withResources)
+    {
+        // Type names are not reliable identity for every node type, the C++ type is
+        signature += typeid(*node).name();
+        signature.push_back('\0');
+
+        const auto& table = Context::GetInstance()->GetPropertyTable();
+        auto baseProperties = table.find(StringHash("GraphNode"));
+        auto properties = table.find(node->GetTypeHash());
+        if (properties != table.end())
+        {
+            for (auto& property : properties->second)
+            {
+                // Position, ID, and name do not change the result
+                bool isBase = false;
+                if (baseProperties != table.end())
+                    for (auto& baseProperty : baseProperties->second)
+                        isBase |= baseProperty->GetHash() == property->GetHash();
+                if (isBase)
+                    continue;
+
+                const Variant value = property->Get(node);
+                if (!withResources && value.getType() == VT_ResourceHandle)
+                    continue;
+                AppendBytes(signature, property->GetHash().value_);
+                if (!AppendValue(signature, value))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    bool GraphOptimizer::HashSubgraph(Graph* graph, GraphSocket* output, uint64_t& hash)
+    {
+        if (!graph || !output || !output->node)
+            return false;
+
+        GraphNode* node = output->node;
+        std::unordered_map<GraphNode*, uint64_t> hashes;
+        if (!HashNode(graph, node, hashes))
+            return false;
+
+        std::string signature;
+        AppendBytes(signature, hashes[node]);
+        AppendBytes(signature, (unsigned)(std::find(node->outputSockets.begin(), node->outputSockets.end(), output) - node->outputSockets.begin()));
+        hash = HashBytes64(signature.data(), signature.size());
+        return true;
+    }
+
+    bool GraphOptimizer::HashSubgraph(Graph* graph, GraphNode* node, uint64_t& hash)
+    {
+        if (!graph || !node)
+            return false;
+
+        std::unordered_map<GraphNode*, uint64_t> hashes;
+        if (!HashNode(graph, node, hashes))
+            return false;
+        hash = hashes[node];
+        return true;
+    }
+
+    bool GraphOptimizer::HashNodeProperties(GraphNode* node, uint64_t& hash, bool withResources)
+    {
+        std::string signature;
+        if (!node || !AppendNodeSignature(node, signature, withResources))
+            return false;
+        hash = HashBytes64(signature.data(), signature.size());
+        return true;
+    }
+
+    bool GraphOptimizer::HashNode(Graph* graph, GraphNode* node, std::unordered_map<GraphNode*, uint64_t>& hashes)
+    {
+        // Shared upstream nodes are hashed once, the way BuildSignature refers to them by pointer
+        if (hashes.find(node) != hashes.end())
+            return true;
+
+        std::string signature;
+        if (!AppendNodeSignature(node, signature))
+            return false;
+
+        for (GraphSocket* socket : node->inputSockets)
+        {
+            auto edges = graph->upstreamEdges_.equal_range(socket);
+            if (edges.first == edges.second)
+            {
+                signature.push_back('v');
+                if (!AppendValue(signature, socket->GetValue()))
+                    return false;
+                continue;
+            }
+
+            for (auto edge = edges.first; edge != edges.second; ++edge)
+            {
+                GraphNode* upstream = edge->second->node;
+                if (!HashNode(graph, upstream, hashes))
+                    return false;
+                const unsigned outputIndex = std::find(upstream->outputSockets.begin(), upstream->outputSockets.end(), edge->second) - upstream->outputSockets.begin();
+                signature.push_back('e');
+                AppendBytes(signature, hashes[upstream]);
+                AppendBytes(signature, outputIndex);
+            }
+        }
+
+        hashes[node] = HashBytes64(signature.data(), signature.size());
+        return true;
+    }
+
+    unsigned GraphOptimizer::MergeDuplicates(Graph* graph, const std::vector<GraphNode*>& roots)
+    {
+        const std::vector<GraphNode*> order = CollectLiveNodes(graph, roots);
+        const std::unordered_set<GraphNode*> rootSet(roots.begin(), roots.end());
+
+        // Upstream merges happen first so the signatures of their consumers already refer to the surviving node
+        std::unordered_map<std::string, GraphNode*> signatures;
+        unsigned merged = 0;
+        std::string signature;
+        for (GraphNode* node : order)
+        {
+            if (rootSet.find(node) != rootSet.end() || node->inputFlowSocket || !node->outputFlowSockets.empty())
+                continue;
+            if (!BuildSignature(graph, node, signature))
+                continue;
+
+            auto found = signatures.find(signature);
+            if (found == signatures.end())
+            {
+                signatures[signature] = node;
+                continue;
+            }
+
+            GraphNode* canonical = found->second;
+            if (canonical->outputSockets.size() != node->outputSockets.size())
+                continue;
+
+            for (unsigned i = 0; i < node->outputSockets.size(); ++i)
+                for (GraphSocket* consumer : GetConsumers(graph, node->outputSockets[i]))
+                    graph->Connect(canonical->outputSockets[i], consumer);
+
+            graph->RemoveNode(node);
+            delete node;
+            ++merged;
+        }
+        return merged;
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+#include <SprueEngine/Variant.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace SprueEngine
+{
+    class Graph;
+    class GraphNode;
+    struct GraphSocket;
+
+    /// Summary of what a GraphOptimizer run changed.
+    struct SPRUE GraphOptimizationStats
+    {
+        unsigned NodesBefore = 0;
+        unsigned NodesAfter = 0;
+        /// Nodes removed because nothing reachable from the roots consumed them.
+        unsigned DeadNodes = 0;
+        /// Nodes removed because their results were folded into constants.
+        unsigned FoldedNodes = 0;
+        /// Constant nodes inserted to replace folded subgraphs.
+        unsigned ConstantsCreated = 0;
+        /// Nodes removed because an identical node already computed the same result.
+        unsigned MergedNodes = 0;
+
+        std::string ToString() const;
+    };
+
+    /// Rewrites a graph in place so that it computes the same results at the roots with fewer nodes.
+    /// Intended for throw-away clones that are about to be evaluated, the rewritten graph is not meant to be edited or saved.
+    /// Removed nodes are deleted.
+    class SPRUE GraphOptimizer
+    {
+        NOCOPYDEF(GraphOptimizer);
+    public:
+        enum Passes
+        {
+            GOP_DeadNodes = 1,
+            GOP_ConstantFolding = 1 << 1,
+            GOP_CommonSubexpressions = 1 << 2,
+            GOP_All = GOP_DeadNodes | GOP_ConstantFolding | GOP_CommonSubexpressions
+        };
+
+        GraphOptimizer(unsigned passes = GOP_All);
+        virtual ~GraphOptimizer();
+
+        /// Optimizes for the entry nodes and the master node of the graph.
+        GraphOptimizationStats Optimize(Graph* graph);
+        /// Optimizes for the given roots, which are never removed or merged.
+        GraphOptimizationStats Optimize(Graph* graph, const std::vector<GraphNode*>& roots);
+
+        /// Hashes everything that decides the values of an output socket: the type, properties and unconnected input values of its node
+        /// and of every node upstream of it. IDs, names and positions are left out, so identical subgraphs hash the same wherever they are.
+        /// Returns false if some property along the way cannot be compared exactly.
+        static bool HashSubgraph(Graph* graph, GraphSocket* output, uint64_t& hash);
+        /// Hashes a node together with everything upstream of it, for nodes such as outputs that have no output sockets to hash.
+        static bool HashSubgraph(Graph* graph, GraphNode* node, uint64_t& hash);
+        /// Hashes the type and properties of a single node. Resource handles are left out when withResources is false,
+        /// for keys that already hash the resource's contents and should not change when it moves.
+        /// Returns false if some property cannot be compared exactly.
+        static bool HashNodeProperties(GraphNode* node, uint64_t& hash, bool withResources = true);
+
+    protected:
+        /// OVERRIDE to supply a node with a single output socket that outputs the value, the node must already be added to the graph.
+        /// Return null if the value cannot be represented, in which case the subgraph producing it is left alone.
+        virtual GraphNode* CreateConstantNode(Graph* graph, const GraphSocket* replacing, const Variant& value) { return 0x0; }
+
+    private:
+        /// Returns every node the roots depend on, upstream nodes are ordered before their consumers.
+        std::vector<GraphNode*> CollectLiveNodes(Graph* graph, const std::vector<GraphNode*>& roots) const;
+        void CollectLiveNodes(Graph* graph, GraphNode* node, std::unordered_set<GraphNode*>& visited, std::vector<GraphNode*>& order) const;
+
+        /// Removes and deletes everything the roots do not depend on, returns the number of nodes removed.
+        unsigned RemoveDeadNodes(Graph* graph, const std::vector<GraphNode*>& roots);
+        /// Evaluates pointwise subgraphs that have no varying inputs once and replaces their results with constant nodes.
+        void FoldConstants(Graph* graph, const std::vector<GraphNode*>& roots, GraphOptimizationStats& stats);
+        /// Merges nodes of the same type with identical properties and identical inputs, returns the number of nodes removed.
+        unsigned MergeDuplicates(Graph* graph, const std::vector<GraphNode*>& roots);
+
+        /// Writes the identity of a node's computation, returns false if some property cannot be compared exactly.
+        bool BuildSignature(Graph* graph, GraphNode* node, std::string& signature) const;
+        /// Writes the type and properties of a node, returns false if some property cannot be compared exactly.
+        static bool AppendNodeSignature(GraphNode* node, std::string& signature, bool withResources = true);
+        static bool HashNode(Graph* graph, GraphNode* node, std::unordered_map<GraphNode*, uint64_t>& hashes);
+        /// Returns the input sockets fed by the given output socket.
+        std::vector<GraphSocket*> GetConsumers(Graph* graph, GraphSocket* output) const;
+
+        unsigned passes_;
+    };
+}
@@ -0,0 +1,201 @@
+#include "GraphProfiler.h"
+
+#include <SprueEngine/FString.h>
+#include <SprueEngine/Graph/GraphNode.h>
+#include <SprueEngine/Reports/HTMLReport.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace SprueEngine
+{
+    static thread_local GraphProfiler* activeProfiler_ = 0x0;
+
+    GraphProfiler::GraphProfiler()
+    {
+
+    }
+
+    GraphProfiler::~GraphProfiler()
+    {
+        Deactivate();
+    }
+
+    void GraphProfiler::Activate()
+    {
+        activeProfiler_ = this;
+    }
+
+    void GraphProfiler::Deactivate()
+    {
+        if (activeProfiler_ == this)
+            activeProfiler_ = 0x0;
+    }
+
+    GraphProfiler* GraphProfiler::GetActive()
+    {
+        return activeProfiler_;
+    }
+
+    NodeProfile& GraphProfiler::GetProfile(const GraphNode* node)
+    {
+        auto found = profiles_.find(node);
+        if (found != profiles_.end())
+            return found->second;
+
+        NodeProfile& profile = profiles_[node];
+        profile.InstanceID = node->GetInstanceID();
+        profile.SourceID = node->GetSourceID();
+        profile.Name = node->name;
+        profile.TypeName = node->GetTypeName();
+        return profile;
+    }
+
+    void GraphProfiler::BeginNode(const GraphNode* node)
+    {
+        Frame frame = { node, Clock::Tick(), 0 };
+        stack_.push_back(frame);
+    }
+
+    void GraphProfiler::EndNode(const GraphNode* node)
+    {
+        if (stack_.empty() || stack_.back().node_ != node)
+            return;
+
+        const Frame frame = stack_.back();
+        stack_.pop_back();
+
+        const math::tick_t elapsed = Clock::TicksInBetween(Clock::Tick(), frame.start_);
+        NodeProfile& profile = GetProfile(node);
+        profile.InclusiveTicks += elapsed;
+        profile.SelfTicks += elapsed > frame.childTicks_ ? elapsed - frame.childTicks_ : 0;
+        ++profile.Samples;
+
+        if (!stack_.empty())
+            stack_.back().childTicks_ += elapsed;
+        else
+            totalTicks_ += elapsed;
+    }
+
+    void GraphProfiler::RecordCacheHit(const GraphNode* node)
+    {
+        ++GetProfile(node).CacheHits;
+    }
+
+    void GraphProfiler::RecordAllocation(const GraphNode* node, unsigned long long bytes)
+    {
+        GetProfile(node).MemoryAllocated += bytes;
+    }
+
+    void GraphProfiler::Clear()
+    {
+        stack_.clear();
+        profiles_.clear();
+        totalTicks_ = 0;
+    }
+
+    std::vector<NodeProfile> GraphProfiler::GetSortedProfiles() const
+    {
+        std::vector<NodeProfile> ret;
+        ret.reserve(profiles_.size());
+        for (auto& record : profiles_)
+            ret.push_back(record.second);
+        std::sort(ret.begin(), ret.end(), [](const NodeProfile& lhs, const NodeProfile& rhs) { return lhs.SelfTicks > rhs.SelfTicks; });
+        return ret;
+    }
+
+    static std::string EscapeJSON(const std::string& text)
+    {
+        std::string ret;
+        ret.reserve(text.size());
+        for (char c : text)
+        {
+            switch (c)
+            {
+            case '"': ret += "\\\""; break;
+            case '\\': ret += "\\\\"; break;
+            case '\n': ret += "\\n"; break;
+            case '\r': ret += "\\r"; break;
+            case '\t': ret += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20)
+                {
+                    char code[8];
+                    snprintf(code, sizeof(code), "\\u%04x", (int)c);
+                    ret += code;
+                }
+                else
+                    ret += c;
+            }
+        }
+        return ret;
+    }
+
+    std::string GraphProfiler::ToJSON(const std::string& label) const
+    {
+        std::stringstream ss;
+        ss << "{\n";
+        ss << "  \"graph\": \"" << EscapeJSON(label) << "\",\n";
+        ss << "  \"totalMS\": " << Clock::TicksToMillisecondsD(totalTicks_) << ",\n";
+        ss << "  \"nodes\": [";
+        auto profiles = GetSortedProfiles();
+        for (unsigned i = 0; i < profiles.size(); ++i)
+        {
+            const NodeProfile& profile = profiles[i];
+            ss << (i == 0 ? "\n" : ",\n");
+            ss << "    { \"id\": " << profile.SourceID;
+            ss << ", \"name\": \"" << EscapeJSON(profile.Name) << "\"";
+            ss << ", \"type\": \"" << EscapeJSON(profile.TypeName) << "\"";
+            ss << ", \"selfMS\": " << profile.SelfMS();
+            ss << ", \"inclusiveMS\": " << profile.InclusiveMS();
+            ss << ", \"samples\": " << profile.Samples;
+            ss << ", \"cacheHits\": " << profile.CacheHits;
+            ss << ", \"memoryBytes\": " << profile.MemoryAllocated << " }";
+        }
+        ss << "\n  ]\n}";
+        return ss.str();
+    }
+
+    bool GraphProfiler::WriteJSON(const std::string& filePath, const std::string& label) const
+    {
+        std::ofstream file(filePath);
+        if (!file.is_open())
+            return false;
+        file << ToJSON(label);
+        return file.good();
+    }
+
+    void GraphProfiler::WriteHTMLTable(HTMLReport* report) const
+    {
+        const double totalMS = Clock::TicksToMillisecondsD(totalTicks_);
+
+        report->Table();
+        report->Tr();
+        report->Th(); report->Text("Node"); report->PopTag();
+        report->Th(); report->Text("Type"); report->PopTag();
+        report->Th(); report->Text("Self (ms)"); report->PopTag();
+        report->Th(); report->Text("Self %"); report->PopTag();
+        report->Th(); report->Text("Inclusive (ms)"); report->PopTag();
+        report->Th(); report->Text("Samples"); report->PopTag();
+        report->Th(); report->Text("Cache Hits"); report->PopTag();
+        report->Th(); report->Text("Memory (KB)"); report->PopTag();
+        report->PopTag();
+
+        for (auto& profile : GetSortedProfiles())
+        {
+            report->Tr();
+            report->Td(); report->Text(profile.Name.empty() ? "Unnamed node" : profile.Name); report->PopTag();
+            report->Td(); report->Text(profile.TypeName); report->PopTag();
+            report->Td(); report->Text(FString("%1", (float)profile.SelfMS())); report->PopTag();
+            report->Td(); report->Text(FString("%1", totalMS > 0.0 ? (float)(profile.SelfMS() / totalMS * 100.0) : 0.0f)); report->PopTag();
+            report->Td(); report->Text(FString("%1", (float)profile.InclusiveMS())); report->PopTag();
+            report->Td(); report->Text(std::to_string(profile.Samples)); report->PopTag();
+            report->Td(); report->Text(std::to_string(profile.CacheHits)); report->PopTag();
+            report->Td(); report->Text(FString("%1", (float)(profile.MemoryAllocated / 1024.0))); report->PopTag();
+            report->PopTag();
+        }
+        report->PopTag();
+    }
+}
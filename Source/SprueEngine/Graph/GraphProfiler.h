@@ -0,0 +1,102 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+#include <SprueEngine/MathGeoLib/Time/Clock.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SprueEngine
+{
+    class GraphNode;
+    class HTMLReport;
+
+    /// Accumulated evaluation statistics for a single node.
+    struct SPRUE NodeProfile
+    {
+        unsigned InstanceID = 0;
+        unsigned SourceID = 0;
+        std::string Name;
+        std::string TypeName;
+        /// Time spent in the node itself, excluding upstream nodes.
+        math::tick_t SelfTicks = 0;
+        /// Time spent in the node including everything evaluated upstream of it.
+        math::tick_t InclusiveTicks = 0;
+        /// Number of times the node was evaluated.
+        unsigned long long Samples = 0;
+        /// Number of times an evaluation was skipped because a stored value or cache was reused.
+        unsigned long long CacheHits = 0;
+        /// Bytes allocated by the node for caches and intermediate images.
+        unsigned long long MemoryAllocated = 0;
+
+        double SelfMS() const { return Clock::TicksToMillisecondsD(SelfTicks); }
+        double InclusiveMS() const { return Clock::TicksToMillisecondsD(InclusiveTicks); }
+    };
+
+    /// Instrumentation for graph evaluation. While a profiler is active on a thread every GraphNode::ExecuteUpstream on that thread records into it.
+    /// Profiling is opt-in, when no profiler is active the cost is a single thread-local lookup per node evaluation.
+    class SPRUE GraphProfiler
+    {
+        NOCOPYDEF(GraphProfiler);
+    public:
+        GraphProfiler();
+        ~GraphProfiler();
+
+        /// Makes this the active profiler for the calling thread.
+        void Activate();
+        /// Stops recording on the calling thread if this is the active profiler.
+        void Deactivate();
+        /// Returns the profiler active on the calling thread, or null.
+        static GraphProfiler* GetActive();
+
+        void BeginNode(const GraphNode* node);
+        void EndNode(const GraphNode* node);
+        void RecordCacheHit(const GraphNode* node);
+        void RecordAllocation(const GraphNode* node, unsigned long long bytes);
+
+        /// Records a cache hit into the active profiler, if any.
+        static void NoteCacheHit(const GraphNode* node) { if (GraphProfiler* profiler = GetActive()) profiler->RecordCacheHit(node); }
+        /// Records an allocation into the active profiler, if any.
+        static void NoteAllocation(const GraphNode* node, unsigned long long bytes) { if (GraphProfiler* profiler = GetActive()) profiler->RecordAllocation(node, bytes); }
+
+        /// Discards all recorded data.
+        void Clear();
+
+        /// Returns all records ordered by self time, slowest first.
+        std::vector<NodeProfile> GetSortedProfiles() const;
+        /// Returns the time spent in the outermost node evaluations.
+        math::tick_t GetTotalTicks() const { return totalTicks_; }
+
+        /// Produces a JSON object for CI tracking, `label` is written as the "graph" field.
+        std::string ToJSON(const std::string& label) const;
+        /// Writes ToJSON to a file.
+        bool WriteJSON(const std::string& filePath, const std::string& label) const;
+        /// Writes a table of all nodes into an HTML report.
+        void WriteHTMLTable(HTMLReport* report) const;
+
+        /// Scoped timing of a single node, does nothing if no profiler is active.
+        struct Scope
+        {
+            Scope(const GraphNode* node) : node_(node), profiler_(GetActive()) { if (profiler_) profiler_->BeginNode(node_); }
+            ~Scope() { if (profiler_) profiler_->EndNode(node_); }
+
+        private:
+            const GraphNode* node_;
+            GraphProfiler* profiler_;
+        };
+
+    private:
+        NodeProfile& GetProfile(const GraphNode* node);
+
+        struct Frame
+        {
+            const GraphNode* node_;
+            math::tick_t start_;
+            math::tick_t childTicks_;
+        };
+        std::vector<Frame> stack_;
+        std::unordered_map<const GraphNode*, NodeProfile> profiles_;
+        math::tick_t totalTicks_ = 0;
+    };
+}
@@ -34,7 +34,7 @@ void IEditable::SetSourceID(unsigned aValue)
 
 bool IEditable::HasProperty(const StringHash& aHash) const
 {
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
     if (found != table.end())
         for (auto& var : found->second)
@@ -50,7 +50,7 @@ Variant IEditable::GetProperty(const std::string& aName) const
 
 Variant IEditable::GetProperty(const StringHash& aHash) const
 {
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
     if (found != table.end())
     {
@@ -66,7 +66,7 @@ Variant IEditable::GetProperty(const StringHash& aHash) const
 
 VariantType IEditable::GetPropertyType(const StringHash& aHash) const
 {
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
     if (found != table.end())
     {
@@ -81,7 +81,7 @@ VariantType IEditable::GetPropertyType(const StringHash& aHash) const
 
 VariantVector IEditable::GetProperties() const
 {
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
     if (found != table.end())
     {
@@ -97,7 +97,7 @@ const std::vector<TypeProperty*>& IEditable::GetProperties(unsigned aFlags) cons
 {
     std::vector<TypeProperty*> ret;
 
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
     if (found != table.end())
     {
@@ -114,7 +114,7 @@ const std::vector<TypeProperty*>& IEditable::GetProperties(unsigned aFlags) cons
 std::vector<std::string> IEditable::GetPropertyNames() const
 {
     std::vector<std::string> ret;
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
     if (found != table.end())
     {
@@ -131,7 +131,7 @@ void IEditable::SetProperty(const std::string& aName, const Variant& aVariant)
 
 void IEditable::SetProperty(const StringHash& aHash, const Variant& aVariant)
 {
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
     if (found != table.end())
     {
@@ -149,7 +149,7 @@ void IEditable::SetProperty(const StringHash& aHash, const Variant& aVariant)
 
 void IEditable::SetProperties(const VariantVector& aProperties)
 {
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
     if (found != table.end())
     {
@@ -166,7 +166,7 @@ void IEditable::ResetProperty(const std::string& aName)
 
 void IEditable::ResetProperty(const StringHash& aHash)
 {
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
     if (found != table.end())
     {
@@ -184,7 +184,7 @@ void IEditable::ResetProperty(const StringHash& aHash)
 
 void IEditable::ResetProperties()
 {
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
     if (found != table.end())
     {
@@ -196,7 +196,7 @@ void IEditable::ResetProperties()
 
 TypeProperty* IEditable::FindProperty(const StringHash& aHash)
 {
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
     if (found != table.end())
     {
@@ -210,26 +210,31 @@ TypeProperty* IEditable::FindProperty(const StringHash& aHash)
 bool IEditable::Deserialize(Deserializer* aSrc, const SerializationContext& context)
 {
     bool okay = true;
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
     sourceID_ = aSrc->ReadUInt();
     if (found != table.end())
     {
-        LOOP_START:
+        // Properties are written in table order, so the one after the last found is nearly always the next one read
+        const auto& properties = found->second;
+        size_t next = 0;
         while (aSrc->ReadBool())
         {
             StringHash propHash = aSrc->ReadStringHash();
-            for (auto property : found->second)
+            size_t index = next < properties.size() && properties[next]->GetHash() == propHash ? next : properties.size();
+            for (size_t i = 0; i < properties.size() && index == properties.size(); ++i)
             {
-                if (property->GetHash() == propHash)
-                {
-                    property->Deserialize(this, aSrc, context);
+                if (properties[i]->GetHash() == propHash)
+                    index = i;
+            }
 
-                    goto LOOP_START;
-                    break; //unreachable
-                }
+            if (index < properties.size())
+            {
+                properties[index]->Deserialize(this, aSrc, context);
+                next = index + 1;
             }
-            SPRUE_LOG_WARNING(FString("Property not found for IEditable deserialization: %1", propHash.value_).c_str());
+            else
+                SPRUE_LOG_WARNING(FString("Property not found for IEditable deserialization: %1", propHash.value_).c_str());
         }
 
         int fieldPermCt = aSrc->ReadInt();
@@ -263,7 +268,7 @@ bool IEditable::Deserialize(Deserializer* aSrc, const SerializationContext& cont
 bool IEditable::Serialize(Serializer* aDest, const SerializationContext& context) const
 {
     bool okay = true;
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
     aDest->WriteStringHash(GetTypeHash());
     IEditable* self = const_cast<IEditable*>(this);
@@ -310,7 +315,7 @@ bool IEditable::Serialize(Serializer* aDest, const SerializationContext& context
 bool IEditable::Deserialize(tinyxml2::XMLElement* aNode, const SerializationContext& context)
 {
     bool success = true;
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
     if (found != table.end())
     {
@@ -372,7 +377,7 @@ bool IEditable::Serialize(tinyxml2::XMLElement* aParent, const SerializationCont
 bool IEditable::SerializeProperties(tinyxml2::XMLElement* aIntoElement, const SerializationContext& context) const
 {
     bool okay = true;
-    auto table = Context::GetInstance()->GetPropertyTable();
+    const auto& table = Context::GetInstance()->GetPropertyTable();
     auto found = table.find(GetTypeHash());
 
     if (found != table.end())
@@ -462,6 +467,8 @@ void IEditable::RandomizePermutations(unsigned seed)
     for (auto perm : fieldPermutations_)
     {
         auto vec = perm.second;
+        if (vec.empty())
+            continue;
         int idx = lcg.Int(0, vec.size() - 1);
         SetProperty(perm.first, vec[idx].value_);
     }
@@ -1,6 +1,9 @@
 #include "BasicImageLoader.h"
 
 #include "../BlockMap.h"
+#include "../FileBuffer.h"
+#include "../FString.h"
+#include "../Logging.h"
 #include "../Resource.h"
 #include "../VectorBuffer.h"
 
@@ -48,24 +51,27 @@ std::shared_ptr<Resource> BasicImageLoader::LoadResource(const char* file) const
         float* data = stbi_loadf(file, &width, &height, &comps, 0);
         if (width && height && comps)
         {
-            size_t dataIndex = 0;
             std::shared_ptr<FilterableBlockMap<RGBA>> img = std::make_shared<FilterableBlockMap<RGBA>>(width, height);
-            for (unsigned y = 0, idx = 0; y < height; ++y)
+            RGBA* pixels = img->getData();
+            const float* src = data;
+            for (unsigned i = 0, count = img->size(); i < count; ++i, src += comps)
             {
-                for (unsigned x = 0; x < width; ++x, idx += comps)
-                {
-                    if (comps == 3)
-                        img->set(RGBA(data[dataIndex], data[dataIndex+1], data[dataIndex+2]), x, y);
-                    else if (comps == 4)
-                        img->set(RGBA(data[dataIndex], data[dataIndex + 1], data[dataIndex + 2], data[dataIndex + 3]), x, y);
-                    dataIndex += comps;
-                }
+                if (comps == 3)
+                    pixels[i] = RGBA(src[0], src[1], src[2]);
+                else if (comps == 4)
+                    pixels[i] = RGBA(src[0], src[1], src[2], src[3]);
             }
 
             stbi_image_free(data);
             return std::make_shared<BitmapResource>(file, img);
         }
     }
+    else if (EndsWith(file, ".texr"))
+    {
+        FileBuffer buffer(file, true, true);
+        if (auto img = LoadRaw(&buffer))
+            return std::make_shared<BitmapResource>(file, img);
+    }
     else if (EndsWith(file, ".dds"))
     {
         //// Load a DDS image
@@ -91,11 +97,22 @@ std::shared_ptr<Resource> BasicImageLoader::LoadResource(const char* file) const
         unsigned char* data = stbi_load(file, &width, &height, &comps, 0);
         if (width && height && comps)
         {
+            // Written in row order straight into the pixels, bytes converted through a table rather than divided per channel
+            static const struct ByteToFloat
+            {
+                float values_[256];
+                ByteToFloat() { for (unsigned i = 0; i < 256; ++i) values_[i] = i / 255.0f; }
+            } table;
+
             std::shared_ptr<FilterableBlockMap<RGBA>> img= std::make_shared<FilterableBlockMap<RGBA>>(width, height);
-            for (unsigned y = 0, idx = 0; y < height; ++y)
+            RGBA* pixels = img->getData();
+            const unsigned char* src = data;
+            for (unsigned i = 0, count = img->size(); i < count; ++i, src += comps)
             {
-                for (unsigned x = 0; x < width; ++x, idx += comps)
-                    img->set(RGBA::FromData(data, idx, comps), x, y);
+                pixels[i].r = table.values_[src[0]];
+                pixels[i].g = comps > 1 ? table.values_[src[1]] : 0.0f;
+                pixels[i].b = comps > 2 ? table.values_[src[2]] : 0.0f;
+                pixels[i].a = comps > 3 ? table.values_[src[3]] : 1.0f;
             }
 
             stbi_image_free(data);
@@ -111,84 +128,29 @@ std::shared_ptr<Resource> BasicImageLoader::LoadResource(const char* file) const
 bool BasicImageLoader::CanLoad(const char* path) const
 {
     std::string text = ToLower(path);
-    return EndsWith(text, ".png") || EndsWith(text, ".jpg") || EndsWith(text, ".jpeg") || EndsWith(text, ".tga") || EndsWith(text, ".bmp") || EndsWith(text, ".psd") || EndsWith(text, ".gif") || EndsWith(text, ".hdr");
+    return EndsWith(text, ".png") || EndsWith(text, ".jpg") || EndsWith(text, ".jpeg") || EndsWith(text, ".tga") || EndsWith(text, ".bmp") || EndsWith(text, ".psd") || EndsWith(text, ".gif") || EndsWith(text, ".hdr") || EndsWith(text, ".texr");
 }
 
-void BasicImageLoader::SavePNG(const FilterableBlockMap<RGBA>* image, const char* fileName)
+void BasicImageLoader::SavePNG(const FilterableBlockMap<RGBA>* image, const char* fileName, ImageCompressionLevel level)
 {
-    const bool anyAlpha = AnyAlphaUsed(image);
-    VectorBuffer buffer;
-    for (unsigned y = 0; y < image->getHeight(); ++y)
-        for (unsigned x = 0; x < image->getWidth(); ++x)
-        {
-            RGBA color = image->get(x, y);
-            color.Clip();
-            buffer.WriteByte(color.r * 255);
-            buffer.WriteByte(color.g * 255);
-            buffer.WriteByte(color.b * 255);
-            if (anyAlpha)
-                buffer.WriteByte(color.a * 255);
-        }
-    stbi_write_png(fileName, image->getWidth(), image->getHeight(), anyAlpha ? 4 : 3, buffer.GetData(), 0);
+    FileBuffer file(fileName, false, true);
+    ImageEncoder::EncodePNG(image, level, &file);
 }
 
-void BasicImageLoader::SavePNG(const FilterableBlockMap<RGBA>* image, VectorBuffer& buffer)
+void BasicImageLoader::SavePNG(const FilterableBlockMap<RGBA>* image, VectorBuffer& buffer, ImageCompressionLevel level)
 {
-    const bool anyAlpha = AnyAlphaUsed(image);
-    VectorBuffer imgBuffer;
-    for (unsigned y = 0; y < image->getHeight(); ++y)
-        for (unsigned x = 0; x < image->getWidth(); ++x)
-        {
-            RGBA color = image->get(x, y);
-            color.Clip();
-            imgBuffer.WriteByte(color.r * 255);
-            imgBuffer.WriteByte(color.g * 255);
-            imgBuffer.WriteByte(color.b * 255);
-            if (anyAlpha)
-                imgBuffer.WriteByte(color.a * 255);
-        }
-    
-    stbi_write_png_to_func(&BasicImageLoader::stbi_write_func, &buffer, image->getWidth(), image->getHeight(), anyAlpha ? 4 : 3, imgBuffer.GetData(), 0);
-    //int length = 0;
-    //void* png = stbi_write_png_to_mem(imgBuffer.GetData(), 4, image->getWidth(), image->getHeight(), imgBuffer.GetSize(), &length);
-    //buffer.Write(png, length);
-    //free(png);
+    ImageEncoder::EncodePNG(image, level, &buffer);
 }
 
-void BasicImageLoader::SaveTGA(const FilterableBlockMap<RGBA>* image, const char* fileName)
+void BasicImageLoader::SaveTGA(const FilterableBlockMap<RGBA>* image, const char* fileName, ImageCompressionLevel level)
 {
-    const bool anyAlpha = AnyAlphaUsed(image);
-    VectorBuffer imgBuffer;
-    for (unsigned y = 0; y < image->getHeight(); ++y)
-        for (unsigned x = 0; x < image->getWidth(); ++x)
-        {
-            RGBA color = image->get(x, y);
-            color.Clip();
-            imgBuffer.WriteByte(color.r * 255);
-            imgBuffer.WriteByte(color.g * 255);
-            imgBuffer.WriteByte(color.b * 255);
-            if (anyAlpha)
-                imgBuffer.WriteByte(color.a * 255);
-        }
-    stbi_write_tga(fileName, image->getWidth(), image->getHeight(), anyAlpha ? 4 : 3, imgBuffer.GetData());
+    FileBuffer file(fileName, false, true);
+    ImageEncoder::EncodeTGA(image, level, &file);
 }
 
-void BasicImageLoader::SaveTGA(const FilterableBlockMap<RGBA>* image, VectorBuffer& buffer)
+void BasicImageLoader::SaveTGA(const FilterableBlockMap<RGBA>* image, VectorBuffer& buffer, ImageCompressionLevel level)
 {
-    const bool anyAlpha = AnyAlphaUsed(image);
-    VectorBuffer imgBuffer;
-    for (unsigned y = 0; y < image->getHeight(); ++y)
-        for (unsigned x = 0; x < image->getWidth(); ++x)
-        {
-            RGBA color = image->get(x, y);
-            color.Clip();
-            imgBuffer.WriteByte(color.r * 255);
-            imgBuffer.WriteByte(color.g * 255);
-            imgBuffer.WriteByte(color.b * 255);
-            if (anyAlpha)
-                imgBuffer.WriteByte(color.a * 255);
-        }
-    stbi_write_tga_to_func(&BasicImageLoader::stbi_write_func, &buffer, image->getWidth(), image->getHeight(), anyAlpha ? 4 : 3, imgBuffer.GetData());
+    ImageEncoder::EncodeTGA(image, level, &buffer);
 }
 
 void BasicImageLoader::SaveHDR(const FilterableBlockMap<RGBA>* image, const char* fileName)
@@ -231,21 +193,30 @@ void BasicImageLoader::SaveHDR(const FilterableBlockMap<RGBA>* image, VectorBuff
 
 void BasicImageLoader::SaveDDS(const FilterableBlockMap<RGBA>* image, const char* fileName)
 {
-    const bool anyAlpha = AnyAlphaUsed(image);
-    VectorBuffer imgBuffer;
-    for (unsigned y = 0; y < image->getHeight(); ++y)
-        for (unsigned x = 0; x < image->getWidth(); ++x)
-        {
-            RGBA color = image->get(x, y);
-            color.Clip();
-            imgBuffer.WriteByte(color.r * 255);
-            imgBuffer.WriteByte(color.g * 255);
-            imgBuffer.WriteByte(color.b * 255);
-            if (anyAlpha)
-                imgBuffer.WriteByte(color.a * 255);
-        }
+    SaveDDS(image, fileName, AnyAlphaUsed(image) ? BCF_BC3 : BCF_BC1, true, false);
+}
 
-    save_image_as_DDS(fileName, image->getWidth(), image->getHeight(), anyAlpha ? 4 : 3, imgBuffer.GetData());
+void BasicImageLoader::SaveDDS(const FilterableBlockMap<RGBA>* image, const char* fileName, BlockCompressionFormat format, bool generateMips, bool isNormalMap)
+{
+    auto levels = BlockCompressor::CompressWithMips(image, format, generateMips, isNormalMap);
+    FileBuffer file(fileName, false, true);
+    BlockCompressor::WriteDDS(&file, levels, format);
+}
+
+void BasicImageLoader::SaveDDS(const FilterableBlockMap<RGBA>* image, VectorBuffer& buffer, BlockCompressionFormat format, bool generateMips, bool isNormalMap)
+{
+    auto levels = BlockCompressor::CompressWithMips(image, format, generateMips, isNormalMap);
+    BlockCompressor::WriteDDS(&buffer, levels, format);
+}
+
+void BasicImageLoader::SaveDDSArray(const std::vector<const FilterableBlockMap<RGBA>*>& images, const char* fileName, BlockCompressionFormat format, bool generateMips, bool isNormalMap)
+{
+    std::vector<std::vector<CompressedMipLevel> > slices;
+    for (auto image : images)
+        slices.push_back(BlockCompressor::CompressWithMips(image, format, generateMips, isNormalMap));
+    FileBuffer file(fileName, false, true);
+    if (!BlockCompressor::WriteDDSArray(&file, slices, format))
+        SPRUE_LOG_ERROR(FString("Unable to write texture array, slices differ in size: %1", fileName).str());
 }
 
 //void BasicImageLoader::SaveDDS(const FilterableBlockMap<RGBA>* image, VectorBuffer& buffer)
@@ -268,6 +239,77 @@ void BasicImageLoader::SaveDDS(const FilterableBlockMap<RGBA>* image, const char
 //
 //}
 
+#define TEXR_VERSION 1
+
+void BasicImageLoader::SaveRaw(const FilterableBlockMap<RGBA>* image, const char* fileName, bool compress)
+{
+    FileBuffer file(fileName, false, true);
+    VectorBuffer buffer;
+    SaveRaw(image, buffer, compress);
+    file.Write(buffer.GetData(), buffer.GetSize());
+}
+
+void BasicImageLoader::SaveRaw(const FilterableBlockMap<RGBA>* image, VectorBuffer& buffer, bool compress)
+{
+    const unsigned char* pixelData = (const unsigned char*)image->getData();
+    const unsigned pixelSize = image->size() * sizeof(RGBA);
+
+    buffer.WriteFileID("TEXR");
+    buffer.WriteUInt(TEXR_VERSION);
+    buffer.WriteUInt(image->getWidth());
+    buffer.WriteUInt(image->getHeight());
+    buffer.WriteUByte(compress ? 1 : 0);
+    if (compress)
+    {
+        std::vector<unsigned char> compressed;
+        ImageEncoder::ZlibCompress(pixelData, pixelSize, ICL_Fastest, compressed);
+        buffer.WriteUInt((unsigned)compressed.size());
+        buffer.Write(compressed.data(), (unsigned)compressed.size());
+    }
+    else
+    {
+        buffer.WriteUInt(pixelSize);
+        buffer.Write(pixelData, pixelSize);
+    }
+}
+
+std::shared_ptr<FilterableBlockMap<RGBA> > BasicImageLoader::LoadRaw(Deserializer* source)
+{
+    if (!source || source->ReadFileID() != "TEXR")
+        return std::shared_ptr<FilterableBlockMap<RGBA> >();
+    if (source->ReadUInt() != TEXR_VERSION)
+    {
+        SPRUE_LOG_ERROR("Unsupported .texr version");
+        return std::shared_ptr<FilterableBlockMap<RGBA> >();
+    }
+
+    const unsigned width = source->ReadUInt();
+    const unsigned height = source->ReadUInt();
+    const bool compressed = source->ReadUByte() != 0;
+    const unsigned payloadSize = source->ReadUInt();
+    if (width == 0 || height == 0)
+        return std::shared_ptr<FilterableBlockMap<RGBA> >();
+
+    std::shared_ptr<FilterableBlockMap<RGBA> > img = std::make_shared<FilterableBlockMap<RGBA> >(width, height);
+    const unsigned pixelSize = img->size() * sizeof(RGBA);
+    if (compressed)
+    {
+        std::vector<char> payload(payloadSize);
+        source->Read(payload.data(), payloadSize);
+        if (stbi_zlib_decode_buffer((char*)img->getData(), pixelSize, payload.data(), payloadSize) != (int)pixelSize)
+        {
+            SPRUE_LOG_ERROR("Corrupt .texr image data");
+            return std::shared_ptr<FilterableBlockMap<RGBA> >();
+        }
+    }
+    else if (payloadSize != pixelSize || source->Read(img->getData(), pixelSize) != pixelSize)
+    {
+        SPRUE_LOG_ERROR("Corrupt .texr image data");
+        return std::shared_ptr<FilterableBlockMap<RGBA> >();
+    }
+    return img;
+}
+
 bool BasicImageLoader::AnyAlphaUsed(const FilterableBlockMap<RGBA>* image)
 {
     for (unsigned y = 0; y < image->getHeight(); ++y)
@@ -3,6 +3,8 @@
 #include <SprueEngine/ResourceLoader.h>
 #include <SprueEngine/BlockMap.h>
 #include <SprueEngine/VectorBuffer.h>
+#include <SprueEngine/Loaders/ImageEncoder.h>
+#include <SprueEngine/Texturing/BlockCompression.h>
 
 namespace SprueEngine
 {
@@ -18,13 +20,24 @@ public:
     virtual std::shared_ptr<Resource> LoadResource(const char*) const override;
     virtual bool CanLoad(const char*) const override;
 
-    static void SavePNG(const FilterableBlockMap<RGBA>* image, const char* fileName);
-    static void SavePNG(const FilterableBlockMap<RGBA>* image, VectorBuffer& buffer);
-    static void SaveTGA(const FilterableBlockMap<RGBA>* image, const char* fileName);
-    static void SaveTGA(const FilterableBlockMap<RGBA>* image, VectorBuffer& buffer);
+    static void SavePNG(const FilterableBlockMap<RGBA>* image, const char* fileName, ImageCompressionLevel level = ICL_Default);
+    static void SavePNG(const FilterableBlockMap<RGBA>* image, VectorBuffer& buffer, ImageCompressionLevel level = ICL_Default);
+    /// TGAs are run-length encoded like stb wrote them, ICL_Store writes them uncompressed.
+    static void SaveTGA(const FilterableBlockMap<RGBA>* image, const char* fileName, ImageCompressionLevel level = ICL_Default);
+    static void SaveTGA(const FilterableBlockMap<RGBA>* image, VectorBuffer& buffer, ImageCompressionLevel level = ICL_Default);
     static void SaveHDR(const FilterableBlockMap<RGBA>* image, const char* fileName);
     static void SaveHDR(const FilterableBlockMap<RGBA>* image, VectorBuffer& buffer);
     static void SaveDDS(const FilterableBlockMap<RGBA>* image, const char* fileName);
+    /// Writes a block compressed DDS in an explicit format, optionally with a complete mip chain.
+    static void SaveDDS(const FilterableBlockMap<RGBA>* image, const char* fileName, BlockCompressionFormat format, bool generateMips, bool isNormalMap);
+    static void SaveDDS(const FilterableBlockMap<RGBA>* image, VectorBuffer& buffer, BlockCompressionFormat format, bool generateMips, bool isNormalMap);
+    /// Writes equally sized images as the slices of a block compressed DDS texture array.
+    static void SaveDDSArray(const std::vector<const FilterableBlockMap<RGBA>*>& images, const char* fileName, BlockCompressionFormat format, bool generateMips, bool isNormalMap);
+    /// Writes the lossless float interchange format (.texr), optionally deflated with the fastest preset.
+    static void SaveRaw(const FilterableBlockMap<RGBA>* image, const char* fileName, bool compress);
+    static void SaveRaw(const FilterableBlockMap<RGBA>* image, VectorBuffer& buffer, bool compress);
+    /// Reads the .texr interchange format, returns null if the data is invalid.
+    static std::shared_ptr<FilterableBlockMap<RGBA> > LoadRaw(Deserializer* source);
     static bool AnyAlphaUsed(const FilterableBlockMap<RGBA>* image);
 
 private:
@@ -0,0 +1,592 @@
+#include "ImageEncoder.h"
+
+#include <SprueEngine/ParallelFor.h>
+#include <SprueEngine/Serializer.h>
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace SprueEngine
+{
+
+#define DEFLATE_WINDOW 32768
+#define DEFLATE_MAX_MATCH 258
+#define DEFLATE_MIN_MATCH 3
+#define DEFLATE_HASH_BITS 15
+#define DEFLATE_MIN_STRIP (128 * 1024)
+#define ADLER_BASE 65521
+
+namespace
+{
+    /// Match search settings for each compression level.
+    struct DeflateParams
+    {
+        unsigned maxChain_;
+        bool lazy_;
+    };
+
+    const DeflateParams& GetDeflateParams(ImageCompressionLevel level)
+    {
+        static const DeflateParams params[] = {
+            { 0, false },
+            { 4, false },
+            { 32, true },
+            { 256, true },
+        };
+        return params[CLAMP((int)level, 0, 3)];
+    }
+
+    /// LSB-first bit packer for deflate streams.
+    struct DeflateWriter
+    {
+        std::vector<unsigned char>& out_;
+        unsigned bitBuffer_ = 0;
+        unsigned bitCount_ = 0;
+
+        DeflateWriter(std::vector<unsigned char>& out) : out_(out) { }
+
+        void Write(unsigned value, unsigned bitCt)
+        {
+            bitBuffer_ |= value << bitCount_;
+            bitCount_ += bitCt;
+            while (bitCount_ >= 8)
+            {
+                out_.push_back((unsigned char)(bitBuffer_ & 0xFF));
+                bitBuffer_ >>= 8;
+                bitCount_ -= 8;
+            }
+        }
+
+        /// Huffman codes are stored most significant bit first.
+        void WriteCode(unsigned code, unsigned bitCt)
+        {
+            unsigned reversed = 0;
+            for (unsigned i = 0; i < bitCt; ++i, code >>= 1)
+                reversed = (reversed << 1) | (code & 1);
+            Write(reversed, bitCt);
+        }
+
+        void Align()
+        {
+            if (bitCount_ > 0)
+                Write(0, 8 - bitCount_);
+        }
+
+        /// Fixed huffman literal/length alphabet.
+        void WriteSymbol(unsigned symbol)
+        {
+            if (symbol <= 143)
+                WriteCode(0x30 + symbol, 8);
+            else if (symbol <= 255)
+                WriteCode(0x190 + symbol - 144, 9);
+            else if (symbol <= 279)
+                WriteCode(symbol - 256, 7);
+            else
+                WriteCode(0xC0 + symbol - 280, 8);
+        }
+
+        void WriteMatch(unsigned length, unsigned distance)
+        {
+            static const unsigned short lengthBase[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+            static const unsigned char lengthExtra[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+            static const unsigned short distBase[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+            static const unsigned char distExtra[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+            unsigned lengthCode = 28;
+            while (lengthBase[lengthCode] > length)
+                --lengthCode;
+            WriteSymbol(257 + lengthCode);
+            if (lengthExtra[lengthCode])
+                Write(length - lengthBase[lengthCode], lengthExtra[lengthCode]);
+
+            unsigned distCode = 29;
+            while (distBase[distCode] > distance)
+                --distCode;
+            WriteCode(distCode, 5);
+            if (distExtra[distCode])
+                Write(distance - distBase[distCode], distExtra[distCode]);
+        }
+    };
+
+    inline unsigned HashBytes(const unsigned char* data)
+    {
+        const unsigned value = data[0] | (data[1] << 8) | (data[2] << 16);
+        return (value * 2654435761u) >> (32 - DEFLATE_HASH_BITS);
+    }
+
+    /// Stored (uncompressed) deflate blocks, the output is always byte aligned.
+    void StoreStrip(const unsigned char* data, unsigned begin, unsigned end, bool isLast, std::vector<unsigned char>& out)
+    {
+        out.reserve(end - begin + ((end - begin) / 65535 + 1) * 5);
+        unsigned position = begin;
+        do {
+            const unsigned blockSize = SprueMin(end - position, 65535u);
+            const bool final = isLast && position + blockSize == end;
+            out.push_back(final ? 1 : 0);
+            out.push_back(blockSize & 0xFF);
+            out.push_back(blockSize >> 8);
+            out.push_back(~blockSize & 0xFF);
+            out.push_back((~blockSize >> 8) & 0xFF);
+            out.insert(out.end(), data + position, data + position + blockSize);
+            position += blockSize;
+        } while (position < end);
+    }
+
+    /// LZ77 with hash chains into a single fixed huffman block. The hash chains are primed with up to 32KB before begin.
+    void DeflateStrip(const unsigned char* data, unsigned length, unsigned begin, unsigned end, bool isLast, const DeflateParams& params, std::vector<unsigned char>& out)
+    {
+        const unsigned primeStart = begin > DEFLATE_WINDOW ? begin - DEFLATE_WINDOW : 0;
+        std::vector<int> head(1 << DEFLATE_HASH_BITS, -1);
+        std::vector<int> prev(end - primeStart, -1);
+
+        auto insert = [&](unsigned pos) {
+            if (pos + DEFLATE_MIN_MATCH > length)
+                return;
+            const unsigned hash = HashBytes(data + pos);
+            prev[pos - primeStart] = head[hash];
+            head[hash] = (int)pos;
+        };
+
+        // Find the longest match for pos without reaching past the end of the strip
+        auto findMatch = [&](unsigned pos, unsigned& matchDistance) -> unsigned {
+            if (pos + DEFLATE_MIN_MATCH > end)
+                return 0;
+            const unsigned maxLength = SprueMin(end - pos, (unsigned)DEFLATE_MAX_MATCH);
+            unsigned bestLength = 0;
+            unsigned chain = params.maxChain_;
+            for (int candidate = head[HashBytes(data + pos)]; candidate >= 0 && chain > 0; candidate = prev[candidate - primeStart], --chain)
+            {
+                const unsigned distance = pos - (unsigned)candidate;
+                if (distance > DEFLATE_WINDOW)
+                    break;
+                if (data[candidate + bestLength] != data[pos + bestLength])
+                    continue;
+                unsigned matchLength = 0;
+                while (matchLength < maxLength && data[candidate + matchLength] == data[pos + matchLength])
+                    ++matchLength;
+                if (matchLength > bestLength)
+                {
+                    bestLength = matchLength;
+                    matchDistance = distance;
+                    if (matchLength == maxLength)
+                        break;
+                }
+            }
+            return bestLength >= DEFLATE_MIN_MATCH ? bestLength : 0;
+        };
+
+        for (unsigned i = primeStart; i < begin; ++i)
+            insert(i);
+
+        out.reserve((end - begin) / 2);
+        DeflateWriter writer(out);
+        writer.Write(isLast ? 1 : 0, 1);
+        writer.Write(1, 2); // fixed huffman
+
+        unsigned pos = begin;
+        while (pos < end)
+        {
+            unsigned distance = 0;
+            unsigned matchLength = findMatch(pos, distance);
+            if (matchLength && params.lazy_ && matchLength < DEFLATE_MAX_MATCH && pos + 1 < end)
+            {
+                // If the next position has a better match emit this byte as a literal instead
+                insert(pos);
+                unsigned nextDistance = 0;
+                const unsigned nextLength = findMatch(pos + 1, nextDistance);
+                if (nextLength > matchLength)
+                {
+                    writer.WriteSymbol(data[pos]);
+                    ++pos;
+                    continue;
+                }
+                writer.WriteMatch(matchLength, distance);
+                for (unsigned i = 1; i < matchLength; ++i)
+                    insert(pos + i);
+                pos += matchLength;
+                continue;
+            }
+
+            if (matchLength)
+            {
+                writer.WriteMatch(matchLength, distance);
+                for (unsigned i = 0; i < matchLength; ++i)
+                    insert(pos + i);
+                pos += matchLength;
+            }
+            else
+            {
+                writer.WriteSymbol(data[pos]);
+                insert(pos);
+                ++pos;
+            }
+        }
+        writer.WriteSymbol(256); // end of block
+
+        // Non-final strips end with an empty stored block so the next strip starts on a byte boundary
+        if (!isLast)
+        {
+            writer.Write(0, 3);
+            writer.Align();
+            writer.Write(0x0000, 16);
+            writer.Write(0xFFFF, 16);
+        }
+        writer.Align();
+    }
+
+    unsigned char PaethPredictor(int a, int b, int c)
+    {
+        const int p = a + b - c;
+        const int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+        if (pa <= pb && pa <= pc)
+            return (unsigned char)a;
+        if (pb <= pc)
+            return (unsigned char)b;
+        return (unsigned char)c;
+    }
+
+    /// Applies a PNG filter to one scanline, returns the sum of absolute signed residuals for the filter heuristic.
+    unsigned FilterRow(unsigned filterType, const unsigned char* row, const unsigned char* prevRow, unsigned rowBytes, unsigned channels, unsigned char* dest)
+    {
+        unsigned cost = 0;
+        for (unsigned i = 0; i < rowBytes; ++i)
+        {
+            const int left = i >= channels ? row[i - channels] : 0;
+            const int up = prevRow ? prevRow[i] : 0;
+            const int upLeft = prevRow && i >= channels ? prevRow[i - channels] : 0;
+            unsigned char value = row[i];
+            switch (filterType)
+            {
+            case 1: value = (unsigned char)(row[i] - left); break;
+            case 2: value = (unsigned char)(row[i] - up); break;
+            case 3: value = (unsigned char)(row[i] - ((left + up) >> 1)); break;
+            case 4: value = (unsigned char)(row[i] - PaethPredictor(left, up, upLeft)); break;
+            }
+            dest[i] = value;
+            cost += abs((signed char)value);
+        }
+        return cost;
+    }
+
+    inline void WriteBigEndian(unsigned char* dest, unsigned value)
+    {
+        dest[0] = (value >> 24) & 0xFF;
+        dest[1] = (value >> 16) & 0xFF;
+        dest[2] = (value >> 8) & 0xFF;
+        dest[3] = value & 0xFF;
+    }
+
+    /// Writes a PNG chunk, the CRC covers the tag and the data. A precomputed CRC may be supplied.
+    bool WriteChunk(Serializer* dest, const char* tag, const unsigned char* data, unsigned length, unsigned dataCRC, bool haveDataCRC)
+    {
+        unsigned char header[8];
+        WriteBigEndian(header, length);
+        memcpy(header + 4, tag, 4);
+        const unsigned crc = haveDataCRC ? dataCRC : ImageEncoder::CRC32(data, length, ImageEncoder::CRC32((const unsigned char*)tag, 4));
+        unsigned char footer[4];
+        WriteBigEndian(footer, crc);
+
+        bool success = dest->Write(header, 8) == 8;
+        if (length)
+            success &= dest->Write(data, length) == length;
+        success &= dest->Write(footer, 4) == 4;
+        return success;
+    }
+}
+
+unsigned ImageEncoder::CRC32(const unsigned char* data, unsigned length, unsigned crc)
+{
+    // Built once by the first call, static initialization is thread safe
+    struct Table
+    {
+        unsigned entries[256];
+        Table()
+        {
+            for (unsigned n = 0; n < 256; ++n)
+            {
+                unsigned c = n;
+                for (unsigned k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                entries[n] = c;
+            }
+        }
+    };
+    static const Table table;
+
+    crc = ~crc;
+    for (unsigned i = 0; i < length; ++i)
+        crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+unsigned ImageEncoder::Adler32(const unsigned char* data, unsigned length, unsigned adler)
+{
+    unsigned a = adler & 0xFFFF;
+    unsigned b = adler >> 16;
+    while (length > 0)
+    {
+        // 5552 is the largest run that cannot overflow before the modulo
+        const unsigned run = SprueMin(length, 5552u);
+        for (unsigned i = 0; i < run; ++i)
+        {
+            a += data[i];
+            b += a;
+        }
+        a %= ADLER_BASE;
+        b %= ADLER_BASE;
+        data += run;
+        length -= run;
+    }
+    return (b << 16) | a;
+}
+
+unsigned ImageEncoder::Adler32Combine(unsigned adlerA, unsigned adlerB, unsigned lengthB)
+{
+    const unsigned remainder = lengthB % ADLER_BASE;
+    unsigned a = adlerA & 0xFFFF;
+    unsigned b = (unsigned)(((unsigned long long)remainder * a) % ADLER_BASE);
+    a += (adlerB & 0xFFFF) + ADLER_BASE - 1;
+    b += (adlerA >> 16) + (adlerB >> 16) + ADLER_BASE - remainder;
+    if (a >= ADLER_BASE) a -= ADLER_BASE;
+    if (a >= ADLER_BASE) a -= ADLER_BASE;
+    if (b >= (ADLER_BASE << 1)) b -= (ADLER_BASE << 1);
+    if (b >= ADLER_BASE) b -= ADLER_BASE;
+    return (b << 16) | a;
+}
+
+void ImageEncoder::ToBytes(const FilterableBlockMap<RGBA>* image, unsigned channels, std::vector<unsigned char>& into)
+{
+    const unsigned width = image->getWidth();
+    into.resize(width * image->getHeight() * channels);
+    unsigned char* data = into.data();
+    ParallelFor(0, image->getHeight(), [=](unsigned y) {
+        unsigned char* row = data + y * width * channels;
+        for (unsigned x = 0; x < width; ++x, row += channels)
+        {
+            RGBA color = image->get(x, y);
+            color.Clip();
+            row[0] = (unsigned char)(color.r * 255);
+            row[1] = (unsigned char)(color.g * 255);
+            row[2] = (unsigned char)(color.b * 255);
+            if (channels > 3)
+                row[3] = (unsigned char)(color.a * 255);
+        }
+    });
+}
+
+void ImageEncoder::DeflateStrips(const unsigned char* data, unsigned length, ImageCompressionLevel level, std::vector<std::vector<unsigned char> >& strips, unsigned& adler)
+{
+    const unsigned workerCt = GetParallelWorkerCount();
+    const unsigned stripSize = SprueMax((unsigned)DEFLATE_MIN_STRIP, length / (workerCt * 4) + 1);
+    const unsigned stripCt = SprueMax((length + stripSize - 1) / stripSize, 1u);
+
+    strips.clear();
+    strips.resize(stripCt);
+    std::vector<unsigned> stripAdler(stripCt, 1);
+
+    const DeflateParams& params = GetDeflateParams(level);
+    ParallelFor(0, stripCt, [&](unsigned stripIndex) {
+        const unsigned begin = stripIndex * stripSize;
+        const unsigned end = SprueMin(begin + stripSize, length);
+        const bool isLast = stripIndex == stripCt - 1;
+        if (level == ICL_Store)
+            StoreStrip(data, begin, end, isLast, strips[stripIndex]);
+        else
+            DeflateStrip(data, length, begin, end, isLast, params, strips[stripIndex]);
+        stripAdler[stripIndex] = Adler32(data + begin, end - begin);
+    });
+
+    adler = stripAdler[0];
+    for (unsigned i = 1; i < stripCt; ++i)
+    {
+        const unsigned begin = i * stripSize;
+        const unsigned end = SprueMin(begin + stripSize, length);
+        adler = Adler32Combine(adler, stripAdler[i], end - begin);
+    }
+}
+
+void ImageEncoder::ZlibCompress(const unsigned char* data, unsigned length, ImageCompressionLevel level, std::vector<unsigned char>& into)
+{
+    // CMF 0x78 = deflate with 32K window, FLEVEL chosen so that (CMF * 256 + FLG) % 31 == 0
+    static const unsigned char flagBytes[] = { 0x01, 0x01, 0x9C, 0xDA };
+
+    std::vector<std::vector<unsigned char> > strips;
+    unsigned adler = 1;
+    DeflateStrips(data, length, level, strips, adler);
+
+    size_t totalSize = 6;
+    for (auto& strip : strips)
+        totalSize += strip.size();
+
+    into.clear();
+    into.reserve(totalSize);
+    into.push_back(0x78);
+    into.push_back(flagBytes[CLAMP((int)level, 0, 3)]);
+    for (auto& strip : strips)
+        into.insert(into.end(), strip.begin(), strip.end());
+    unsigned char adlerBytes[4];
+    WriteBigEndian(adlerBytes, adler);
+    into.insert(into.end(), adlerBytes, adlerBytes + 4);
+}
+
+bool ImageEncoder::EncodePNG(const FilterableBlockMap<RGBA>* image, ImageCompressionLevel level, Serializer* dest)
+{
+    static const unsigned char signature[] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    static const unsigned char flagBytes[] = { 0x01, 0x01, 0x9C, 0xDA };
+
+    if (!image || !dest || image->getWidth() == 0 || image->getHeight() == 0)
+        return false;
+
+    const unsigned width = image->getWidth();
+    const unsigned height = image->getHeight();
+    bool anyAlpha = false;
+    for (unsigned i = 0; i < image->size() && !anyAlpha; ++i)
+        anyAlpha = image->getData()[i].a < 1.0f;
+    const unsigned channels = anyAlpha ? 4 : 3;
+    const unsigned rowBytes = width * channels;
+
+    std::vector<unsigned char> pixels;
+    ToBytes(image, channels, pixels);
+
+    // Filter each scanline independently, rows only read the previous unfiltered row
+    std::vector<unsigned char> filtered((rowBytes + 1) * height);
+    ParallelFor(0, height, [&](unsigned y) {
+        const unsigned char* row = pixels.data() + y * rowBytes;
+        const unsigned char* prevRow = y > 0 ? row - rowBytes : 0x0;
+        unsigned char* dest = filtered.data() + y * (rowBytes + 1);
+        if (level == ICL_Store)
+        {
+            dest[0] = 0;
+            memcpy(dest + 1, row, rowBytes);
+            return;
+        }
+
+        std::vector<unsigned char> scratch(rowBytes);
+        unsigned bestFilter = 0;
+        unsigned bestCost = UINT_MAX;
+        for (unsigned filter = 0; filter < 5; ++filter)
+        {
+            const unsigned cost = FilterRow(filter, row, prevRow, rowBytes, channels, scratch.data());
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestFilter = filter;
+            }
+        }
+        dest[0] = (unsigned char)bestFilter;
+        FilterRow(bestFilter, row, prevRow, rowBytes, channels, dest + 1);
+    });
+    pixels.clear();
+    pixels.shrink_to_fit();
+
+    std::vector<std::vector<unsigned char> > strips;
+    unsigned adler = 1;
+    DeflateStrips(filtered.data(), (unsigned)filtered.size(), level, strips, adler);
+
+    // Each strip becomes its own IDAT chunk so the chunk CRCs can also be computed in parallel
+    std::vector<unsigned> stripCRC(strips.size());
+    ParallelFor(0, (unsigned)strips.size(), [&](unsigned i) {
+        stripCRC[i] = CRC32(strips[i].data(), (unsigned)strips[i].size(), CRC32((const unsigned char*)"IDAT", 4));
+    });
+
+    unsigned char ihdr[13];
+    WriteBigEndian(ihdr, width);
+    WriteBigEndian(ihdr + 4, height);
+    ihdr[8] = 8; // bit depth
+    ihdr[9] = anyAlpha ? 6 : 2; // color type, RGBA or RGB
+    ihdr[10] = 0; // deflate
+    ihdr[11] = 0; // adaptive filtering
+    ihdr[12] = 0; // no interlace
+
+    unsigned char zlibHeader[2] = { 0x78, flagBytes[CLAMP((int)level, 0, 3)] };
+    unsigned char adlerBytes[4];
+    WriteBigEndian(adlerBytes, adler);
+
+    bool success = dest->Write(signature, 8) == 8;
+    success &= WriteChunk(dest, "IHDR", ihdr, 13, 0, false);
+    success &= WriteChunk(dest, "IDAT", zlibHeader, 2, 0, false);
+    for (unsigned i = 0; i < strips.size(); ++i)
+        success &= WriteChunk(dest, "IDAT", strips[i].data(), (unsigned)strips[i].size(), stripCRC[i], true);
+    success &= WriteChunk(dest, "IDAT", adlerBytes, 4, 0, false);
+    success &= WriteChunk(dest, "IEND", 0x0, 0, 0, false);
+    return success;
+}
+
+bool ImageEncoder::EncodeTGA(const FilterableBlockMap<RGBA>* image, ImageCompressionLevel level, Serializer* dest)
+{
+    if (!image || !dest || image->getWidth() == 0 || image->getHeight() == 0)
+        return false;
+
+    const unsigned width = image->getWidth();
+    const unsigned height = image->getHeight();
+    bool anyAlpha = false;
+    for (unsigned i = 0; i < image->size() && !anyAlpha; ++i)
+        anyAlpha = image->getData()[i].a < 1.0f;
+    const unsigned channels = anyAlpha ? 4 : 3;
+    const bool useRLE = level != ICL_Store;
+
+    std::vector<unsigned char> pixels;
+    ToBytes(image, channels, pixels);
+
+    // Swizzle to BGR(A) and optionally run-length encode, packets never cross a scanline so rows are independent
+    std::vector<std::vector<unsigned char> > rows(height);
+    ParallelFor(0, height, [&](unsigned y) {
+        unsigned char* row = pixels.data() + y * width * channels;
+        for (unsigned x = 0; x < width; ++x)
+            std::swap(row[x * channels], row[x * channels + 2]);
+
+        std::vector<unsigned char>& out = rows[y];
+        if (!useRLE)
+        {
+            out.assign(row, row + width * channels);
+            return;
+        }
+
+        out.reserve(width * channels + width / 128 + 1);
+        unsigned x = 0;
+        while (x < width)
+        {
+            // Count identical pixels
+            unsigned runLength = 1;
+            while (x + runLength < width && runLength < 128 && memcmp(row + x * channels, row + (x + runLength) * channels, channels) == 0)
+                ++runLength;
+            if (runLength > 1)
+            {
+                out.push_back((unsigned char)(0x80 | (runLength - 1)));
+                out.insert(out.end(), row + x * channels, row + (x + 1) * channels);
+                x += runLength;
+                continue;
+            }
+
+            // Gather raw pixels until a run of at least 2 starts
+            unsigned rawLength = 1;
+            while (x + rawLength < width && rawLength < 128)
+            {
+                if (x + rawLength + 1 < width && memcmp(row + (x + rawLength) * channels, row + (x + rawLength + 1) * channels, channels) == 0)
+                    break;
+                ++rawLength;
+            }
+            out.push_back((unsigned char)(rawLength - 1));
+            out.insert(out.end(), row + x * channels, row + (x + rawLength) * channels);
+            x += rawLength;
+        }
+    });
+
+    unsigned char header[18];
+    memset(header, 0, sizeof(header));
+    header[2] = useRLE ? 10 : 2; // truecolor, optionally RLE
+    header[12] = width & 0xFF;
+    header[13] = (width >> 8) & 0xFF;
+    header[14] = height & 0xFF;
+    header[15] = (height >> 8) & 0xFF;
+    header[16] = (unsigned char)(channels * 8);
+    header[17] = (anyAlpha ? 8 : 0) | 0x20; // alpha bits, top-left origin
+
+    bool success = dest->Write(header, 18) == 18;
+    for (auto& row : rows)
+        success &= dest->Write(row.data(), (unsigned)row.size()) == row.size();
+    return success;
+}
+
+}
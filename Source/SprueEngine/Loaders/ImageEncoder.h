@@ -0,0 +1,51 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+#include <SprueEngine/BlockMap.h>
+
+#include <vector>
+
+namespace SprueEngine
+{
+
+class Serializer;
+
+/// Speed/size presets for image encoding.
+enum ImageCompressionLevel
+{
+    ICL_Store = 0,      // No compression at all (stored deflate blocks / uncompressed TGA), fastest to write
+    ICL_Fastest = 1,    // Short match search, no lazy matching
+    ICL_Default = 2,    // Balanced
+    ICL_Best = 3,       // Long match search with lazy matching, slowest
+};
+
+/// Multithreaded image encoders for PNG and TGA.
+/// PNG data is deflated in independent strips on every hardware thread, each strip is primed with the preceding 32KB so that
+/// matches may still reach across strips, and the strips are joined into a single valid zlib stream (byte aligned with empty stored blocks).
+class SPRUE ImageEncoder
+{
+public:
+    /// Converts the image to 8-bit interleaved channels (3 or 4), rows are converted in parallel.
+    static void ToBytes(const FilterableBlockMap<RGBA>* image, unsigned channels, std::vector<unsigned char>& into);
+
+    /// Compresses data into a complete zlib stream (header, deflate data, adler32).
+    static void ZlibCompress(const unsigned char* data, unsigned length, ImageCompressionLevel level, std::vector<unsigned char>& into);
+
+    /// Writes a complete PNG file, alpha is only written if it is used.
+    static bool EncodePNG(const FilterableBlockMap<RGBA>* image, ImageCompressionLevel level, Serializer* dest);
+    /// Writes a complete TGA file, any level other than ICL_Store uses run-length encoding.
+    static bool EncodeTGA(const FilterableBlockMap<RGBA>* image, ImageCompressionLevel level, Serializer* dest);
+
+    /// Computes the CRC32 used by PNG chunks, pass a previous result to continue a running checksum.
+    static unsigned CRC32(const unsigned char* data, unsigned length, unsigned crc = 0);
+    /// Computes the adler32 checksum used by zlib streams.
+    static unsigned Adler32(const unsigned char* data, unsigned length, unsigned adler = 1);
+    /// Combines the adler32 of two consecutive blocks of data.
+    static unsigned Adler32Combine(unsigned adlerA, unsigned adlerB, unsigned lengthB);
+
+private:
+    /// Deflates data into independently encoded byte-aligned strips, the concatenation of the strips is a raw deflate stream.
+    static void DeflateStrips(const unsigned char* data, unsigned length, ImageCompressionLevel level, std::vector<std::vector<unsigned char> >& strips, unsigned& adler);
+};
+
+}
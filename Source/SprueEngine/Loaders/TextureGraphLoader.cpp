@@ -0,0 +1,145 @@
+#include "TextureGraphLoader.h"
+
+#include <SprueEngine/FileBuffer.h>
+#include <SprueEngine/FString.h>
+#include <SprueEngine/GeneralUtility.h>
+#include <SprueEngine/Graph/Graph.h>
+#include <SprueEngine/Logging.h>
+#include <SprueEngine/SerializationContext.h>
+
+#include <fstream>
+#include <iterator>
+
+namespace SprueEngine
+{
+
+const StringHash TextureGraphResource::type_("TextureGraph");
+const std::string TextureGraphLoader::resourceURI_("TextureGraph");
+const StringHash TextureGraphLoader::typeHash_("TextureGraph");
+
+TextureGraphResource::~TextureGraphResource()
+{
+    if (graph_)
+        delete graph_;
+    graph_ = 0x0;
+}
+
+std::shared_ptr<const TextureGraphResource::ImageSet> TextureGraphResource::GetCachedImages(uint64_t key) const
+{
+    std::lock_guard<std::mutex> lock(cacheLock_);
+    auto found = cache_.find(key);
+    if (found != cache_.end())
+        return found->second;
+    return std::shared_ptr<const ImageSet>();
+}
+
+void TextureGraphResource::CacheImages(uint64_t key, const std::shared_ptr<const ImageSet>& images)
+{
+    std::lock_guard<std::mutex> lock(cacheLock_);
+    if (cache_.find(key) == cache_.end())
+        cacheOrder_.push_back(key);
+    cache_[key] = images;
+    while (cacheOrder_.size() > MaxCachedImageSets)
+    {
+        cache_.erase(cacheOrder_.front());
+        cacheOrder_.pop_front();
+    }
+}
+
+void TextureGraphResource::ClearCachedImages()
+{
+    std::lock_guard<std::mutex> lock(cacheLock_);
+    cache_.clear();
+    cacheOrder_.clear();
+}
+
+unsigned TextureGraphResource::GetCachedImageSetCount() const
+{
+    std::lock_guard<std::mutex> lock(cacheLock_);
+    return (unsigned)cache_.size();
+}
+
+std::shared_ptr<Resource> TextureGraphResource::Clone() const
+{
+    std::shared_ptr<TextureGraphResource> ret(new TextureGraphResource());
+    // Deep copy, stored images are not carried over
+    ret->name_ = name_;
+    ret->graph_ = graph_ ? (Graph*)graph_->Clone() : 0x0;
+    ret->contentHash_ = contentHash_;
+    return ret;
+}
+
+std::string TextureGraphLoader::GetResourceURIRoot() const
+{
+    return resourceURI_;
+}
+
+StringHash TextureGraphLoader::GetResourceTypeID() const
+{
+    return typeHash_;
+}
+
+std::shared_ptr<Resource> TextureGraphLoader::LoadResource(const char* fileName) const
+{
+    Graph* graph = LoadGraph(fileName);
+    if (!graph)
+        return std::shared_ptr<Resource>();
+
+    // Hashing the file rather than the path, the same library saved twice hashes the same
+    std::ifstream file(fileName, std::ios::binary);
+    const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return std::make_shared<TextureGraphResource>(fileName, graph, HashBytes64(contents.data(), contents.size()));
+}
+
+bool TextureGraphLoader::CanLoad(const char* path) const
+{
+    std::string text = ToLower(path);
+    return EndsWith(text, ".texg") || EndsWith(text, ".xml");
+}
+
+Graph* TextureGraphLoader::LoadGraph(const std::string& filePath)
+{
+    SerializationContext ctx;
+    ctx.relativePath_ = FolderOf(filePath);
+
+    Graph* graph = 0x0;
+    if (EndsWith(filePath, ".xml"))
+    {
+        tinyxml2::XMLDocument doc;
+        tinyxml2::XMLError errCode = doc.LoadFile(filePath.c_str());
+        if (errCode == tinyxml2::XMLError::XML_SUCCESS)
+        {
+            if (tinyxml2::XMLElement* root = doc.FirstChildElement("graph"))
+            {
+                graph = new Graph();
+                graph->Deserialize(root, ctx);
+            }
+        }
+        else
+        {
+            SPRUE_LOG_ERROR(FString("Unable to open texture graph: %1", filePath));
+            return 0x0;
+        }
+    }
+    else if (EndsWith(filePath, ".texg"))
+    {
+        FileBuffer buffer(filePath.c_str(), true, true);
+        if (buffer.ReadFileID().compare("TEXG") == 0)
+        {
+            // Read the string hash, had to write the hash in order to work with Clone() correctly.
+            buffer.ReadStringHash();
+            graph = new Graph();
+            graph->Deserialize(&buffer, ctx);
+        }
+    }
+
+    if (graph && !ctx.pathErrors_.empty())
+    {
+        SPRUE_LOG_ERROR(FString("Unable to resolve all file paths in texture graph: %1", filePath));
+        delete graph;
+        return 0x0;
+    }
+    return graph;
+}
+
+}
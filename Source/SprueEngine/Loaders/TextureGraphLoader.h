@@ -0,0 +1,81 @@
+#pragma once
+
+#include <SprueEngine/ResourceLoader.h>
+#include <SprueEngine/BlockMap.h>
+#include <SprueEngine/Resource.h>
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace SprueEngine
+{
+
+class Graph;
+
+/// A texture graph loaded from a .texg or .xml file, used as a library of reusable groups.
+/// Group nodes evaluating the graph store their materialized results here, keyed by a hash of the graph and of their bound inputs,
+/// so every document referencing the same library file shares them through the ResourceStore.
+class SPRUE TextureGraphResource : public Resource
+{
+    BASECLASSDEF(TextureGraphResource, Resource);
+    NOCOPYDEF(TextureGraphResource);
+    TextureGraphResource() { }
+public:
+    typedef std::vector<std::shared_ptr<FilterableBlockMap<RGBA> > > ImageSet;
+
+    /// Maximum number of image sets kept, the oldest are dropped first.
+    static const unsigned MaxCachedImageSets = 64;
+
+    TextureGraphResource(const std::string& name, Graph* graph, uint64_t contentHash) { name_ = name; graph_ = graph; contentHash_ = contentHash; }
+    virtual ~TextureGraphResource();
+
+    virtual StringHash GetResourceType() const override { return type_; }
+
+    /// The loaded graph, must not be evaluated directly as other documents share it, evaluate a clone.
+    const Graph* GetGraph() const { return graph_; }
+    /// Hash of the file contents.
+    uint64_t GetContentHash() const { return contentHash_; }
+
+    /// Returns the image set stored for the key, or null.
+    std::shared_ptr<const ImageSet> GetCachedImages(uint64_t key) const;
+    /// Stores an image set for the key.
+    void CacheImages(uint64_t key, const std::shared_ptr<const ImageSet>& images);
+    /// Drops every stored image set.
+    void ClearCachedImages();
+    unsigned GetCachedImageSetCount() const;
+
+    virtual std::shared_ptr<Resource> Clone() const override;
+
+protected:
+    Graph* graph_ = 0x0;
+    uint64_t contentHash_ = 0;
+    mutable std::mutex cacheLock_;
+    std::unordered_map<uint64_t, std::shared_ptr<const ImageSet> > cache_;
+    std::deque<uint64_t> cacheOrder_;
+
+    static const StringHash type_;
+};
+
+class SPRUE TextureGraphLoader : public ResourceLoader
+{
+    NOCOPYDEF(TextureGraphLoader);
+    BASECLASSDEF(TextureGraphLoader, ResourceLoader);
+public:
+    TextureGraphLoader() { }
+    virtual std::string GetResourceURIRoot() const override;
+    virtual StringHash GetResourceTypeID() const override;
+    virtual std::shared_ptr<Resource> LoadResource(const char*) const override;
+    virtual bool CanLoad(const char*) const override;
+
+    /// Reads a texture graph from a .texg or .xml file, returns null on failure.
+    static Graph* LoadGraph(const std::string& filePath);
+
+private:
+    static const std::string resourceURI_;
+    static const StringHash typeHash_;
+};
+
+}
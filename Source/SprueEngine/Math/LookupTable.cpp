@@ -0,0 +1,111 @@
+#include "LookupTable.h"
+
+#include <SprueEngine/ResponseCurve.h>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+    #define SPRUE_LUT_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace SprueEngine
+{
+
+void LookupTable::Bake(const ColorRamp& ramp, unsigned size)
+{
+    Bake(size, [&ramp](float position) { return ramp.Get(position); });
+}
+
+void LookupTable::Bake(const ColorCurves& curves, unsigned size)
+{
+    Bake(size, [&curves](float position) { return RGBA(curves.R.GetY(position), curves.G.GetY(position), curves.B.GetY(position), curves.A.GetY(position)); });
+}
+
+void LookupTable::Bake(const ResponseCurve& curve, unsigned size)
+{
+    Bake(size, [&curve](float position) { const float value = curve.GetValue(position); return RGBA(value, value, value, 1.0f); });
+}
+
+void LookupTable::Resize(unsigned size)
+{
+    size_ = CLAMP(size, MinSize, MaxSize);
+    for (unsigned c = 0; c < 4; ++c)
+        channels_[c].resize(size_ + 1);
+}
+
+void LookupTable::SetEntry(unsigned index, const RGBA& value)
+{
+    channels_[0][index] = value.r;
+    channels_[1][index] = value.g;
+    channels_[2][index] = value.b;
+    channels_[3][index] = value.a;
+}
+
+void LookupTable::Finish()
+{
+    for (unsigned c = 0; c < 4; ++c)
+        channels_[c][size_] = channels_[c][size_ - 1];
+}
+
+float LookupTable::LookupOne(unsigned channel, float position) const
+{
+    // Written so that NaN clamps to 0, as _mm_max_ps does
+    position = position > 0.0f ? position : 0.0f;
+    position = position < 1.0f ? position : 1.0f;
+    const float scaled = position * (size_ - 1);
+    const unsigned index = (unsigned)scaled;
+    const float fraction = scaled - index;
+    const float* table = channels_[channel].data();
+    return table[index] + (table[index + 1] - table[index]) * fraction;
+}
+
+RGBA LookupTable::Get(float position) const
+{
+    if (!size_)
+        return RGBA(0, 0, 0, 0);
+    return RGBA(LookupOne(0, position), LookupOne(1, position), LookupOne(2, position), LookupOne(3, position));
+}
+
+RGBA LookupTable::GetPerChannel(const RGBA& value) const
+{
+    if (!size_)
+        return value;
+    return RGBA(LookupOne(0, value.r), LookupOne(1, value.g), LookupOne(2, value.b), LookupOne(3, value.a));
+}
+
+void LookupTable::Lookup(unsigned channel, const float* positions, float* into, unsigned count) const
+{
+    channel &= 3;
+    if (!size_)
+    {
+        for (unsigned i = 0; i < count; ++i)
+            into[i] = 0.0f;
+        return;
+    }
+
+    unsigned i = 0;
+#ifdef SPRUE_LUT_SSE2
+    const float* table = channels_[channel].data();
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps((float)(size_ - 1));
+    int indices[4];
+    for (; i + 4 <= count; i += 4)
+    {
+        // max(x, 0) returns 0 for NaN
+        const __m128 position = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(positions + i), zero), one);
+        const __m128 scaled = _mm_mul_ps(position, scale);
+        const __m128i index = _mm_cvttps_epi32(scaled);
+        const __m128 fraction = _mm_sub_ps(scaled, _mm_cvtepi32_ps(index));
+        _mm_storeu_si128((__m128i*)indices, index);
+
+        // SSE2 has no gather, the loads are scalar and the interpolation vectorized
+        const __m128 low = _mm_setr_ps(table[indices[0]], table[indices[1]], table[indices[2]], table[indices[3]]);
+        const __m128 high = _mm_setr_ps(table[indices[0] + 1], table[indices[1] + 1], table[indices[2] + 1], table[indices[3] + 1]);
+        _mm_storeu_ps(into + i, _mm_add_ps(low, _mm_mul_ps(_mm_sub_ps(high, low), fraction)));
+    }
+#endif
+    for (; i < count; ++i)
+        into[i] = LookupOne(channel, positions[i]);
+}
+
+}
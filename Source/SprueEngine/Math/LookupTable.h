@@ -0,0 +1,63 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+#include <SprueEngine/Math/Color.h>
+
+#include <vector>
+
+namespace SprueEngine
+{
+
+struct ResponseCurve;
+
+/// A function of 0 - 1 baked into a 1D table of RGBA entries and looked up with linear interpolation.
+/// Replaces evaluating ramps and curves control point by control point for every pixel. Inputs outside 0 - 1 (and NaN)
+/// are clamped to the ends of the table. Channels are stored as separate arrays so that a whole lane of register values
+/// can be looked up at once, four at a time with SSE2 where available.
+class SPRUE LookupTable
+{
+public:
+    static const unsigned MinSize = 256;
+    static const unsigned MaxSize = 65536;
+    static const unsigned DefaultSize = 4096;
+
+    /// Bakes func(position) -> RGBA at size evenly spaced positions from 0 to 1 inclusive, size is clamped to MinSize - MaxSize.
+    template<typename FUNC>
+    void Bake(unsigned size, FUNC func)
+    {
+        Resize(size);
+        const float step = 1.0f / (size_ - 1);
+        for (unsigned i = 0; i < size_; ++i)
+            SetEntry(i, func(i * step));
+        Finish();
+    }
+
+    /// Bakes a gradient ramp, look it up with Get.
+    void Bake(const ColorRamp& ramp, unsigned size = DefaultSize);
+    /// Bakes each curve into its own channel, look it up with GetPerChannel.
+    void Bake(const ColorCurves& curves, unsigned size = DefaultSize);
+    /// Bakes a response curve into every color channel with an alpha of 1.
+    void Bake(const ResponseCurve& curve, unsigned size = DefaultSize);
+
+    /// Number of entries, 0 if never baked.
+    unsigned GetSize() const { return size_; }
+
+    /// Looks up a position in every channel, as a gradient ramp.
+    RGBA Get(float position) const;
+    /// Looks up every channel of the value in the same channel of the table, as color curves.
+    RGBA GetPerChannel(const RGBA& value) const;
+    /// Looks up count positions in one channel of the table. Into may be the same array as positions.
+    void Lookup(unsigned channel, const float* positions, float* into, unsigned count) const;
+
+private:
+    void Resize(unsigned size);
+    void SetEntry(unsigned index, const RGBA& value);
+    /// Pads the table so that interpolating at exactly 1 never reads past the end.
+    void Finish();
+    float LookupOne(unsigned channel, float position) const;
+
+    std::vector<float> channels_[4];
+    unsigned size_ = 0;
+};
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace SprueEngine
+{
+
+    /// Returns the number of worker threads to use for data-parallel work, never less than 1.
+    inline unsigned GetParallelWorkerCount()
+    {
+        const unsigned hardwareCt = std::thread::hardware_concurrency();
+        return hardwareCt > 0 ? hardwareCt : 1;
+    }
+
+    /// Runs FUNC(index) for every index in [begin, end) across all hardware threads.
+    /// Indices are handed out one at a time from a shared counter so uneven rows (ie. image rows with expensive content) balance themselves.
+    /// The calling thread participates in the work, the call blocks until every index has been processed.
+    template<typename FUNC>
+    void ParallelFor(unsigned begin, unsigned end, FUNC func, unsigned maxWorkers = 0)
+    {
+        if (end <= begin)
+            return;
+
+        unsigned workerCt = maxWorkers > 0 ? std::min(maxWorkers, GetParallelWorkerCount()) : GetParallelWorkerCount();
+        workerCt = std::min(workerCt, end - begin);
+        if (workerCt <= 1)
+        {
+            for (unsigned i = begin; i < end; ++i)
+                func(i);
+            return;
+        }
+
+        std::atomic<unsigned> nextIndex(begin);
+        auto worker = [&]() {
+            for (unsigned i = nextIndex++; i < end; i = nextIndex++)
+                func(i);
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(workerCt - 1);
+        for (unsigned i = 0; i < workerCt - 1; ++i)
+            threads.push_back(std::thread(worker));
+        worker();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+}
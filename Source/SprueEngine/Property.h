@@ -401,11 +401,11 @@ namespace SprueEngine
             ResourceHandle read = src->ReadVariant().getResourceHandle();
             read.RemapPath(context.relativePath_);
 
-            // Verify we can reach the file, if not then push a path error
-            if (!FileAccessible(read.Name))
+            // Verify we can reach the file, if not then push a path error. Clones were verified when their source was loaded
+            if (!context.isClone_ && !FileAccessible(read.Name))
                 context.pathErrors_.push_back(SerializationContext::PathError{ (IEditable*)obj, this, read.Name });
 
-            Set(obj, read); 
+            SetOrDefer(obj, read, context);
         }
 
 #ifndef SPRUE_NO_XML
@@ -433,11 +433,23 @@ namespace SprueEngine
                 if (!FileAccessible(handle.Name))
                     context.pathErrors_.push_back(SerializationContext::PathError{ (IEditable*)obj, this, handle.Name });
 
-                Set(obj, handle);
+                SetOrDefer(obj, handle, context);
             }
         }
 #endif
 
+        void SetOrDefer(void* obj, const ResourceHandle& handle, const SerializationContext& context)
+        {
+            if (context.deferResources_ && !handle.Name.empty())
+            {
+                CLASSTYPE* src = static_cast<CLASSTYPE*>(obj);
+                (src->*handleSetter_)(handle);
+                context.deferredResources_.push_back(SerializationContext::DeferredResource{ obj, this, handle.Type, handle.Name });
+            }
+            else
+                Set(obj, handle);
+        }
+
         HANDLE_GETTER handleGetter_;
         HANDLE_SETTER handleSetter_;
         RESOURCE_GETTER resourceGetter_;
@@ -5,15 +5,18 @@
 #include <SprueEngine/Core/Context.h>
 #include <SprueEngine/Graph/Graph.h>
 #include <SprueEngine/Graph/GraphNode.h>
+#include <SprueEngine/Graph/GraphProfiler.h>
 #include <SprueEngine/Graph/GraphSocket.h>
-#include <SprueEngine/FileBuffer.h>
 #include <SprueEngine/FString.h>
+#include <SprueEngine/Loaders/TextureGraphLoader.h>
 #include <SprueEngine/Reports/HTMLReport.h>
 #include <SprueEngine/Logging.h>
 #include <SprueEngine/TextureGen/TextureNode.h>
 
 #include <SprueEngine/MathGeoLib/Time/Clock.h>
 
+#include <fstream>
+
 namespace SprueEngine
 {
 
@@ -21,14 +24,23 @@ namespace SprueEngine
     {
         HTMLReport report(path, title);
         MakeTOC(&report, files);
+        std::vector<std::string> profiles;
         for (auto file : files)
         {
             if (Graph* graph = GraphFromFile(file))
             {
-                MakeHTMLReport(&report, file, graph, false);
+                GraphProfiler profiler;
+                MakeHTMLReport(&report, file, graph, false, profiler);
+                profiles.push_back(profiler.ToJSON(FileName(file)));
                 delete graph;
             }
         }
+
+        std::ofstream json(GetProfilePath(path));
+        json << "[\n";
+        for (unsigned i = 0; i < profiles.size(); ++i)
+            json << profiles[i] << (i + 1 < profiles.size() ? ",\n" : "\n");
+        json << "]";
     }
 
     TextureGraphReport::TextureGraphReport(const std::string& title, const std::string& path, const std::string& file)
@@ -36,7 +48,10 @@ namespace SprueEngine
         if (Graph* graph = GraphFromFile(file))
         {
             HTMLReport report(path, title);
-            MakeHTMLReport(&report, file, graph, true);
+            GraphProfiler profiler;
+            MakeHTMLReport(&report, file, graph, true, profiler);
+            profiler.WriteJSON(GetProfilePath(path), FileName(file));
+            delete graph;
         }
     }
 
@@ -45,7 +60,7 @@ namespace SprueEngine
 
     }
 
-    void TextureGraphReport::MakeHTMLReport(HTMLReport* report, const std::string& reportTitle, Graph* graph, bool detailed)
+    void TextureGraphReport::MakeHTMLReport(HTMLReport* report, const std::string& reportTitle, Graph* graph, bool detailed, GraphProfiler& profiler)
     {
         // Print the report title
         report->Header(1);
@@ -70,9 +85,11 @@ namespace SprueEngine
             report->PopTag();
             auto startTime = Clock::Tick();
             // TODO! generate the PNG image
+            profiler.Activate();
             auto blockmap = output->GetPreview();
-            report->ImgEmbedded(blockmap.get());
+            profiler.Deactivate();
             auto endTime = Clock::Tick();
+            report->ImgEmbedded(blockmap.get());
             auto elapsedTime = Clock::TicksInBetween(endTime, startTime);
             totalGenerationTime += elapsedTime;
             report->P();
@@ -87,6 +104,12 @@ namespace SprueEngine
         report->Text(FString("Total generation time: %1 seconds", Clock::TicksToSecondsF(totalGenerationTime)));
         report->PopTag();
 
+        report->Anchor("node_timing");
+        report->Header(2);
+        report->Text("Node Timing");
+        report->PopTag();
+        profiler.WriteHTMLTable(report);
+
         report->Anchor("basic_info");
         report->Header(2);
         report->Text("Basic Information");
@@ -219,61 +242,18 @@ namespace SprueEngine
         }
     }
 
-    Graph* TextureGraphReport::GraphFromFile(const std::string& filePath)
+    std::string TextureGraphReport::GetProfilePath(const std::string& reportPath)
     {
-        SprueEngine::SerializationContext ctx;
-        ctx.relativePath_ = FolderOf(filePath);
-
-        Graph* graph = 0x0;
-        if (EndsWith(filePath, ".xml"))
-        {
-            tinyxml2::XMLDocument doc;
-            tinyxml2::XMLError errCode = doc.LoadFile(filePath.c_str());
-            if (errCode == tinyxml2::XMLError::XML_SUCCESS)
-            {
-                if (tinyxml2::XMLElement* root = doc.FirstChildElement("graph"))
-                {
-                    graph = new Graph();
-                    graph->Deserialize(root, ctx);
-                    if (ctx.pathErrors_.empty())
-                        return graph;
-                    else
-                    {
-                        SPRUE_LOG_ERROR(FString("Unable to resolve all file paths in file for report: %1", filePath));
-                        delete graph;
-                    }
-                }
-                if (graph)
-                    delete graph;
-            }
-            else
-            {
-                SPRUE_LOG_ERROR(FString("Unable to open file for report: %1", filePath));
-            }
-        }
-        else if (EndsWith(filePath, ".texg"))
-        {
-            FileBuffer buffer(filePath.c_str(), true, true);
-            if (buffer.ReadFileID().compare("TEXG") == 0)
-            {
-                // Read the string hash, had to write the hash in order to work with Clone() correctly.
-                buffer.ReadStringHash();
-                graph = new Graph();
-                graph->Deserialize(&buffer, ctx);
-
-                if (ctx.pathErrors_.empty())
-                    return graph;
-                else
-                {
-                    SPRUE_LOG_ERROR(FString("Unable to resolve all file paths in file for report: %1", filePath));
-                    delete graph;
-                }
-
-                return graph;
-            }
-        }
+        const size_t extStart = reportPath.find_last_of('.');
+        const size_t lastSlash = reportPath.find_last_of("/\\");
+        if (extStart != std::string::npos && (lastSlash == std::string::npos || extStart > lastSlash))
+            return reportPath.substr(0, extStart) + "_profile.json";
+        return reportPath + "_profile.json";
+    }
 
-        return graph;
+    Graph* TextureGraphReport::GraphFromFile(const std::string& filePath)
+    {
+        return TextureGraphLoader::LoadGraph(filePath);
     }
 
     void TextureGraphReport::MakeTOC(HTMLReport* report, const std::vector<std::string>& files)
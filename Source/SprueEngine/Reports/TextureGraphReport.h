@@ -8,6 +8,7 @@
 namespace SprueEngine
 {
     class Graph;
+    class GraphProfiler;
     class HTMLReport;
 
     /// Constructs a report that contains information on:
@@ -16,6 +17,7 @@ namespace SprueEngine
     ///     External graph references
     ///         Externals referenced by a graph
     ///         Graphs referenced by other graphs
+    ///     Per-node timing, also written next to the report as <report>_profile.json
     class SPRUE TextureGraphReport
     {
     public:
@@ -23,10 +25,14 @@ namespace SprueEngine
         TextureGraphReport(const std::string& reportTitle, const std::string& path, const std::string& file);
         virtual ~TextureGraphReport();
 
+        /// Loads a graph from .texg or .xml, returns null if the file could not be read or has unresolved paths.
+        static Graph* GraphFromFile(const std::string& filePath);
+
     protected:
-        void MakeHTMLReport(HTMLReport* report, const std::string& reportTitle, Graph* graph, bool detailed);
+        void MakeHTMLReport(HTMLReport* report, const std::string& reportTitle, Graph* graph, bool detailed, GraphProfiler& profiler);
         void MakeTOC(HTMLReport* report, const std::vector<std::string>& files);
-        Graph* GraphFromFile(const std::string& filePath);
+        /// Path of the JSON timing data that accompanies a report.
+        static std::string GetProfilePath(const std::string& reportPath);
     };
 
 }
\ No newline at end of file
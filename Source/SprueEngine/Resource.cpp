@@ -80,6 +80,25 @@ unsigned MeshResource::GetTriangleCount() const
     return ret;
 }
 
+unsigned long long MeshResource::GetMemorySize() const
+{
+    unsigned long long ret = 0;
+    for (const MeshData* mesh : meshes_)
+    {
+        if (!mesh)
+            continue;
+        ret += mesh->GetPositionBuffer().size() * sizeof(Vec3);
+        ret += mesh->GetNormalBuffer().size() * sizeof(Vec3);
+        ret += mesh->GetTangentBuffer().size() * sizeof(Vec4);
+        ret += mesh->GetColorBuffer().size() * sizeof(RGBA);
+        ret += mesh->GetUVBuffer().size() * sizeof(Vec2);
+        ret += mesh->GetBoneIndexBuffer().size() * sizeof(IntVec4);
+        ret += mesh->GetBoneWeightBuffer().size() * sizeof(Vec4);
+        ret += mesh->GetIndexBuffer().size() * sizeof(unsigned);
+    }
+    return ret;
+}
+
 std::shared_ptr<Resource> BitmapResource::Clone() const
 {
     std::shared_ptr<BitmapResource> res(new BitmapResource());
@@ -52,6 +52,9 @@ public:
 
     std::shared_ptr<Resource> GetParent() const { return parentResource_; }
 
+    /// Approximate bytes held, for the ResourceStore's memory budget.
+    virtual unsigned long long GetMemorySize() const { return 0; }
+
 protected:
     std::string name_;
     /// This resource is a sub-resource.
@@ -82,6 +85,8 @@ public:
 
     virtual std::shared_ptr<Resource> Clone() const override;
 
+    virtual unsigned long long GetMemorySize() const override;
+
 protected:
     std::vector<MeshData*> meshes_;
     Skeleton* skeleton_ = 0x0;
@@ -104,6 +109,8 @@ public:
 
     virtual std::shared_ptr<Resource> Clone() const override;
 
+    virtual unsigned long long GetMemorySize() const override { return data_ ? sizeof(RGBA) * (unsigned long long)data_->size() : 0; }
+
 protected:
     std::shared_ptr< FilterableBlockMap<RGBA> > data_;
 
@@ -4,14 +4,23 @@
 #include "Loaders/FBXLoader.h"
 #include "Loaders/OBJLoader.h"
 #include "Loaders/SVGLoader.h"
+#include "Loaders/TextureGraphLoader.h"
 
 #include "Core/Context.h"
+#include "FileBuffer.h"
 #include "FString.h"
+#include "GeneralUtility.h"
 #include "Logging.h"
+#include "Property.h"
 #include "Resource.h"
 #include "ResourceLoader.h"
+#include "SerializationContext.h"
+#include "VectorBuffer.h"
 #include "Libs/UriParser.hpp"
 
+#include <cstdio>
+#include <cstring>
+
 namespace SprueEngine
 {
 
@@ -22,33 +31,65 @@ ResourceStore::ResourceStore(Context* context)
     context->RegisterResourceLoader(new OBJLoader());
     context->RegisterResourceLoader(new FBXLoader());
     context->RegisterResourceLoader(new SVGLoader());
+    context->RegisterResourceLoader(new TextureGraphLoader());
 }
 
 ResourceStore::~ResourceStore()
 {
-    
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        stopping_ = true;
+        prefetch_.clear();
+    }
+    prefetchQueued_.notify_all();
+    for (auto& thread : prefetchThreads_)
+        thread.join();
 }
 
-std::shared_ptr<Resource> ResourceStore::GetOrLoadResource(const char* fileName, const StringHash& resourceType)
+std::shared_ptr<Resource> ResourceStore::GetResource(const char* fileName)
 {
-    // Can we find or is it unloaded?
+    std::lock_guard<std::mutex> lock(lock_);
     auto found = resources_.find(fileName);
-    if (found != resources_.end() && !found->second.expired())
+    if (found != resources_.end())
+        return found->second.lock();
+    return 0x0;
+}
+
+std::shared_ptr<Resource> ResourceStore::GetOrLoadResource(const char* fileName, const StringHash& resourceType)
+{
+    const StringHash key(fileName);
+    std::unique_lock<std::mutex> lock(lock_);
+    for (;;)
     {
-        if (std::shared_ptr<Resource> ret = found->second.lock())
+        // Can we find or is it unloaded?
+        if (std::shared_ptr<Resource> ret = Find(fileName, key))
             return ret;
+        if (loading_.find(key) == loading_.end())
+            break;
+        loaded_.wait(lock);
     }
+    loading_.insert(key);
+    lock.unlock();
 
+    // Stamped before loading, a file that changes while it is read will be seen as changed next time
+    const uint64_t stamp = GetFileStamp(fileName);
+    std::shared_ptr<Resource> resource;
     if (ResourceLoader* loader = Context::GetInstance()->GetResourceLoader(resourceType, fileName))
+        resource = Load(loader, fileName, stamp);
+
+    lock.lock();
+    loading_.erase(key);
+    if (resource)
     {
-        if (std::shared_ptr<Resource> resource = loader->LoadResource(fileName))
-        {
-            resources_[fileName] = resource;
-            return resource;
-        }
+        resources_[key] = resource;
+        Retain(key, resource, stamp);
     }
-    SPRUE_LOG_ERROR(FString("Unable to load resource: %1", fileName).c_str());
-    return 0x0;
+    lock.unlock();
+    loaded_.notify_all();
+
+    if (!resource)
+        SPRUE_LOG_ERROR(FString("Unable to load resource: %1", fileName).c_str());
+    return resource;
 }
 
 std::shared_ptr<Resource> ResourceStore::LoadFromURI(const char* resourceURI)
@@ -60,7 +101,195 @@ std::shared_ptr<Resource> ResourceStore::LoadFromURI(const char* resourceURI)
 
 void ResourceStore::StoreResource(const char* fileName, std::shared_ptr<Resource> resource)
 {
-    resources_[fileName] = resource;
+    std::lock_guard<std::mutex> lock(lock_);
+    const StringHash key(fileName);
+    resources_[key] = resource;
+
+    // Not from the file, must not be mistaken for it
+    auto retained = retained_.find(key);
+    if (retained != retained_.end())
+        Release(retained);
+}
+
+void ResourceStore::Prefetch(const std::vector<ResourceHandle>& handles)
+{
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (stopping_)
+            return;
+        for (const ResourceHandle& handle : handles)
+        {
+            if (!handle.Name.empty())
+                prefetch_.push_back(std::make_pair(handle.Name, handle.Type));
+        }
+        if (prefetch_.empty())
+            return;
+        const unsigned hardwareCt = std::thread::hardware_concurrency();
+        const unsigned threadCt = SprueMax(1u, SprueMin(PrefetchThreads, hardwareCt));
+        while (prefetchThreads_.size() < threadCt)
+            prefetchThreads_.push_back(std::thread(&ResourceStore::PrefetchLoop, this));
+    }
+    prefetchQueued_.notify_all();
+}
+
+void ResourceStore::LoadDeferred(const SerializationContext& context)
+{
+    std::vector<ResourceHandle> handles;
+    for (const SerializationContext::DeferredResource& deferred : context.deferredResources_)
+        handles.push_back(ResourceHandle(deferred.type_, deferred.name_));
+    Prefetch(handles);
+
+    // Either loaded by now, loading and waited for, or not yet started and loaded here
+    for (const SerializationContext::DeferredResource& deferred : context.deferredResources_)
+        deferred.property_->Set(deferred.object_, ResourceHandle(deferred.type_, deferred.name_));
+    context.deferredResources_.clear();
+}
+
+void ResourceStore::PrefetchLoop()
+{
+    for (;;)
+    {
+        std::pair<std::string, StringHash> next;
+        {
+            std::unique_lock<std::mutex> lock(lock_);
+            prefetchQueued_.wait(lock, [this] { return stopping_ || !prefetch_.empty(); });
+            if (stopping_)
+                return;
+            next = prefetch_.front();
+            prefetch_.pop_front();
+        }
+        GetOrLoadResource(next.first.c_str(), next.second);
+    }
+}
+
+void ResourceStore::SetMemoryBudget(unsigned long long bytes)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    memoryBudget_ = bytes;
+    while (memoryUsed_ > memoryBudget_ && !uses_.empty())
+        Release(retained_.find(uses_.back()));
+}
+
+void ResourceStore::ReleaseRetained()
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    retained_.clear();
+    uses_.clear();
+    memoryUsed_ = 0;
+}
+
+void ResourceStore::SetDecodedImageCache(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    decodedCache_ = directory;
+    while (!decodedCache_.empty() && (decodedCache_.back() == '/' || decodedCache_.back() == '\\'))
+        decodedCache_.pop_back();
+}
+
+std::string ResourceStore::GetDecodedImageCache() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    return decodedCache_;
+}
+
+std::shared_ptr<Resource> ResourceStore::Find(const char* fileName, const StringHash& key)
+{
+    auto found = resources_.find(key);
+    if (found == resources_.end())
+        return 0x0;
+    std::shared_ptr<Resource> ret = found->second.lock();
+    if (!ret)
+        return 0x0;
+
+    auto retained = retained_.find(key);
+    if (retained != retained_.end())
+    {
+        // Held only here and by ret, nothing is using it so it may as well be current
+        if (ret.use_count() == 2 && GetFileStamp(fileName) != retained->second.stamp_)
+        {
+            Release(retained);
+            resources_.erase(found);
+            return 0x0;
+        }
+        uses_.splice(uses_.begin(), uses_, retained->second.use_);
+    }
+    return ret;
+}
+
+void ResourceStore::Retain(const StringHash& key, const std::shared_ptr<Resource>& resource, uint64_t stamp)
+{
+    auto found = retained_.find(key);
+    if (found != retained_.end())
+        Release(found);
+
+    uses_.push_front(key);
+    const unsigned long long size = resource->GetMemorySize();
+    retained_[key] = Retained { resource, uses_.begin(), size, stamp };
+    memoryUsed_ += size;
+
+    // The newest is kept even if it alone exceeds the budget, it is about to be used
+    while (memoryUsed_ > memoryBudget_ && uses_.size() > 1)
+        Release(retained_.find(uses_.back()));
+}
+
+void ResourceStore::Release(std::map<StringHash, Retained>::iterator retained)
+{
+    memoryUsed_ -= retained->second.size_;
+    uses_.erase(retained->second.use_);
+    retained_.erase(retained);
+}
+
+std::shared_ptr<Resource> ResourceStore::Load(ResourceLoader* loader, const char* fileName, uint64_t stamp)
+{
+    // Large images are kept decoded as uncompressed .texr, read back in a single block instead of decoded and converted per pixel
+    std::string cachePath;
+    if (stamp != 0 && dynamic_cast<BasicImageLoader*>(loader) && !EndsWith(ToLower(fileName), ".texr"))
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (!decodedCache_.empty())
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "%016llx.texr", (unsigned long long)HashBytes64(fileName, strlen(fileName), stamp));
+            cachePath = decodedCache_ + "/" + name;
+        }
+    }
+
+    if (!cachePath.empty())
+    {
+        FileBuffer file(cachePath.c_str(), true, true);
+        if (file.GetIStream()->good())
+        {
+            if (std::shared_ptr<FilterableBlockMap<RGBA> > image = BasicImageLoader::LoadRaw(&file))
+                return std::make_shared<BitmapResource>(fileName, image);
+        }
+    }
+
+    std::shared_ptr<Resource> resource = loader->LoadResource(fileName);
+    if (!cachePath.empty())
+    {
+        BitmapResource* bitmap = dynamic_cast<BitmapResource*>(resource.get());
+        if (bitmap && bitmap->GetImage() && bitmap->GetImage()->size() >= DecodedCacheMinPixels)
+        {
+            VectorBuffer buffer;
+            BasicImageLoader::SaveRaw(bitmap->GetImage(), buffer, false);
+
+            // Through a temporary file so that a reader never sees it half written
+            const std::string tempPath = cachePath + ".tmp";
+            if (FILE* file = fopen(tempPath.c_str(), "wb"))
+            {
+                bool success = fwrite(buffer.GetData(), 1, buffer.GetSize(), file) == buffer.GetSize();
+                success &= fclose(file) == 0;
+                if (success)
+                {
+                    remove(cachePath.c_str());
+                    success = rename(tempPath.c_str(), cachePath.c_str()) == 0;
+                }
+                if (!success)
+                    remove(tempPath.c_str());
+            }
+        }
+    }
+    return resource;
 }
 
-}
\ No newline at end of file
+}
@@ -3,24 +3,44 @@
 #include <SprueEngine/IContextService.h>
 #include <SprueEngine/StringHash.h>
 
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace SprueEngine
 {
 
 class Context;
 class Resource;
+class ResourceLoader;
+struct ResourceHandle;
+struct SerializationContext;
 
 /*
 Path resources as URIs?
     Image://MyFileFolder/MyFilePath.jpg
     Mesh://MyFileFolder/MyFilePath.obj?param=Value&param2=Value2
 */
-/// Container for resources
+/// Container for resources.
+/// Resources stay loaded while anything uses them, and the most recently used are retained beyond that up to a memory budget
+/// so that releasing the last graph clone does not mean decoding the file again for the next one.
+/// A retained resource nothing else uses is reloaded if its file changed on disk. Safe to use from any thread.
 class SPRUE ResourceStore : public IContextService
 {
 public:
+    /// Images of at least this many pixels are written to the decoded image cache.
+    static const unsigned DecodedCacheMinPixels = 1024 * 1024;
+    /// Number of threads loading prefetched resources.
+    static const unsigned PrefetchThreads = 4;
+
     ResourceStore(Context* context);
     ~ResourceStore();
 
@@ -28,13 +48,7 @@ public:
     template<class T>
     std::shared_ptr<T> GetResource(const char* fileName)
     {
-        auto found = resources_.find(fileName);
-        if (found != resources_.end())
-        {
-            if (std::shared_ptr<T> ret = std::dynamic_pointer_cast<T>(found->second.lock()))
-                return ret;
-        }
-        return 0x0;
+        return std::dynamic_pointer_cast<T>(GetResource(fileName));
     }
 
     template<class T>
@@ -49,15 +63,68 @@ public:
         return std::dynamic_pointer_cast<T>(LoadFromURI(uri));
     }
 
+    std::shared_ptr<Resource> GetResource(const char* fileName);
+
+    /// Returns the loaded resource or loads it, waiting for it instead if another thread is already loading it.
     std::shared_ptr<Resource> GetOrLoadResource(const char* fileName, const StringHash& resourceType);
-    
+
     /// Load a resource via a URI. Protocol indicates the resource type.
     std::shared_ptr<Resource> LoadFromURI(const char* uri);
 
     void StoreResource(const char* fileName, std::shared_ptr<Resource> resource);
 
+    /// Starts loading the resources in the background, GetOrLoadResource will then find them loaded or wait for the load in progress.
+    void Prefetch(const std::vector<ResourceHandle>& handles);
+    /// Loads the resources gathered by deserializing with deferResources_ set, all at once, and hands them to their objects.
+    void LoadDeferred(const SerializationContext& context);
+
+    /// Bytes of resources retained while not in use.
+    void SetMemoryBudget(unsigned long long bytes);
+    unsigned long long GetMemoryBudget() const { return memoryBudget_; }
+    unsigned long long GetMemoryUsed() const { return memoryUsed_; }
+    /// Releases every retained resource, those still in use stay loaded.
+    void ReleaseRetained();
+
+    /// Folder that large decoded images are kept in as .texr, which must exist. Empty disables the decoded image cache.
+    void SetDecodedImageCache(const std::string& directory);
+    std::string GetDecodedImageCache() const;
+
 private:
+    struct Retained
+    {
+        std::shared_ptr<Resource> resource_;
+        std::list<StringHash>::iterator use_;
+        unsigned long long size_;
+        /// GetFileStamp of the file when it was loaded.
+        uint64_t stamp_;
+    };
+
+    /// Returns the loaded resource, or null if it is not loaded or was reloaded from a changed file. The lock must be held.
+    std::shared_ptr<Resource> Find(const char* fileName, const StringHash& key);
+    /// Holds on to the resource and releases the least recently used beyond the budget. The lock must be held.
+    void Retain(const StringHash& key, const std::shared_ptr<Resource>& resource, uint64_t stamp);
+    void Release(std::map<StringHash, Retained>::iterator retained);
+    /// Loads through the loader, or through the decoded image cache for images.
+    std::shared_ptr<Resource> Load(ResourceLoader* loader, const char* fileName, uint64_t stamp);
+    void PrefetchLoop();
+
+    mutable std::mutex lock_;
+    /// Signalled whenever a load finishes.
+    std::condition_variable loaded_;
     std::map<StringHash, std::weak_ptr<Resource> > resources_;
+    std::map<StringHash, Retained> retained_;
+    /// Retained keys from most to least recently used.
+    std::list<StringHash> uses_;
+    /// Keys of resources some thread is loading.
+    std::set<StringHash> loading_;
+    unsigned long long memoryBudget_ = 512 * 1024 * 1024;
+    unsigned long long memoryUsed_ = 0;
+    std::string decodedCache_;
+
+    std::deque<std::pair<std::string, StringHash> > prefetch_;
+    std::condition_variable prefetchQueued_;
+    std::vector<std::thread> prefetchThreads_;
+    bool stopping_ = false;
 };
 
-}
\ No newline at end of file
+}
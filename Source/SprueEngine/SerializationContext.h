@@ -1,5 +1,7 @@
 #pragma once
 
+#include <SprueEngine/StringHash.h>
+
 #include <string>
 #include <vector>
 
@@ -16,9 +18,20 @@ namespace SprueEngine
             TypeProperty* property_;
             std::string path_;
         };
+        /// Resource property read while deferResources_ is set, loaded later by ResourceStore::LoadDeferred.
+        struct DeferredResource
+        {
+            void* object_;
+            TypeProperty* property_;
+            StringHash type_;
+            std::string name_;
+        };
         std::string relativePath_;
         bool isClone_ = false;
+        /// Resource properties only read their handles, so that the resources of a whole graph can be loaded together.
+        bool deferResources_ = false;
         mutable std::vector< PathError > pathErrors_;
+        mutable std::vector< DeferredResource > deferredResources_;
     };
 
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 #include "BakerNodes.h"
 
 #include <SprueEngine/Core/Context.h>
+#include <SprueEngine/GeneralUtility.h>
+#include <SprueEngine/Graph/Graph.h>
+#include <SprueEngine/Graph/GraphOptimizer.h>
+#include <SprueEngine/Graph/GraphProfiler.h>
+#include <SprueEngine/Texturing/BakeCache.h>
 #include <SprueEngine/Texturing/TextureBakers.h>
 
 namespace SprueEngine
@@ -14,6 +19,36 @@ namespace SprueEngine
         REGISTER_PROPERTY_MEMORY(TextureBakerNode, unsigned, offsetof(TextureBakerNode, Height), 256, "Height", "Height of the generated image", PS_Default);
     }
 
+    bool TextureBakerNode::GetBakeKey(uint64_t& key)
+    {
+        // The mesh counts by its contents rather than by its path
+        uint64_t properties = 0;
+        if (!meshData || !GraphOptimizer::HashNodeProperties(this, properties, false))
+            return false;
+        key = BakeCache::MakeKey(BakeCache::GetInstance()->HashMesh(meshResourceHandle.Name, meshData), GetTypeName(), Width, Height, properties);
+        return true;
+    }
+
+    bool TextureBakerNode::LoadCache()
+    {
+        keyed_ = GetBakeKey(bakeKey_);
+        if (!keyed_)
+            return false;
+
+        std::shared_ptr<FilterableBlockMap<RGBA> > cached = BakeCache::GetInstance()->Get(bakeKey_, Width, Height);
+        if (!cached)
+            return false;
+        Cache = cached;
+        GraphProfiler::NoteCacheHit(this);
+        return true;
+    }
+
+    void TextureBakerNode::StoreCache()
+    {
+        if (keyed_ && Cache)
+            BakeCache::GetInstance()->Store(bakeKey_, Cache);
+    }
+
     void AmbientOcclusionBakerNode::Register(Context* context)
     {
         context->CopyBaseProperties("TextureBakerNode", "AmbientOcclusionBakerNode");
@@ -28,9 +63,12 @@ namespace SprueEngine
 
     int AmbientOcclusionBakerNode::Execute(const Variant& param)
     {
-        if (!Cache && meshData)
+        if (Cache)
+            GraphProfiler::NoteCacheHit(this);
+        else if (meshData && !LoadCache())
         {
             Cache.reset(new FilterableBlockMap<RGBA>(Width, Height));
+            GraphProfiler::NoteAllocation(this, sizeof(RGBA) * Width * Height);
 
             nv::HalfEdge::Mesh* mesh = meshData->GetMesh(0)->BuildHalfEdgeMesh();
             AmbientOcclusionBaker baker(mesh, meshData->GetMesh(0));
@@ -44,6 +82,7 @@ namespace SprueEngine
             
             delete data;
             delete mesh;
+            StoreCache();
         }
 
         if (Cache)
@@ -68,9 +107,12 @@ namespace SprueEngine
 
     int CurvatureBakerNode::Execute(const Variant& param)
     {
-        if (!Cache && meshData)
+        if (Cache)
+            GraphProfiler::NoteCacheHit(this);
+        else if (meshData && !LoadCache())
         {
             Cache.reset(new FilterableBlockMap<RGBA>(Width, Height));
+            GraphProfiler::NoteAllocation(this, sizeof(RGBA) * Width * Height);
 
             nv::HalfEdge::Mesh* mesh = meshData->GetMesh(0)->BuildHalfEdgeMesh();
             CurvatureBaker baker(mesh, meshData->GetMesh(0));
@@ -80,6 +122,7 @@ namespace SprueEngine
             memcpy(Cache->getData(), data->getData(), sizeof(RGBA) * Cache->getWidth() * Cache->getHeight());
             delete mesh;
             delete data;
+            StoreCache();
         }
 
         if (Cache)
@@ -105,9 +148,12 @@ namespace SprueEngine
 
     int ObjectSpacePositionBakerNode::Execute(const Variant& param)
     {
-        if (!Cache && meshData)
+        if (Cache)
+            GraphProfiler::NoteCacheHit(this);
+        else if (meshData && !LoadCache())
         {
             Cache.reset(new FilterableBlockMap<RGBA>(Width, Height));
+            GraphProfiler::NoteAllocation(this, sizeof(RGBA) * Width * Height);
 
             ObjectSpacePositionBaker baker(0x0, meshData->GetMesh(0));
             baker.SetHeight(Height);
@@ -115,6 +161,7 @@ namespace SprueEngine
             FilterableBlockMap<RGBA>* data = baker.Bake();
             memcpy(Cache->getData(), data->getData(), sizeof(RGBA) * Cache->getWidth() * Cache->getHeight());
             delete data;
+            StoreCache();
         }
 
         if (Cache)
@@ -137,9 +184,12 @@ namespace SprueEngine
 
     int ObjectSpaceNormalBakerNode::Execute(const Variant& param)
     {
-        if (!Cache && meshData)
+        if (Cache)
+            GraphProfiler::NoteCacheHit(this);
+        else if (meshData && !LoadCache())
         {
             Cache.reset(new FilterableBlockMap<RGBA>(Width, Height));
+            GraphProfiler::NoteAllocation(this, sizeof(RGBA) * Width * Height);
 
             ObjectSpaceNormalBaker baker(0x0, meshData->GetMesh(0));
             baker.SetHeight(Height);
@@ -148,6 +198,7 @@ namespace SprueEngine
             memcpy(Cache->getData(), data->getData(), sizeof(RGBA) * Cache->getWidth() * Cache->getHeight());
             
             delete data;
+            StoreCache();
         }
 
         if (Cache)
@@ -170,9 +221,12 @@ namespace SprueEngine
 
     int ObjectSpaceGradientBakerNode::Execute(const Variant& param)
     {
-        if (!Cache && meshData)
+        if (Cache)
+            GraphProfiler::NoteCacheHit(this);
+        else if (meshData && !LoadCache())
         {
             Cache.reset(new FilterableBlockMap<RGBA>(Width, Height));
+            GraphProfiler::NoteAllocation(this, sizeof(RGBA) * Width * Height);
 
             ObjectSpaceGradientBaker baker(0x0, meshData->GetMesh(0));
             baker.SetHeight(Height);
@@ -180,6 +234,7 @@ namespace SprueEngine
             FilterableBlockMap<RGBA>* data = baker.Bake();
             memcpy(Cache->getData(), data->getData(), sizeof(RGBA) * Cache->getWidth() * Cache->getHeight());
             delete data;
+            StoreCache();
         }
 
         if (Cache)
@@ -202,9 +257,12 @@ namespace SprueEngine
 
     int VertexColorBakerNode::Execute(const Variant& param)
     {
-        if (!Cache && meshData)
+        if (Cache)
+            GraphProfiler::NoteCacheHit(this);
+        else if (meshData && !LoadCache())
         {
             Cache.reset(new FilterableBlockMap<RGBA>(Width, Height));
+            GraphProfiler::NoteAllocation(this, sizeof(RGBA) * Width * Height);
 
             VertexColorBaker baker(0x0, meshData->GetMesh(0));
             baker.SetHeight(Height);
@@ -212,6 +270,7 @@ namespace SprueEngine
             FilterableBlockMap<RGBA>* data = baker.Bake();
             memcpy(Cache->getData(), data->getData(), sizeof(RGBA) * Cache->getWidth() * Cache->getHeight());
             delete data;
+            StoreCache();
         }
 
         if (Cache)
@@ -237,9 +296,12 @@ namespace SprueEngine
 
     int FacetBakerNode::Execute(const Variant& param)
     {
-        if (!Cache && meshData)
+        if (Cache)
+            GraphProfiler::NoteCacheHit(this);
+        else if (meshData && !LoadCache())
         {
             Cache.reset(new FilterableBlockMap<RGBA>(Width, Height));
+            GraphProfiler::NoteAllocation(this, sizeof(RGBA) * Width * Height);
 
             FacetBaker baker(meshData->GetMesh(0));
             baker.SetHeight(Height);
@@ -250,6 +312,7 @@ namespace SprueEngine
             FilterableBlockMap<RGBA>* data = baker.Bake();
             memcpy(Cache->getData(), data->getData(), sizeof(RGBA) * Cache->getWidth() * Cache->getHeight());
             delete data;
+            StoreCache();
         }
 
         if (Cache)
@@ -272,9 +335,10 @@ namespace SprueEngine
 
     int DominantPlaneBakerNode::Execute(const Variant& param)
     {
-        if (meshData && (!Cache || (Cache->getWidth() != Width || Cache->getHeight() != Height)))
+        if (meshData && (!Cache || (Cache->getWidth() != Width || Cache->getHeight() != Height)) && !LoadCache())
         {
             Cache.reset(new FilterableBlockMap<RGBA>(Width, Height));
+            GraphProfiler::NoteAllocation(this, sizeof(RGBA) * Width * Height);
 
             DominantPlaneBaker baker(meshData->GetMesh(0));
             baker.SetHeight(Height);
@@ -282,6 +346,7 @@ namespace SprueEngine
             FilterableBlockMap<RGBA>* data = baker.Bake();
             memcpy(Cache->getData(), data->getData(), sizeof(RGBA) * Cache->getWidth() * Cache->getHeight());
             delete data;
+            StoreCache();
         }
 
         if (Cache)
@@ -311,11 +376,34 @@ namespace SprueEngine
             InsertInput(0, "RGB", TEXGRAPH_CHANNEL);
     }
 
+    bool TriplanarBakerNode::GetBakeKey(uint64_t& key)
+    {
+        if (!TextureBakerNode::GetBakeKey(key))
+            return false;
+
+        // What is projected is part of the bake, a bitmap by its pixels and anything else by the subgraph producing it
+        if (imageData_ && imageData_->GetImage())
+        {
+            const FilterableBlockMap<RGBA>* image = imageData_->GetImage();
+            key = HashBytes64(image->getData(), sizeof(RGBA) * image->size(), key);
+            return true;
+        }
+
+        auto edge = graph->GetUpstreamEdges().find(inputSockets[0]);
+        uint64_t upstream = 0;
+        if (edge == graph->GetUpstreamEdges().end() || !GraphOptimizer::HashSubgraph(graph, edge->second, upstream))
+            return false;
+        key = HashBytes64(&upstream, sizeof(upstream), key);
+        return true;
+    }
+
     int TriplanarBakerNode::Execute(const Variant& param)
     {
-        if (meshData && imageData_ && (!Cache || (Cache->getWidth() != Width || Cache->getHeight() != Height)))
+        const bool resized = !Cache || Cache->getWidth() != Width || Cache->getHeight() != Height;
+        if (meshData && imageData_ && resized && !LoadCache())
         {
             Cache.reset(new FilterableBlockMap<RGBA>(Width, Height));
+            GraphProfiler::NoteAllocation(this, sizeof(RGBA) * Width * Height);
             TriPlanarProjectionBaker baker(0x0, meshData->GetMesh(0));
             baker.SetHeight(Height);
             baker.SetWidth(Width);
@@ -327,8 +415,9 @@ namespace SprueEngine
             FilterableBlockMap<RGBA>* data = baker.Bake();
             memcpy(Cache->getData(), data->getData(), sizeof(RGBA) * Cache->getWidth() * Cache->getHeight());
             delete data;
+            StoreCache();
         }
-        else if (meshData && GetInputSocket(0)->HasConnections() && !imageData_ && (!Cache || Cache->getWidth() != Width || Cache->getHeight() != Height))
+        else if (meshData && GetInputSocket(0)->HasConnections() && !imageData_ && resized && !LoadCache())
         {
             std::unique_ptr<FilterableBlockMap<RGBA>> map(new FilterableBlockMap<RGBA>(Width, Height));
             Vec4 pos(0, 0, Width, Height);
@@ -344,6 +433,7 @@ namespace SprueEngine
             }
 
             Cache.reset(new FilterableBlockMap<RGBA>(Width, Height));
+            GraphProfiler::NoteAllocation(this, sizeof(RGBA) * Width * Height);
             TriPlanarProjectionBaker baker(0x0, meshData->GetMesh(0));
             baker.SetHeight(Height);
             baker.SetWidth(Width);
@@ -355,6 +445,7 @@ namespace SprueEngine
             FilterableBlockMap<RGBA>* data = baker.Bake();
             memcpy(Cache->getData(), data->getData(), sizeof(RGBA) * Cache->getWidth() * Cache->getHeight());
             delete data;
+            StoreCache();
         }
 
         if (Cache)
@@ -9,11 +9,16 @@ namespace SprueEngine
 
     };
 
+    /// Bakes are kept in BakeCache, so that clones, reopened documents and later sessions find them instead of baking again.
     class SPRUE TextureBakerNode : public SelfPreviewableNode
     {
     public:
         static void Register(Context*);
 
+        /// Key of the bake in BakeCache from the mesh file, type, resolution and properties. Returns false if the bake cannot be keyed.
+        /// OVERRIDE to add anything else the bake depends on.
+        virtual bool GetBakeKey(uint64_t& key);
+
         std::shared_ptr<FilterableBlockMap<RGBA> > Cache;
 
         ResourceHandle meshResourceHandle;
@@ -27,6 +32,16 @@ namespace SprueEngine
 
         unsigned Width = 256;
         unsigned Height = 256;
+
+    protected:
+        /// Takes the bake from BakeCache into Cache, returns true if it was found.
+        bool LoadCache();
+        /// Hands a fresh bake in Cache to BakeCache, under the key LoadCache looked for.
+        void StoreCache();
+
+    private:
+        uint64_t bakeKey_ = 0;
+        bool keyed_ = false;
     };
 
 
@@ -111,6 +126,8 @@ namespace SprueEngine
 
         float scale_ = 1.0f;
 
+        virtual bool GetBakeKey(uint64_t& key) override;
+
         virtual unsigned GetClassVersion() const override { return 2; }
         virtual void VersionUpdate(unsigned fromVersion) override;
     };
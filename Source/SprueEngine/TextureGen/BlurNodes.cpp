@@ -51,6 +51,21 @@ int BlurModifier::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+float BlurModifier::EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const
+{
+    const float input = inputFrequencies.empty() ? 0.0f : inputFrequencies[0];
+    const float maxResolution = resolution.MaxElement();
+    if (BlurRadius < 2 || maxResolution <= 0.0f)
+        return input;
+
+    // Gaussian of Sigma kernel cells, the kernel's extent bounds it when Sigma is wider than the kernel
+    const float sigma = SprueMin(Sigma, BlurRadius * 0.25f) * fabsf(BlurStepSize) / maxResolution;
+    if (sigma <= 0.0f)
+        return input;
+    // Beyond this the Gaussian's response has fallen below 1%
+    return SprueMin(input, 0.483f / sigma);
+}
+
 #define EULERS_NUMBER 2.71828182846f
 
 void BlurModifier::CalculateKernel(std::vector<float>& target)
@@ -15,6 +15,7 @@ namespace SprueEngine
         float Sigma = 1.5f;
 
         virtual bool WillForceExecute() const override { return true; }
+        virtual float EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const override;
         void CalculateKernel(std::vector<float>& target);
     };
 
@@ -33,6 +34,9 @@ namespace SprueEngine
     {
     public:
         IMPL_TEXTURE_NODE(AnisotropicBlur);
+
+        /// Edges keep their sharpness, nothing is removed that the input holds.
+        virtual float EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const override { return inputFrequencies.empty() ? 0.0f : inputFrequencies[0]; }
     };
 
 }
\ No newline at end of file
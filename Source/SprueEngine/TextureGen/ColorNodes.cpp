@@ -3,6 +3,9 @@
 #include "../Core/Context.h"
 #include <SprueEngine/StringConversion.h>
 
+#include <cstdint>
+#include <unordered_map>
+
 namespace SprueEngine
 {
 
@@ -71,21 +74,53 @@ void IDMapGenerator::Construct()
 {
 }
 
+/// ID maps are painted with 8 bit colors, telling colors apart at 8 bits per channel lets them be hashed.
+static uint32_t IDMapColorKey(const RGBA& color)
+{
+    auto quantize = [](float value) { return (uint32_t)(SprueMax(0.0f, SprueMin(1.0f, value)) * 255.0f + 0.5f); };
+    return quantize(color.r) | (quantize(color.g) << 8) | (quantize(color.b) << 16) | (quantize(color.a) << 24);
+}
+
 void IDMapGenerator::SetImageData(const std::shared_ptr<BitmapResource>& img) { 
     ImageData = img; 
-    if (ImageData)
+    colors.clear();
+    labels.clear();
+    if (ImageData && ImageData->GetImage())
     {
-        std::vector<RGBA> colors;
-        for (unsigned y = 0; y < ImageData->GetImage()->getHeight(); ++y)
+        // A single pass labels every pixel with the ID of its color, masks are then a comparison of integers
+        const FilterableBlockMap<RGBA>* image = ImageData->GetImage();
+        const unsigned width = image->getWidth();
+        const unsigned height = image->getHeight();
+        std::unordered_map<uint32_t, uint16_t> colorIDs;
+        labels.resize(width * height);
+        uint32_t lastKey = 0;
+        uint16_t lastID = NoID;
+        bool started = false;
+        for (unsigned y = 0; y < height; ++y)
         {
-            for (unsigned x = 0; x < ImageData->GetImage()->getWidth(); ++x)
+            const RGBA* row = image->getData() + (image->IsFlippedIndexing() ? height - y - 1 : y) * width;
+            for (unsigned x = 0; x < width; ++x)
             {
-                RGBA col = ImageData->GetImage()->get(x, y);
-                if (std::find(colors.begin(), colors.end(), col) == colors.end())
-                    colors.push_back(col);
+                // Neighbouring pixels are mostly the same ID
+                const uint32_t key = IDMapColorKey(row[x]);
+                if (key != lastKey || !started)
+                {
+                    auto found = colorIDs.find(key);
+                    if (found == colorIDs.end())
+                    {
+                        // Past the limit colors are remembered as having no ID, an ID map never has that many regions
+                        const bool hasID = colors.size() < MaxIDs;
+                        found = colorIDs.insert(std::make_pair(key, hasID ? (uint16_t)colors.size() : NoID)).first;
+                        if (hasID)
+                            colors.push_back(row[x]);
+                    }
+                    lastKey = key;
+                    lastID = found->second;
+                    started = true;
+                }
+                labels[y * width + x] = lastID;
             }
         }
-        this->colors = colors;
 
         if (!inSerialization)
         {
@@ -105,7 +140,7 @@ void IDMapGenerator::SetImageData(const std::shared_ptr<BitmapResource>& img) {
                 else
                 {
                     // sockets removed
-                    outputSockets.erase(outputSockets.begin() + (outputSockets.size() - difference), outputSockets.end());
+                    outputSockets.erase(outputSockets.begin() + colors.size(), outputSockets.end());
                     NotifySocketsChange();
                 }
             }
@@ -115,14 +150,20 @@ void IDMapGenerator::SetImageData(const std::shared_ptr<BitmapResource>& img) {
 
 int IDMapGenerator::Execute(const Variant& param)
 {
+    static const Variant White(RGBA::White);
+    static const Variant Black(RGBA::Black);
+
     auto vec = param.getVec4Safe();
-    if (ImageData && ImageData->GetImage())
+    if (ImageData && ImageData->GetImage() && !labels.empty())
     {
-        const int ix = vec.x * ImageData->GetImage()->getWidth();
-        const int iy = vec.y * ImageData->GetImage()->getHeight();
+        const int width = ImageData->GetImage()->getWidth();
+        const int height = ImageData->GetImage()->getHeight();
+        const int ix = CLAMP((int)(vec.x * width), 0, width - 1);
+        const int iy = CLAMP((int)(vec.y * height), 0, height - 1);
 
+        const uint16_t label = labels[iy * width + ix];
         for (unsigned i = 0; i < outputSockets.size() && i < colors.size(); ++i)
-            outputSockets[i]->StoreValue(colors[i] == ImageData->GetImage()->get(ix, iy) ? RGBA::White : RGBA::Black);
+            outputSockets[i]->StoreValue(i == label ? White : Black);
     }
 
     return GRAPH_EXECUTE_COMPLETE;
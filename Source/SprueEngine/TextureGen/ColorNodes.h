@@ -2,6 +2,8 @@
 
 #include <SprueEngine/TextureGen/TextureNode.h>
 
+#include <cstdint>
+
 namespace SprueEngine
 {
     
@@ -9,6 +11,7 @@ namespace SprueEngine
     {
     public:
         IMPL_TEXTURE_NODE(ReplaceColorModifier);
+        virtual bool IsPointwise() const override { return true; }
 
         RGBA Replace;
         RGBA With;
@@ -19,6 +22,7 @@ namespace SprueEngine
     {
     public:
         IMPL_TEXTURE_NODE(SelectColorModifier);
+        virtual bool IsPointwise() const override { return true; }
 
         RGBA Select = RGBA::Black;
         float Tolerance = 0.1f;
@@ -40,8 +44,13 @@ namespace SprueEngine
 
         virtual bool Deserialize(Deserializer* src, const SerializationContext& context) override;
 
-        // Temporary cache
+        /// Unique colors of the image in the order they are first found, the index of a color is its ID and output socket.
         std::vector<RGBA> colors;
+        /// ID of the color of every pixel of the image, row by row, rebuilt along with colors whenever the image changes.
+        /// Two bytes a pixel, a 4096 square map holds 32MB of them. Colors found after the first MaxIDs are labeled NoID and output nothing.
+        std::vector<uint16_t> labels;
+        static const unsigned MaxIDs = 0xFFFF;
+        static const uint16_t NoID = 0xFFFF;
         bool inSerialization = false;
 
         virtual std::shared_ptr<FilterableBlockMap<RGBA>> GetPreview(unsigned width = TEXGRAPH_PREVIEW_SIZE, unsigned height = TEXGRAPH_PREVIEW_SIZE) override;
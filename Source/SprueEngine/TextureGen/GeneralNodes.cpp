@@ -1,6 +1,7 @@
 #include <SprueEngine/TextureGen/GeneralNodes.h>
 
 #include <SprueEngine/Core/Context.h>
+#include <SprueEngine/TextureGen/TextureProgram.h>
 
 namespace SprueEngine
 {
@@ -25,6 +26,13 @@ int ColorNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool ColorNode::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Const(code.Out(0), Value);
+    return true;
+}
+
 std::shared_ptr<FilterableBlockMap<RGBA> > ColorNode::GetPreview(unsigned, unsigned)
 {
     std::shared_ptr<FilterableBlockMap<RGBA> > ret = std::shared_ptr<FilterableBlockMap<RGBA> >(new FilterableBlockMap<RGBA>(64, 32));
@@ -49,6 +57,13 @@ int FloatNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool FloatNode::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Const(code.Out(0), RGBA(Value, Value, Value));
+    return true;
+}
+
 std::shared_ptr<FilterableBlockMap<RGBA> > FloatNode::GetPreview(unsigned, unsigned)
 {
     std::shared_ptr<FilterableBlockMap<RGBA> > ret = std::shared_ptr<FilterableBlockMap<RGBA> >(new FilterableBlockMap<RGBA>(64, 32));
@@ -57,7 +72,7 @@ std::shared_ptr<FilterableBlockMap<RGBA> > FloatNode::GetPreview(unsigned, unsig
     return ret;
 }
 
-#define MATH_FUNC_NODE(TYPENAME, FUNCNAME) void TYPENAME::Register(Context* context) { \
+#define MATH_FUNC_NODE(TYPENAME, FUNCNAME, OPCODE) void TYPENAME::Register(Context* context) { \
    context->CopyBaseProperties("GraphNode", #TYPENAME); \
 } \
 void TYPENAME::Construct() \
@@ -72,13 +87,17 @@ int TYPENAME::Execute(const Variant& param) { \
     col.b = FUNCNAME(col.b);\
     col.a = FUNCNAME(col.a);\
     GetOutputSocket(0)->StoreValue(col); \
-    return GRAPH_EXECUTE_COMPLETE; }
-
-MATH_FUNC_NODE(CosNode, cosf);
-MATH_FUNC_NODE(SinNode, sinf);
-MATH_FUNC_NODE(SqrtNode, sqrtf);
-MATH_FUNC_NODE(ExpNode, expf);
-MATH_FUNC_NODE(TanNode, tanf);
+    return GRAPH_EXECUTE_COMPLETE; } \
+bool TYPENAME::Compile(VectorBuffer* buffer) const { \
+    TextureCodeWriter code(this, buffer); \
+    code.Op(OPCODE, code.Out(0), code.In(0)); \
+    return true; }
+
+MATH_FUNC_NODE(CosNode, cosf, TOP_Cos);
+MATH_FUNC_NODE(SinNode, sinf, TOP_Sin);
+MATH_FUNC_NODE(SqrtNode, sqrtf, TOP_Sqrt);
+MATH_FUNC_NODE(ExpNode, expf, TOP_Exp);
+MATH_FUNC_NODE(TanNode, tanf, TOP_Tan);
 
 GENERIC_REGISTER(PowNode);
 
@@ -104,6 +123,13 @@ int PowNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool PowNode::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Op(TOP_Pow, code.Out(0), code.In(0), code.In(1));
+    return true;
+}
+
 GENERIC_REGISTER(AverageNode);
 
 void AverageNode::Construct()
@@ -119,6 +145,13 @@ int AverageNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool AverageNode::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Op(TOP_AverageRGB, code.Out(0), code.In(0));
+    return true;
+}
+
 GENERIC_REGISTER(MinNode);
 
 void MinNode::Construct()
@@ -134,6 +167,13 @@ int MinNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool MinNode::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Op(TOP_MinRGB, code.Out(0), code.In(0));
+    return true;
+}
+
 GENERIC_REGISTER(MaxNode);
 
 void MaxNode::Construct()
@@ -149,6 +189,13 @@ int MaxNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool MaxNode::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Op(TOP_MaxRGB, code.Out(0), code.In(0));
+    return true;
+}
+
 GENERIC_REGISTER(Clamp01Node);
 
 void Clamp01Node::Construct()
@@ -166,6 +213,13 @@ int Clamp01Node::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool Clamp01Node::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Op(TOP_Clamp01, code.Out(0), code.In(0));
+    return true;
+}
+
 GENERIC_REGISTER(SplitNode);
 
 void SplitNode::Construct()
@@ -191,6 +245,16 @@ int SplitNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool SplitNode::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Const(code.Temp(0), RGBA(1.0f, 1.0f, 1.0f, 1.0f));
+    code.Pack(code.Out(0), code.In(0), 0, code.In(0), 1, code.In(0), 2, code.Temp(0), 0);
+    for (unsigned i = 0; i < 4; ++i)
+        code.Splat(code.Out(i + 1), code.In(0), i);
+    return true;
+}
+
 void SplitNode::VersionUpdate(unsigned fromVersion)
 {
     if (fromVersion < 2)
@@ -230,6 +294,23 @@ int CombineNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool CombineNode::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Const(code.Temp(0), RGBA(1.0f, 1.0f, 1.0f, 1.0f));
+    const unsigned char alpha = inputSockets[4]->HasConnections() ? code.In(4) : code.Temp(0);
+    if (inputSockets[0]->HasConnections())
+    {
+        // Execute reads the RGB input without filling, a scalar there would not be splatted
+        if (!code.InputFedBy(0, TEXGRAPH_RGBA))
+            return false;
+        code.Pack(code.Out(0), code.In(0), 0, code.In(0), 2, code.In(0), 1, alpha, 0);
+    }
+    else
+        code.Pack(code.Out(0), code.In(1), 0, code.In(2), 0, code.In(3), 0, alpha, 0);
+    return true;
+}
+
 GENERIC_REGISTER(RGBToHSVNode);
 
 void RGBToHSVNode::Construct()
@@ -271,6 +352,13 @@ int RGBToHSVNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool RGBToHSVNode::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Op(TOP_RGBToHSV, code.Out(0), code.In(0));
+    return true;
+}
+
 GENERIC_REGISTER(HSVToRGBNode);
 
 void HSVToRGBNode::Construct()
@@ -336,6 +424,14 @@ int HSVToRGBNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool HSVToRGBNode::Compile(VectorBuffer* buffer) const
+{
+    // Matches Execute, which outputs its input unchanged
+    TextureCodeWriter code(this, buffer);
+    code.Op(TOP_Move, code.Out(0), code.In(0));
+    return true;
+}
+
 GENERIC_REGISTER(BrightnessRGBNode);
 
 void BrightnessRGBNode::Construct()
@@ -352,6 +448,13 @@ int BrightnessRGBNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool BrightnessRGBNode::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Op(TOP_Luminance, code.Out(0), code.In(0));
+    return true;
+}
+
 static const char* BlendModeNames[] = {
     "Normal",
     "Additive",
@@ -471,6 +574,24 @@ int BlendNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool BlendNode::Compile(VectorBuffer* buffer) const
+{
+    if (mode_ == TGB_Dissolve || mode_ == TGB_NormalMap)
+        return false;
+
+    TextureCodeWriter code(this, buffer);
+    unsigned char weight = code.In(2);
+    if (alphaMode_ == TGBA_UseWeight && !inputSockets[2]->HasConnections())
+    {
+        Variant weightVal = inputSockets[2]->GetValue();
+        const float blendWeight = weightVal.getType() != VT_None ? weightVal.getFloatSafe() : 0.5f;
+        weight = code.Temp(0);
+        code.Const(weight, RGBA(blendWeight, blendWeight, blendWeight));
+    }
+    code.Emit(TOP_Blend, code.Out(0), code.In(0), code.In(1), weight, 0, (float)mode_, (float)alphaMode_, 0.0f, 0.0f);
+    return true;
+}
+
 void BrightnessNode::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "BrightnessNode");
@@ -493,6 +614,15 @@ int BrightnessNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool BrightnessNode::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Const(code.Temp(0), RGBA(Power, Power, Power, Power));
+    code.Op(TOP_Mul, code.Out(0), code.In(0), code.Temp(0));
+    code.Op(TOP_Clamp01, code.Out(0), code.Out(0));
+    return true;
+}
+
 void ContrastNode::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "ContrastNode");
@@ -520,6 +650,18 @@ int ContrastNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool ContrastNode::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Const(code.Temp(0), RGBA(-0.5f, -0.5f, -0.5f, 0.0f));
+    code.Const(code.Temp(1), RGBA(Power, Power, Power, Power));
+    code.Const(code.Temp(2), RGBA(0.5f, 0.5f, 0.5f, 0.0f));
+    code.Op(TOP_Add, code.Temp(3), code.In(0), code.Temp(0));
+    code.Op(TOP_Mul, code.Temp(3), code.Temp(3), code.Temp(1));
+    code.Op(TOP_Add, code.Out(0), code.Temp(3), code.Temp(2));
+    return true;
+}
+
 void ToGammaNode::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "ToGammaNode");
@@ -542,6 +684,14 @@ int ToGammaNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool ToGammaNode::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Const(code.Temp(0), RGBA(1.0f / 2.2f, 1.0f / 2.2f, 1.0f / 2.2f, 1.0f));
+    code.Op(TOP_Pow, code.Out(0), code.In(0), code.Temp(0));
+    return true;
+}
+
 void FromGammaNode::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "FromGammaNode");
@@ -564,6 +714,14 @@ int FromGammaNode::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool FromGammaNode::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Const(code.Temp(0), RGBA(2.2f, 2.2f, 2.2f, 1.0f));
+    code.Op(TOP_Pow, code.Out(0), code.In(0), code.Temp(0));
+    return true;
+}
+
 void ToNormalizedRange::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "ToNormalizedRange");
@@ -589,6 +747,14 @@ int ToNormalizedRange::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool ToNormalizedRange::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.OpImm(TOP_Normalize, code.Temp(0), code.In(0), range_.getLowerBound(), range_.getUpperBound());
+    code.Op(TOP_Clamp01, code.Out(0), code.Temp(0));
+    return true;
+}
+
 void FromNormalizedRange::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "FromNormalizedRange");
@@ -614,4 +780,12 @@ int FromNormalizedRange::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool FromNormalizedRange::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.OpImm(TOP_Denormalize, code.Temp(0), code.In(0), range_.getLowerBound(), range_.getUpperBound());
+    code.Op(TOP_Clamp01, code.Out(0), code.Temp(0));
+    return true;
+}
+
 }
\ No newline at end of file
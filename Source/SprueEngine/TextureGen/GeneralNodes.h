@@ -10,6 +10,8 @@ class SPRUE ColorNode : public TextureNode
 {
 public:
     IMPL_TEXTURE_NODE(ColorNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
     RGBA Value = RGBA(1,0,0);
 
     virtual bool CanPreview() const { return true; }
@@ -21,6 +23,8 @@ class SPRUE FloatNode : public TextureNode
 {
 public:
     IMPL_TEXTURE_NODE(FloatNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
     float Value = 0.5f;
 
     virtual bool CanPreview() const { return true; }
@@ -32,6 +36,8 @@ class SPRUE CosNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(CosNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 };
 
 /// Applies sine on the inputs
@@ -39,6 +45,8 @@ class SPRUE SinNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(SinNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 };
 
 /// Applies tan on the inputs
@@ -46,6 +54,8 @@ class SPRUE TanNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(SinNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 };
 
 /// Applies expf on the inputs
@@ -53,6 +63,8 @@ class SPRUE ExpNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(ExpNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 };
 
 /// Takes 2 inputs and applies powf(A, B), to all color channels as well
@@ -60,6 +72,8 @@ class SPRUE PowNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(PowNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 };
 
 /// Takes 2 inputs and applies sqrtf(A, B), to all color channels as well
@@ -67,6 +81,8 @@ class SPRUE SqrtNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(SqrtNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 };
 
 /// Takes a Color and returns the RGB average
@@ -74,6 +90,8 @@ class SPRUE AverageNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(AverageNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 };
 
 /// Takes a Color and returns the smallest of R, G, or B
@@ -81,6 +99,8 @@ class SPRUE MinNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(MaxNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 };
 
 /// Takes a Color and returns the largest of R, G, or B
@@ -88,6 +108,8 @@ class SPRUE MaxNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(MaxNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 };
 
 
@@ -96,6 +118,8 @@ class SPRUE Clamp01Node : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(Clamp01Node);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 };
 
 /// Splits an RGBA channel into R, G, B, A floats
@@ -103,6 +127,8 @@ class SPRUE SplitNode : public TextureNode
 {
 public:
     IMPL_TEXTURE_NODE(SplitNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 
     virtual bool CanPreview() const override { return false; }
     virtual unsigned GetClassVersion() const override { return 2; }
@@ -114,6 +140,8 @@ class SPRUE CombineNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(CombineNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 
     virtual unsigned GetClassVersion() const override { return 2; }
     virtual void VersionUpdate(unsigned fromVersion) override;
@@ -124,6 +152,8 @@ class SPRUE RGBToHSVNode : public TextureNode
 {
 public:
     IMPL_TEXTURE_NODE(RGBToHSVNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 };
 
 /// Convers an HSV input (as RGB) into an RGB output
@@ -131,6 +161,8 @@ class SPRUE HSVToRGBNode : public TextureNode
 {
 public:
     IMPL_TEXTURE_NODE(RGBToHSVNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 };
 
 /// Extracts the luminance from an RGB color
@@ -138,6 +170,8 @@ class SPRUE BrightnessRGBNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(BrightnessRGBNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 };
 
 enum TexGenBlendMode
@@ -168,6 +202,8 @@ class SPRUE BlendNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(BlendNode);
+    virtual bool IsPointwise() const override { return mode_ != TGB_Dissolve; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 
     TexGenBlendMode GetBlendMode() const { return mode_; }
     void SetBlendMode(TexGenBlendMode mode) { mode_ = mode; }
@@ -181,6 +217,8 @@ class SPRUE BrightnessNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(BrightnessNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
     float Power = 1.2f;
 };
 
@@ -188,6 +226,8 @@ class SPRUE ContrastNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(ContrastNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
     float Power = 1.2f;
 };
 
@@ -195,6 +235,8 @@ class SPRUE ToGammaNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(FromGammaNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
     float Gamma = 2.2f;
 };
 
@@ -202,6 +244,8 @@ class SPRUE FromGammaNode : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(FromGammaNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
     float Gamma = 2.2f;
 };
 
@@ -209,6 +253,8 @@ class SPRUE ToNormalizedRange : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(ToNormalizedRange);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 
     RangedFloat range_;
 };
@@ -217,6 +263,8 @@ class SPRUE FromNormalizedRange : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(FromNormalizedRange);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 
     RangedFloat range_;
 };
@@ -9,6 +9,7 @@ namespace SprueEngine
     {
     public:
         IMPL_TEXTURE_NODE(PBRAlbedoEnforcerNode);
+        virtual bool IsPointwise() const override { return true; }
         bool AlertMode = false;
         bool StrictMode = false;
     };
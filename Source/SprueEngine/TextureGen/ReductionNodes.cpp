@@ -0,0 +1,217 @@
+#include "ReductionNodes.h"
+
+#include <SprueEngine/Core/Context.h>
+#include <SprueEngine/Graph/GraphOptimizer.h>
+#include <SprueEngine/Graph/GraphProfiler.h>
+
+namespace SprueEngine
+{
+
+///=================================================
+/// Reduction base
+///=================================================
+
+void ReductionNode::Reduce(unsigned width, unsigned height)
+{
+    width_ = width;
+    height_ = height;
+    // An unconnected input is a constant, refilled every pass rather than hashed
+    auto edge = graph->GetUpstreamEdges().find(inputSockets[0]);
+    hashed_ = edge != graph->GetUpstreamEdges().end() && GraphOptimizer::HashSubgraph(graph, edge->second, upstreamHash_);
+
+    input_.reset(new FilterableBlockMap<RGBA>(width, height));
+    GraphProfiler::NoteAllocation(this, sizeof(RGBA) * width * height);
+    if (GetInputSocket(0)->HasConnections())
+    {
+        for (unsigned y = 0; y < height; ++y)
+        {
+            for (unsigned x = 0; x < width; ++x)
+            {
+                ForceExecuteUpstreamOnly(Vec4(x / (float)width, y / (float)height, width, height));
+                input_->set(GetInputSocket(0)->GetValue().getColorSafe(true), x, y);
+            }
+        }
+    }
+    else
+        input_->fill(GetInputSocket(0)->GetValue().getColorSafe(true));
+
+    statistics_.Calculate(input_.get());
+}
+
+void ReductionNode::AdoptCaches(TextureNode* previous)
+{
+    ReductionNode* source = dynamic_cast<ReductionNode*>(previous);
+    if (!source || !source->input_)
+        return;
+
+    input_ = source->input_;
+    statistics_ = source->statistics_;
+    width_ = source->width_;
+    height_ = source->height_;
+    upstreamHash_ = source->upstreamHash_;
+    hashed_ = source->hashed_;
+}
+
+int ReductionNode::ExecuteReduction(const Variant& param)
+{
+    const Vec4 coord = param.getVec4Safe();
+    const unsigned width = SprueMax((unsigned)coord.z, 1u);
+    const unsigned height = SprueMax((unsigned)coord.w, 1u);
+    // Upstream edits are looked for once per render pass, whichever pixel the pass happens to start at
+    const bool newPass = graph->GetRenderPass() != checkedPass_;
+    checkedPass_ = graph->GetRenderPass();
+    if (width != width_ || height != height_ || !input_)
+        Reduce(width, height);
+    else if (newPass)
+    {
+        uint64_t hash = 0;
+        auto edge = graph->GetUpstreamEdges().find(inputSockets[0]);
+        if (!hashed_ || edge == graph->GetUpstreamEdges().end() || !GraphOptimizer::HashSubgraph(graph, edge->second, hash) || hash != upstreamHash_)
+            Reduce(width, height);
+        else
+            GraphProfiler::NoteCacheHit(this);
+    }
+
+    int x = (int)floorf(coord.x * width + 0.5f) % (int)width;
+    int y = (int)floorf(coord.y * height + 0.5f) % (int)height;
+    if (x < 0)
+        x += width;
+    if (y < 0)
+        y += height;
+
+    GetOutputSocket(0)->StoreValue(Apply(input_->get(x, y)));
+    return GRAPH_EXECUTE_COMPLETE;
+}
+
+///=================================================
+/// Normalize
+///=================================================
+
+void NormalizeModifier::Register(Context* context)
+{
+    context->CopyBaseProperties("GraphNode", "NormalizeModifier");
+    REGISTER_PROPERTY_MEMORY(NormalizeModifier, bool, offsetof(NormalizeModifier, PerChannel), true, "Per Channel", "Each color channel is stretched by its own range instead of the range of all three", PS_Default | PS_Permutable);
+    REGISTER_PROPERTY_MEMORY(NormalizeModifier, float, offsetof(NormalizeModifier, Deviations), 0.0f, "Deviations", "If greater than zero the range is this many standard deviations either side of the mean instead of the minimum and maximum", PS_SmallIncrement | PS_Permutable);
+}
+
+void NormalizeModifier::Construct()
+{
+    AddInput("In", TEXGRAPH_CHANNEL);
+    AddOutput("Out", TEXGRAPH_CHANNEL);
+}
+
+int NormalizeModifier::Execute(const Variant& param)
+{
+    return ExecuteReduction(param);
+}
+
+RGBA NormalizeModifier::Apply(const RGBA& value) const
+{
+    const ImageStatistics& stats = GetStatistics();
+    float lower[3];
+    float upper[3];
+    for (unsigned c = 0; c < 3; ++c)
+    {
+        if (Deviations > 0.0f)
+        {
+            const float spread = stats.GetStandardDeviation(c) * Deviations;
+            lower[c] = ImageStatistics::Channel(stats.Mean, c) - spread;
+            upper[c] = ImageStatistics::Channel(stats.Mean, c) + spread;
+        }
+        else
+        {
+            lower[c] = ImageStatistics::Channel(stats.Min, c);
+            upper[c] = ImageStatistics::Channel(stats.Max, c);
+        }
+    }
+    if (!PerChannel)
+    {
+        lower[0] = lower[1] = lower[2] = SprueMin(lower[0], SprueMin(lower[1], lower[2]));
+        upper[0] = upper[1] = upper[2] = SprueMax(upper[0], SprueMax(upper[1], upper[2]));
+    }
+
+    RGBA ret(Remap(value.r, lower[0], upper[0]), Remap(value.g, lower[1], upper[1]), Remap(value.b, lower[2], upper[2]), value.a);
+    ret.Clip();
+    return ret;
+}
+
+///=================================================
+/// Auto-levels
+///=================================================
+
+void AutoLevelsModifier::Register(Context* context)
+{
+    context->CopyBaseProperties("GraphNode", "AutoLevelsModifier");
+    REGISTER_PROPERTY_MEMORY(AutoLevelsModifier, bool, offsetof(AutoLevelsModifier, PerChannel), true, "Per Channel", "Each color channel is leveled by its own percentiles, which also corrects color casts", PS_Default | PS_Permutable);
+    REGISTER_PROPERTY_MEMORY(AutoLevelsModifier, float, offsetof(AutoLevelsModifier, LowClip), 0.005f, "Low Clip", "Fraction of the darkest pixels that become black", PS_NormalRange | PS_TinyIncrement | PS_Permutable);
+    REGISTER_PROPERTY_MEMORY(AutoLevelsModifier, float, offsetof(AutoLevelsModifier, HighClip), 0.005f, "High Clip", "Fraction of the brightest pixels that become white", PS_NormalRange | PS_TinyIncrement | PS_Permutable);
+}
+
+void AutoLevelsModifier::Construct()
+{
+    AddInput("In", TEXGRAPH_CHANNEL);
+    AddOutput("Out", TEXGRAPH_CHANNEL);
+}
+
+int AutoLevelsModifier::Execute(const Variant& param)
+{
+    return ExecuteReduction(param);
+}
+
+RGBA AutoLevelsModifier::Apply(const RGBA& value) const
+{
+    const ImageStatistics& stats = GetStatistics();
+    float lower[3];
+    float upper[3];
+    for (unsigned c = 0; c < 3; ++c)
+    {
+        lower[c] = stats.Percentile(c, LowClip);
+        upper[c] = stats.Percentile(c, 1.0f - HighClip);
+    }
+    if (!PerChannel)
+    {
+        lower[0] = lower[1] = lower[2] = SprueMin(lower[0], SprueMin(lower[1], lower[2]));
+        upper[0] = upper[1] = upper[2] = SprueMax(upper[0], SprueMax(upper[1], upper[2]));
+    }
+
+    RGBA ret(Remap(value.r, lower[0], upper[0]), Remap(value.g, lower[1], upper[1]), Remap(value.b, lower[2], upper[2]), value.a);
+    ret.Clip();
+    return ret;
+}
+
+///=================================================
+/// Histogram equalization
+///=================================================
+
+void HistogramEqualizeModifier::Register(Context* context)
+{
+    context->CopyBaseProperties("GraphNode", "HistogramEqualizeModifier");
+    REGISTER_PROPERTY_MEMORY(HistogramEqualizeModifier, float, offsetof(HistogramEqualizeModifier, Strength), 1.0f, "Strength", "Blends between the input (0) and the fully equalized result (1)", PS_NormalRange | PS_TinyIncrement | PS_Permutable);
+}
+
+void HistogramEqualizeModifier::Construct()
+{
+    AddInput("In", TEXGRAPH_CHANNEL);
+    AddOutput("Out", TEXGRAPH_CHANNEL);
+}
+
+int HistogramEqualizeModifier::Execute(const Variant& param)
+{
+    return ExecuteReduction(param);
+}
+
+RGBA HistogramEqualizeModifier::Apply(const RGBA& value) const
+{
+    const ImageStatistics& stats = GetStatistics();
+    RGBA ret = value;
+    float* channels = &ret.r;
+    for (unsigned c = 0; c < 3; ++c)
+    {
+        // A flat channel has nothing to redistribute
+        if (ImageStatistics::Channel(stats.Max, c) > ImageStatistics::Channel(stats.Min, c))
+            channels[c] = channels[c] + (stats.CumulativeFraction(c, channels[c]) - channels[c]) * Strength;
+    }
+    return ret;
+}
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <SprueEngine/TextureGen/TextureNode.h>
+#include <SprueEngine/Texturing/ImageStatistics.h>
+
+#include <cstdint>
+
+namespace SprueEngine
+{
+
+/// Base for nodes that need image-wide statistics of their input, which per-pixel evaluation cannot see.
+/// The first input is materialized once per evaluation resolution and reduced into ImageStatistics,
+/// after which every pixel is a pointwise Apply of the materialized value using those statistics.
+/// The input is reduced again when the upstream graph hashes differently at the first evaluation of a render pass (Graph::BeginRenderPass).
+class SPRUE ReductionNode : public PreviewableNode
+{
+public:
+    virtual bool WillForceExecute() const override { return true; }
+
+    /// Statistics of the input at the last evaluated resolution.
+    const ImageStatistics& GetStatistics() const { return statistics_; }
+    /// Takes over the reduced input of previous, it is checked against upstream at the first evaluation as it would be here.
+    virtual void AdoptCaches(TextureNode* previous) override;
+
+protected:
+    /// Reduces the input if the resolution changed and stores Apply of the pixel in the first output.
+    int ExecuteReduction(const Variant& param);
+    /// Pointwise stage, maps an input value using the statistics.
+    virtual RGBA Apply(const RGBA& value) const = 0;
+
+    /// Remaps value from [lower, upper] into [0, 1], a flat range maps to 0.
+    static float Remap(float value, float lower, float upper) { return upper > lower ? (value - lower) / (upper - lower) : 0.0f; }
+
+private:
+    void Reduce(unsigned width, unsigned height);
+
+    std::shared_ptr<FilterableBlockMap<RGBA> > input_;
+    ImageStatistics statistics_;
+    unsigned width_ = 0;
+    unsigned height_ = 0;
+    uint64_t upstreamHash_ = 0;
+    /// Graph::GetRenderPass when the input was last checked for upstream edits.
+    unsigned checkedPass_ = 0;
+    bool hashed_ = false;
+};
+
+/// Stretches the input's range to fill 0 - 1, either its full range or a number of standard deviations around its mean.
+class SPRUE NormalizeModifier : public ReductionNode
+{
+public:
+    IMPL_TEXTURE_NODE(NormalizeModifier);
+
+    bool PerChannel = true;
+    float Deviations = 0.0f;
+
+protected:
+    virtual RGBA Apply(const RGBA& value) const override;
+};
+
+/// Stretches the input so that its darkest and brightest percentiles clip, as image editors' auto-levels.
+class SPRUE AutoLevelsModifier : public ReductionNode
+{
+public:
+    IMPL_TEXTURE_NODE(AutoLevelsModifier);
+
+    bool PerChannel = true;
+    float LowClip = 0.005f;
+    float HighClip = 0.005f;
+
+protected:
+    virtual RGBA Apply(const RGBA& value) const override;
+};
+
+/// Redistributes the values of each color channel so that they are evenly spread, flattening the histogram.
+class SPRUE HistogramEqualizeModifier : public ReductionNode
+{
+public:
+    IMPL_TEXTURE_NODE(HistogramEqualizeModifier);
+
+    float Strength = 1.0f;
+
+protected:
+    virtual RGBA Apply(const RGBA& value) const override;
+};
+
+}
@@ -0,0 +1,216 @@
+#include "RemapNode.h"
+
+#include <SprueEngine/Graph/GraphOptimizer.h>
+#include <SprueEngine/Graph/GraphProfiler.h>
+#include <SprueEngine/TextureGen/TextureProgram.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace SprueEngine
+{
+
+const float RemapNode::ForcedNodeCost = 9.0f;
+const float RemapNode::CompiledNodeCost = 0.25f;
+const float RemapNode::GatherSampleCost = 2.0f;
+
+float RemapNode::EstimateUpstreamCost(unsigned index, bool& compiled) const
+{
+    compiled = false;
+    const auto& edges = graph->GetUpstreamEdges();
+    auto found = edges.find(inputSockets[index]);
+    if (found == edges.end())
+        return 0.0f;
+
+    GraphSocket* source = found->second;
+    TextureProgram program;
+    compiled = program.Build(source->node, std::find(source->node->outputSockets.begin(), source->node->outputSockets.end(), source) - source->node->outputSockets.begin()) && program.GetExternalCount() == 0;
+
+    // Shared upstream nodes are stored once per evaluation walk, so each is counted once
+    float cost = 0.0f;
+    std::unordered_set<GraphNode*> visited;
+    std::vector<GraphNode*> open(1, source->node);
+    while (!open.empty())
+    {
+        GraphNode* node = open.back();
+        open.pop_back();
+        if (!visited.insert(node).second)
+            continue;
+
+        cost += node->WillForceExecute() ? ForcedNodeCost : 1.0f;
+        for (GraphSocket* socket : node->inputSockets)
+        {
+            auto upstreamEdges = edges.equal_range(socket);
+            for (auto edge = upstreamEdges.first; edge != upstreamEdges.second; ++edge)
+                open.push_back(edge->second->node);
+        }
+    }
+    return cost;
+}
+
+float RemapNode::EstimateReevaluationCost(unsigned index) const
+{
+    bool compiled = false;
+    return EstimateUpstreamCost(index, compiled) * GetSampleRate(index);
+}
+
+float RemapNode::EstimateGatherCost(unsigned index) const
+{
+    bool compiled = false;
+    const float upstream = EstimateUpstreamCost(index, compiled);
+    return (compiled ? upstream * CompiledNodeCost : upstream) + GatherSampleCost * GetSampleRate(index);
+}
+
+bool RemapNode::HashInput(unsigned index, uint64_t& hash) const
+{
+    auto edge = graph->GetUpstreamEdges().find(inputSockets[index]);
+    return edge != graph->GetUpstreamEdges().end() && GraphOptimizer::HashSubgraph(graph, edge->second, hash);
+}
+
+void RemapNode::PrepareInputs(const Vec4& pixel)
+{
+    const unsigned width = SprueMax((unsigned)pixel.z, 1u);
+    const unsigned height = SprueMax((unsigned)pixel.w, 1u);
+    if (inputs_.size() != inputSockets.size())
+    {
+        inputs_.clear();
+        inputs_.resize(inputSockets.size());
+        decided_ = false;
+    }
+
+    const bool resized = width != width_ || height != height_;
+    if (resized)
+    {
+        width_ = width;
+        height_ = height;
+        for (InputState& input : inputs_)
+            input.pyramid_.Clear();
+    }
+
+    if (!decided_ || resized)
+    {
+        for (unsigned i = 0; i < inputs_.size(); ++i)
+        {
+            InputState& input = inputs_[i];
+            input.gather_ = false;
+            if (IsRemappedInput(i) && GetInputSocket(i)->HasConnections())
+            {
+                if (Evaluation == RE_Gather)
+                    input.gather_ = true;
+                else if (Evaluation == RE_Auto)
+                    input.gather_ = EstimateGatherCost(i) < EstimateReevaluationCost(i);
+            }
+            if (!input.gather_)
+                input.pyramid_.Clear();
+        }
+        decided_ = true;
+    }
+
+    // Upstream edits are looked for once per render pass, whichever pixel the pass happens to start at
+    const bool newPass = graph->GetRenderPass() != checkedPass_;
+    checkedPass_ = graph->GetRenderPass();
+    for (unsigned i = 0; i < inputs_.size(); ++i)
+    {
+        InputState& input = inputs_[i];
+        if (!input.gather_)
+            continue;
+
+        if (input.pyramid_.IsEmpty())
+            Materialize(i, width, height);
+        else if (newPass)
+        {
+            uint64_t hash = 0;
+            if (!input.hashed_ || !HashInput(i, hash) || hash != input.upstreamHash_)
+                Materialize(i, width, height);
+            else
+                GraphProfiler::NoteCacheHit(this);
+        }
+    }
+}
+
+void RemapNode::AdoptCaches(TextureNode* previous)
+{
+    RemapNode* source = dynamic_cast<RemapNode*>(previous);
+    if (!source || source->inputs_.size() != inputSockets.size())
+        return;
+
+    // How each input is evaluated is decided again, this node's evaluation setting may differ
+    inputs_.swap(source->inputs_);
+    width_ = source->width_;
+    height_ = source->height_;
+    decided_ = false;
+}
+
+void RemapNode::Materialize(unsigned index, unsigned width, unsigned height)
+{
+    InputState& input = inputs_[index];
+    input.hashed_ = HashInput(index, input.upstreamHash_);
+
+    std::shared_ptr<FilterableBlockMap<RGBA> > image(new FilterableBlockMap<RGBA>(width, height));
+    GraphSocket* source = graph->GetUpstreamEdges().find(inputSockets[index])->second;
+    TextureProgram program;
+    if (program.Build(source->node, std::find(source->node->outputSockets.begin(), source->node->outputSockets.end(), source) - source->node->outputSockets.begin()))
+        program.Execute(image.get());
+    else
+    {
+        for (unsigned y = 0; y < height; ++y)
+        {
+            for (unsigned x = 0; x < width; ++x)
+            {
+                EvaluateInput(index, Vec4(x / (float)width, y / (float)height, width, height));
+                image->set(GetInputSocket(index)->GetValue().getColorSafe(true), x, y);
+            }
+        }
+    }
+
+    input.pyramid_.Build(image);
+    GraphProfiler::NoteAllocation(this, input.pyramid_.GetMemorySize());
+}
+
+void RemapNode::EvaluateInput(unsigned index, const Vec4& coord)
+{
+    GraphSocket* socket = GetInputSocket(index);
+    if (!(socket->typeID))
+        return;
+
+    auto upstreamEdges = graph->GetUpstreamEdges().equal_range(socket);
+    unsigned junk = -1;
+    for (auto edge = upstreamEdges.first; edge != upstreamEdges.second; ++edge)
+    {
+        edge->second->node->ExecuteUpstream(junk, coord);
+        socket->StoreValue(edge->second->GetValue());
+    }
+}
+
+RGBA RemapNode::SampleInput(unsigned index, const Vec4& coord, float footprint)
+{
+    if (IsGathering(index) && !inputs_[index].pyramid_.IsEmpty())
+        return inputs_[index].pyramid_.Sample(coord.x, coord.y, footprint);
+
+    // Wrapped as the pyramid wraps, an input reads the same whether it is gathered or evaluated again
+    EvaluateInput(index, Vec4(coord.x - floorf(coord.x), coord.y - floorf(coord.y), coord.z, coord.w));
+    return GetInputSocket(index)->GetValue().getColorSafe(true);
+}
+
+RGBA RemapNode::SampleRemapped(unsigned index, const Vec4& pixel)
+{
+    const Vec4 coord = FilterParameter(pixel).getVec4Safe();
+    if (!IsGathering(index))
+        return SampleInput(index, coord);
+
+    // Distance in input pixels between where this pixel and its neighbours land, across the tiling edge if that is nearer
+    const float width = SprueMax(pixel.z, 1.0f);
+    const float height = SprueMax(pixel.w, 1.0f);
+    auto distanceTo = [&](const Vec4& neighbour) {
+        const Vec4 other = FilterParameter(neighbour).getVec4Safe();
+        float dx = other.x - coord.x;
+        float dy = other.y - coord.y;
+        dx = (dx - floorf(dx + 0.5f)) * width;
+        dy = (dy - floorf(dy + 0.5f)) * height;
+        return sqrtf(dx * dx + dy * dy);
+    };
+    const float footprint = SprueMax(distanceTo(Vec4(pixel.x + 1.0f / width, pixel.y, pixel.z, pixel.w)), distanceTo(Vec4(pixel.x, pixel.y + 1.0f / height, pixel.z, pixel.w)));
+    return SampleInput(index, coord, footprint);
+}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <SprueEngine/TextureGen/TextureNode.h>
+#include <SprueEngine/Texturing/MipPyramid.h>
+
+#include <cstdint>
+
+namespace SprueEngine
+{
+
+/// How a RemapNode evaluates its remapped inputs.
+enum RemapEvaluation
+{
+    RE_Auto,        // Chosen per input by comparing EstimateReevaluationCost and EstimateGatherCost
+    RE_Gather,      // The input is rendered once on a grid and remapped samples are filtered lookups into its mip pyramid
+    RE_Reevaluate   // Everything upstream of the input is evaluated again at every remapped coordinate
+};
+
+/// Base for nodes that sample their inputs at coordinates other than the pixel being evaluated (transforms, tiling, warps, divisions).
+/// Re-evaluating a large upstream subgraph at every remapped coordinate costs the whole subgraph per sample, gathering instead renders
+/// each input once per resolution, compiled to a TextureProgram where possible, and turns every sample into a trilinear lookup
+/// filtered by how far neighbouring pixels land apart. Inputs are treated as tiling either way, as the rest of the texture graph does:
+/// remapped coordinates wrap into [0, 1) before upstream is evaluated again, just as the pyramid wraps its lookups.
+/// Materialized inputs are rendered again when the resolution changes, and when the upstream graph hashes differently at the first
+/// evaluation of a render pass (Graph::BeginRenderPass).
+class SPRUE RemapNode : public PreviewableNode
+{
+public:
+    virtual bool WillForceExecute() const override { return true; }
+    virtual void AttributeUpdated(const StringHash& attr) override { decided_ = false; }
+    /// Takes over the pyramids of previous, they are checked against upstream at the first evaluation as any others are.
+    virtual void AdoptCaches(TextureNode* previous) override;
+
+    /// Returns true if the input was being gathered at the last evaluated resolution.
+    bool IsGathering(unsigned index) const { return index < inputs_.size() && inputs_[index].gather_; }
+
+    /// Estimated cost, in node evaluations per output pixel, of evaluating everything upstream of the input at every sample.
+    float EstimateReevaluationCost(unsigned index) const;
+    /// Estimated cost, in node evaluations per output pixel, of rendering the input once and gathering every sample from it.
+    float EstimateGatherCost(unsigned index) const;
+
+    /// Upstream nodes that force their own evaluation (blurs, emboss and the like) count as this many node evaluations.
+    static const float ForcedNodeCost;
+    /// Node evaluations a node compiled into a TextureProgram counts as.
+    static const float CompiledNodeCost;
+    /// Node evaluations a trilinear gather counts as.
+    static const float GatherSampleCost;
+
+    int Evaluation = RE_Auto;
+
+protected:
+    /// Call first in Execute, decides how every input is evaluated and materializes the gathered ones when out of date.
+    void PrepareInputs(const Vec4& pixel);
+    /// Value of the input at a remapped coordinate, wrapped into [0, 1). Footprint is the width in pixels of the input that one output pixel covers.
+    RGBA SampleInput(unsigned index, const Vec4& coord, float footprint = 1.0f);
+    /// SampleInput at FilterParameter of the pixel, the footprint measured from where neighbouring pixels are remapped to.
+    RGBA SampleRemapped(unsigned index, const Vec4& pixel);
+    /// Evaluates only what is upstream of one input at the coordinate and stores the value in its socket.
+    void EvaluateInput(unsigned index, const Vec4& coord);
+
+    /// OVERRIDE with the expected number of samples of the input per output pixel, the fraction of the output reading it times the samples taken.
+    virtual float GetSampleRate(unsigned index) const { return 1.0f; }
+    /// OVERRIDE to return false for inputs that are only read at the pixel being evaluated and never gathered.
+    virtual bool IsRemappedInput(unsigned index) const { return true; }
+
+private:
+    struct InputState
+    {
+        MipPyramid pyramid_;
+        uint64_t upstreamHash_ = 0;
+        bool hashed_ = false;
+        bool gather_ = false;
+    };
+
+    /// Sum of the evaluation cost of every node upstream of the input, each counted once.
+    float EstimateUpstreamCost(unsigned index, bool& compiled) const;
+    /// Renders the input on a width * height grid and builds its pyramid.
+    void Materialize(unsigned index, unsigned width, unsigned height);
+    /// Hashes the subgraph feeding the input, returns false if it cannot be hashed exactly.
+    bool HashInput(unsigned index, uint64_t& hash) const;
+
+    std::vector<InputState> inputs_;
+    unsigned width_ = 0;
+    unsigned height_ = 0;
+    /// Graph::GetRenderPass when the inputs were last checked for upstream edits.
+    unsigned checkedPass_ = 0;
+    bool decided_ = false;
+};
+
+}
@@ -0,0 +1,190 @@
+#include "ResolutionPlanner.h"
+
+#include <SprueEngine/Core/Context.h>
+#include <SprueEngine/FString.h>
+#include <SprueEngine/Graph/Graph.h>
+#include <SprueEngine/Graph/GraphSocket.h>
+#include <SprueEngine/TextureGen/TexModifierImpl.h>
+#include <SprueEngine/TextureGen/TextureNode.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace SprueEngine
+{
+
+std::string ResolutionPlannerStats::ToString() const
+{
+    std::string ret = FString("%1 samplers inserted for %2 edges", NodesInserted, EdgesReduced);
+    ret += ", " + std::to_string(PixelsBefore) + " -> " + std::to_string(PixelsAfter) + " pixels";
+    return ret;
+}
+
+ResolutionPlanner::ResolutionPlanner(const ResolutionPlannerSettings& settings) :
+    settings_(settings)
+{
+
+}
+
+ResolutionPlannerStats ResolutionPlanner::Plan(Graph* graph, const std::vector<GraphNode*>& roots, unsigned width, unsigned height)
+{
+    ResolutionPlannerStats stats;
+    frequencies_.clear();
+    samplers_.clear();
+    planned_.clear();
+    width_ = width;
+    height_ = height;
+    if (!graph || settings_.ForceFullResolution || width == 0 || height == 0)
+        return stats;
+
+    for (GraphNode* root : roots)
+    {
+        if (root)
+            PlanNode(graph, root, width, height, stats);
+    }
+    return stats;
+}
+
+float ResolutionPlanner::EstimateFrequency(Graph* graph, GraphSocket* output, unsigned width, unsigned height)
+{
+    if (width != width_ || height != height_)
+    {
+        frequencies_.clear();
+        width_ = width;
+        height_ = height;
+    }
+    return SocketFrequency(graph, output);
+}
+
+unsigned ResolutionPlanner::RequiredSize(float frequency) const
+{
+    if (!(frequency < TextureNode::UnboundedFrequency))
+        return UINT_MAX;
+
+    const float error = SprueMax(settings_.MaxError, 1e-6f);
+    float size = settings_.Filter == RF_Bicubic ? PI * frequency / cbrtf(4.0f * error) : PI * frequency / (2.0f * sqrtf(error));
+    // Never below the Nyquist rate, whatever the tolerance
+    size = SprueMax(size, 2.0f * frequency);
+    if (size > 65536.0f)
+        return UINT_MAX;
+
+    // Powers of two keep the grid aligned with power of two renders, so grid samples land exactly on pixels
+    unsigned ret = SprueMax(settings_.MinimumSize, 1u);
+    while (ret < size)
+        ret <<= 1;
+    return ret;
+}
+
+float ResolutionPlanner::SocketFrequency(Graph* graph, GraphSocket* output)
+{
+    auto found = frequencies_.find(output);
+    if (found != frequencies_.end())
+        return found->second;
+
+    // Marked first so that a cycle reads as unbounded rather than recursing forever
+    frequencies_[output] = TextureNode::UnboundedFrequency;
+
+    float ret = TextureNode::UnboundedFrequency;
+    GraphNode* node = output->node;
+    if (TextureNode* textureNode = dynamic_cast<TextureNode*>(node))
+    {
+        const auto& edges = graph->GetUpstreamEdges();
+        std::vector<float> inputs(node->inputSockets.size(), 0.0f);
+        for (unsigned i = 0; i < node->inputSockets.size(); ++i)
+        {
+            auto upstreamEdges = edges.equal_range(node->inputSockets[i]);
+            for (auto edge = upstreamEdges.first; edge != upstreamEdges.second; ++edge)
+                inputs[i] = SprueMax(inputs[i], SocketFrequency(graph, edge->second));
+        }
+        const unsigned outputIndex = std::find(node->outputSockets.begin(), node->outputSockets.end(), output) - node->outputSockets.begin();
+        ret = textureNode->EstimateFrequency(outputIndex, inputs, Vec2((float)width_, (float)height_));
+    }
+
+    frequencies_[output] = ret;
+    return ret;
+}
+
+void ResolutionPlanner::PlanNode(Graph* graph, GraphNode* node, unsigned gridWidth, unsigned gridHeight, ResolutionPlannerStats& stats)
+{
+    // A sampler's own grid is what everything upstream of it is evaluated on
+    if (SampleSizeModifier* sampler = dynamic_cast<SampleSizeModifier*>(node))
+    {
+        gridWidth = SprueMin(gridWidth, SprueMax((unsigned)sampler->newSize.x, 1u));
+        gridHeight = SprueMin(gridHeight, SprueMax((unsigned)sampler->newSize.y, 1u));
+    }
+
+    const unsigned long long gridPixels = (unsigned long long)gridWidth * gridHeight;
+    auto found = planned_.find(node);
+    if (found != planned_.end() && found->second >= gridPixels)
+        return;
+    planned_[node] = gridPixels;
+
+    // Collected first, rewiring changes the edges
+    std::vector<std::pair<GraphSocket*, GraphSocket*> > inputs;
+    const auto& edges = graph->GetUpstreamEdges();
+    for (GraphSocket* socket : node->inputSockets)
+    {
+        if (socket->control)
+            continue;
+        auto upstreamEdges = edges.equal_range(socket);
+        for (auto edge = upstreamEdges.first; edge != upstreamEdges.second; ++edge)
+            inputs.push_back(std::make_pair(socket, edge->second));
+    }
+
+    for (auto& input : inputs)
+    {
+        GraphSocket* source = input.second;
+        GraphNode* upstream = source->node;
+
+        // Constant branches are already folded by the optimizer and cost less than a lookup
+        const float frequency = dynamic_cast<SampleSizeModifier*>(upstream) ? 0.0f : SocketFrequency(graph, source);
+        const unsigned size = frequency > 0.0f ? RequiredSize(frequency) : UINT_MAX;
+        const unsigned width = SprueMin(size, width_);
+        const unsigned height = SprueMin(size, height_);
+        if (size != UINT_MAX && (unsigned long long)width * height * 4 <= gridPixels)
+        {
+            if (SampleSizeModifier* sampler = GetSampler(graph, source, width, height, stats))
+            {
+                if (graph->Connect(sampler->GetOutputSocket(0), input.first))
+                {
+                    ++stats.EdgesReduced;
+                    stats.PixelsBefore += gridPixels;
+                    stats.PixelsAfter += (unsigned long long)width * height;
+                    PlanNode(graph, sampler, gridWidth, gridHeight, stats);
+                    continue;
+                }
+            }
+        }
+        PlanNode(graph, upstream, gridWidth, gridHeight, stats);
+    }
+}
+
+SampleSizeModifier* ResolutionPlanner::GetSampler(Graph* graph, GraphSocket* source, unsigned width, unsigned height, ResolutionPlannerStats& stats)
+{
+    auto found = samplers_.find(source);
+    if (found != samplers_.end())
+        return found->second;
+
+    SampleSizeModifier* sampler = dynamic_cast<SampleSizeModifier*>(Context::GetInstance()->Create<GraphNode>("SampleSizeModifier"));
+    if (!sampler)
+        return 0x0;
+    sampler->Construct();
+    sampler->newSize = Vec2((float)width, (float)height);
+    sampler->Bilinear = true;
+    sampler->Bicubic = settings_.Filter == RF_Bicubic;
+    sampler->KeepStepSizes = true;
+    graph->AddNode(sampler, false);
+    if (!graph->Connect(source, sampler->GetInputSocket(0)))
+    {
+        graph->RemoveNode(sampler);
+        delete sampler;
+        return 0x0;
+    }
+
+    samplers_[source] = sampler;
+    ++stats.NodesInserted;
+    return sampler;
+}
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SprueEngine
+{
+
+class Graph;
+class GraphNode;
+struct GraphSocket;
+class SampleSizeModifier;
+
+/// Filtering ResolutionPlanner reconstructs reduced branches with.
+enum ResolutionFilter
+{
+    RF_Bilinear,
+    RF_Bicubic
+};
+
+/// Tolerances of a ResolutionPlanner run.
+struct SPRUE ResolutionPlannerSettings
+{
+    /// Largest acceptable difference from the full resolution result, in the 0 - 1 range of a channel.
+    float MaxError = 1.0f / 255.0f;
+    /// Filter used to enlarge reduced branches back to the full resolution.
+    ResolutionFilter Filter = RF_Bilinear;
+    /// Grids are never made smaller than this.
+    unsigned MinimumSize = 16;
+    /// Leaves the graph untouched, for renders that must match the full resolution result exactly.
+    bool ForceFullResolution = false;
+};
+
+/// Summary of what a ResolutionPlanner run changed.
+struct SPRUE ResolutionPlannerStats
+{
+    /// SampleSizeModifiers inserted.
+    unsigned NodesInserted = 0;
+    /// Input sockets rewired to read from an inserted node.
+    unsigned EdgesReduced = 0;
+    /// Pixels every reduced branch would otherwise have been evaluated at, summed.
+    unsigned long long PixelsBefore = 0;
+    /// Pixels of the grids the reduced branches are evaluated on instead.
+    unsigned long long PixelsAfter = 0;
+
+    std::string ToString() const;
+};
+
+/// Finds branches of a texture graph whose content changes slowly enough that evaluating them on a coarser grid and filtering the grid
+/// up to the full resolution stays within MaxError, and inserts SampleSizeModifiers that do so. Frequencies come from
+/// TextureNode::EstimateFrequency, branches whose frequency is unbounded stay at full resolution.
+/// The grid size needed for a frequency F, in cycles across the texture, follows from the interpolation error of a sinusoid of amplitude 0.5:
+/// bilinear filtering errs by pi^2 F^2 / 4N^2 on N samples and Catmull-Rom by pi^3 F^3 / 4N^3.
+/// Rewrites the graph in place, intended for throw-away clones that are about to be previewed as GraphOptimizer is.
+class SPRUE ResolutionPlanner
+{
+    NOCOPYDEF(ResolutionPlanner);
+public:
+    ResolutionPlanner(const ResolutionPlannerSettings& settings = ResolutionPlannerSettings());
+
+    /// Plans for the roots evaluated at width * height.
+    ResolutionPlannerStats Plan(Graph* graph, const std::vector<GraphNode*>& roots, unsigned width, unsigned height);
+
+    /// Estimated highest frequency held by an output socket, in cycles across the texture.
+    float EstimateFrequency(Graph* graph, GraphSocket* output, unsigned width, unsigned height);
+    /// Smallest grid size that reproduces content of the frequency within the settings' error.
+    unsigned RequiredSize(float frequency) const;
+
+    const ResolutionPlannerSettings& GetSettings() const { return settings_; }
+
+private:
+    /// Reduces the inputs of the node that the grid it is evaluated on oversamples, then continues upstream.
+    void PlanNode(Graph* graph, GraphNode* node, unsigned gridWidth, unsigned gridHeight, ResolutionPlannerStats& stats);
+    /// Returns the SampleSizeModifier reading the source socket on a width * height grid, creating it if need be.
+    SampleSizeModifier* GetSampler(Graph* graph, GraphSocket* source, unsigned width, unsigned height, ResolutionPlannerStats& stats);
+    /// EstimateFrequency at the planned resolution, memoized.
+    float SocketFrequency(Graph* graph, GraphSocket* output);
+
+    ResolutionPlannerSettings settings_;
+    unsigned width_ = 0;
+    unsigned height_ = 0;
+    /// Memoized EstimateFrequency of every output socket.
+    std::unordered_map<GraphSocket*, float> frequencies_;
+    /// Inserted nodes by the socket they read.
+    std::unordered_map<GraphSocket*, SampleSizeModifier*> samplers_;
+    /// Largest grid every node has been planned at, nodes reached again with a grid no larger are already planned.
+    std::unordered_map<GraphNode*, unsigned long long> planned_;
+};
+
+}
@@ -4,6 +4,7 @@
 #include <SprueEngine/Core/Context.h>
 #include <SprueEngine/MathGeoLib/AllMath.h>
 #include <SprueEngine/Libs/ANL_NoiseGen.h>
+#include <SprueEngine/TextureGen/TextureProgram.h>
 
 #define FAST_NOISE_ADDR(TYPE, PARAM) (offsetof(TYPE, noise_) + offsetof(FastNoise, PARAM))
 
@@ -113,6 +114,17 @@ int RowsGenerator::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool RowsGenerator::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    // Execute only reads plain numbers from the perturbation input
+    if (!code.InputFedBy(0, TEXGRAPH_FLOAT))
+        return false;
+    code.Op(TOP_Coord, code.Temp(0));
+    code.Emit(TOP_Rows, code.Out(0), code.Temp(0), code.In(0), 0, 0, PerturbPower, (float)RowCount, Vertical ? 1.0f : 0.0f, AlternateDeadColumns ? 1.0f : 0.0f);
+    return true;
+}
+
 void CheckerGenerator::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "CheckerGenerator");
@@ -150,6 +162,19 @@ int CheckerGenerator::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool CheckerGenerator::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    if (!code.InputFedBy(0, TEXGRAPH_FLOAT) || !code.InputFedBy(1, TEXGRAPH_FLOAT))
+        return false;
+    code.Const(code.Temp(0), ColorA);
+    code.Const(code.Temp(1), ColorB);
+    code.Op(TOP_Coord, code.Temp(2));
+    code.Emit(TOP_Checker, code.Temp(3), code.Temp(2), code.In(0), code.In(1), 0, (float)TileCount.x, (float)TileCount.y, 0.0f, 0.0f);
+    code.Op(TOP_Select, code.Out(0), code.Temp(3), code.Temp(1), code.Temp(0));
+    return true;
+}
+
 void BrickGenerator::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "BrickGenerator");
@@ -345,6 +370,11 @@ int FBMGenerator::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+float FBMGenerator::EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const
+{
+    return LatticeNoiseFrequency(Vec2(Period.x, Period.y), noise_.m_octaves, noise_.m_lacunarity);
+}
+
 void PerlinNoiseGenerator::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "PerlinNoiseGenerator");
@@ -379,6 +409,11 @@ int PerlinNoiseGenerator::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+float PerlinNoiseGenerator::EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const
+{
+    return LatticeNoiseFrequency(Vec2(Period.x, Period.y));
+}
+
 void VoronoiGenerator::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "VoronoiGenerator");
@@ -737,83 +772,142 @@ void GaborNoiseGenerator::Register(Context* context)
     REGISTER_PROPERTY_MEMORY(GaborNoiseGenerator, float, offsetof(GaborNoiseGenerator, Impulses), 64.0f, "Impulses", "", PS_VisualConsequence);
     REGISTER_PROPERTY_MEMORY(GaborNoiseGenerator, float, offsetof(GaborNoiseGenerator, Period), 256.0f, "Period", "", PS_VisualConsequence);
     REGISTER_PROPERTY_MEMORY(GaborNoiseGenerator, float, offsetof(GaborNoiseGenerator, Offset), 0.0f, "Offset", "", PS_VisualConsequence | PS_TinyIncrement);
-    REGISTER_PROPERTY_MEMORY(GaborNoiseGenerator, float, FAST_NOISE_ADDR(GaborNoiseGenerator, m_frequency), 8, "Frequency", "", PS_Default);
-    REGISTER_PROPERTY_MEMORY(GaborNoiseGenerator, unsigned, FAST_NOISE_ADDR(GaborNoiseGenerator, m_seed), 0, "Seed", "", PS_VisualConsequence);
+    REGISTER_PROPERTY_MEMORY(GaborNoiseGenerator, unsigned, offsetof(GaborNoiseGenerator, Seed), 0, "Seed", "", PS_VisualConsequence);
+    REGISTER_PROPERTY_MEMORY(GaborNoiseGenerator, bool, offsetof(GaborNoiseGenerator, Isotropic), false, "Isotropic", "Every impulse is given a random orientation instead of Omega", PS_VisualConsequence | PS_Permutable);
 }
 
 void GaborNoiseGenerator::Construct()
 {
-    noise_.m_seed = 0;
-    noise_.m_frequency = 8;
-    noise_.SetNoiseType(FastNoise::NoiseType::Value);
     AddOutput("", TEXGRAPH_FLOAT);
 }
 
+void GaborNoiseGenerator::UpdateImpulses()
+{
+    ImpulseTable& t = table_;
+    // Periods below a unit are clamped, the table and the evaluation must both use the clamped one or the cells stop tiling
+    const float period = SprueMax(Period, 1.0f);
+    if (!t.cellStart_.empty() && t.alpha_ == Alpha && t.f0_ == F0 && t.omega_ == Omega && t.impulses_ == Impulses && t.period_ == period && t.offset_ == Offset && t.seed_ == Seed && t.isotropic_ == Isotropic)
+        return;
+
+    t.alpha_ = Alpha;
+    t.f0_ = F0;
+    t.omega_ = Omega;
+    t.impulses_ = Impulses;
+    t.period_ = period;
+    t.offset_ = Offset;
+    t.seed_ = Seed;
+    t.isotropic_ = Isotropic;
+
+    // Cells are at least a kernel radius wide and divide the period evenly, so the 3x3 neighborhood covers the kernel and tiles
+    t.kernelRadius_ = sqrtf(-logf(0.05f) / PI) / SprueMax(Alpha, 1e-4f);
+    t.cells_ = (unsigned)CLAMP(floorf(period / t.kernelRadius_), 1.0f, 1024.0f);
+    t.cellSize_ = period / t.cells_;
+
+    const float impulseDensity = Impulses / (PI * t.kernelRadius_ * t.kernelRadius_);
+    const float meanImpulses = impulseDensity * t.cellSize_ * t.cellSize_;
+    const float expMean = expf(-meanImpulses);
+
+    t.cellStart_.resize(t.cells_ * t.cells_ + 1);
+    t.x_.clear();
+    t.y_.clear();
+    t.weight_.clear();
+    t.frequencyX_.clear();
+    t.frequencyY_.clear();
+    for (unsigned cy = 0; cy < t.cells_; ++cy)
+    {
+        for (unsigned cx = 0; cx < t.cells_; ++cx)
+        {
+            t.cellStart_[cy * t.cells_ + cx] = (unsigned)t.x_.size();
+
+            // Multiplicative LCG seeded per cell
+            unsigned state = Morton(cx, cy) + (unsigned)Offset + Seed * 2654435761u;
+            if (state == 0)
+                state = 1;
+            auto random = [&state]() { state *= 3039177861u; return state / 4294967296.0f; };
+
+            // Poisson distributed impulse count, falling back on the mean when the mean is too large for Knuth's method
+            unsigned count = 0;
+            if (meanImpulses < 64.0f)
+            {
+                for (float product = random(); product >= expMean; product *= random())
+                    ++count;
+            }
+            else
+                count = (unsigned)(meanImpulses + 0.5f);
+
+            for (unsigned i = 0; i < count; ++i)
+            {
+                t.x_.push_back(random() * t.cellSize_);
+                t.y_.push_back(random() * t.cellSize_);
+                t.weight_.push_back(random() * 2.0f - 1.0f);
+                const float omega = Isotropic ? random() * 2.0f * PI : Omega;
+                t.frequencyX_.push_back(2.0f * PI * F0 * cosf(omega));
+                t.frequencyY_.push_back(2.0f * PI * F0 * sinf(omega));
+            }
+        }
+    }
+    t.cellStart_.back() = (unsigned)t.x_.size();
+}
+
 int GaborNoiseGenerator::Execute(const Variant& param)
 {
-    const Vec2 p = param.getVec2Safe();
+    UpdateImpulses();
+    const ImpulseTable& t = table_;
 
-    const float kernelRadius = std::sqrtf(-std::log(0.05) / PI) / Alpha;
-    const float impulseDensity = Impulses / (PI * kernelRadius * kernelRadius);
-
-    Vec4 pos = Make4D(p, Vec2(Period, Period));
-    float x = pos.x; //p.x * Period;
-    float y = pos.y; //p.y * Period;
-    float z = pos.z;
-    float w = pos.w;
-
-    x /= kernelRadius, y /= kernelRadius;
-    float int_x = std::floor(x), int_y = std::floor(y);
-    float frac_x = x - int_x, frac_y = y - int_y;
-    int i = int(int_x), j = int(int_y);
-    float noise = 0.0;
-    for (int di = -1; di <= +1; ++di) {
-        for (int dj = -1; dj <= +1; ++dj) {
-            noise += CellValue(i + di, j + dj, frac_x - di, frac_y - dj, impulseDensity, kernelRadius);
+    const Vec2 p = param.getVec2Safe();
+    const float x = p.x * t.period_;
+    const float y = p.y * t.period_;
+    const int cellX = (int)floorf(x / t.cellSize_);
+    const int cellY = (int)floorf(y / t.cellSize_);
+    const int cells = (int)t.cells_;
+    const float radiusSquared = t.kernelRadius_ * t.kernelRadius_;
+    const float envelope = -PI * Alpha * Alpha;
+
+    const float* impulseX = t.x_.data();
+    const float* impulseY = t.y_.data();
+    const float* weights = t.weight_.data();
+    const float* frequencyX = t.frequencyX_.data();
+    const float* frequencyY = t.frequencyY_.data();
+
+    float noise = 0.0f;
+    for (int dj = -1; dj <= 1; ++dj)
+    {
+        const int row = (((cellY + dj) % cells) + cells) % cells;
+        const float originY = (cellY + dj) * t.cellSize_;
+        for (int di = -1; di <= 1; ++di)
+        {
+            const int column = (((cellX + di) % cells) + cells) % cells;
+            const float originX = (cellX + di) * t.cellSize_;
+            const unsigned cell = row * cells + column;
+            const unsigned end = t.cellStart_[cell + 1];
+            for (unsigned i = t.cellStart_[cell]; i < end; ++i)
+            {
+                const float dx = x - (originX + impulseX[i]);
+                const float dy = y - (originY + impulseY[i]);
+                const float distanceSquared = dx * dx + dy * dy;
+                if (distanceSquared < radiusSquared)
+                    noise += weights[i] * expf(envelope * distanceSquared) * cosf(frequencyX[i] * dx + frequencyY[i] * dy);
+            }
         }
     }
 
-    GetOutputSocket(0)->StoreValue(noise);
+    GetOutputSocket(0)->StoreValue(noise * K);
     return GRAPH_EXECUTE_COMPLETE;
 }
 
-float GaborNoiseGenerator::CellValue(int i, int j, float x, float y, float impulseDensity, float kernelRadius)
+float GaborNoiseGenerator::EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const
 {
-    unsigned s = Morton(i, j) + Offset; // nonperiodic noise
-    if (s == 0) s = 1;
-    
-    double number_of_impulses_per_cell = impulseDensity * kernelRadius * kernelRadius;
-    unsigned number_of_impulses = NORMALIZE(noise_.GetValue(i, j), -1, 1) * number_of_impulses_per_cell;
-    float noise = 0.0;
-    for (unsigned i = 0; i < number_of_impulses; ++i) {
-        float x_i = NORMALIZE(noise_.GetValue(noise_.m_seed + i, j * 13), -1, 1);
-        float y_i = NORMALIZE(noise_.GetValue(noise_.m_seed + i * 21, j), -1, 1);
-        float w_i = noise_.GetValue(noise_.m_seed + i * 37, j * 37463);
-        float omega_0_i = NORMALIZE(noise_.GetValue(noise_.m_seed + i * 471, j * 7), -1, 1) * 2.0 * PI;
-        float x_i_x = x - x_i;
-        float y_i_y = y - y_i;
-        if (((x_i_x * x_i_x) + (y_i_y * y_i_y)) < 1.0) {
-            noise += w_i * Gabor(K, Alpha, F0, Omega, x_i_x * kernelRadius, y_i_y * kernelRadius); // anisotropic
-            //noise += w_i * gabor(K_, a_, F_0_, omega_0_i, x_i_x * kernel_radius_, y_i_y * kernel_radius_); // isotropic
-        }
-    }
-    return noise;
+    // The carrier widened by the bandwidth of the Gaussian envelope, out to where it has fallen below 1%
+    return (fabsf(F0) + fabsf(Alpha) * 1.2f) * fabsf(Period);
 }
 
 unsigned GaborNoiseGenerator::Morton(unsigned x, unsigned y)
 {
     unsigned z = 0;
-    for (unsigned i = 0; i < (sizeof(unsigned) * CHAR_BIT); ++i) {
+    for (unsigned i = 0; i < (sizeof(unsigned) * CHAR_BIT) / 2; ++i) {
         z |= ((x & (1 << i)) << i) | ((y & (1 << i)) << (i + 1));
     }
     return z;
 }
 
-float GaborNoiseGenerator::Gabor(float K, float a, float F_0, float omega_0, float x, float y)
-{
-    float gaussian_envelop = K * std::exp(-PI * (a * a) * ((x * x) + (y * y)));
-    float sinusoidal_carrier = std::cos(2.0 * PI * F_0 * ((x * std::cos(omega_0)) + (y * std::sin(omega_0))));
-    return gaussian_envelop * sinusoidal_carrier;
-}
-
 }
\ No newline at end of file
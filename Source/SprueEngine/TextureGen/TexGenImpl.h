@@ -20,6 +20,7 @@ class SPRUE RowsGenerator : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(RowsGenerator);
+    virtual bool Compile(VectorBuffer* buffer) const override;
     unsigned RowCount = 6;
     bool Vertical = true;
     float PerturbPower = 1.0f;
@@ -30,6 +31,7 @@ class SPRUE CheckerGenerator : public SelfPreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(CheckerGenerator);
+    virtual bool Compile(VectorBuffer* buffer) const override;
     RGBA ColorA;
     RGBA ColorB;
     IntVec2 TileCount;
@@ -63,6 +65,7 @@ class SPRUE FBMGenerator : public SelfPreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(FBMGenerator);
+    virtual float EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const override;
     bool Inverted = false;
     Vec3 Period = Vec3(8, 8, 8);
 private:
@@ -73,6 +76,7 @@ class SPRUE PerlinNoiseGenerator : public SelfPreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(PerlinNoiseGenerator);
+    virtual float EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const override;
     bool Inverted;
     Vec3 Period = Vec3(8, 8, 8);
 private:
@@ -194,10 +198,15 @@ public:
 private:
 };
 
+/// Sparse convolution Gabor noise, periodic over Period units in both directions.
+/// The random impulses of every cell of the period are generated once into a flat table, stored as structure of arrays and
+/// rebuilt only when a parameter affecting them changes. Each pixel then sums the impulses of its 3x3 cell neighborhood
+/// from contiguous runs of that table, wrapping cell indices around the period.
 class SPRUE GaborNoiseGenerator : public SelfPreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(GaborNoiseGenerator);
+    virtual float EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const override;
 
     float K = 1.0f;
     float Alpha = 0.05f;
@@ -206,12 +215,42 @@ public:
     float Impulses = 64.0f;
     float Period = 256.0f;
     float Offset = 0;
+    unsigned Seed = 0;
+    bool Isotropic = false;
 
 private:
-    float CellValue(int i, int j, float x, float y, float impulseDensity, float kernelRadius);
+    /// Impulses of every cell of one period, cell (x, y) owns the range [cellStart_[y * cells + x], cellStart_[y * cells + x + 1]).
+    struct ImpulseTable
+    {
+        /// Parameters the table was generated with.
+        float alpha_ = 0.0f;
+        float f0_ = 0.0f;
+        float omega_ = 0.0f;
+        float impulses_ = 0.0f;
+        /// Period clamped to at least 1, Execute scales coordinates by this rather than by Period.
+        float period_ = 0.0f;
+        float offset_ = 0.0f;
+        unsigned seed_ = 0;
+        bool isotropic_ = false;
+
+        unsigned cells_ = 0;
+        float cellSize_ = 0.0f;
+        float kernelRadius_ = 0.0f;
+        std::vector<unsigned> cellStart_;
+        /// Position within the cell, in units.
+        std::vector<float> x_;
+        std::vector<float> y_;
+        std::vector<float> weight_;
+        /// Frequency vector of the sinusoidal carrier, 2 PI F0 (cos omega, sin omega).
+        std::vector<float> frequencyX_;
+        std::vector<float> frequencyY_;
+    };
+
+    /// Regenerates the impulse table if it is out of date.
+    void UpdateImpulses();
     unsigned Morton(unsigned x, unsigned y);
-    float Gabor(float K, float a, float F_0, float omega_0, float x, float y);
-    FastNoise noise_;
+
+    ImpulseTable table_;
 };
 
 }
\ No newline at end of file
@@ -1,6 +1,12 @@
 #include "TexModifierImpl.h"
 
 #include <SprueEngine/Core/Context.h>
+#include <SprueEngine/TextureGen/TextureProgram.h>
+#include <SprueEngine/Graph/GraphOptimizer.h>
+#include <SprueEngine/Graph/GraphProfiler.h>
+#include <SprueEngine/Texturing/DistanceTransform.h>
+
+#include <algorithm>
 
 namespace SprueEngine
 {
@@ -8,6 +14,16 @@ namespace SprueEngine
     // Helper to minimize typo risks
 #define GENERIC_REGISTER(NAME) void NAME :: Register(Context* context) { context->CopyBaseProperties("GraphNode", #NAME); }
 
+static const char* RemapEvaluationNames[] = {
+    "Auto",
+    "Gather",
+    "Re-evaluate",
+    0x0
+};
+
+    // Every RemapNode exposes the same choice of evaluation
+#define REGISTER_REMAP_EVALUATION(NAME) REGISTER_ENUM_MEMORY(NAME, int, offsetof(NAME, Evaluation), RE_Auto, "Evaluation", "Whether remapped inputs are rendered once and gathered from or evaluated again at every remapped coordinate, Auto decides by estimated cost", PS_Default, RemapEvaluationNames)
+
 ///=================================================
 /// Invert color
 ///=================================================
@@ -33,6 +49,16 @@ int InvertTextureModifier::Execute(const Variant& parameter)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool InvertTextureModifier::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Const(code.Temp(0), RGBA(-1.0f, -1.0f, -1.0f, 1.0f));
+    code.Const(code.Temp(1), RGBA(1.0f, 1.0f, 1.0f, 0.0f));
+    code.Op(TOP_Mul, code.Temp(2), code.In(0), code.Temp(0));
+    code.Op(TOP_Add, code.Out(0), code.Temp(2), code.Temp(1));
+    return true;
+}
+
 void SolarizeTextureModifier::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "SolarizeTextureModifier");
@@ -65,6 +91,13 @@ int SolarizeTextureModifier::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool SolarizeTextureModifier::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.OpImm(TOP_Solarize, code.Out(0), code.In(0), Threshold, InvertLower ? 1.0f : 0.0f);
+    return true;
+}
+
 void ConvolutionFilter::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "ConvolutionFilter");
@@ -140,6 +173,7 @@ void GradientRampTextureModifier::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "GradientRampTextureModifier");
     REGISTER_PROPERTY_MEMORY(GradientRampTextureModifier, ColorRamp, offsetof(GradientRampTextureModifier, Gradient), ColorRamp(), "Gradient", "", PS_Default | PS_Permutable);
+    REGISTER_PROPERTY_MEMORY(GradientRampTextureModifier, unsigned, offsetof(GradientRampTextureModifier, TableSize), LookupTable::DefaultSize, "Table Size", "Number of entries (256 - 65536) the gradient is baked into", PS_Default);
 }
 
 void GradientRampTextureModifier::Construct()
@@ -169,16 +203,62 @@ int GradientRampTextureModifier::Execute(const Variant& param)
     //OLD COS BASED GRADIENT: 
     //OLD COS BASED GRADIENT: RGBA result = a + b * firstResult;
 
-    RGBA result = Gradient.Get(gradientValue);
+    RGBA result = GetLookupTable(0)->Get(gradientValue);
     GetOutputSocket(0)->StoreValue(result);
 
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool GradientRampTextureModifier::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Lookup(code.Out(0), code.In(0), 0, false);
+    return true;
+}
+
+/// Exact comparison, a table is only reused for the very ramp it was baked from.
+static bool SameRamp(const ColorRamp& lhs, const ColorRamp& rhs)
+{
+    if (lhs.colors.size() != rhs.colors.size())
+        return false;
+    for (size_t i = 0; i < lhs.colors.size(); ++i)
+    {
+        const auto& a = lhs.colors[i];
+        const auto& b = rhs.colors[i];
+        if (a.first != b.first || a.second.r != b.second.r || a.second.g != b.second.g || a.second.b != b.second.b || a.second.a != b.second.a)
+            return false;
+    }
+    return true;
+}
+
+static bool SameCurve(const ColorCurve& lhs, const ColorCurve& rhs)
+{
+    if (lhs.knots_.size() != rhs.knots_.size())
+        return false;
+    for (size_t i = 0; i < lhs.knots_.size(); ++i)
+        if (lhs.knots_[i].x != rhs.knots_[i].x || lhs.knots_[i].y != rhs.knots_[i].y)
+            return false;
+    return true;
+}
+
+std::shared_ptr<const LookupTable> GradientRampTextureModifier::GetLookupTable(unsigned index) const
+{
+    if (!table_ || tableSize_ != TableSize || !SameRamp(tableGradient_, Gradient))
+    {
+        std::shared_ptr<LookupTable> table(new LookupTable());
+        table->Bake(Gradient, TableSize);
+        tableGradient_ = Gradient;
+        tableSize_ = TableSize;
+        table_ = table;
+    }
+    return table_;
+}
+
 void CurveTextureModifier::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "CurveTextureModifier");
     REGISTER_PROPERTY_MEMORY(CurveTextureModifier, ColorCurves, offsetof(CurveTextureModifier, Curves), ColorCurves(), "Curves", "", PS_Default | PS_Permutable);
+    REGISTER_PROPERTY_MEMORY(CurveTextureModifier, unsigned, offsetof(CurveTextureModifier, TableSize), LookupTable::DefaultSize, "Table Size", "Number of entries (256 - 65536) each curve is baked into", PS_Default);
 }
 
 void CurveTextureModifier::Construct()
@@ -190,11 +270,99 @@ void CurveTextureModifier::Construct()
 int CurveTextureModifier::Execute(const Variant& param)
 {
     RGBA color = GetInputSocket(0)->GetValue().getColorSafe(true);
-    color = Curves.Curve(color);
+    color = GetLookupTable(0)->GetPerChannel(color);
     GetOutputSocket(0)->StoreValue(color);
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool CurveTextureModifier::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Lookup(code.Out(0), code.In(0), 0, true);
+    return true;
+}
+
+std::shared_ptr<const LookupTable> CurveTextureModifier::GetLookupTable(unsigned index) const
+{
+    if (!table_ || tableSize_ != TableSize || !SameCurve(tableCurves_.R, Curves.R) || !SameCurve(tableCurves_.G, Curves.G) || !SameCurve(tableCurves_.B, Curves.B) || !SameCurve(tableCurves_.A, Curves.A))
+    {
+        std::shared_ptr<LookupTable> table(new LookupTable());
+        table->Bake(Curves, TableSize);
+        tableCurves_ = Curves;
+        tableSize_ = TableSize;
+        table_ = table;
+    }
+    return table_;
+}
+
+void LUTRemapModifier::Register(Context* context)
+{
+    context->CopyBaseProperties("GraphNode", "LUTRemapModifier");
+    REGISTER_RESOURCE(LUTRemapModifier, BitmapResource, GetLUTResourceHandle, SetLUTResourceHandle, GetLUTData, SetLUTData, ResourceHandle("Image"), "LUT", "Image whose row is used as the lookup table", PS_Default | PS_Permutable);
+    REGISTER_PROPERTY_MEMORY(LUTRemapModifier, bool, offsetof(LUTRemapModifier, PerChannel), true, "Per Channel", "Each channel is looked up in the same channel of the LUT, otherwise red is looked up and the LUT's color output", PS_Default | PS_Permutable);
+    REGISTER_PROPERTY_MEMORY(LUTRemapModifier, float, offsetof(LUTRemapModifier, Row), 0.5f, "Row", "Vertical position of the row of the image to use", PS_NormalRange | PS_TinyIncrement | PS_Permutable);
+    REGISTER_PROPERTY_MEMORY(LUTRemapModifier, unsigned, offsetof(LUTRemapModifier, TableSize), LookupTable::DefaultSize, "Table Size", "Number of entries (256 - 65536) the LUT is resampled into", PS_Default);
+}
+
+void LUTRemapModifier::Construct()
+{
+    AddInput("In", TEXGRAPH_CHANNEL);
+    AddOutput("Out", TEXGRAPH_CHANNEL);
+}
+
+int LUTRemapModifier::Execute(const Variant& param)
+{
+    RGBA color = GetInputSocket(0)->GetValue().getColorSafe(true);
+    if (std::shared_ptr<const LookupTable> table = GetLookupTable(0))
+        color = PerChannel ? table->GetPerChannel(color) : table->Get(color.r);
+    GetOutputSocket(0)->StoreValue(color);
+    return GRAPH_EXECUTE_COMPLETE;
+}
+
+bool LUTRemapModifier::Compile(VectorBuffer* buffer) const
+{
+    // Without an image the input passes through, which is left to Execute
+    if (!LUTData || !LUTData->GetImage())
+        return false;
+    TextureCodeWriter code(this, buffer);
+    code.Lookup(code.Out(0), code.In(0), 0, PerChannel);
+    return true;
+}
+
+std::shared_ptr<const LookupTable> LUTRemapModifier::GetLookupTable(unsigned index) const
+{
+    const FilterableBlockMap<RGBA>* image = LUTData ? LUTData->GetImage() : 0x0;
+    if (!image)
+        return std::shared_ptr<const LookupTable>();
+    if (!table_ || tableImage_ != image || tableRow_ != Row || tableSize_ != TableSize || tablePerChannel_ != PerChannel)
+    {
+        const unsigned width = image->getWidth();
+        const unsigned height = image->getHeight();
+        if (width == 0 || height == 0)
+            return std::shared_ptr<const LookupTable>();
+        const unsigned row = (unsigned)CLAMP(Row * height, 0.0f, height - 1.0f);
+        const bool perChannel = PerChannel;
+
+        // Pixel centers run from 0 to 1 across the row
+        std::shared_ptr<LookupTable> table(new LookupTable());
+        table->Bake(TableSize, [=](float position) {
+            const float x = position * (width - 1);
+            const unsigned left = (unsigned)x;
+            const unsigned right = SprueMin(left + 1, width - 1);
+            RGBA value = SprueLerp(image->get(left, row), image->get(right, row), x - left);
+            if (perChannel)
+                value.a = position;
+            return value;
+        });
+        tableImage_ = image;
+        tableRow_ = Row;
+        tableSize_ = TableSize;
+        tablePerChannel_ = PerChannel;
+        table_ = table;
+    }
+    return table_;
+}
+
 void SobelTextureModifier::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "SobelTextureModifier");
@@ -275,6 +443,26 @@ int ClipTextureModifier::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool ClipTextureModifier::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    unsigned char lowerBound = code.In(1);
+    unsigned char upperBound = code.In(2);
+    if (!inputSockets[1]->HasConnections())
+    {
+        lowerBound = code.Temp(0);
+        code.Const(lowerBound, RGBA(Range.getLowerBound(), Range.getLowerBound(), Range.getLowerBound(), Range.getLowerBound()));
+    }
+    if (!inputSockets[2]->HasConnections())
+    {
+        upperBound = code.Temp(1);
+        code.Const(upperBound, RGBA(Range.getUpperBound(), Range.getUpperBound(), Range.getUpperBound(), Range.getUpperBound()));
+    }
+    code.Op(TOP_Max, code.Temp(2), lowerBound, code.In(0));
+    code.Op(TOP_Min, code.Out(0), upperBound, code.Temp(2));
+    return true;
+}
+
 void EmbossModifier::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "EmbossModifier");
@@ -323,6 +511,7 @@ void TileModifier::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "TileModifier");
     REGISTER_PROPERTY_MEMORY(TileModifier, Vec2, offsetof(TileModifier, Tiling), Vec2(2, 2), "Tiling", "", PS_Default | PS_Permutable);
+    REGISTER_REMAP_EVALUATION(TileModifier);
 }
 
 void TileModifier::Construct()
@@ -331,17 +520,31 @@ void TileModifier::Construct()
     AddOutput("Out", TEXGRAPH_CHANNEL);
 }
 
-int TileModifier::Execute(const Variant& param)
+Variant TileModifier::FilterParameter(const Variant& parameter) const
 {
-    Vec4 coord = param.getVec4Safe();
+    Vec4 coord = parameter.getVec4Safe();
     coord.x = coord.x * Tiling.x;
     coord.y = coord.y * Tiling.y;
     coord.x -= floorf(coord.x);
     coord.y -= floorf(coord.y);
+    return coord;
+}
+
+float TileModifier::EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const
+{
+    // Partial repeats leave a seam where the coordinate wraps
+    if (Tiling.x != floorf(Tiling.x) || Tiling.y != floorf(Tiling.y))
+        return UnboundedFrequency;
+    const float input = inputFrequencies.empty() ? 0.0f : inputFrequencies[0];
+    return input * SprueMax(fabsf(Tiling.x), fabsf(Tiling.y));
+}
 
-    ForceExecuteUpstreamOnly(coord);
+int TileModifier::Execute(const Variant& param)
+{
+    const Vec4 pixel = param.getVec4Safe();
+    PrepareInputs(pixel);
     
-    GetOutputSocket(0)->StoreValue(GetInputSocket(0)->GetValue().getColorSafe(true));
+    GetOutputSocket(0)->StoreValue(SampleRemapped(0, pixel));
 
     return GRAPH_EXECUTE_COMPLETE;
 }
@@ -350,6 +553,7 @@ void TransformModifier::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "TransformModifier");
     REGISTER_PROPERTY_MEMORY(TransformModifier, Mat3x3, offsetof(TransformModifier, Matrix), Mat3x3(1, 0, 0, 0, 1, 0, 0, 0, 1), "Matrix", "", PS_Default | PS_Permutable);
+    REGISTER_REMAP_EVALUATION(TransformModifier);
 }
 
 void TransformModifier::Construct()
@@ -370,9 +574,19 @@ Variant TransformModifier::FilterParameter(const Variant& parameter) const
     return Vec4(trans.x, trans.y, coord.z, coord.w);
 }
 
+float TransformModifier::EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const
+{
+    // The Frobenius norm bounds how much the matrix can stretch any direction of the coordinate
+    const float input = inputFrequencies.empty() ? 0.0f : inputFrequencies[0];
+    const float norm = sqrtf(Matrix[0][0] * Matrix[0][0] + Matrix[0][1] * Matrix[0][1] + Matrix[1][0] * Matrix[1][0] + Matrix[1][1] * Matrix[1][1]);
+    return input * norm;
+}
+
 int TransformModifier::Execute(const Variant& param)
 {
-    RGBA color = GetInputSocket(0)->GetValue().getColorSafe(true);
+    const Vec4 pixel = param.getVec4Safe();
+    PrepareInputs(pixel);
+    RGBA color = SampleRemapped(0, pixel);
     GetOutputSocket(0)->StoreValue(color);
     GetOutputSocket(1)->StoreValue(color.r);
     return GRAPH_EXECUTE_COMPLETE;
@@ -384,6 +598,7 @@ void SimpleTransformModifier::Register(Context* context)
     REGISTER_PROPERTY_MEMORY(SimpleTransformModifier, Vec2, offsetof(SimpleTransformModifier, Offset), Vec2(), "Offset", "", PS_Default | PS_Permutable);
     REGISTER_PROPERTY_MEMORY(SimpleTransformModifier, float, offsetof(SimpleTransformModifier, Rotation), 0.0f, "Rotation", "", PS_Default | PS_Permutable);
     REGISTER_PROPERTY_MEMORY(SimpleTransformModifier, Vec2, offsetof(SimpleTransformModifier, Scale), Vec2(1, 1), "Scale", "", PS_Default | PS_Permutable);
+    REGISTER_REMAP_EVALUATION(SimpleTransformModifier);
 }
 
 void SimpleTransformModifier::Construct()
@@ -415,10 +630,17 @@ Variant SimpleTransformModifier::FilterParameter(const Variant& parameter) const
     return Vec4(transformed.x, transformed.y, truePt.z, truePt.w);
 }
 
+float SimpleTransformModifier::EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const
+{
+    const float input = inputFrequencies.empty() ? 0.0f : inputFrequencies[0];
+    return input * SprueMax(fabsf(Scale.x), fabsf(Scale.y));
+}
+
 int SimpleTransformModifier::Execute(const Variant& param)
 {
-    RGBA color = GetInputSocket(0)->GetValue().getColorSafe(true);
-    GetOutputSocket(0)->StoreValue(color);
+    const Vec4 pixel = param.getVec4Safe();
+    PrepareInputs(pixel);
+    GetOutputSocket(0)->StoreValue(SampleRemapped(0, pixel));
     return GRAPH_EXECUTE_COMPLETE;
 }
 
@@ -427,6 +649,7 @@ void CartesianToPolarModifier::Register(Context* context)
     context->CopyBaseProperties("GraphNode", "CartesianToPolarModifier");
     //REGISTER_PROPERTY_MEMORY(CartesianToPolarModifier, float, offsetof(CartesianToPolarModifier, velocity_), 0.0f, "Velocity", "Acceleration factor for creating an Archimedean spiral", PS_VisualConsequence);
     //REGISTER_PROPERTY_MEMORY(CartesianToPolarModifier, float, offsetof(CartesianToPolarModifier, spacing_), 1.0f, "Spacing Scale", "Defines that spacing for an Archimedean spiral", PS_VisualConsequence);
+    REGISTER_REMAP_EVALUATION(CartesianToPolarModifier);
 }
 
 void CartesianToPolarModifier::Construct()
@@ -450,13 +673,16 @@ Variant CartesianToPolarModifier::FilterParameter(const Variant& parameter) cons
 
 int CartesianToPolarModifier::Execute(const Variant& param)
 {
-    GetOutputSocket(0)->StoreValue(GetInputSocket(0)->GetValue());
+    const Vec4 pixel = param.getVec4Safe();
+    PrepareInputs(pixel);
+    GetOutputSocket(0)->StoreValue(SampleRemapped(0, pixel));
     return GRAPH_EXECUTE_COMPLETE;
 }
 
 void PolarToCartesianModifier::Register(Context* context)
 {
     COPY_PROPERTIES(GraphNode, PolarToCartesianModifier);
+    REGISTER_REMAP_EVALUATION(PolarToCartesianModifier);
 }
 
 void PolarToCartesianModifier::Construct()
@@ -477,7 +703,9 @@ Variant PolarToCartesianModifier::FilterParameter(const Variant& parameter) cons
 
 int PolarToCartesianModifier::Execute(const Variant& param)
 {
-    GetOutputSocket(0)->StoreValue(GetInputSocket(0)->GetValue());
+    const Vec4 pixel = param.getVec4Safe();
+    PrepareInputs(pixel);
+    GetOutputSocket(0)->StoreValue(SampleRemapped(0, pixel));
     return GRAPH_EXECUTE_COMPLETE;
 }
 
@@ -487,6 +715,7 @@ void DivModifier::Register(Context* context)
     REGISTER_PROPERTY_MEMORY(DivModifier, float, offsetof(DivModifier, Fraction), 0.5f, "Fraction", "Where the divider is placed", PS_TinyIncrement | PS_Permutable);
     REGISTER_PROPERTY_MEMORY(DivModifier, bool, offsetof(DivModifier, Vertical), false, "Vertical", "Controls how the division is oriented", PS_Default | PS_Permutable);
     REGISTER_PROPERTY_MEMORY(DivModifier, bool, offsetof(DivModifier, NormalizeCoordinates), false, "Normalize Coords.", "Upstream nodes will be reevaluated in the local space of each division", PS_Default | PS_Permutable);
+    REGISTER_REMAP_EVALUATION(DivModifier);
 }
 
 void DivModifier::Construct()
@@ -496,43 +725,30 @@ void DivModifier::Construct()
     AddOutput("Out", TEXGRAPH_CHANNEL);
 }
 
+float DivModifier::GetSampleRate(unsigned index) const
+{
+    const float fraction = CLAMP01(Fraction);
+    return index == 0 ? fraction : 1.0f - fraction;
+}
+
 int DivModifier::Execute(const Variant& param)
 {
-    Vec4 value = param.getVec4Safe();
-    if (Vertical)
-    {
-        if (value.x < Fraction)
-        {
-            if (NormalizeCoordinates)
-                value.x = NORMALIZE(value.x, 0.0f, Fraction);
-            ForceExecuteUpstreamOnly(value);
-            GetOutputSocket(0)->StoreValue(GetInputSocket(0)->GetValue());
-        }
-        else
-        {
-            if (NormalizeCoordinates)
-                value.x = NORMALIZE(value.x, Fraction, 1.0f);
-            ForceExecuteUpstreamOnly(value);
-            GetOutputSocket(0)->StoreValue(GetInputSocket(1)->GetValue());
-        }
-    }
-    else // horizontal
+    const Vec4 pixel = param.getVec4Safe();
+    PrepareInputs(pixel);
+
+    Vec4 value = pixel;
+    float& axis = Vertical ? value.x : value.y;
+    const unsigned index = axis < Fraction ? 0 : 1;
+    float footprint = 1.0f;
+    if (NormalizeCoordinates)
     {
-        if (value.y < Fraction)
-        {
-            if (NormalizeCoordinates)
-                value.y = NORMALIZE(value.y, 0.0f, Fraction);
-            ForceExecuteUpstreamOnly(value);
-            GetOutputSocket(0)->StoreValue(GetInputSocket(0)->GetValue());
-        }
-        else
-        {
-            if (NormalizeCoordinates)
-                value.y = NORMALIZE(value.y, Fraction, 1.0f);
-            ForceExecuteUpstreamOnly(value);
-            GetOutputSocket(0)->StoreValue(GetInputSocket(1)->GetValue());
-        }
+        const float lower = index == 0 ? 0.0f : Fraction;
+        const float upper = index == 0 ? Fraction : 1.0f;
+        axis = NORMALIZE(axis, lower, upper);
+        footprint = 1.0f / SprueMax(upper - lower, EPSILON);
     }
+
+    GetOutputSocket(0)->StoreValue(SampleInput(index, value, footprint));
     return GRAPH_EXECUTE_COMPLETE;
 }
 
@@ -542,6 +758,7 @@ void TrimModifier::Register(Context* context)
     REGISTER_PROPERTY_MEMORY(TrimModifier, float, offsetof(TrimModifier, TrimSize), 0.2f, "Trim Size", "The size of each piece of trim", PS_TinyIncrement | PS_Permutable);
     REGISTER_PROPERTY_MEMORY(TrimModifier, bool, offsetof(TrimModifier, Vertical), false, "Vertical", "Controls the orientation of the trim", PS_Default | PS_Permutable);
     REGISTER_PROPERTY_MEMORY(TrimModifier, bool, offsetof(TrimModifier, NormalizeCoordinates), false, "Normalize Coords.", "Upstream nodes will be evaluated based on the pixel's position in each cell", PS_Default | PS_Permutable);
+    REGISTER_REMAP_EVALUATION(TrimModifier);
 }
 
 void TrimModifier::Construct()
@@ -552,66 +769,54 @@ void TrimModifier::Construct()
     AddOutput("Out", TEXGRAPH_CHANNEL);
 }
 
+float TrimModifier::GetSampleRate(unsigned index) const
+{
+    const float trim = CLAMP(TrimSize, 0.0f, 0.5f);
+    const bool hasRightEdge = inputSockets[2]->HasConnections();
+    if (index == 0)
+        return hasRightEdge ? trim : trim * 2.0f;
+    else if (index == 1)
+        return 1.0f - trim * 2.0f;
+    return hasRightEdge ? trim : 0.0f;
+}
+
 int TrimModifier::Execute(const Variant& param)
 {
-    Vec4 coord = param.getVec4Safe();
+    const Vec4 pixel = param.getVec4Safe();
+    PrepareInputs(pixel);
 
     // do we need to ask for right edge?
     const bool hasRightEdge = GetInputSocket(2)->HasConnections();
 
-    // Vertically oriented trim
-    if (Vertical)
+    // Vertically oriented trim varies along x
+    Vec4 coord = pixel;
+    float& axis = Vertical ? coord.x : coord.y;
+
+    // inside center unless in either trim
+    unsigned index = 1;
+    float lower = TrimSize;
+    float upper = 1.0f - TrimSize;
+    if (axis <= TrimSize) // inside left trim?
     {
-        // inside left trim?
-        if (coord.x <= TrimSize)
-        {
-            if (NormalizeCoordinates)
-                coord.x = NORMALIZE(coord.x, 0.0f, TrimSize);
-            ForceExecuteUpstreamOnly(coord);
-            GetOutputSocket(0)->StoreValue(GetInputSocket(0)->GetValue());
-        }
-        else if (coord.x > 1.0f - TrimSize) // inside right trim?
-        {
-            if (NormalizeCoordinates)
-                coord.x = NORMALIZE(coord.x, 0.0f, TrimSize);
-            ForceExecuteUpstreamOnly(coord);
-            GetOutputSocket(0)->StoreValue(hasRightEdge ? GetInputSocket(2)->GetValue() : GetInputSocket(0)->GetValue());
-        }
-        else // inside center
-        {
-            if (NormalizeCoordinates)
-                coord.x = NORMALIZE(coord.x, TrimSize, 1.0f - TrimSize);
-            ForceExecuteUpstreamOnly(coord);
-            GetOutputSocket(0)->StoreValue(GetInputSocket(1)->GetValue());
-        }
+        index = 0;
+        lower = 0.0f;
+        upper = TrimSize;
     }
-    else // Horizontally oriented trim
+    else if (axis > 1.0f - TrimSize) // inside right trim?
     {
-        // inside left trim?
-        if (coord.y <= TrimSize)
-        {
-            if (NormalizeCoordinates)
-                coord.y = NORMALIZE(coord.y, 0.0f, TrimSize);
-            ForceExecuteUpstreamOnly(coord);
-            GetOutputSocket(0)->StoreValue(GetInputSocket(0)->GetValue());
-        }
-        else if (coord.y > 1.0f - TrimSize) // inside right trim?
-        {
-            if (NormalizeCoordinates)
-                coord.y = NORMALIZE(coord.y, 0.0f, TrimSize);
-            ForceExecuteUpstreamOnly(coord);
-            GetOutputSocket(0)->StoreValue(hasRightEdge ? GetInputSocket(2)->GetValue() : GetInputSocket(0)->GetValue());
-        }
-        else // inside center
-        {
-            if (NormalizeCoordinates)
-                coord.y = NORMALIZE(coord.y, TrimSize, 1.0f - TrimSize);
-            ForceExecuteUpstreamOnly(coord);
-            GetOutputSocket(0)->StoreValue(GetInputSocket(1)->GetValue());
-        }
+        index = hasRightEdge ? 2 : 0;
+        lower = 1.0f - TrimSize;
+        upper = 1.0f;
     }
 
+    float footprint = 1.0f;
+    if (NormalizeCoordinates)
+    {
+        axis = NORMALIZE(axis, lower, upper);
+        footprint = 1.0f / SprueMax(upper - lower, EPSILON);
+    }
 
+    GetOutputSocket(0)->StoreValue(SampleInput(index, coord, footprint));
     return GRAPH_EXECUTE_COMPLETE;
 }
 
@@ -619,6 +824,7 @@ void WarpModifier::Register(Context* context)
 {
     context->CopyBaseProperties("GraphNode", "WarpModifier");
     REGISTER_PROPERTY_MEMORY(WarpModifier, float, offsetof(WarpModifier, Intensity), 0.01f, "Intensity", "How large the warp's step size will be", PS_TinyIncrement | PS_Permutable);
+    REGISTER_REMAP_EVALUATION(WarpModifier);
 }
 
 void WarpModifier::Construct()
@@ -631,33 +837,16 @@ void WarpModifier::Construct()
 
 int WarpModifier::Execute(const Variant& param)
 {
-    Vec4 vec = param.getVec4Safe();
-    float x_coord = vec.x + GetInputSocket(1)->GetValue().getFloatSafe() * Intensity;
-    float x_coord_lo = (float)x_coord;
-    float x_coord_hi = x_coord_lo + 1 * Intensity;
-    float x_frac = x_coord - x_coord_lo;
-    float y_coord = vec.y + GetInputSocket(2)->GetValue().getFloatSafe() * Intensity;
-    float y_coord_lo = (float)y_coord;
-    float y_coord_hi = y_coord_lo + 1 * Intensity;
-    float y_frac = y_coord - y_coord_lo;
-
-    ForceExecuteUpstreamOnly(Vec4(x_coord_lo, y_coord_lo, vec.z, vec.w));
-    RGBA tl = GetInputSocket(0)->GetValue().getColorSafe(true);
-
-    ForceExecuteUpstreamOnly(Vec4(x_coord_hi, y_coord_lo, vec.z, vec.w));
-    RGBA tr = GetInputSocket(0)->GetValue().getColorSafe(true);
-
-    ForceExecuteUpstreamOnly(Vec4(x_coord_lo, y_coord_hi, vec.z, vec.w));
-    RGBA bl = GetInputSocket(0)->GetValue().getColorSafe(true);
+    const Vec4 pixel = param.getVec4Safe();
+    PrepareInputs(pixel);
 
-    ForceExecuteUpstreamOnly(Vec4(x_coord_hi, y_coord_hi, vec.z, vec.w));
-    RGBA br = GetInputSocket(0)->GetValue().getColorSafe(true);
+    // The perturbation is read where the pixel is, only the source is sampled at the warped coordinate
+    EvaluateInput(1, pixel);
+    EvaluateInput(2, pixel);
+    const float x_coord = pixel.x + GetInputSocket(1)->GetValue().getFloatSafe() * Intensity;
+    const float y_coord = pixel.y + GetInputSocket(2)->GetValue().getFloatSafe() * Intensity;
 
-    RGBA left = SprueLerp(tl, tr, x_frac);
-    RGBA right = SprueLerp(bl, br, x_frac);
-    RGBA result = SprueLerp(left, right, y_frac);
-
-    GetOutputSocket(0)->StoreValue(result);
+    GetOutputSocket(0)->StoreValue(SampleInput(0, Vec4(x_coord, y_coord, pixel.z, pixel.w)));
 
     return GRAPH_EXECUTE_COMPLETE;
 }
@@ -686,6 +875,13 @@ int PosterizeModifier::Execute(const Variant& param)
     return GRAPH_EXECUTE_COMPLETE;
 }
 
+bool PosterizeModifier::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.OpImm(TOP_Posterize, code.Out(0), code.In(0), (float)Range);
+    return true;
+}
+
 float PosterizeModifier::Posterize(float in)
 {
     if (Range > 1)
@@ -789,6 +985,8 @@ void SampleSizeModifier::Register(Context* context)
     COPY_PROPERTIES(GraphNode, SampleSizeModifier);
     REGISTER_PROPERTY_MEMORY(SampleSizeModifier, Vec2, offsetof(SampleSizeModifier, newSize), Vec2(128, 128), "New Size", "Size to perform sampling at", PS_VisualConsequence | PS_Permutable);
     REGISTER_PROPERTY_MEMORY(SampleSizeModifier, bool, offsetof(SampleSizeModifier, Bilinear), true, "Bilinear Filtering", "The output of this node will be filtered bilinearly", PS_VisualConsequence | PS_Permutable);
+    REGISTER_PROPERTY_MEMORY(SampleSizeModifier, bool, offsetof(SampleSizeModifier, Bicubic), false, "Bicubic Filtering", "The output of this node will be filtered with a Catmull-Rom spline, takes precedence over bilinear filtering", PS_VisualConsequence | PS_Permutable);
+    REGISTER_PROPERTY_MEMORY(SampleSizeModifier, bool, offsetof(SampleSizeModifier, KeepStepSizes), false, "Keep Step Sizes", "Upstream nodes see the resolution the output is used at, so that blur and emboss step sizes cover the same area of the texture", PS_VisualConsequence);
 }
 
 void SampleSizeModifier::Construct()
@@ -800,31 +998,234 @@ void SampleSizeModifier::Construct()
 Variant SampleSizeModifier::FilterParameter(const Variant& param) const
 {
     Vec4 p = param.getVec4Safe();
-    p.z = newSize.x;
-    p.y = newSize.y;
+    if (!KeepStepSizes)
+    {
+        p.z = newSize.x;
+        p.w = newSize.y;
+    }
     return p;
 }
 
-int SampleSizeModifier::Execute(const Variant& param)
+float SampleSizeModifier::EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const
 {
-    if (!cache)
+    // Nothing finer than the grid survives it
+    const float input = inputFrequencies.empty() ? 0.0f : inputFrequencies[0];
+    return SprueMin(input, SprueMax(newSize.x, newSize.y) * 0.5f);
+}
+
+void SampleSizeModifier::Render(const Vec2& resolution)
+{
+    const unsigned width = SprueMax((unsigned)newSize.x, 1u);
+    const unsigned height = SprueMax((unsigned)newSize.y, 1u);
+    GraphSocket* source = graph->GetUpstreamEdges().find(inputSockets[0])->second;
+    cacheResolution_ = resolution;
+    hashed_ = GraphOptimizer::HashSubgraph(graph, source, upstreamHash_);
+    scalar_ = source->typeID == TEXGRAPH_FLOAT;
+
+    std::shared_ptr<FilterableBlockMap<RGBA> > image(new FilterableBlockMap<RGBA>(width, height));
+    // A compiled program evaluates at the grid's own resolution
+    TextureProgram program;
+    const bool gridResolution = !KeepStepSizes || (resolution.x == width && resolution.y == height);
+    if (gridResolution && program.Build(source->node, std::find(source->node->outputSockets.begin(), source->node->outputSockets.end(), source) - source->node->outputSockets.begin()))
+        program.Execute(image.get());
+    else
     {
-        cache.reset(new FilterableBlockMap<RGBA>(newSize.x, newSize.y));
-        for (unsigned y = 0; y < newSize.y; ++y)
+        for (unsigned y = 0; y < height; ++y)
         {
-            for (unsigned x = 0; x < newSize.x; ++x)
+            for (unsigned x = 0; x < width; ++x)
             {
-                ForceExecuteUpstreamOnly(Vec4(((float)x) / newSize.x, ((float)y) / newSize.y, newSize.x, newSize.y));
-                cache->set(GetInputSocket(0)->GetValue().getColorSafe(), x, y);
+                ForceExecuteUpstreamOnly(Vec4(x / (float)width, y / (float)height, resolution.x, resolution.y));
+                image->set(GetInputSocket(0)->GetValue().getColorSafe(true), x, y);
             }
         }
     }
 
-    Vec2 coord = param.getVec2Safe();
-    if (Bilinear)
-        GetOutputSocket(0)->StoreValue(cache->getBilinear(coord.x, coord.y));
+    cache_.Build(image, false);
+    GraphProfiler::NoteAllocation(this, cache_.GetMemorySize());
+}
+
+void SampleSizeModifier::AdoptCaches(TextureNode* previous)
+{
+    // The grid is checked against upstream at the first evaluation, only its size and how it was rendered have to agree
+    SampleSizeModifier* source = dynamic_cast<SampleSizeModifier*>(previous);
+    if (!source || source->newSize.x != newSize.x || source->newSize.y != newSize.y || source->KeepStepSizes != KeepStepSizes)
+        return;
+
+    std::swap(cache_, source->cache_);
+    cacheResolution_ = source->cacheResolution_;
+    upstreamHash_ = source->upstreamHash_;
+    hashed_ = source->hashed_;
+    scalar_ = source->scalar_;
+}
+
+int SampleSizeModifier::Execute(const Variant& param)
+{
+    if (!GetInputSocket(0)->HasConnections())
+    {
+        GetOutputSocket(0)->StoreValue(GetInputSocket(0)->GetValue());
+        return GRAPH_EXECUTE_COMPLETE;
+    }
+
+    const Vec4 pixel = param.getVec4Safe();
+    const Vec2 resolution = KeepStepSizes ? Vec2(pixel.z, pixel.w) : newSize;
+    // Upstream edits are looked for once per render pass, whichever pixel the pass happens to start at
+    const bool newPass = graph->GetRenderPass() != checkedPass_;
+    checkedPass_ = graph->GetRenderPass();
+    if (cache_.IsEmpty() || resolution.x != cacheResolution_.x || resolution.y != cacheResolution_.y)
+        Render(resolution);
+    else if (newPass)
+    {
+        uint64_t hash = 0;
+        if (!hashed_ || !GraphOptimizer::HashSubgraph(graph, graph->GetUpstreamEdges().find(inputSockets[0])->second, hash) || hash != upstreamHash_)
+            Render(resolution);
+        else
+            GraphProfiler::NoteCacheHit(this);
+    }
+
+    RGBA value;
+    if (Bicubic)
+        value = cache_.SampleBicubic(pixel.x, pixel.y);
+    else if (Bilinear)
+        value = cache_.SampleLevel(0, pixel.x, pixel.y);
     else
-        GetOutputSocket(0)->StoreValue(cache->get(coord.x * cache->getWidth(), coord.y * cache->getHeight()));
+        value = cache_.SampleNearest(pixel.x, pixel.y);
+
+    if (scalar_)
+        GetOutputSocket(0)->StoreValue(value.r);
+    else
+        GetOutputSocket(0)->StoreValue(value);
+
+    return GRAPH_EXECUTE_COMPLETE;
+}
+
+///=================================================
+/// Frequency hint
+///=================================================
+
+void FrequencyHintModifier::Register(Context* context)
+{
+    COPY_PROPERTIES(GraphNode, FrequencyHintModifier);
+    REGISTER_PROPERTY_MEMORY(FrequencyHintModifier, float, offsetof(FrequencyHintModifier, MaxFrequency), 8.0f, "Max Frequency", "Highest number of cycles across the texture the input holds, lower values let previews evaluate the input at a reduced resolution", PS_Default);
+}
+
+void FrequencyHintModifier::Construct()
+{
+    AddInput("In", TEXGRAPH_CHANNEL);
+    AddOutput("Out", TEXGRAPH_CHANNEL);
+}
+
+int FrequencyHintModifier::Execute(const Variant& param)
+{
+    GetOutputSocket(0)->StoreValue(GetInputSocket(0)->GetValue());
+    return GRAPH_EXECUTE_COMPLETE;
+}
+
+bool FrequencyHintModifier::Compile(VectorBuffer* buffer) const
+{
+    TextureCodeWriter code(this, buffer);
+    code.Op(TOP_Move, code.Out(0), code.In(0));
+    return true;
+}
+
+void DistanceFieldModifier::Register(Context* context)
+{
+    COPY_PROPERTIES(GraphNode, DistanceFieldModifier);
+    REGISTER_PROPERTY_MEMORY(DistanceFieldModifier, float, offsetof(DistanceFieldModifier, Threshold), 0.5f, "Threshold", "Values of the mask at or above the threshold are inside", PS_NormalRange | PS_TinyIncrement | PS_Permutable);
+    REGISTER_PROPERTY_MEMORY(DistanceFieldModifier, float, offsetof(DistanceFieldModifier, Range), 0.05f, "Range", "Distance from the edge, as a fraction of the texture size, over which the outputs fall off", PS_VisualConsequence | PS_TinyIncrement | PS_Permutable);
+    REGISTER_PROPERTY_MEMORY(DistanceFieldModifier, bool, offsetof(DistanceFieldModifier, Tiling), true, "Tiling", "Distances are measured across the edges of the texture to the nearest repeat", PS_VisualConsequence | PS_Permutable);
+}
+
+void DistanceFieldModifier::Construct()
+{
+    AddInput("Mask", TEXGRAPH_FLOAT);
+    AddOutput("Distance", TEXGRAPH_FLOAT);
+    AddOutput("Bevel", TEXGRAPH_FLOAT);
+    AddOutput("Outline", TEXGRAPH_FLOAT);
+    AddOutput("Inner Glow", TEXGRAPH_FLOAT);
+    AddOutput("Outer Glow", TEXGRAPH_FLOAT);
+}
+
+void DistanceFieldModifier::CalculateField(unsigned width, unsigned height)
+{
+    width_ = width;
+    height_ = height;
+    fieldThreshold_ = Threshold;
+    fieldTiling_ = Tiling;
+    // An unconnected mask is a constant, calculated again every pass rather than hashed
+    auto edge = graph->GetUpstreamEdges().find(inputSockets[0]);
+    hashed_ = edge != graph->GetUpstreamEdges().end() && GraphOptimizer::HashSubgraph(graph, edge->second, upstreamHash_);
+
+    std::vector<bool> inside(width * height, false);
+    if (GetInputSocket(0)->HasConnections())
+    {
+        for (unsigned y = 0; y < height; ++y)
+        {
+            for (unsigned x = 0; x < width; ++x)
+            {
+                ForceExecuteUpstreamOnly(Vec4(x / (float)width, y / (float)height, width, height));
+                inside[y * width + x] = GetInputSocket(0)->GetValue().getFloatSafe() >= Threshold;
+            }
+        }
+    }
+    else
+        std::fill(inside.begin(), inside.end(), GetInputSocket(0)->GetValue().getFloatSafe() >= Threshold);
+
+    DistanceTransform::SignedDistance(inside, width, height, Tiling, field_);
+    GraphProfiler::NoteAllocation(this, sizeof(float) * width * height);
+}
+
+void DistanceFieldModifier::AdoptCaches(TextureNode* previous)
+{
+    // The field is checked against upstream at the first evaluation, as it would be here
+    DistanceFieldModifier* source = dynamic_cast<DistanceFieldModifier*>(previous);
+    if (!source || source->field_.empty())
+        return;
+
+    field_.swap(source->field_);
+    width_ = source->width_;
+    height_ = source->height_;
+    fieldThreshold_ = source->fieldThreshold_;
+    fieldTiling_ = source->fieldTiling_;
+    upstreamHash_ = source->upstreamHash_;
+    hashed_ = source->hashed_;
+}
+
+int DistanceFieldModifier::Execute(const Variant& param)
+{
+    const Vec4 coord = param.getVec4Safe();
+    const unsigned width = SprueMax((unsigned)coord.z, 1u);
+    const unsigned height = SprueMax((unsigned)coord.w, 1u);
+    // Upstream edits are looked for once per render pass, whichever pixel the pass happens to start at
+    const bool newPass = graph->GetRenderPass() != checkedPass_;
+    checkedPass_ = graph->GetRenderPass();
+    if (field_.empty() || width != width_ || height != height_ || Threshold != fieldThreshold_ || Tiling != fieldTiling_)
+        CalculateField(width, height);
+    else if (newPass)
+    {
+        uint64_t hash = 0;
+        auto edge = graph->GetUpstreamEdges().find(inputSockets[0]);
+        if (!hashed_ || edge == graph->GetUpstreamEdges().end() || !GraphOptimizer::HashSubgraph(graph, edge->second, hash) || hash != upstreamHash_)
+            CalculateField(width, height);
+        else
+            GraphProfiler::NoteCacheHit(this);
+    }
+
+    int x = (int)floorf(coord.x * width + 0.5f) % (int)width;
+    int y = (int)floorf(coord.y * height + 0.5f) % (int)height;
+    if (x < 0)
+        x += width;
+    if (y < 0)
+        y += height;
+
+    // Normalized so that 1 is Range away from the edge, positive inside
+    const float rangePixels = SprueMax(Range * SprueMax(width, height), 0.5f);
+    const float distance = field_[y * width + x] / rangePixels;
+
+    GetOutputSocket(0)->StoreValue(distance);
+    GetOutputSocket(1)->StoreValue(CLAMP(distance, 0.0f, 1.0f));
+    GetOutputSocket(2)->StoreValue(1.0f - SprueMin(fabsf(distance), 1.0f));
+    GetOutputSocket(3)->StoreValue(distance > 0.0f ? 1.0f - SprueMin(distance, 1.0f) : 0.0f);
+    GetOutputSocket(4)->StoreValue(distance < 0.0f ? 1.0f - SprueMin(-distance, 1.0f) : 0.0f);
 
     return GRAPH_EXECUTE_COMPLETE;
 }
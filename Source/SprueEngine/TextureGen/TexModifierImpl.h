@@ -1,5 +1,8 @@
 #pragma once
 
+#include <SprueEngine/Math/LookupTable.h>
+#include <SprueEngine/Resource.h>
+#include <SprueEngine/TextureGen/RemapNode.h>
 #include <SprueEngine/TextureGen/TextureNode.h>
 
 namespace SprueEngine
@@ -9,12 +12,17 @@ class SPRUE InvertTextureModifier : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(InvertTextureModifier);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 };
 
 class SPRUE SolarizeTextureModifier : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(SolarizeTextureModifier);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
+    virtual float EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const override { return UnboundedFrequency; }
     float Threshold = 0.5f;
     bool InvertLower = true;
 };
@@ -40,18 +48,72 @@ public:
     virtual bool WillForceExecute() const override { return true; }
 };
 
+/// The ramp is baked into a LookupTable, rebaked when the gradient or table size differ from those it was baked from.
 class SPRUE GradientRampTextureModifier : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(GradientRampTextureModifier);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
+    virtual std::shared_ptr<const LookupTable> GetLookupTable(unsigned index) const override;
     ColorRamp Gradient;
+    unsigned TableSize = LookupTable::DefaultSize;
+
+private:
+    mutable std::shared_ptr<const LookupTable> table_;
+    /// Properties the table was baked from, properties can be set without AttributeUpdated being called.
+    mutable ColorRamp tableGradient_;
+    mutable unsigned tableSize_ = 0;
 };
 
+/// The curves are baked into a LookupTable, rebaked when the curves or table size differ from those it was baked from.
 class SPRUE CurveTextureModifier : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(CurveTextureModifier);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
+    virtual std::shared_ptr<const LookupTable> GetLookupTable(unsigned index) const override;
     ColorCurves Curves;
+    unsigned TableSize = LookupTable::DefaultSize;
+
+private:
+    mutable std::shared_ptr<const LookupTable> table_;
+    /// Properties the table was baked from, properties can be set without AttributeUpdated being called.
+    mutable ColorCurves tableCurves_;
+    mutable unsigned tableSize_ = 0;
+};
+
+/// Remaps the input through a 1D LUT read from a row of an image, left is 0 and right is 1.
+/// Per channel each channel is looked up in the same channel of the image (alpha passes through),
+/// otherwise the red channel is looked up and the image's color returned, as a gradient map.
+/// The row is resampled into a LookupTable, resampled again when the image, row, table size or per channel setting differ from its own.
+class SPRUE LUTRemapModifier : public PreviewableNode
+{
+public:
+    IMPL_TEXTURE_NODE(LUTRemapModifier);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
+    virtual std::shared_ptr<const LookupTable> GetLookupTable(unsigned index) const override;
+
+    ResourceHandle GetLUTResourceHandle() const { return lutResourceHandle; }
+    void SetLUTResourceHandle(const ResourceHandle& handle) { lutResourceHandle = handle; }
+    std::shared_ptr<BitmapResource> GetLUTData() const { return LUTData; }
+    void SetLUTData(const std::shared_ptr<BitmapResource>& img) { LUTData = img; table_.reset(); }
+
+    std::shared_ptr<BitmapResource> LUTData;
+    ResourceHandle lutResourceHandle;
+    bool PerChannel = true;
+    float Row = 0.5f;
+    unsigned TableSize = LookupTable::DefaultSize;
+
+private:
+    mutable std::shared_ptr<const LookupTable> table_;
+    /// What the table was resampled from, properties can be set without AttributeUpdated being called.
+    mutable const FilterableBlockMap<RGBA>* tableImage_ = 0x0;
+    mutable float tableRow_ = 0.0f;
+    mutable unsigned tableSize_ = 0;
+    mutable bool tablePerChannel_ = false;
 };
 
 class SPRUE SobelTextureModifier : public SelfPreviewableNode
@@ -66,48 +128,59 @@ class SPRUE ClipTextureModifier : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(ClipTextureModifier);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
     RangedFloat Range = RangedFloat(0.0f, 1.0f);
 };
 
-class SPRUE TileModifier : public PreviewableNode
+class SPRUE TileModifier : public RemapNode
 {
 public:
     TileModifier() : Tiling(1.0f, 1.0f) { }
 
     IMPL_TEXTURE_NODE(TileModifier);
+
+    virtual Variant FilterParameter(const Variant& parameter) const override;
+    virtual float EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const override;
         
     Vec2 Tiling;
 };
 
-class SPRUE WarpModifier : public PreviewableNode
+/// Only the Warp input is remapped, the perturbation inputs are read at the pixel.
+class SPRUE WarpModifier : public RemapNode
 {
 public:
     IMPL_TEXTURE_NODE(WarpModifier);
     float Intensity = 0.01f;
+
+protected:
+    virtual bool IsRemappedInput(unsigned index) const override { return index == 0; }
 };
 
-class SPRUE TransformModifier : public PreviewableNode
+class SPRUE TransformModifier : public RemapNode
 {
 public:
     IMPL_TEXTURE_NODE(TransformModifier);
     Mat3x3 Matrix;
 
     virtual Variant FilterParameter(const Variant& parameter) const override;
+    virtual float EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const override;
 };
 
-class SPRUE SimpleTransformModifier : public PreviewableNode
+class SPRUE SimpleTransformModifier : public RemapNode
 {
 public:
     IMPL_TEXTURE_NODE(SimpleTransformModifier);
 
     virtual Variant FilterParameter(const Variant& parameter) const override;
+    virtual float EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const override;
 
     Vec2 Offset;
     Vec2 Scale = Vec2(1, 1);
     float Rotation = 0.0f;
 };
 
-class SPRUE CartesianToPolarModifier : public PreviewableNode
+class SPRUE CartesianToPolarModifier : public RemapNode
 {
 public:
     IMPL_TEXTURE_NODE(CartesianToPolarModifier);
@@ -117,7 +190,7 @@ public:
     float spacing_ = 1.0f;
 };
 
-class SPRUE PolarToCartesianModifier : public PreviewableNode
+class SPRUE PolarToCartesianModifier : public RemapNode
 {
 public:
     IMPL_TEXTURE_NODE(PolarToCartesianModifier);
@@ -125,7 +198,7 @@ public:
 };
 
 /// Divides space into two seperate partitions
-class SPRUE DivModifier : public PreviewableNode
+class SPRUE DivModifier : public RemapNode
 {
 public:
     IMPL_TEXTURE_NODE(DivModifier);
@@ -134,10 +207,11 @@ public:
     bool Vertical = false;
     bool NormalizeCoordinates = false;
 
-    virtual bool WillForceExecute() const override { return true; }
+protected:
+    virtual float GetSampleRate(unsigned index) const override;
 };
 
-class SPRUE TrimModifier : public PreviewableNode
+class SPRUE TrimModifier : public RemapNode
 {
 public:
     IMPL_TEXTURE_NODE(TrimModifier);
@@ -145,7 +219,8 @@ public:
     bool Vertical = false;
     bool NormalizeCoordinates = false;
 
-    virtual bool WillForceExecute() const override { return true; }
+protected:
+    virtual float GetSampleRate(unsigned index) const override;
 };
 
 class SPRUE EmbossModifier : public SelfPreviewableNode
@@ -163,6 +238,9 @@ class SPRUE PosterizeModifier : public PreviewableNode
 {
 public:
     IMPL_TEXTURE_NODE(PosterizeModifier);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
+    virtual float EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const override { return UnboundedFrequency; }
     unsigned Range = 8;
 
     float Posterize(float in);
@@ -181,6 +259,9 @@ public:
     virtual bool WillForceExecute() const override { return true; }
 };
 
+/// Renders its input once on a grid of New Size and filters every sample from it.
+/// The grid is rendered again when the resolution of the evaluation changes while Keep Step Sizes is set, and when the upstream graph
+/// hashes differently at the first evaluation of a render pass (Graph::BeginRenderPass).
 class SPRUE SampleSizeModifier : public PreviewableNode
 {
 public:
@@ -188,10 +269,75 @@ public:
 
     virtual Variant FilterParameter(const Variant& param) const override;
     virtual bool WillForceExecute() const override { return true; }
+    virtual void AttributeUpdated(const StringHash& attr) override { cache_.Clear(); }
+    virtual void AdoptCaches(TextureNode* previous) override;
+    virtual float EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const override;
 
     Vec2 newSize = Vec2(128, 128);
     bool Bilinear = true;
-    std::shared_ptr<FilterableBlockMap<RGBA> > cache;
+    /// Catmull-Rom filtering, sharper than bilinear when enlarging smooth content.
+    bool Bicubic = false;
+    /// Upstream nodes are evaluated with the resolution the output is consumed at rather than New Size, so that step sizes measured in pixels
+    /// (blurs, emboss) cover the same area of the texture either way. Set on the nodes ResolutionPlanner inserts.
+    bool KeepStepSizes = false;
+
+private:
+    /// Renders the input on the grid, resolution is passed upstream when KeepStepSizes is set.
+    void Render(const Vec2& resolution);
+
+    MipPyramid cache_;
+    Vec2 cacheResolution_;
+    uint64_t upstreamHash_ = 0;
+    /// Graph::GetRenderPass when the grid was last checked for upstream edits.
+    unsigned checkedPass_ = 0;
+    bool hashed_ = false;
+    bool scalar_ = false;
+};
+
+/// Passes its input through unchanged, declaring the highest frequency it holds for ResolutionPlanner.
+/// For content the planner cannot estimate, such as bitmaps and bakes known to be smooth, or to keep a branch at full resolution with a large value.
+class SPRUE FrequencyHintModifier : public PreviewableNode
+{
+public:
+    IMPL_TEXTURE_NODE(FrequencyHintModifier);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
+    virtual float EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const override { return MaxFrequency; }
+
+    /// Cycles across the texture.
+    float MaxFrequency = 8.0f;
+};
+
+/// Signed distance from the edge of a thresholded mask, the basis for bevels, outlines and glows.
+/// The mask is rendered once per evaluation resolution and transformed exactly in linear time by DistanceTransform,
+/// instead of sampling the input repeatedly per pixel as the blur and emboss based approximations do.
+/// The field is calculated again when the mask's upstream graph hashes differently at the first evaluation of a render pass.
+class SPRUE DistanceFieldModifier : public PreviewableNode
+{
+public:
+    IMPL_TEXTURE_NODE(DistanceFieldModifier);
+    virtual bool WillForceExecute() const override { return true; }
+
+    float Threshold = 0.5f;
+    float Range = 0.05f;
+    bool Tiling = true;
+
+    virtual void AdoptCaches(TextureNode* previous) override;
+
+private:
+    /// Renders the mask at the given resolution and transforms it.
+    void CalculateField(unsigned width, unsigned height);
+
+    /// Signed distance in pixels of every pixel, positive inside the mask.
+    std::vector<float> field_;
+    unsigned width_ = 0;
+    unsigned height_ = 0;
+    float fieldThreshold_ = 0.0f;
+    bool fieldTiling_ = false;
+    uint64_t upstreamHash_ = 0;
+    /// Graph::GetRenderPass when the mask was last checked for upstream edits.
+    unsigned checkedPass_ = 0;
+    bool hashed_ = false;
 };
 
 }
\ No newline at end of file
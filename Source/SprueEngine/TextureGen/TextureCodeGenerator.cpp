@@ -0,0 +1,239 @@
+#include <SprueEngine/TextureGen/TextureCodeGenerator.h>
+
+#include <SprueEngine/FString.h>
+#include <SprueEngine/Graph/Graph.h>
+#include <SprueEngine/TextureGen/TextureNode.h>
+#include <SprueEngine/TextureGen/TextureProgram.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <unordered_set>
+
+namespace SprueEngine
+{
+
+static const char* ChannelNames[] = { "r", "g", "b", "a" };
+
+/// C++ keywords and alternative tokens, none of which can name a namespace.
+static const std::unordered_set<std::string> ReservedWords = {
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch", "char", "char16_t", "char32_t",
+    "class", "compl", "const", "const_cast", "constexpr", "continue", "decltype", "default", "delete", "do", "double", "dynamic_cast", "else",
+    "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace",
+    "new", "noexcept", "not", "not_eq", "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register", "reinterpret_cast",
+    "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct", "switch", "template", "this", "thread_local",
+    "throw", "true", "try", "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while",
+    "xor", "xor_eq"
+};
+
+TextureCodeGenerator::TextureCodeGenerator()
+{
+
+}
+
+bool TextureCodeGenerator::Generate(Graph* graph, const std::string& namespaceName, const std::string& runtimeInclude)
+{
+    source_.clear();
+    errors_.clear();
+    generated_ = 0;
+    if (!graph)
+        return false;
+
+    std::stringstream ss;
+    ss << "// Generated by TextureCodeGenerator, regenerate from the texture graph rather than editing.\n";
+    ss << "#pragma once\n\n";
+    ss << "#include \"" << runtimeInclude << "\"\n\n";
+    ss << "namespace " << MakeIdentifier(namespaceName, "TextureGraph") << "\n{\n\n";
+
+    std::set<std::string> usedNames;
+    unsigned outputIndex = 0;
+    for (TextureOutputNode* node : graph->GetNodesByType<TextureOutputNode>())
+    {
+        ++outputIndex;
+        std::string identifier = MakeIdentifier(node->name, "Output" + std::to_string(outputIndex));
+        while (!usedNames.insert(identifier).second)
+            identifier += "_" + std::to_string(outputIndex);
+
+        std::string code;
+        if (GenerateOutput(node, identifier, code))
+        {
+            ss << code << "\n";
+            ++generated_;
+        }
+    }
+
+    ss << "}\n";
+    source_ = ss.str();
+    return generated_ > 0;
+}
+
+bool TextureCodeGenerator::GenerateOutput(TextureOutputNode* node, const std::string& identifier, std::string& code)
+{
+    TextureProgram program;
+    if (!program.Build(node))
+    {
+        errors_.push_back(FString("%1: the output cannot be compiled", identifier));
+        return false;
+    }
+    if (program.GetExternalCount() > 0)
+    {
+        std::unordered_set<GraphNode*> reported;
+        for (auto& external : program.externals_)
+        {
+            if (reported.insert(external.node_).second)
+                errors_.push_back(FString("%1: %2 (%3) cannot be compiled", identifier, external.node_->name.empty() ? std::string("unnamed node") : external.node_->name, std::string(external.node_->GetTypeName())));
+        }
+        return false;
+    }
+
+    std::unordered_set<unsigned char> constants;
+    for (auto& instruction : program.constants_)
+        constants.insert(instruction.dst_);
+    auto reg = [&](unsigned char index) { return std::string(constants.find(index) != constants.end() ? "k" : "r") + std::to_string(index); };
+
+    std::stringstream ss;
+    ss << "/// " << (node->name.empty() ? identifier : node->name) << "\n";
+    ss << "namespace " << identifier << "\n{\n";
+    ss << "    using namespace SprueEngine::TextureRuntime;\n\n";
+    ss << "    constexpr unsigned Width = " << node->Width << ";\n";
+    ss << "    constexpr unsigned Height = " << node->Height << ";\n";
+    ss << "    constexpr int Format = " << (int)node->Format << ";\n\n";
+
+    ss << "    inline Color Evaluate(float u, float v, float width, float height)\n    {\n";
+    for (auto& instruction : program.constants_)
+    {
+        ss << "        constexpr Color " << reg(instruction.dst_) << " = { "
+            << WriteFloat(instruction.imm_[0]) << ", " << WriteFloat(instruction.imm_[1]) << ", " << WriteFloat(instruction.imm_[2]) << ", " << WriteFloat(instruction.imm_[3]) << " };\n";
+    }
+
+    std::set<unsigned char> variables;
+    for (auto& instruction : program.code_)
+        variables.insert(instruction.dst_);
+    if (!variables.empty())
+    {
+        ss << "        Color";
+        bool first = true;
+        for (unsigned char index : variables)
+        {
+            ss << (first ? " " : ", ") << reg(index);
+            first = false;
+        }
+        ss << ";\n";
+    }
+
+    for (auto& instruction : program.code_)
+    {
+        const std::string a = reg(instruction.src_[0]);
+        const std::string b = reg(instruction.src_[1]);
+        const std::string c = reg(instruction.src_[2]);
+        const std::string d = reg(instruction.src_[3]);
+        const float* imm = instruction.imm_;
+        auto channel = [](const std::string& name, float index) { return name + "." + ChannelNames[(unsigned)index & 3]; };
+
+        ss << "        " << reg(instruction.dst_) << " = ";
+        switch (instruction.op_)
+        {
+        case TOP_Const: ss << "Make(" << WriteFloat(imm[0]) << ", " << WriteFloat(imm[1]) << ", " << WriteFloat(imm[2]) << ", " << WriteFloat(imm[3]) << ")"; break;
+        case TOP_Move: ss << a; break;
+        case TOP_Add: ss << "Add(" << a << ", " << b << ")"; break;
+        case TOP_Sub: ss << "Sub(" << a << ", " << b << ")"; break;
+        case TOP_Mul: ss << "Mul(" << a << ", " << b << ")"; break;
+        case TOP_Div: ss << "Div(" << a << ", " << b << ")"; break;
+        case TOP_Min: ss << "Min(" << a << ", " << b << ")"; break;
+        case TOP_Max: ss << "Max(" << a << ", " << b << ")"; break;
+        case TOP_Pow: ss << "Pow(" << a << ", " << b << ")"; break;
+        case TOP_Cos: ss << "Cos(" << a << ")"; break;
+        case TOP_Sin: ss << "Sin(" << a << ")"; break;
+        case TOP_Tan: ss << "Tan(" << a << ")"; break;
+        case TOP_Exp: ss << "Exp(" << a << ")"; break;
+        case TOP_Sqrt: ss << "Sqrt(" << a << ")"; break;
+        case TOP_Clamp01: ss << "Clamp01(" << a << ")"; break;
+        case TOP_Splat: ss << "Splat(" << channel(a, imm[0]) << ")"; break;
+        case TOP_Pack: ss << "Make(" << channel(a, imm[0]) << ", " << channel(b, imm[1]) << ", " << channel(c, imm[2]) << ", " << channel(d, imm[3]) << ")"; break;
+        case TOP_AverageRGB: ss << "AverageRGB(" << a << ")"; break;
+        case TOP_MinRGB: ss << "MinRGB(" << a << ")"; break;
+        case TOP_MaxRGB: ss << "MaxRGB(" << a << ")"; break;
+        case TOP_Luminance: ss << "Luminance(" << a << ")"; break;
+        case TOP_RGBToHSV: ss << "RGBToHSV(" << a << ")"; break;
+        case TOP_Normalize: ss << "Normalize(" << a << ", " << WriteFloat(imm[0]) << ", " << WriteFloat(imm[1]) << ")"; break;
+        case TOP_Denormalize: ss << "Denormalize(" << a << ", " << WriteFloat(imm[0]) << ", " << WriteFloat(imm[1]) << ")"; break;
+        case TOP_Solarize: ss << "Solarize(" << a << ", " << WriteFloat(imm[0]) << ", " << (imm[1] != 0.0f ? "true" : "false") << ")"; break;
+        case TOP_Posterize: ss << "Posterize(" << a << ", " << WriteFloat(imm[0]) << ")"; break;
+        case TOP_Blend: ss << "Blend(" << a << ", " << b << ", " << c << ".r, " << (int)imm[0] << ", " << (int)imm[1] << ")"; break;
+        case TOP_Coord: ss << "Make(u, v, width, height)"; break;
+        case TOP_Select: ss << "Select(" << a << ", " << b << ", " << c << ")"; break;
+        case TOP_Checker: ss << "Splat(Checker(" << a << ".r + " << b << ".r, " << a << ".g + " << c << ".r, " << WriteFloat(imm[0]) << ", " << WriteFloat(imm[1]) << ") ? 1.0f : 0.0f)"; break;
+        case TOP_Rows: ss << "Splat(Rows(" << a << ".r, " << a << ".g, " << b << ".r, " << WriteFloat(imm[0]) << ", " << WriteFloat(imm[1]) << ", " << (imm[2] != 0.0f ? "true" : "false") << ", " << (imm[3] != 0.0f ? "true" : "false") << "))"; break;
+        case TOP_Lookup:
+            errors_.push_back(FString("%1: lookup tables (curves, ramps and LUTs) cannot be written out", identifier));
+            return false;
+        default:
+            errors_.push_back(FString("%1: unknown instruction %2", identifier, (int)instruction.op_));
+            return false;
+        }
+        ss << ";\n";
+    }
+    ss << "        return " << reg(program.result_) << ";\n";
+    ss << "    }\n\n";
+
+    ss << "    /// Fills width * height pixels, row by row, the way TextureOutputNode would present them.\n";
+    ss << "    inline void Render(Color* pixels, unsigned width = Width, unsigned height = Height)\n    {\n";
+    ss << "        for (unsigned y = 0; y < height; ++y)\n";
+    ss << "            for (unsigned x = 0; x < width; ++x)\n";
+    ss << "                pixels[y * width + x] = Output(Evaluate(x / (float)width, y / (float)height, (float)width, (float)height), Format);\n";
+    ss << "    }\n";
+    ss << "}\n";
+
+    code = ss.str();
+    return true;
+}
+
+bool TextureCodeGenerator::WriteFile(const std::string& filePath) const
+{
+    std::ofstream file(filePath);
+    if (!file.is_open())
+        return false;
+    file << source_;
+    return file.good();
+}
+
+std::string TextureCodeGenerator::MakeIdentifier(const std::string& text, const std::string& fallback)
+{
+    std::string ret;
+    for (char c : text)
+    {
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_')
+            ret += c;
+        else if (!ret.empty() && ret.back() != '_')
+            ret += '_';
+    }
+    while (!ret.empty() && ret.back() == '_')
+        ret.pop_back();
+    if (ret.empty())
+        return fallback;
+    if (ret[0] >= '0' && ret[0] <= '9')
+        ret.insert(ret.begin(), '_');
+    else if (ReservedWords.count(ret))
+        ret += '_';
+    return ret;
+}
+
+std::string TextureCodeGenerator::WriteFloat(float value)
+{
+    if (std::isnan(value))
+        return "NAN";
+    if (std::isinf(value))
+        return value > 0 ? "HUGE_VALF" : "-HUGE_VALF";
+
+    // 9 significant digits always read back as the same float
+    char text[32];
+    snprintf(text, sizeof(text), "%.9g", value);
+    std::string ret = text;
+    if (ret.find_first_of(".e") == std::string::npos)
+        ret += ".0";
+    return ret + "f";
+}
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+
+#include <string>
+#include <vector>
+
+namespace SprueEngine
+{
+
+class Graph;
+class TextureOutputNode;
+class TextureProgram;
+
+/// Writes the outputs of a finished texture graph as C++ that evaluates them without the engine.
+/// Each TextureOutputNode is compiled into a TextureProgram whose instructions are then written out as straight-line code,
+/// with every property and unconnected socket value baked in as a constexpr constant. The generated source only includes TextureRuntime.h.
+/// Outputs depending on nodes that cannot be compiled (noise, bitmaps, blurs, bakers and the like) are reported as errors and skipped.
+class SPRUE TextureCodeGenerator
+{
+    NOCOPYDEF(TextureCodeGenerator);
+public:
+    TextureCodeGenerator();
+
+    /// Generates the source for every TextureOutputNode of the graph inside namespaceName, returns false if no output could be generated.
+    bool Generate(Graph* graph, const std::string& namespaceName, const std::string& runtimeInclude = "TextureRuntime.h");
+
+    /// The source written by the last Generate.
+    const std::string& GetSource() const { return source_; }
+    /// Reasons outputs were skipped by the last Generate.
+    const std::vector<std::string>& GetErrors() const { return errors_; }
+    /// Number of outputs written by the last Generate.
+    unsigned GetGeneratedCount() const { return generated_; }
+
+    /// Writes the source to a file.
+    bool WriteFile(const std::string& filePath) const;
+
+    /// Turns arbitrary text into a usable C++ identifier, C++ keywords get a trailing underscore.
+    static std::string MakeIdentifier(const std::string& text, const std::string& fallback);
+
+private:
+    bool GenerateOutput(TextureOutputNode* node, const std::string& identifier, std::string& code);
+    static std::string WriteFloat(float value);
+
+    std::string source_;
+    std::vector<std::string> errors_;
+    unsigned generated_ = 0;
+};
+
+}
@@ -0,0 +1,34 @@
+#include <SprueEngine/TextureGen/TextureGraphOptimizer.h>
+
+#include <SprueEngine/Core/Context.h>
+#include <SprueEngine/TextureGen/GeneralNodes.h>
+
+namespace SprueEngine
+{
+
+GraphNode* TextureGraphOptimizer::CreateConstantNode(Graph* graph, const GraphSocket* replacing, const Variant& value)
+{
+    if (value.getType() == VT_Float)
+    {
+        if (FloatNode* node = dynamic_cast<FloatNode*>(Context::GetInstance()->Create<GraphNode>("FloatNode")))
+        {
+            node->Construct();
+            node->Value = value.getFloat();
+            graph->AddNode(node, false);
+            return node;
+        }
+    }
+    else if (value.getType() == VT_Color)
+    {
+        if (ColorNode* node = dynamic_cast<ColorNode*>(Context::GetInstance()->Create<GraphNode>("ColorNode")))
+        {
+            node->Construct();
+            node->Value = value.getRGBA();
+            graph->AddNode(node, false);
+            return node;
+        }
+    }
+    return 0x0;
+}
+
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <SprueEngine/Graph/GraphOptimizer.h>
+
+namespace SprueEngine
+{
+
+/// GraphOptimizer for texture graphs, folded values become FloatNode or ColorNode constants.
+class SPRUE TextureGraphOptimizer : public GraphOptimizer
+{
+public:
+    TextureGraphOptimizer(unsigned passes = GOP_All) : GraphOptimizer(passes) { }
+
+protected:
+    virtual GraphNode* CreateConstantNode(Graph* graph, const GraphSocket* replacing, const Variant& value) override;
+};
+
+}
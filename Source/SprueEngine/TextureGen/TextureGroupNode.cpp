@@ -0,0 +1,292 @@
+#include "TextureGroupNode.h"
+
+#include <SprueEngine/Core/Context.h>
+#include <SprueEngine/FString.h>
+#include <SprueEngine/GeneralUtility.h>
+#include <SprueEngine/Graph/Graph.h>
+#include <SprueEngine/Graph/GraphOptimizer.h>
+#include <SprueEngine/Graph/GraphProfiler.h>
+#include <SprueEngine/Graph/GraphSocket.h>
+#include <SprueEngine/TextureGen/TextureProgram.h>
+#include <SprueEngine/VectorBuffer.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace SprueEngine
+{
+
+/// Nearest pixel of the image for the coordinate, wrapping outside of 0-1. Pixels are evaluated at x / width, rounding recovers them exactly.
+static const RGBA& SampleNearest(const FilterableBlockMap<RGBA>* image, const Vec4& coord)
+{
+    const int width = image->getWidth();
+    const int height = image->getHeight();
+    int x = (int)floorf(coord.x * width + 0.5f) % width;
+    int y = (int)floorf(coord.y * height + 0.5f) % height;
+    if (x < 0)
+        x += width;
+    if (y < 0)
+        y += height;
+    return image->get(x, y);
+}
+
+///=================================================
+/// Group input
+///=================================================
+
+void TextureGroupInputNode::Register(Context* context)
+{
+    context->CopyBaseProperties("GraphNode", "TextureGroupInputNode");
+    REGISTER_PROPERTY_MEMORY(TextureGroupInputNode, unsigned, offsetof(TextureGroupInputNode, Index), 0, "Index", "Which input socket of the group this node outputs", PS_Default);
+    REGISTER_PROPERTY_MEMORY(TextureGroupInputNode, RGBA, offsetof(TextureGroupInputNode, DefaultValue), RGBA(0, 0, 0, 1), "Default Value", "Output when the graph is evaluated on its own rather than as a group", PS_TinyIncrement);
+}
+
+void TextureGroupInputNode::Construct()
+{
+    AddOutput("Out", TEXGRAPH_CHANNEL);
+}
+
+int TextureGroupInputNode::Execute(const Variant& param)
+{
+    if (Image && Image->getWidth() && Image->getHeight())
+        GetOutputSocket(0)->StoreValue(SampleNearest(Image.get(), param.getVec4Safe()));
+    else
+        GetOutputSocket(0)->StoreValue(DefaultValue);
+    return GRAPH_EXECUTE_COMPLETE;
+}
+
+///=================================================
+/// Group
+///=================================================
+
+void TextureGroupNode::Register(Context* context)
+{
+    context->CopyBaseProperties("GraphNode", "TextureGroupNode");
+    REGISTER_RESOURCE(TextureGroupNode, TextureGraphResource, GetGroupResourceHandle, SetGroupResourceHandle, GetGroupData, SetGroupData, ResourceHandle("TextureGraph"), "Group", "Texture graph used as the group, its group input nodes and outputs become the sockets of this node", PS_Default);
+}
+
+void TextureGroupNode::Construct()
+{
+    // Sockets come from the group
+}
+
+bool TextureGroupNode::Deserialize(Deserializer* src, const SerializationContext& context)
+{
+    // The sockets are read back with the node, the group must not add its own while its property is loaded
+    deserializing_ = true;
+    const bool ret = PreviewableNode::Deserialize(src, context);
+    deserializing_ = false;
+    return ret;
+}
+
+#ifndef SPRUE_NO_XML
+bool TextureGroupNode::Deserialize(tinyxml2::XMLElement* element, const SerializationContext& context)
+{
+    deserializing_ = true;
+    const bool ret = PreviewableNode::Deserialize(element, context);
+    deserializing_ = false;
+    return ret;
+}
+#endif
+
+void TextureGroupNode::SetGroupData(const std::shared_ptr<TextureGraphResource>& group)
+{
+    GroupData = group;
+    images_.reset();
+    // Materialized again at the next evaluation whatever its resolution
+    width_ = height_ = 0;
+    keyed_ = false;
+    if (!deserializing_)
+        RebuildSockets();
+}
+
+void TextureGroupNode::RebuildSockets()
+{
+    if (graph)
+        graph->DisconnectAll(this);
+    for (GraphSocket* socket : inputSockets)
+        delete socket;
+    for (GraphSocket* socket : outputSockets)
+        delete socket;
+    inputSockets.clear();
+    outputSockets.clear();
+
+    if (!GroupData || !GroupData->GetGraph())
+        return;
+
+    // Indices may have gaps, every index up to the largest gets a socket
+    const Graph* group = GroupData->GetGraph();
+    std::vector<std::string> inputNames;
+    for (TextureGroupInputNode* input : group->GetNodesByType<TextureGroupInputNode>())
+    {
+        if (input->Index >= inputNames.size())
+            inputNames.resize(input->Index + 1);
+        if (inputNames[input->Index].empty())
+            inputNames[input->Index] = input->name.empty() ? FString("Input %1", input->Index + 1).str() : input->name;
+    }
+    for (const std::string& name : inputNames)
+        AddInput(name, TEXGRAPH_CHANNEL);
+
+    unsigned outputIndex = 0;
+    for (TextureOutputNode* output : group->GetNodesByType<TextureOutputNode>())
+    {
+        ++outputIndex;
+        AddOutput(output->name.empty() ? FString("Output %1", outputIndex).str() : output->name, TEXGRAPH_CHANNEL);
+    }
+}
+
+bool TextureGroupNode::BuildKey(unsigned width, unsigned height, uint64_t& key) const
+{
+    if (!graph)
+        return false;
+
+    std::string signature;
+    auto append = [&signature](const void* data, size_t size) { signature.append((const char*)data, size); };
+    const uint64_t contentHash = GroupData->GetContentHash();
+    append(&contentHash, sizeof(contentHash));
+    append(&width, sizeof(width));
+    append(&height, sizeof(height));
+
+    for (GraphSocket* socket : inputSockets)
+    {
+        auto edge = graph->GetUpstreamEdges().find(socket);
+        if (edge != graph->GetUpstreamEdges().end())
+        {
+            uint64_t upstream = 0;
+            if (!GraphOptimizer::HashSubgraph(graph, edge->second, upstream))
+                return false;
+            signature.push_back('e');
+            append(&upstream, sizeof(upstream));
+        }
+        else
+        {
+            VectorBuffer buffer;
+            if (!socket->GetValue().Write(&buffer))
+                return false;
+            signature.push_back('v');
+            if (buffer.GetSize())
+                append(buffer.GetData(), buffer.GetSize());
+        }
+    }
+
+    key = HashBytes64(signature.data(), signature.size());
+    return true;
+}
+
+void TextureGroupNode::Materialize(unsigned width, unsigned height)
+{
+    images_.reset();
+    width_ = width;
+    height_ = height;
+    keyed_ = false;
+    cacheHit_ = false;
+    if (!GroupData || !GroupData->GetGraph())
+        return;
+
+    uint64_t key = 0;
+    const bool shared = BuildKey(width, height, key);
+    key_ = key;
+    keyed_ = shared;
+    if (shared)
+    {
+        if ((images_ = GroupData->GetCachedImages(key)))
+        {
+            cacheHit_ = true;
+            GraphProfiler::NoteCacheHit(this);
+            return;
+        }
+    }
+
+    // Cloning goes through the context's factories, one group at a time
+    static std::mutex cloneMutex;
+    Graph* clone = 0x0;
+    {
+        std::lock_guard<std::mutex> lock(cloneMutex);
+        clone = (Graph*)GroupData->GetGraph()->Clone();
+    }
+    if (!clone)
+        return;
+
+    // Render the bound inputs
+    std::vector<std::shared_ptr<FilterableBlockMap<RGBA> > > inputs(inputSockets.size());
+    for (auto& input : inputs)
+        input.reset(new FilterableBlockMap<RGBA>(width, height));
+    if (!inputs.empty())
+    {
+        for (unsigned y = 0; y < height; ++y)
+        {
+            for (unsigned x = 0; x < width; ++x)
+            {
+                ForceExecuteUpstreamOnly(Vec4(x / (float)width, y / (float)height, width, height));
+                for (unsigned i = 0; i < inputSockets.size(); ++i)
+                    inputs[i]->set(inputSockets[i]->GetValue().getColorSafe(true), x, y);
+            }
+        }
+    }
+    for (TextureGroupInputNode* input : clone->GetNodesByType<TextureGroupInputNode>())
+        if (input->Index < inputs.size())
+            input->Image = inputs[input->Index];
+
+    // Render every output unclipped, as the value of an output socket
+    std::shared_ptr<TextureGraphResource::ImageSet> images(new TextureGraphResource::ImageSet());
+    for (TextureOutputNode* output : clone->GetNodesByType<TextureOutputNode>())
+    {
+        clone->BeginRenderPass();
+        std::shared_ptr<FilterableBlockMap<RGBA> > image(new FilterableBlockMap<RGBA>(width, height));
+        TextureProgram program;
+        if (program.Build(output))
+            program.Execute(image.get());
+        else
+        {
+            unsigned ctx = 0;
+            for (unsigned y = 0; y < height; ++y)
+            {
+                for (unsigned x = 0; x < width; ++x)
+                {
+                    ctx = y * width + x + 1;
+                    output->ExecuteUpstream(ctx, Vec4(x / (float)width, y / (float)height, width, height));
+                    image->set(output->GetOutputSocket(0)->GetValue().getColorSafe(true), x, y);
+                }
+            }
+        }
+        images->push_back(image);
+    }
+    GraphProfiler::NoteAllocation(this, sizeof(RGBA) * width * height * (inputs.size() + images->size()));
+
+    {
+        std::lock_guard<std::mutex> lock(cloneMutex);
+        delete clone;
+    }
+
+    images_ = images;
+    if (shared)
+        GroupData->CacheImages(key, images_);
+}
+
+int TextureGroupNode::Execute(const Variant& param)
+{
+    const Vec4 coord = param.getVec4Safe();
+    const unsigned width = SprueMax((unsigned)coord.z, 1u);
+    const unsigned height = SprueMax((unsigned)coord.w, 1u);
+    // Upstream edits are looked for once per render pass, a failed materialization is retried then rather than for every pixel
+    const bool newPass = graph && graph->GetRenderPass() != checkedPass_;
+    if (graph)
+        checkedPass_ = graph->GetRenderPass();
+    if (width != width_ || height != height_)
+        Materialize(width, height);
+    else if (newPass)
+    {
+        // Bound inputs are hashed into the key, an edit upstream of them changes it
+        uint64_t key = 0;
+        if (!keyed_ || !BuildKey(width, height, key) || key != key_)
+            Materialize(width, height);
+    }
+    if (!images_)
+        return GRAPH_EXECUTE_COMPLETE;
+
+    for (unsigned i = 0; i < outputSockets.size() && i < images_->size(); ++i)
+        outputSockets[i]->StoreValue(SampleNearest((*images_)[i].get(), coord));
+    return GRAPH_EXECUTE_COMPLETE;
+}
+
+}
@@ -1,8 +1,75 @@
 #pragma once
 
+#include <SprueEngine/TextureGen/TextureNode.h>
+#include <SprueEngine/Loaders/TextureGraphLoader.h>
+
+#include <cstdint>
+
 namespace SprueEngine
 {
 
+/// Inside a group library graph, outputs whatever is bound to the group's input socket of the same index.
+/// When the library graph is evaluated on its own the default value is output instead.
+class SPRUE TextureGroupInputNode : public TextureNode
+{
+public:
+    IMPL_TEXTURE_NODE(TextureGroupInputNode);
+
+    unsigned Index = 0;
+    RGBA DefaultValue = RGBA(0, 0, 0, 1);
+    /// Bound input, sampled at the nearest pixel. Set by TextureGroupNode on the clone it evaluates.
+    std::shared_ptr<FilterableBlockMap<RGBA> > Image;
+};
+
+/// Evaluates a group library graph (a .texg or .xml texture graph) in place of a node. Every TextureGroupInputNode of the library
+/// becomes an input socket and every TextureOutputNode an output socket.
+/// The group is materialized once at the resolution it is evaluated at: its bound inputs are rendered into images, a clone of the
+/// library graph renders every output, and the node then only looks up pixels. Materialized results are stored in the library resource
+/// keyed by a hash of the library file, of everything upstream of each bound input and of the resolution, so identical instances,
+/// in one document or several documents using the same library, render the group once. The key is built again at the first evaluation
+/// of every render pass (Graph::BeginRenderPass), so edits upstream of bound inputs materialize the group again.
+class SPRUE TextureGroupNode : public PreviewableNode
+{
+public:
+    IMPL_TEXTURE_NODE(TextureGroupNode);
+    virtual bool WillForceExecute() const override { return true; }
+
+    virtual bool Deserialize(Deserializer* src, const SerializationContext& context) override;
+#ifndef SPRUE_NO_XML
+    virtual bool Deserialize(tinyxml2::XMLElement* element, const SerializationContext& context) override;
+#endif
+
+    ResourceHandle GetGroupResourceHandle() const { return groupResourceHandle; }
+    void SetGroupResourceHandle(const ResourceHandle& handle) { groupResourceHandle = handle; }
+    std::shared_ptr<TextureGraphResource> GetGroupData() const { return GroupData; }
+    /// Changing the group replaces the sockets to match it, disconnecting everything.
+    void SetGroupData(const std::shared_ptr<TextureGraphResource>& group);
+
+    /// Recreates the sockets from the group's input and output nodes.
+    void RebuildSockets();
+
+    /// Returns true if the last materialization was found in the library's cache.
+    bool WasCacheHit() const { return cacheHit_; }
+
+    std::shared_ptr<TextureGraphResource> GroupData;
+    ResourceHandle groupResourceHandle;
+
+private:
+    /// Renders or fetches the outputs of the group at the given resolution.
+    void Materialize(unsigned width, unsigned height);
+    /// Hashes everything the group's outputs depend on, returns false if some bound input cannot be hashed exactly.
+    bool BuildKey(unsigned width, unsigned height, uint64_t& key) const;
 
+    std::shared_ptr<const TextureGraphResource::ImageSet> images_;
+    unsigned width_ = 0;
+    unsigned height_ = 0;
+    /// BuildKey of the last materialization, valid if keyed_.
+    uint64_t key_ = 0;
+    /// Graph::GetRenderPass when the key was last checked for upstream edits.
+    unsigned checkedPass_ = 0;
+    bool keyed_ = false;
+    bool cacheHit_ = false;
+    bool deserializing_ = false;
+};
 
-}
\ No newline at end of file
+}
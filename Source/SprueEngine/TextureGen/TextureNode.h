@@ -8,6 +8,9 @@
 namespace SprueEngine
 {
 
+class LookupTable;
+class VectorBuffer;
+
 #define TEXGRAPH_RGBA   (1)
 #define TEXGRAPH_FLOAT  (1 << 1)
 #define TEXGRAPH_MASK (1 << 2)
@@ -22,6 +25,23 @@ class SPRUE TextureNode : public GraphNode
 public:
     static Vec4 Make4D(Vec2 coord, Vec2 tiling);
     static float CalculateStepSize(float stepSize, const Vec4& coordinates);
+
+    /// Returns a lookup table the node's compiled code refers to by index with TOP_Lookup, baked if out of date.
+    virtual std::shared_ptr<const LookupTable> GetLookupTable(unsigned index) const { return std::shared_ptr<const LookupTable>(); }
+
+    /// EstimateFrequency of content with no known limit, such as hard edges.
+    static const float UnboundedFrequency;
+    /// Returns the highest spatial frequency, in cycles across the texture, the output can hold given the highest frequencies of the inputs
+    /// (0 for unconnected inputs) when evaluated at the given resolution. Used by ResolutionPlanner to find branches that a coarser grid represents.
+    /// The default sums the inputs for pointwise nodes and is unbounded for everything else.
+    virtual float EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const;
+    /// Frequency of lattice noise repeating period times across the texture, octaves each lacunarity times finer than the last.
+    static float LatticeNoiseFrequency(const Vec2& period, unsigned octaves = 1, float lacunarity = 2.0f);
+
+    /// OVERRIDE for nodes that materialize their inputs, to take over what previous, the same node in an earlier clone of the graph, materialized.
+    /// What is taken over is checked against upstream at the first evaluation of the next render pass. Called by hosts that keep a clone
+    /// resident (TexGraphService) before deleting previous.
+    virtual void AdoptCaches(TextureNode* previous) { }
 };
 
 class SPRUE PreviewableNode : public TextureNode
@@ -29,6 +49,7 @@ class SPRUE PreviewableNode : public TextureNode
 public:
     virtual bool CanPreview() const override { return true; }
     virtual std::shared_ptr<FilterableBlockMap<RGBA>> GetPreview(unsigned width = TEXGRAPH_PREVIEW_SIZE, unsigned height = TEXGRAPH_PREVIEW_SIZE) override;
+    virtual std::shared_ptr<FilterableBlockMap<RGBA>> GetPreviewRegion(unsigned width, unsigned height, unsigned left, unsigned top, unsigned regionWidth, unsigned regionHeight) override;
 };
 
 class SPRUE SelfPreviewableNode : public TextureNode
@@ -36,6 +57,7 @@ class SPRUE SelfPreviewableNode : public TextureNode
 public:
     virtual bool CanPreview() const override { return true; }
     virtual std::shared_ptr<FilterableBlockMap<RGBA>> GetPreview(unsigned width = TEXGRAPH_PREVIEW_SIZE, unsigned height = TEXGRAPH_PREVIEW_SIZE) override;
+    virtual std::shared_ptr<FilterableBlockMap<RGBA>> GetPreviewRegion(unsigned width, unsigned height, unsigned left, unsigned top, unsigned regionWidth, unsigned regionHeight) override;
 };
 
 enum TexGenOutputType
@@ -63,6 +85,8 @@ class SPRUE TextureOutputNode : public TextureNode
 {
 public:
     IMPL_TEXTURE_NODE(TextureOutputNode);
+    virtual bool IsPointwise() const override { return true; }
+    virtual bool Compile(VectorBuffer* buffer) const override;
 
     TexGenOutputType OutputType;
     TexGenOutputFormat Format;
@@ -72,9 +96,12 @@ public:
 
     virtual bool CanPreview() const override { return true; }
     virtual std::shared_ptr<FilterableBlockMap<RGBA>> GetPreview(unsigned width = TEXGRAPH_PREVIEW_SIZE, unsigned height = TEXGRAPH_PREVIEW_SIZE) override;
+    virtual std::shared_ptr<FilterableBlockMap<RGBA>> GetPreviewRegion(unsigned width, unsigned height, unsigned left, unsigned top, unsigned regionWidth, unsigned regionHeight) override;
 };
 
 class Context;
 void RegisterTextureNodes(Context*);
+/// Type names of every node factory added by RegisterTextureNodes, in registration order. Empty until RegisterTextureNodes has run.
+const std::vector<std::string>& GetTextureNodeTypeNames();
 
 }
\ No newline at end of file
@@ -9,9 +9,14 @@
 #include "NormalMapNodes.h"
 #include "PatternGen.h"
 #include "PBRNodes.h"
+#include "ReductionNodes.h"
 #include "SpecializedGen.h"
 #include "TexGenImpl.h"
 #include "TexModifierImpl.h"
+#include "TextureGroupNode.h"
+#include "TextureProgram.h"
+
+#include <cfloat>
 
 namespace SprueEngine
 {
@@ -36,9 +41,42 @@ namespace SprueEngine
         return (1.0f / Vec2(coordinates.z, coordinates.w).MaxElement()) * stepSize;
     }
 
+    const float TextureNode::UnboundedFrequency = FLT_MAX;
+
+    float TextureNode::EstimateFrequency(unsigned outputIndex, const std::vector<float>& inputFrequencies, const Vec2& resolution) const
+    {
+        if (!IsPointwise())
+            return UnboundedFrequency;
+        // Multiplying inputs adds their frequencies, the sum bounds any product of them
+        float ret = 0.0f;
+        for (float frequency : inputFrequencies)
+            ret = SprueMin(ret + frequency, UnboundedFrequency);
+        return ret;
+    }
+
+    float TextureNode::LatticeNoiseFrequency(const Vec2& period, unsigned octaves, float lacunarity)
+    {
+        // Interpolated lattice noise keeps nearly all of its energy below two cycles per lattice cell
+        return fabsf(period.MaxElement()) * 2.0f * powf(SprueMax(fabsf(lacunarity), 1.0f), (float)(SprueMax(octaves, 1u) - 1));
+    }
+
     std::shared_ptr<FilterableBlockMap<RGBA>> PreviewableNode::GetPreview(unsigned width, unsigned height)
     {
         std::shared_ptr<FilterableBlockMap<RGBA>> ret(new FilterableBlockMap<RGBA>(width, height));
+        if (graph)
+            graph->BeginRenderPass();
+
+        // Pointwise chains run as bytecode a tile at a time
+        TextureProgram program;
+        if (program.Build(this))
+        {
+            program.Execute(ret.get());
+            for (unsigned y = 0; y < height; ++y)
+                for (unsigned x = 0; x < width; ++x)
+                    ret->get(x, y).Clip();
+            return ret;
+        }
+
         unsigned ctx = 0;
         for (unsigned y = 0; y < height; ++y)
         {
@@ -59,6 +97,37 @@ namespace SprueEngine
         return ret;
     }
 
+    std::shared_ptr<FilterableBlockMap<RGBA>> PreviewableNode::GetPreviewRegion(unsigned width, unsigned height, unsigned left, unsigned top, unsigned regionWidth, unsigned regionHeight)
+    {
+        std::shared_ptr<FilterableBlockMap<RGBA>> ret(new FilterableBlockMap<RGBA>(regionWidth, regionHeight));
+        if (graph)
+            graph->BeginRenderPass();
+
+        TextureProgram program;
+        if (program.Build(this))
+            program.Execute(ret.get(), width, height, left, top);
+        else
+        {
+            // Counted rather than derived from the pixel so that no two pixels of the region share a context
+            unsigned ctx = 1;
+            for (unsigned y = 0; y < regionHeight; ++y)
+            {
+                for (unsigned x = 0; x < regionWidth; ++x, ++ctx)
+                {
+                    unsigned pixelCtx = ctx;
+                    ExecuteUpstream(pixelCtx, Vec4((left + x) / (float)width, (top + y) / (float)height, width, height));
+                    if (GraphSocket* socket = GetOutputSocket(0))
+                        ret->set(socket->GetValue().getColorSafe(true), x, y);
+                }
+            }
+        }
+
+        for (unsigned y = 0; y < regionHeight; ++y)
+            for (unsigned x = 0; x < regionWidth; ++x)
+                ret->get(x, y).Clip();
+        return ret;
+    }
+
     std::shared_ptr<FilterableBlockMap<RGBA>> SelfPreviewableNode::GetPreview(unsigned width, unsigned height)
     {
         std::shared_ptr<FilterableBlockMap<RGBA>> ret(new FilterableBlockMap<RGBA>(width, height));
@@ -80,6 +149,27 @@ namespace SprueEngine
         return ret;
     }
 
+    std::shared_ptr<FilterableBlockMap<RGBA>> SelfPreviewableNode::GetPreviewRegion(unsigned width, unsigned height, unsigned left, unsigned top, unsigned regionWidth, unsigned regionHeight)
+    {
+        std::shared_ptr<FilterableBlockMap<RGBA>> ret(new FilterableBlockMap<RGBA>(regionWidth, regionHeight));
+
+        for (unsigned y = 0; y < regionHeight; ++y)
+        {
+            for (unsigned x = 0; x < regionWidth; ++x)
+            {
+                Execute(Vec4((left + x) / (float)width, (top + y) / (float)height, width, height));
+                if (GraphSocket* socket = GetOutputSocket(0))
+                {
+                    RGBA color = socket->GetValue().getColorSafe(true);
+                    color.Clip();
+                    ret->set(color, x, y);
+                }
+            }
+        }
+
+        return ret;
+    }
+
     static const char* TEXGEN_OUTPUT_TYPE_NAMES[] = {
         "Albedo",
         "Roughness",
@@ -126,9 +216,40 @@ namespace SprueEngine
         return GRAPH_EXECUTE_COMPLETE;
     }
 
+    bool TextureOutputNode::Compile(VectorBuffer* buffer) const
+    {
+        TextureCodeWriter code(this, buffer);
+        if (!inputSockets[0]->HasConnections())
+            code.Const(code.Out(0), DefaultColor);
+        else
+            code.Op(TOP_Move, code.Out(0), code.In(0));
+        return true;
+    }
+
     std::shared_ptr<FilterableBlockMap<RGBA>> TextureOutputNode::GetPreview(unsigned width, unsigned height)
     {
         std::shared_ptr<FilterableBlockMap<RGBA>> ret(new FilterableBlockMap<RGBA>(width, height));
+        if (graph)
+            graph->BeginRenderPass();
+
+        TextureProgram program;
+        if (program.Build(this))
+        {
+            program.Execute(ret.get());
+            for (unsigned y = 0; y < height; ++y)
+            {
+                for (unsigned x = 0; x < width; ++x)
+                {
+                    RGBA& color = ret->get(x, y);
+                    color.Clip();
+                    if (Format == TGOF_RGB)
+                        color.a = 1.0f;
+                    if (Format == TGOF_Alpha)
+                        color = RGBA(color.r, color.r, color.r);
+                }
+            }
+            return ret;
+        }
 
         unsigned ctx = 0;
         for (unsigned y = 0; y < width; ++y)
@@ -155,10 +276,58 @@ namespace SprueEngine
         return ret;
     }
 
-#define REG(NAME, TIP) context->RegisterFactory<NAME>( #NAME, #TIP ); NAME::Register(context)
+    std::shared_ptr<FilterableBlockMap<RGBA>> TextureOutputNode::GetPreviewRegion(unsigned width, unsigned height, unsigned left, unsigned top, unsigned regionWidth, unsigned regionHeight)
+    {
+        std::shared_ptr<FilterableBlockMap<RGBA>> ret(new FilterableBlockMap<RGBA>(regionWidth, regionHeight));
+        if (graph)
+            graph->BeginRenderPass();
+
+        TextureProgram program;
+        if (program.Build(this))
+            program.Execute(ret.get(), width, height, left, top);
+        else
+        {
+            unsigned ctx = 1;
+            for (unsigned y = 0; y < regionHeight; ++y)
+            {
+                for (unsigned x = 0; x < regionWidth; ++x, ++ctx)
+                {
+                    unsigned pixelCtx = ctx;
+                    ExecuteUpstream(pixelCtx, Vec4((left + x) / (float)width, (top + y) / (float)height, width, height));
+                    if (GraphSocket* socket = GetOutputSocket(0))
+                        ret->set(socket->GetValue().getColorSafe(true), x, y);
+                }
+            }
+        }
+
+        for (unsigned y = 0; y < regionHeight; ++y)
+        {
+            for (unsigned x = 0; x < regionWidth; ++x)
+            {
+                RGBA& color = ret->get(x, y);
+                color.Clip();
+                if (Format == TGOF_RGB)
+                    color.a = 1.0f;
+                if (Format == TGOF_Alpha)
+                    color = RGBA(color.r, color.r, color.r);
+            }
+        }
+        return ret;
+    }
+
+    static std::vector<std::string> TextureNodeTypeNames;
+
+    const std::vector<std::string>& GetTextureNodeTypeNames()
+    {
+        return TextureNodeTypeNames;
+    }
+
+#define REG(NAME, TIP) context->RegisterFactory<NAME>( #NAME, #TIP ); NAME::Register(context); TextureNodeTypeNames.push_back( #NAME )
 
     void RegisterTextureNodes(Context* context)
     {
+        TextureNodeTypeNames.clear();
+
         REG(TextureOutputNode, "Final rendition into a texture");
 
         // General Nodes
@@ -216,6 +385,7 @@ namespace SprueEngine
         // Modifiers and Filters
         REG(ClipTextureModifier, "Clips the input to the specified range");
         REG(CurveTextureModifier, "Applies free-form curves to the input channels");
+        REG(LUTRemapModifier, "Remaps the input through a 1D lookup table read from an image");
         REG(EmbossModifier, "Creates a beveling and emboss effect on the input");
         REG(GradientRampTextureModifier, "Remaps the input to a color gradient");
         REG(InvertTextureModifier, "Returns the inverted value of the input");
@@ -241,6 +411,17 @@ namespace SprueEngine
         REG(SampleSizeModifier, "Performs up/down sampling by processing the graph at lower or higher resolutions");
         REG(CartesianToPolarModifier, "");
         REG(PolarToCartesianModifier, "");
+        REG(DistanceFieldModifier, "Outputs the exact signed distance from the edge of a mask, with bevel, outline and glow profiles");
+        REG(FrequencyHintModifier, "Passes the input through, declaring how much detail it holds so previews can evaluate it at a reduced resolution");
+
+        // Image-wide statistics
+        REG(NormalizeModifier, "Stretches the range of the whole input to fill 0 - 1");
+        REG(AutoLevelsModifier, "Stretches the input so that its darkest and brightest percentiles become black and white");
+        REG(HistogramEqualizeModifier, "Evenly redistributes the values of the input across 0 - 1");
+
+        // Groups
+        REG(TextureGroupNode, "Evaluates a texture graph file as a reusable group, identical instances share one result");
+        REG(TextureGroupInputNode, "Inside a group graph, outputs the value bound to one of the group's inputs");
 
         // Baker Nodes
         TextureBakerNode::Register(context);
@@ -0,0 +1,575 @@
+#include "TextureProgram.h"
+
+#include <SprueEngine/Graph/Graph.h>
+#include <SprueEngine/Graph/GraphNode.h>
+#include <SprueEngine/Graph/GraphSocket.h>
+#include <SprueEngine/Math/LookupTable.h>
+#include <SprueEngine/Math/MathDef.h>
+#include <SprueEngine/TextureGen/GeneralNodes.h>
+#include <SprueEngine/TextureGen/TextureRuntime.h>
+#include <SprueEngine/VectorBuffer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace SprueEngine
+{
+
+/// Number of source registers read by each opcode.
+static const unsigned OperandCounts[TOP_Count] = {
+    0, // TOP_Const
+    1, // TOP_Move
+    2, // TOP_Add
+    2, // TOP_Sub
+    2, // TOP_Mul
+    2, // TOP_Div
+    2, // TOP_Min
+    2, // TOP_Max
+    2, // TOP_Pow
+    1, // TOP_Cos
+    1, // TOP_Sin
+    1, // TOP_Tan
+    1, // TOP_Exp
+    1, // TOP_Sqrt
+    1, // TOP_Clamp01
+    1, // TOP_Splat
+    4, // TOP_Pack
+    1, // TOP_AverageRGB
+    1, // TOP_MinRGB
+    1, // TOP_MaxRGB
+    1, // TOP_Luminance
+    1, // TOP_RGBToHSV
+    1, // TOP_Normalize
+    1, // TOP_Denormalize
+    1, // TOP_Solarize
+    1, // TOP_Posterize
+    3, // TOP_Blend
+    0, // TOP_Coord
+    3, // TOP_Select
+    3, // TOP_Checker
+    2, // TOP_Rows
+    1, // TOP_Lookup
+};
+
+static const unsigned MaxRegisters = 256;
+
+TextureCodeWriter::TextureCodeWriter(const GraphNode* node, VectorBuffer* buffer) :
+    node_(node),
+    buffer_(buffer),
+    inputCount_(node->inputSockets.size()),
+    outputCount_(node->outputSockets.size())
+{
+
+}
+
+bool TextureCodeWriter::InputFedBy(unsigned index, unsigned typeID) const
+{
+    GraphSocket* socket = node_->inputSockets[index];
+    for (auto connection : socket->GetConnections())
+    {
+        const GraphSocket* upstream = connection.first == socket ? connection.second : connection.first;
+        if (upstream->typeID != typeID)
+            return false;
+    }
+    return true;
+}
+
+void TextureCodeWriter::Op(TextureOpCode op, unsigned char dst, unsigned char a, unsigned char b, unsigned char c, unsigned char d)
+{
+    Emit(op, dst, a, b, c, d, 0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+void TextureCodeWriter::OpImm(TextureOpCode op, unsigned char dst, unsigned char a, float imm0, float imm1, float imm2, float imm3)
+{
+    Emit(op, dst, a, 0, 0, 0, imm0, imm1, imm2, imm3);
+}
+
+void TextureCodeWriter::Const(unsigned char dst, const RGBA& value)
+{
+    Emit(TOP_Const, dst, 0, 0, 0, 0, value.r, value.g, value.b, value.a);
+}
+
+void TextureCodeWriter::Splat(unsigned char dst, unsigned char src, unsigned channel)
+{
+    Emit(TOP_Splat, dst, src, 0, 0, 0, (float)channel, 0.0f, 0.0f, 0.0f);
+}
+
+void TextureCodeWriter::Pack(unsigned char dst, unsigned char r, unsigned rChannel, unsigned char g, unsigned gChannel, unsigned char b, unsigned bChannel, unsigned char a, unsigned aChannel)
+{
+    Emit(TOP_Pack, dst, r, g, b, a, (float)rChannel, (float)gChannel, (float)bChannel, (float)aChannel);
+}
+
+void TextureCodeWriter::Lookup(unsigned char dst, unsigned char src, unsigned table, bool perChannel)
+{
+    Emit(TOP_Lookup, dst, src, 0, 0, 0, (float)table, perChannel ? 0.0f : 1.0f, 0.0f, 0.0f);
+}
+
+void TextureCodeWriter::Emit(TextureOpCode op, unsigned char dst, unsigned char a, unsigned char b, unsigned char c, unsigned char d, float imm0, float imm1, float imm2, float imm3)
+{
+    buffer_->WriteUByte((unsigned char)op);
+    buffer_->WriteUByte(dst);
+    buffer_->WriteUByte(a);
+    buffer_->WriteUByte(b);
+    buffer_->WriteUByte(c);
+    buffer_->WriteUByte(d);
+    buffer_->WriteFloat(imm0);
+    buffer_->WriteFloat(imm1);
+    buffer_->WriteFloat(imm2);
+    buffer_->WriteFloat(imm3);
+}
+
+struct TextureProgram::BuildState
+{
+    /// Local code of every node that compiled.
+    std::unordered_map<GraphNode*, std::vector<Instruction> > nodeCode_;
+    /// Nodes that were checked and cannot be compiled.
+    std::unordered_set<GraphNode*> external_;
+    std::unordered_set<GraphNode*> compiled_;
+    std::unordered_set<GraphNode*> inProgress_;
+    /// Register holding the value of an output socket.
+    std::unordered_map<GraphSocket*, unsigned char> socketRegisters_;
+    /// Consumers of an output socket whose code has not been assigned registers yet.
+    std::unordered_map<GraphSocket*, unsigned> remainingUses_;
+    std::vector<unsigned char> freeRegisters_;
+    std::vector<bool> permanent_;
+
+    /// Permanent registers are loaded outside of the per-tile code (constants and externals), they are never shared.
+    bool Allocate(unsigned char& reg, bool permanent)
+    {
+        if (!permanent && !freeRegisters_.empty())
+        {
+            reg = freeRegisters_.back();
+            freeRegisters_.pop_back();
+            return true;
+        }
+        if (permanent_.size() >= MaxRegisters)
+            return false;
+        reg = (unsigned char)permanent_.size();
+        permanent_.push_back(permanent);
+        return true;
+    }
+
+    void Release(unsigned char reg)
+    {
+        if (!permanent_[reg])
+            freeRegisters_.push_back(reg);
+    }
+};
+
+static GraphSocket* GetUpstreamSocket(GraphNode* node, GraphSocket* input)
+{
+    auto edges = node->graph->GetUpstreamEdges().equal_range(input);
+    return edges.first != edges.second ? edges.first->second : 0x0;
+}
+
+TextureProgram::TextureProgram()
+{
+
+}
+
+TextureProgram::~TextureProgram()
+{
+
+}
+
+bool TextureProgram::Build(GraphNode* root, unsigned outputIndex)
+{
+    constants_.clear();
+    code_.clear();
+    externals_.clear();
+    tables_.clear();
+    registers_.clear();
+    registerCount_ = 0;
+    compiledNodes_ = 0;
+
+    if (!root || !root->graph || outputIndex >= root->outputSockets.size())
+        return false;
+
+    BuildState state;
+    if (!Discover(root, state))
+        return false;
+
+    // The result must outlive every instruction
+    GraphSocket* resultSocket = root->outputSockets[outputIndex];
+    ++state.remainingUses_[resultSocket];
+
+    if (!CompileNode(root, state))
+    {
+        constants_.clear();
+        code_.clear();
+        externals_.clear();
+        tables_.clear();
+        return false;
+    }
+
+    result_ = state.socketRegisters_[resultSocket];
+    registerCount_ = state.permanent_.size();
+    compiledNodes_ = state.compiled_.size();
+    return true;
+}
+
+bool TextureProgram::Discover(GraphNode* node, BuildState& state)
+{
+    if (state.nodeCode_.find(node) != state.nodeCode_.end())
+        return true;
+    if (state.external_.find(node) != state.external_.end())
+        return false;
+
+    bool compilable = !node->WillForceExecute() && !node->inputFlowSocket && node->outputFlowSockets.empty();
+    for (GraphSocket* socket : node->inputSockets)
+        compilable &= node->graph->GetUpstreamEdges().count(socket) <= 1;
+
+    std::vector<Instruction> code;
+    if (compilable)
+    {
+        VectorBuffer buffer;
+        compilable = node->Compile(&buffer);
+        buffer.Seek(0);
+        while (compilable && !buffer.IsEof())
+        {
+            Instruction instruction;
+            instruction.op_ = buffer.ReadUByte();
+            instruction.dst_ = buffer.ReadUByte();
+            for (unsigned i = 0; i < 4; ++i)
+                instruction.src_[i] = buffer.ReadUByte();
+            for (unsigned i = 0; i < 4; ++i)
+                instruction.imm_[i] = buffer.ReadFloat();
+            compilable = instruction.op_ < TOP_Count;
+            if (compilable && instruction.op_ == TOP_Lookup)
+            {
+                // Renumber the node's table into the program's
+                TextureNode* textureNode = dynamic_cast<TextureNode*>(node);
+                std::shared_ptr<const LookupTable> table = textureNode ? textureNode->GetLookupTable((unsigned)instruction.imm_[0]) : std::shared_ptr<const LookupTable>();
+                compilable = table && table->GetSize() > 0;
+                instruction.imm_[0] = (float)tables_.size();
+                tables_.push_back(table);
+            }
+            code.push_back(instruction);
+        }
+        compilable &= !code.empty();
+    }
+
+    if (!compilable)
+    {
+        state.external_.insert(node);
+        return false;
+    }
+
+    state.nodeCode_[node] = code;
+    for (GraphSocket* socket : node->inputSockets)
+    {
+        if (GraphSocket* upstream = GetUpstreamSocket(node, socket))
+        {
+            Discover(upstream->node, state);
+            ++state.remainingUses_[upstream];
+        }
+    }
+    return true;
+}
+
+bool TextureProgram::CompileNode(GraphNode* node, BuildState& state)
+{
+    if (state.compiled_.find(node) != state.compiled_.end())
+        return true;
+    // Cycles cannot be evaluated as a chain
+    if (!state.inProgress_.insert(node).second)
+        return false;
+
+    // Upstream code first
+    std::vector<GraphSocket*> upstreamSockets(node->inputSockets.size(), 0x0);
+    for (unsigned i = 0; i < node->inputSockets.size(); ++i)
+    {
+        upstreamSockets[i] = GetUpstreamSocket(node, node->inputSockets[i]);
+        if (upstreamSockets[i] && state.nodeCode_.find(upstreamSockets[i]->node) != state.nodeCode_.end())
+            if (!CompileNode(upstreamSockets[i]->node, state))
+                return false;
+    }
+
+    const std::vector<Instruction>& code = state.nodeCode_[node];
+    const unsigned inputCount = node->inputSockets.size();
+    const unsigned outputCount = node->outputSockets.size();
+
+    // Registers written exactly once by a constant can be loaded once for the whole program
+    std::unordered_map<unsigned char, unsigned> writeCounts;
+    std::unordered_set<unsigned char> constantWrites;
+    for (const Instruction& instruction : code)
+    {
+        ++writeCounts[instruction.dst_];
+        if (instruction.op_ == TOP_Const)
+            constantWrites.insert(instruction.dst_);
+    }
+    auto isConstant = [&](unsigned char local) { return constantWrites.find(local) != constantWrites.end() && writeCounts[local] == 1; };
+
+    std::unordered_map<unsigned char, unsigned char> registers;
+    for (unsigned i = 0; i < inputCount; ++i)
+    {
+        unsigned char reg = 0;
+        GraphSocket* upstream = upstreamSockets[i];
+        if (!upstream)
+        {
+            // Unconnected inputs see their socket value, just as PropogateValues would leave it
+            if (!state.Allocate(reg, true))
+                return false;
+            const RGBA value = node->inputSockets[i]->GetValue().getColorSafe(true);
+            Instruction load = { TOP_Const, reg, { 0, 0, 0, 0 }, { value.r, value.g, value.b, value.a } };
+            constants_.push_back(load);
+        }
+        else
+        {
+            auto found = state.socketRegisters_.find(upstream);
+            if (found != state.socketRegisters_.end())
+                reg = found->second;
+            else
+            {
+                // Everything compiled has been assigned by now, this is a node evaluated per pixel
+                if (!state.Allocate(reg, true))
+                    return false;
+                External external = { upstream->node, upstream, reg };
+                externals_.push_back(external);
+                state.socketRegisters_[upstream] = reg;
+            }
+        }
+        registers[(unsigned char)i] = reg;
+    }
+
+    for (unsigned i = 0; i < outputCount; ++i)
+    {
+        const unsigned char local = (unsigned char)(inputCount + i);
+        unsigned char reg = 0;
+        if (!state.Allocate(reg, isConstant(local)))
+            return false;
+        registers[local] = reg;
+        state.socketRegisters_[node->outputSockets[i]] = reg;
+    }
+
+    std::vector<unsigned char> temporaries;
+    for (const Instruction& local : code)
+    {
+        Instruction instruction = local;
+        for (unsigned i = 0; i < OperandCounts[local.op_]; ++i)
+        {
+            auto found = registers.find(local.src_[i]);
+            if (found == registers.end())
+                return false; // read before written
+            instruction.src_[i] = found->second;
+        }
+
+        auto found = registers.find(local.dst_);
+        if (found == registers.end())
+        {
+            if (local.dst_ < inputCount + outputCount)
+                return false;
+            unsigned char reg = 0;
+            if (!state.Allocate(reg, isConstant(local.dst_)))
+                return false;
+            registers[local.dst_] = reg;
+            if (!state.permanent_[reg])
+                temporaries.push_back(reg);
+            instruction.dst_ = reg;
+        }
+        else if (local.dst_ < inputCount)
+            return false; // inputs may be shared with other nodes
+        else
+            instruction.dst_ = found->second;
+
+        if (instruction.op_ == TOP_Const && isConstant(local.dst_))
+            constants_.push_back(instruction);
+        else
+            code_.push_back(instruction);
+    }
+
+    for (unsigned char reg : temporaries)
+        state.Release(reg);
+    for (GraphSocket* upstream : upstreamSockets)
+        if (upstream && --state.remainingUses_[upstream] == 0)
+            state.Release(state.socketRegisters_[upstream]);
+    for (GraphSocket* output : node->outputSockets)
+        if (state.remainingUses_[output] == 0)
+            state.Release(state.socketRegisters_[output]);
+
+    state.inProgress_.erase(node);
+    state.compiled_.insert(node);
+    return true;
+}
+
+void TextureProgram::Execute(FilterableBlockMap<RGBA>* into)
+{
+    Execute(into, into->getWidth(), into->getHeight(), 0, 0);
+}
+
+void TextureProgram::Execute(FilterableBlockMap<RGBA>* into, unsigned width, unsigned height, unsigned left, unsigned top)
+{
+    const unsigned regionWidth = into->getWidth();
+    const unsigned pixelCount = regionWidth * into->getHeight();
+
+    width_ = width;
+    height_ = height;
+    left_ = left;
+    top_ = top;
+    regionWidth_ = regionWidth;
+    tileStart_ = 0;
+    registers_.assign(registerCount_ * 4 * TileSize, 0.0f);
+    for (const Instruction& instruction : constants_)
+        Run(instruction, TileSize);
+
+    unsigned executionContext = 1;
+    for (unsigned start = 0; start < pixelCount; start += TileSize)
+    {
+        const unsigned count = SprueMin(TileSize, pixelCount - start);
+        tileStart_ = start;
+
+        // Nodes that are not compiled are still evaluated one pixel at a time
+        if (!externals_.empty())
+        {
+            for (unsigned i = 0; i < count; ++i)
+            {
+                const unsigned x = left + (start + i) % regionWidth;
+                const unsigned y = top + (start + i) / regionWidth;
+                const Variant parameter(Vec4(x / (float)width, y / (float)height, width, height));
+                unsigned pixelContext = executionContext;
+                for (const External& external : externals_)
+                {
+                    external.node_->ExecuteUpstream(pixelContext, parameter);
+                    const RGBA value = external.socket_->GetValue().getColorSafe(true);
+                    Lane(external.register_, 0)[i] = value.r;
+                    Lane(external.register_, 1)[i] = value.g;
+                    Lane(external.register_, 2)[i] = value.b;
+                    Lane(external.register_, 3)[i] = value.a;
+                }
+                executionContext = pixelContext + 1;
+            }
+        }
+
+        for (const Instruction& instruction : code_)
+            Run(instruction, count);
+
+        const float* r = Lane(result_, 0);
+        const float* g = Lane(result_, 1);
+        const float* b = Lane(result_, 2);
+        const float* a = Lane(result_, 3);
+        for (unsigned i = 0; i < count; ++i)
+            into->set(RGBA(r[i], g[i], b[i], a[i]), (start + i) % regionWidth, (start + i) / regionWidth);
+    }
+}
+
+static_assert(TextureRuntime::Blend_LinearDodge == (int)TGB_LinearDodge && TextureRuntime::BlendAlpha_Source == (int)TGBA_UseSourceAlpha, "TextureRuntime blending constants must match BlendNode");
+
+#define TEXPROG_UNARY(EXPR) for (unsigned c = 0; c < 4; ++c) { float* d = Lane(instruction.dst_, c); const float* a = Lane(instruction.src_[0], c); for (unsigned i = 0; i < count; ++i) d[i] = EXPR; } break;
+#define TEXPROG_BINARY(EXPR) for (unsigned c = 0; c < 4; ++c) { float* d = Lane(instruction.dst_, c); const float* a = Lane(instruction.src_[0], c); const float* b = Lane(instruction.src_[1], c); for (unsigned i = 0; i < count; ++i) d[i] = EXPR; } break;
+#define TEXPROG_LOAD(NAME, REG) const TextureRuntime::Color NAME = { Lane(REG, 0)[i], Lane(REG, 1)[i], Lane(REG, 2)[i], Lane(REG, 3)[i] }
+#define TEXPROG_STORE(VALUE) { const TextureRuntime::Color stored = VALUE; Lane(instruction.dst_, 0)[i] = stored.r; Lane(instruction.dst_, 1)[i] = stored.g; Lane(instruction.dst_, 2)[i] = stored.b; Lane(instruction.dst_, 3)[i] = stored.a; }
+#define TEXPROG_PIXEL(BODY) for (unsigned i = 0; i < count; ++i) { TEXPROG_LOAD(value, instruction.src_[0]); BODY; } break;
+
+void TextureProgram::Run(const Instruction& instruction, unsigned count)
+{
+    switch (instruction.op_)
+    {
+    case TOP_Const:
+        for (unsigned c = 0; c < 4; ++c)
+            std::fill(Lane(instruction.dst_, c), Lane(instruction.dst_, c) + count, instruction.imm_[c]);
+        break;
+    case TOP_Move:
+        if (instruction.dst_ != instruction.src_[0])
+            for (unsigned c = 0; c < 4; ++c)
+                memcpy(Lane(instruction.dst_, c), Lane(instruction.src_[0], c), sizeof(float) * count);
+        break;
+    case TOP_Add:   TEXPROG_BINARY(a[i] + b[i])
+    case TOP_Sub:   TEXPROG_BINARY(a[i] - b[i])
+    case TOP_Mul:   TEXPROG_BINARY(a[i] * b[i])
+    case TOP_Div:   TEXPROG_BINARY(a[i] / SprueMax(b[i], EPSILON))
+    case TOP_Min:   TEXPROG_BINARY(SprueMin(a[i], b[i]))
+    case TOP_Max:   TEXPROG_BINARY(SprueMax(a[i], b[i]))
+    case TOP_Pow:   TEXPROG_BINARY(powf(a[i], b[i]))
+    case TOP_Cos:   TEXPROG_UNARY(cosf(a[i]))
+    case TOP_Sin:   TEXPROG_UNARY(sinf(a[i]))
+    case TOP_Tan:   TEXPROG_UNARY(tanf(a[i]))
+    case TOP_Exp:   TEXPROG_UNARY(expf(a[i]))
+    case TOP_Sqrt:  TEXPROG_UNARY(sqrtf(a[i]))
+    case TOP_Clamp01: TEXPROG_UNARY(CLAMP01(a[i]))
+    case TOP_Splat: {
+        const float* channel = Lane(instruction.src_[0], (unsigned)instruction.imm_[0]);
+        for (unsigned i = 0; i < count; ++i)
+            TEXPROG_STORE(TextureRuntime::Splat(channel[i]));
+    } break;
+    case TOP_Pack: {
+        const float* r = Lane(instruction.src_[0], (unsigned)instruction.imm_[0]);
+        const float* g = Lane(instruction.src_[1], (unsigned)instruction.imm_[1]);
+        const float* b = Lane(instruction.src_[2], (unsigned)instruction.imm_[2]);
+        const float* a = Lane(instruction.src_[3], (unsigned)instruction.imm_[3]);
+        for (unsigned i = 0; i < count; ++i)
+            TEXPROG_STORE(TextureRuntime::Make(r[i], g[i], b[i], a[i]));
+    } break;
+    case TOP_AverageRGB: TEXPROG_PIXEL(TEXPROG_STORE(TextureRuntime::AverageRGB(value)))
+    case TOP_MinRGB: TEXPROG_PIXEL(TEXPROG_STORE(TextureRuntime::MinRGB(value)))
+    case TOP_MaxRGB: TEXPROG_PIXEL(TEXPROG_STORE(TextureRuntime::MaxRGB(value)))
+    case TOP_Luminance: TEXPROG_PIXEL(TEXPROG_STORE(TextureRuntime::Luminance(value)))
+    case TOP_RGBToHSV: TEXPROG_PIXEL(TEXPROG_STORE(TextureRuntime::RGBToHSV(value)))
+    case TOP_Normalize: TEXPROG_PIXEL(TEXPROG_STORE(TextureRuntime::Normalize(value, instruction.imm_[0], instruction.imm_[1])))
+    case TOP_Denormalize: TEXPROG_PIXEL(TEXPROG_STORE(TextureRuntime::Denormalize(value, instruction.imm_[0], instruction.imm_[1])))
+    case TOP_Solarize: TEXPROG_PIXEL(TEXPROG_STORE(TextureRuntime::Solarize(value, instruction.imm_[0], instruction.imm_[1] != 0.0f)))
+    case TOP_Posterize: TEXPROG_PIXEL(TEXPROG_STORE(TextureRuntime::Posterize(value, instruction.imm_[0])))
+    case TOP_Blend: {
+        const int mode = (int)instruction.imm_[0];
+        const int alphaMode = (int)instruction.imm_[1];
+        const float* weight = Lane(instruction.src_[2], 0);
+        for (unsigned i = 0; i < count; ++i)
+        {
+            TEXPROG_LOAD(dest, instruction.src_[0]);
+            TEXPROG_LOAD(src, instruction.src_[1]);
+            TEXPROG_STORE(TextureRuntime::Blend(dest, src, weight[i], mode, alphaMode));
+        }
+    } break;
+    case TOP_Coord:
+        for (unsigned i = 0; i < count; ++i)
+        {
+            const unsigned x = left_ + (tileStart_ + i) % regionWidth_;
+            const unsigned y = top_ + (tileStart_ + i) / regionWidth_;
+            TEXPROG_STORE(TextureRuntime::Make(x / (float)width_, y / (float)height_, (float)width_, (float)height_));
+        }
+        break;
+    case TOP_Select:
+        for (unsigned i = 0; i < count; ++i)
+        {
+            TEXPROG_LOAD(mask, instruction.src_[0]);
+            TEXPROG_LOAD(whenSet, instruction.src_[1]);
+            TEXPROG_LOAD(whenClear, instruction.src_[2]);
+            TEXPROG_STORE(TextureRuntime::Select(mask, whenSet, whenClear));
+        }
+        break;
+    case TOP_Checker: {
+        const float* u = Lane(instruction.src_[0], 0);
+        const float* v = Lane(instruction.src_[0], 1);
+        const float* perturbX = Lane(instruction.src_[1], 0);
+        const float* perturbY = Lane(instruction.src_[2], 0);
+        for (unsigned i = 0; i < count; ++i)
+            TEXPROG_STORE(TextureRuntime::Splat(TextureRuntime::Checker(u[i] + perturbX[i], v[i] + perturbY[i], instruction.imm_[0], instruction.imm_[1]) ? 1.0f : 0.0f));
+    } break;
+    case TOP_Rows: {
+        const float* u = Lane(instruction.src_[0], 0);
+        const float* v = Lane(instruction.src_[0], 1);
+        const float* perturb = Lane(instruction.src_[1], 0);
+        for (unsigned i = 0; i < count; ++i)
+            TEXPROG_STORE(TextureRuntime::Splat(TextureRuntime::Rows(u[i], v[i], perturb[i], instruction.imm_[0], instruction.imm_[1], instruction.imm_[2] != 0.0f, instruction.imm_[3] != 0.0f)));
+    } break;
+    case TOP_Lookup: {
+        const LookupTable* table = tables_[(unsigned)instruction.imm_[0]].get();
+        if (instruction.imm_[1] != 0.0f)
+        {
+            // Destination may share the source's register
+            lookupPositions_.assign(Lane(instruction.src_[0], 0), Lane(instruction.src_[0], 0) + count);
+            for (unsigned c = 0; c < 4; ++c)
+                table->Lookup(c, lookupPositions_.data(), Lane(instruction.dst_, c), count);
+        }
+        else
+        {
+            for (unsigned c = 0; c < 4; ++c)
+                table->Lookup(c, Lane(instruction.src_[0], c), Lane(instruction.dst_, c), count);
+        }
+    } break;
+    }
+}
+
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+#include <SprueEngine/BlockMap.h>
+#include <SprueEngine/Math/Color.h>
+
+#include <memory>
+#include <vector>
+
+namespace SprueEngine
+{
+
+class GraphNode;
+struct GraphSocket;
+class LookupTable;
+class VectorBuffer;
+
+/// Operations of the texture bytecode. Every register holds an RGBA value per pixel of a tile.
+/// Scalar values are held the way Variant::getColorSafe(true) would present them, as (x, x, x, 1).
+enum TextureOpCode
+{
+    TOP_Const = 0,      // dst = imm
+    TOP_Move,           // dst = a
+    TOP_Add,            // dst = a + b
+    TOP_Sub,            // dst = a - b
+    TOP_Mul,            // dst = a * b
+    TOP_Div,            // dst = a / max(b, EPSILON), as RGBA::operator/
+    TOP_Min,            // dst = min(a, b)
+    TOP_Max,            // dst = max(a, b)
+    TOP_Pow,            // dst = powf(a, b)
+    TOP_Cos,            // dst = cosf(a)
+    TOP_Sin,            // dst = sinf(a)
+    TOP_Tan,            // dst = tanf(a)
+    TOP_Exp,            // dst = expf(a)
+    TOP_Sqrt,           // dst = sqrtf(a)
+    TOP_Clamp01,        // dst = clamp(a, 0, 1)
+    TOP_Splat,          // dst = (a[imm0], a[imm0], a[imm0], 1)
+    TOP_Pack,           // dst = (a[imm0], b[imm1], c[imm2], d[imm3])
+    TOP_AverageRGB,     // dst = splat(RGBA::AverageRGB(a))
+    TOP_MinRGB,         // dst = splat(min(a.r, a.g, a.b))
+    TOP_MaxRGB,         // dst = splat(max(a.r, a.g, a.b))
+    TOP_Luminance,      // dst = splat(RGBA::Brightness(a))
+    TOP_RGBToHSV,       // dst = hsv(a)
+    TOP_Normalize,      // dst.rgb = NORMALIZE(a.rgb, imm0, imm1), dst.a = a.a
+    TOP_Denormalize,    // dst.rgb = DENORMALIZE(a.rgb, imm0, imm1), dst.a = a.a
+    TOP_Solarize,       // dst.rgb = a.rgb beyond threshold imm0 inverted, imm1 != 0 inverts below the threshold
+    TOP_Posterize,      // dst.rgb = a.rgb posterized into imm0 steps
+    TOP_Blend,          // dst = BlendNode of dest a, source b and weight c.r, imm0 is the TexGenBlendMode and imm1 the TexGenBlendAlpha
+    TOP_Coord,          // dst = (u, v, width, height) of the pixel, the same Vec4 the nodes receive as their evaluation parameter
+    TOP_Select,         // dst = a.r != 0 ? b : c
+    TOP_Checker,        // dst = splat(1) where CheckerGenerator uses ColorB for coordinate a perturbed by (b.r, c.r), imm0 and imm1 are the tile counts
+    TOP_Rows,           // dst = splat(RowsGenerator of coordinate a perturbed by b.r), imm0 perturb power, imm1 row count, imm2 vertical, imm3 alternate dead rows
+    TOP_Lookup,         // dst = every channel of a looked up in the same channel of lookup table imm0, imm1 != 0 looks up a.r in every channel
+    TOP_Count
+};
+
+/// Writes the bytecode of a single node for GraphNode::Compile.
+/// Register numbers are local to the node: the input sockets come first, followed by the output sockets, followed by temporaries.
+/// A register written by Const must not be written again, constants are loaded once for the whole program rather than per tile.
+class SPRUE TextureCodeWriter
+{
+public:
+    TextureCodeWriter(const GraphNode* node, VectorBuffer* buffer);
+
+    unsigned char In(unsigned index) const { return (unsigned char)index; }
+    unsigned char Out(unsigned index) const { return (unsigned char)(inputCount_ + index); }
+    unsigned char Temp(unsigned index) const { return (unsigned char)(inputCount_ + outputCount_ + index); }
+
+    /// Returns true if the input is unconnected or only fed by output sockets of the given type.
+    /// Registers hold every value as a color, nodes that treat the Variant type specially must check what feeds them.
+    bool InputFedBy(unsigned index, unsigned typeID) const;
+
+    void Op(TextureOpCode op, unsigned char dst, unsigned char a = 0, unsigned char b = 0, unsigned char c = 0, unsigned char d = 0);
+    void OpImm(TextureOpCode op, unsigned char dst, unsigned char a, float imm0, float imm1 = 0.0f, float imm2 = 0.0f, float imm3 = 0.0f);
+    void Const(unsigned char dst, const RGBA& value);
+    void Splat(unsigned char dst, unsigned char src, unsigned channel);
+    void Pack(unsigned char dst, unsigned char r, unsigned rChannel, unsigned char g, unsigned gChannel, unsigned char b, unsigned bChannel, unsigned char a, unsigned aChannel);
+    /// Looks src up in the node's lookup table of the given index (TextureNode::GetLookupTable), perChannel false looks up src.r only.
+    void Lookup(unsigned char dst, unsigned char src, unsigned table, bool perChannel);
+    /// Writes an instruction with every operand given.
+    void Emit(TextureOpCode op, unsigned char dst, unsigned char a, unsigned char b, unsigned char c, unsigned char d, float imm0, float imm1, float imm2, float imm3);
+
+private:
+    const GraphNode* node_;
+    VectorBuffer* buffer_;
+    unsigned inputCount_;
+    unsigned outputCount_;
+};
+
+/// A chain of nodes compiled into register bytecode and run a tile at a time.
+/// Nodes that cannot be compiled feeding into the chain are evaluated per pixel as before and their results loaded into registers,
+/// every compiled instruction then runs over the whole tile without virtual dispatch or Variants.
+class SPRUE TextureProgram
+{
+    NOCOPYDEF(TextureProgram);
+    friend class TextureCodeGenerator;
+public:
+    /// Pixels processed per instruction.
+    static const unsigned TileSize = 256;
+
+    TextureProgram();
+    ~TextureProgram();
+
+    /// Compiles everything upstream of the given output socket of root that can be compiled, fails if root itself cannot be.
+    bool Build(GraphNode* root, unsigned outputIndex = 0);
+
+    /// Evaluates the program for every pixel, writing values exactly as the root's output socket would hold them (unclipped).
+    void Execute(FilterableBlockMap<RGBA>* into);
+    /// Evaluates only the pixels of a width x height image that start at left, top and cover the size of into.
+    void Execute(FilterableBlockMap<RGBA>* into, unsigned width, unsigned height, unsigned left, unsigned top);
+
+    /// Number of compiled nodes.
+    unsigned GetCompiledNodeCount() const { return compiledNodes_; }
+    /// Number of per-tile instructions.
+    unsigned GetInstructionCount() const { return code_.size(); }
+    /// Number of registers used.
+    unsigned GetRegisterCount() const { return registerCount_; }
+    /// Number of sockets of nodes that could not be compiled and are evaluated per pixel.
+    unsigned GetExternalCount() const { return externals_.size(); }
+    /// Number of lookup tables referenced.
+    unsigned GetLookupTableCount() const { return tables_.size(); }
+
+private:
+    struct Instruction
+    {
+        unsigned char op_;
+        unsigned char dst_;
+        unsigned char src_[4];
+        float imm_[4];
+    };
+
+    /// A socket of a node that is not compiled, evaluated per pixel and loaded into a register.
+    struct External
+    {
+        GraphNode* node_;
+        GraphSocket* socket_;
+        unsigned char register_;
+    };
+
+    struct BuildState;
+    /// Compiles the node and everything compilable upstream of it into local code, returns false if the node cannot be compiled.
+    bool Discover(GraphNode* node, BuildState& state);
+    /// Assigns registers to the local code of the node, after its upstream nodes.
+    bool CompileNode(GraphNode* node, BuildState& state);
+    void Run(const Instruction& instruction, unsigned count);
+
+    float* Lane(unsigned char reg, unsigned channel) { return &registers_[(reg * 4 + channel) * TileSize]; }
+
+    std::vector<Instruction> constants_;
+    std::vector<Instruction> code_;
+    std::vector<External> externals_;
+    /// Lookup tables of TOP_Lookup, held so that nodes rebaking theirs does not affect a built program.
+    std::vector<std::shared_ptr<const LookupTable> > tables_;
+    std::vector<float> lookupPositions_;
+    std::vector<float> registers_;
+    unsigned tileStart_ = 0;
+    unsigned width_ = 0;
+    unsigned height_ = 0;
+    /// Region being evaluated, pixels are numbered in rows of regionWidth_ from left_, top_.
+    unsigned left_ = 0;
+    unsigned top_ = 0;
+    unsigned regionWidth_ = 0;
+    unsigned registerCount_ = 0;
+    unsigned compiledNodes_ = 0;
+    unsigned char result_ = 0;
+};
+
+}
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cmath>
+
+/// Evaluation functions shared by the TextureProgram bytecode interpreter and the C++ written by TextureCodeGenerator.
+/// Deliberately free of any other engine header so that generated sources only need this file to compile.
+namespace SprueEngine
+{
+namespace TextureRuntime
+{
+
+struct Color
+{
+    float r, g, b, a;
+};
+
+/// Same values as TexGenBlendMode.
+enum BlendMode
+{
+    Blend_Normal,
+    Blend_Additive,
+    Blend_Subtract,
+    Blend_Multiply,
+    Blend_Divide,
+    Blend_ColorBurn,
+    Blend_LinearBurn,
+    Blend_Screen,
+    Blend_ColorDodge,
+    Blend_LinearDodge,
+};
+
+/// Same values as TexGenBlendAlpha.
+enum BlendAlpha
+{
+    BlendAlpha_Weight,
+    BlendAlpha_Dest,
+    BlendAlpha_Source
+};
+
+/// Same values as TexGenOutputFormat.
+enum OutputFormat
+{
+    Output_RGB,
+    Output_RGBA,
+    Output_Alpha
+};
+
+inline float Min(float a, float b) { return a < b ? a : b; }
+inline float Max(float a, float b) { return a > b ? a : b; }
+inline float Clamp01(float value) { return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value); }
+/// Division as RGBA::operator/ performs it.
+inline float Divide(float a, float b) { return a / Max(b, 1e-7f); }
+inline float Normalize(float value, float lower, float upper) { return (value - lower) / (upper - lower); }
+inline float Denormalize(float value, float lower, float upper) { return value * (upper - lower) + lower; }
+
+inline Color Splat(float value) { Color ret = { value, value, value, 1.0f }; return ret; }
+inline Color Make(float r, float g, float b, float a) { Color ret = { r, g, b, a }; return ret; }
+
+inline Color Add(const Color& a, const Color& b) { return Make(a.r + b.r, a.g + b.g, a.b + b.b, a.a + b.a); }
+inline Color Sub(const Color& a, const Color& b) { return Make(a.r - b.r, a.g - b.g, a.b - b.b, a.a - b.a); }
+inline Color Mul(const Color& a, const Color& b) { return Make(a.r * b.r, a.g * b.g, a.b * b.b, a.a * b.a); }
+inline Color Div(const Color& a, const Color& b) { return Make(Divide(a.r, b.r), Divide(a.g, b.g), Divide(a.b, b.b), Divide(a.a, b.a)); }
+inline Color Min(const Color& a, const Color& b) { return Make(Min(a.r, b.r), Min(a.g, b.g), Min(a.b, b.b), Min(a.a, b.a)); }
+inline Color Max(const Color& a, const Color& b) { return Make(Max(a.r, b.r), Max(a.g, b.g), Max(a.b, b.b), Max(a.a, b.a)); }
+inline Color Pow(const Color& a, const Color& b) { return Make(powf(a.r, b.r), powf(a.g, b.g), powf(a.b, b.b), powf(a.a, b.a)); }
+inline Color Cos(const Color& a) { return Make(cosf(a.r), cosf(a.g), cosf(a.b), cosf(a.a)); }
+inline Color Sin(const Color& a) { return Make(sinf(a.r), sinf(a.g), sinf(a.b), sinf(a.a)); }
+inline Color Tan(const Color& a) { return Make(tanf(a.r), tanf(a.g), tanf(a.b), tanf(a.a)); }
+inline Color Exp(const Color& a) { return Make(expf(a.r), expf(a.g), expf(a.b), expf(a.a)); }
+inline Color Sqrt(const Color& a) { return Make(sqrtf(a.r), sqrtf(a.g), sqrtf(a.b), sqrtf(a.a)); }
+inline Color Clamp01(const Color& a) { return Make(Clamp01(a.r), Clamp01(a.g), Clamp01(a.b), Clamp01(a.a)); }
+
+inline float Channel(const Color& value, unsigned channel)
+{
+    switch (channel)
+    {
+    case 0: return value.r;
+    case 1: return value.g;
+    case 2: return value.b;
+    }
+    return value.a;
+}
+
+inline Color Select(const Color& mask, const Color& whenSet, const Color& whenClear) { return mask.r != 0.0f ? whenSet : whenClear; }
+
+inline Color AverageRGB(const Color& a) { return Splat((a.r + a.g + a.b) / 3.0f); }
+inline Color MinRGB(const Color& a) { return Splat(Min(a.r, Min(a.g, a.b))); }
+inline Color MaxRGB(const Color& a) { return Splat(Max(a.r, Max(a.g, a.b))); }
+inline Color Luminance(const Color& a) { return Splat(a.r * 0.2126f + a.g * 0.7152f + a.b * 0.0722f); }
+
+inline Color Normalize(const Color& a, float lower, float upper) { return Make(Normalize(a.r, lower, upper), Normalize(a.g, lower, upper), Normalize(a.b, lower, upper), a.a); }
+inline Color Denormalize(const Color& a, float lower, float upper) { return Make(Denormalize(a.r, lower, upper), Denormalize(a.g, lower, upper), Denormalize(a.b, lower, upper), a.a); }
+
+inline Color RGBToHSV(const Color& color)
+{
+    Color hsv = { 0.0f, 0.0f, 0.0f, 1.0f };
+    const float min = Min(color.r, Min(color.g, color.b));
+    const float max = Max(color.r, Max(color.g, color.b));
+    hsv.b = max;
+    const float delta = max - min;
+
+    if (max == 0)
+    {
+        hsv.g = 0;
+        hsv.b = -1;
+    }
+    else
+    {
+        hsv.g = delta / max;
+        if (color.r == max)
+            hsv.r = (color.g - color.b) / delta;
+        else if (color.g == max)
+            hsv.r = 2 + (color.b - color.r) / delta;
+        else
+            hsv.r = 4 + (color.r - color.g) / delta;
+        hsv.r *= 60;
+        if (hsv.r < 0)
+            hsv.r += 360;
+    }
+    return hsv;
+}
+
+inline Color Solarize(const Color& a, float threshold, bool invertLower)
+{
+    if (invertLower)
+        return Make(a.r < threshold ? 1.0f - a.r : a.r, a.g < threshold ? 1.0f - a.g : a.g, a.b < threshold ? 1.0f - a.b : a.b, a.a);
+    return Make(a.r > threshold ? 1.0f - a.r : a.r, a.g > threshold ? 1.0f - a.g : a.g, a.b > threshold ? 1.0f - a.b : a.b, a.a);
+}
+
+inline float Posterize(float value, float range)
+{
+    if (range > 1.0f)
+        return ((int)(value * range) / range);
+    else if (range == 1.0f)
+        return 0.0f;
+    return 1.0f;
+}
+
+inline Color Posterize(const Color& a, float range) { return Make(Posterize(a.r, range), Posterize(a.g, range), Posterize(a.b, range), a.a); }
+
+/// BlendNode for every mode except dissolve and normal map blending.
+inline Color Blend(Color dest, Color src, float weight, int mode, int alphaMode)
+{
+    const Color white = { 1.0f, 1.0f, 1.0f, 1.0f };
+    float blendWeight = weight;
+    if (alphaMode == BlendAlpha_Dest)
+    {
+        blendWeight = dest.a;
+        dest.a = 1.0f;
+        src.a = 1.0f;
+    }
+    else if (alphaMode == BlendAlpha_Source)
+    {
+        blendWeight = src.a;
+        src.a = 1.0f;
+        dest.a = 1.0f;
+    }
+
+    Color result = { 0.0f, 0.0f, 0.0f, 1.0f };
+    switch (mode)
+    {
+    case Blend_Normal:
+        result = Add(Mul(src, Make(blendWeight, blendWeight, blendWeight, blendWeight)), Mul(dest, Make(1 - blendWeight, 1 - blendWeight, 1 - blendWeight, 1 - blendWeight)));
+        break;
+    case Blend_Additive:
+    case Blend_LinearDodge:
+        result = Add(dest, src);
+        break;
+    case Blend_Subtract:
+        result = Sub(dest, src);
+        break;
+    case Blend_Multiply:
+        result = Mul(dest, src);
+        break;
+    case Blend_Divide:
+        result = Div(dest, src);
+        break;
+    case Blend_ColorBurn:
+        result = Sub(white, Div(Sub(white, src), dest));
+        break;
+    case Blend_LinearBurn:
+        result = Sub(Add(dest, src), white);
+        break;
+    case Blend_Screen:
+        result = Sub(white, Mul(Sub(white, dest), Sub(white, src)));
+        break;
+    case Blend_ColorDodge:
+        result = Div(src, Sub(white, dest));
+        break;
+    }
+    return Add(dest, Mul(Sub(result, dest), Make(blendWeight, blendWeight, blendWeight, blendWeight)));
+}
+
+/// CheckerGenerator, returns true where ColorB is used.
+inline bool Checker(float x, float y, float tilesX, float tilesY)
+{
+    return !(((int)(x * tilesX) + (int)(y * tilesY)) & 1);
+}
+
+/// RowsGenerator.
+inline float Rows(float u, float v, float perturb, float perturbPower, float rowCount, bool vertical, bool alternateDeadColumns)
+{
+    const float perturbation = perturb * perturbPower;
+    const float samplingX = vertical ? u : v;
+    const float sineValue = sinf((samplingX + perturbation) * 3.141596f * rowCount);
+    if (alternateDeadColumns)
+        return sineValue < 0.0f ? 0.0f : (sineValue > 1.0f ? 1.0f : sineValue);
+    const float absValue = fabsf(sineValue);
+    return absValue < 0.0f ? 0.0f : (absValue > 1.0f ? 1.0f : absValue);
+}
+
+/// Clipping and channel selection TextureOutputNode applies to its image.
+inline Color Output(const Color& value, int format)
+{
+    Color ret = Clamp01(value);
+    if (format == Output_RGB)
+        ret.a = 1.0f;
+    if (format == Output_Alpha)
+        ret = Make(ret.r, ret.r, ret.r, 1.0f);
+    return ret;
+}
+
+}
+}
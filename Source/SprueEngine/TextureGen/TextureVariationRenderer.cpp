@@ -0,0 +1,513 @@
+#include "TextureVariationRenderer.h"
+
+#include <SprueEngine/FString.h>
+#include <SprueEngine/Graph/Graph.h>
+#include <SprueEngine/Graph/GraphNode.h>
+#include <SprueEngine/Graph/GraphSocket.h>
+#include <SprueEngine/Loaders/BasicImageLoader.h>
+#include <SprueEngine/Logging.h>
+#include <SprueEngine/ParallelFor.h>
+#include <SprueEngine/TextureGen/TextureCodeGenerator.h>
+#include <SprueEngine/TextureGen/TextureNode.h>
+
+#include <algorithm>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace SprueEngine
+{
+
+typedef std::unordered_map<GraphSocket*, std::vector<GraphSocket*> > ConsumerMap;
+
+struct TextureVariationRenderer::SharedNode
+{
+    unsigned sourceID_ = 0;
+    unsigned width_ = 0;
+    unsigned height_ = 0;
+    /// Samples of each output socket, null for sockets nothing varying consumes.
+    std::vector<std::shared_ptr<std::vector<Variant> > > samples_;
+    /// Varying consumers of each output socket, as the source ID of the node and the index of its input socket.
+    std::vector<std::vector<std::pair<unsigned, unsigned> > > consumers_;
+};
+
+/// Stands in for a shared node in a variation's clone, outputs the samples stored for the pixel being evaluated.
+class SharedSamplesNode : public TextureNode
+{
+public:
+    SharedSamplesNode(unsigned width, unsigned height, const std::vector<std::shared_ptr<std::vector<Variant> > >& samples) :
+        width_(width), height_(height), samples_(samples)
+    {
+    }
+
+    virtual StringHash GetTypeHash() const override { return StringHash("SharedSamplesNode"); }
+    virtual const char* GetTypeName() const override { return "SharedSamplesNode"; }
+    virtual void Construct() override { }
+
+    virtual int Execute(const Variant& parameter) override
+    {
+        // Pixels are evaluated at x / width, rounding recovers the exact pixel
+        const Vec4 coord = parameter.getVec4Safe();
+        const unsigned x = SprueMin((unsigned)SprueMax(coord.x * width_ + 0.5f, 0.0f), width_ - 1);
+        const unsigned y = SprueMin((unsigned)SprueMax(coord.y * height_ + 0.5f, 0.0f), height_ - 1);
+        const unsigned index = y * width_ + x;
+        for (unsigned i = 0; i < outputSockets.size() && i < samples_.size(); ++i)
+            if (samples_[i])
+                outputSockets[i]->StoreValue((*samples_[i])[index]);
+        return GRAPH_EXECUTE_COMPLETE;
+    }
+
+private:
+    unsigned width_;
+    unsigned height_;
+    std::vector<std::shared_ptr<std::vector<Variant> > > samples_;
+};
+
+static bool HasPermutations(const GraphNode* node)
+{
+    for (auto& field : node->GetFieldPermutationMap())
+        if (!field.second.empty())
+            return true;
+    return false;
+}
+
+/// Collects the output resolutions reached downstream of node, returns false if a node that is not pointwise is reached.
+static bool CollectPointwiseReach(GraphNode* node, const ConsumerMap& consumers, std::set<std::pair<unsigned, unsigned> >& sizes, std::unordered_set<GraphNode*>& visited)
+{
+    if (!visited.insert(node).second)
+        return true;
+    if (!node->IsPointwise() || node->WillForceExecute())
+        return false;
+    if (TextureOutputNode* output = dynamic_cast<TextureOutputNode*>(node))
+        sizes.insert(std::make_pair(output->Width, output->Height));
+
+    for (GraphSocket* socket : node->outputSockets)
+    {
+        auto found = consumers.find(socket);
+        if (found == consumers.end())
+            continue;
+        for (GraphSocket* consumer : found->second)
+            if (!CollectPointwiseReach(consumer->node, consumers, sizes, visited))
+                return false;
+    }
+    return true;
+}
+
+TextureVariationRenderer::TextureVariationRenderer()
+{
+
+}
+
+TextureVariationRenderer::~TextureVariationRenderer()
+{
+
+}
+
+bool TextureVariationRenderer::Render(Graph* graph, const std::vector<unsigned>& seeds, bool weighted, unsigned maxWorkers)
+{
+    std::vector<GraphNode*> roots;
+    if (graph)
+    {
+        for (GraphNode* node : graph->GetNodes())
+            if (HasPermutations(node))
+                roots.push_back(node);
+    }
+
+    if (!RenderVariations(graph, roots, seeds.size(), [&](Graph* clone, unsigned index) { ApplyPermutations(clone, seeds[index], weighted); }, maxWorkers))
+        return false;
+    for (unsigned i = 0; i < seeds.size(); ++i)
+        variations_[i].Seed = seeds[i];
+    return true;
+}
+
+bool TextureVariationRenderer::RenderSweep(Graph* graph, const std::vector<TextureSweepTrack>& tracks, unsigned frameCount, bool loop, unsigned maxWorkers)
+{
+    std::vector<GraphNode*> roots;
+    if (graph)
+    {
+        for (auto& track : tracks)
+        {
+            GraphNode* node = graph->GetNodeBySourceID(track.NodeID);
+            if (!node)
+            {
+                SPRUE_LOG_ERROR(FString("Sweep track refers to a node that is not in the graph: %1", track.NodeID).str());
+                return false;
+            }
+            if (!node->FindProperty(StringHash(track.Property)))
+            {
+                SPRUE_LOG_ERROR(FString("Sweep track refers to a property %1 does not have: %2", std::string(node->GetTypeName()), track.Property).str());
+                return false;
+            }
+            roots.push_back(node);
+        }
+    }
+
+    // Frames are spread over [0, 1], a loop never reaches 1 as it would repeat frame 0
+    const unsigned steps = loop ? frameCount : frameCount - 1;
+    auto frameTime = [=](unsigned frame) { return steps > 0 ? frame / (float)steps : 0.0f; };
+
+    auto apply = [&](Graph* clone, unsigned frame) {
+        const float t = frameTime(frame);
+        for (auto& track : tracks)
+            if (GraphNode* node = clone->GetNodeBySourceID(track.NodeID))
+                node->SetProperty(track.Property, InterpolateProperty(track.From, track.To, t));
+    };
+    if (!RenderVariations(graph, roots, frameCount, apply, maxWorkers))
+        return false;
+    for (unsigned i = 0; i < frameCount; ++i)
+    {
+        variations_[i].Seed = i;
+        variations_[i].Time = frameTime(i);
+    }
+    return true;
+}
+
+bool TextureVariationRenderer::RenderVariations(Graph* graph, const std::vector<GraphNode*>& roots, unsigned count, const std::function<void(Graph*, unsigned)>& apply, unsigned maxWorkers)
+{
+    variations_.clear();
+    outputNames_.clear();
+    outputTypes_.clear();
+    shared_.clear();
+    varyingNodes_ = sharedNodes_ = sharedOutputs_ = 0;
+    if (!graph)
+        return false;
+
+    const std::vector<TextureOutputNode*> outputs = graph->GetNodesByType<TextureOutputNode>();
+    if (outputs.empty())
+        return false;
+    for (unsigned i = 0; i < outputs.size(); ++i)
+    {
+        outputNames_.push_back(TextureCodeGenerator::MakeIdentifier(outputs[i]->name, "Output" + std::to_string(i + 1)));
+        outputTypes_.push_back(outputs[i]->OutputType);
+    }
+
+    ConsumerMap consumers;
+    for (auto& edge : graph->GetUpstreamEdges())
+        consumers[edge.second].push_back(edge.first);
+
+    // Everything downstream of a root varies
+    std::unordered_set<GraphNode*> varying;
+    std::vector<GraphNode*> open;
+    for (GraphNode* node : roots)
+        if (varying.insert(node).second)
+            open.push_back(node);
+    while (!open.empty())
+    {
+        GraphNode* node = open.back();
+        open.pop_back();
+        for (GraphSocket* socket : node->outputSockets)
+        {
+            auto found = consumers.find(socket);
+            if (found == consumers.end())
+                continue;
+            for (GraphSocket* consumer : found->second)
+                if (varying.insert(consumer->node).second)
+                    open.push_back(consumer->node);
+        }
+    }
+    varyingNodes_ = varying.size();
+
+    // Invariant nodes feeding the varying part, sampled once where every varying path to an output is pointwise
+    for (GraphNode* node : graph->GetNodes())
+    {
+        if (varying.find(node) != varying.end() || dynamic_cast<TextureOutputNode*>(node) || node->inputFlowSocket || !node->outputFlowSockets.empty())
+            continue;
+
+        // Value nodes are cheaper to evaluate than to look up
+        bool hasUpstream = false;
+        for (GraphSocket* socket : node->inputSockets)
+            hasUpstream |= graph->GetUpstreamEdges().count(socket) > 0;
+        if (!hasUpstream && node->IsPointwise())
+            continue;
+
+        std::shared_ptr<SharedNode> shared(new SharedNode());
+        shared->sourceID_ = node->GetSourceID();
+        shared->samples_.resize(node->outputSockets.size());
+        shared->consumers_.resize(node->outputSockets.size());
+
+        std::set<std::pair<unsigned, unsigned> > sizes;
+        std::unordered_set<GraphNode*> visited;
+        bool feedsVarying = false;
+        bool exact = true;
+        for (unsigned i = 0; i < node->outputSockets.size() && exact; ++i)
+        {
+            auto found = consumers.find(node->outputSockets[i]);
+            if (found == consumers.end())
+                continue;
+            for (GraphSocket* consumer : found->second)
+            {
+                if (varying.find(consumer->node) == varying.end())
+                    continue;
+                feedsVarying = true;
+                exact &= CollectPointwiseReach(consumer->node, consumers, sizes, visited);
+                const auto& inputs = consumer->node->inputSockets;
+                shared->consumers_[i].push_back(std::make_pair(consumer->node->GetSourceID(), (unsigned)(std::find(inputs.begin(), inputs.end(), consumer) - inputs.begin())));
+            }
+        }
+        if (!feedsVarying || !exact || sizes.size() != 1)
+            continue;
+
+        shared->width_ = sizes.begin()->first;
+        shared->height_ = sizes.begin()->second;
+        shared_.push_back(shared);
+    }
+    sharedNodes_ = shared_.size();
+
+    // Outputs that do not vary are rendered once, shared nodes are sampled on a separate clone so no stale socket values are picked up
+    std::vector<std::shared_ptr<FilterableBlockMap<RGBA> > > sharedImages(outputs.size());
+    std::vector<unsigned> varyingOutputs;
+    if (Graph* base = (Graph*)graph->Clone())
+    {
+        for (unsigned i = 0; i < outputs.size(); ++i)
+        {
+            if (varying.find(outputs[i]) != varying.end())
+            {
+                varyingOutputs.push_back(i);
+                continue;
+            }
+            if (GraphNode* node = base->GetNodeBySourceID(outputs[i]->GetSourceID()))
+                sharedImages[i] = node->GetPreview(outputs[i]->Width, outputs[i]->Height);
+            ++sharedOutputs_;
+        }
+        delete base;
+    }
+    else
+        return false;
+
+    if (!shared_.empty() && !varyingOutputs.empty())
+    {
+        if (Graph* bakeClone = (Graph*)graph->Clone())
+        {
+            for (auto& shared : shared_)
+                Bake(bakeClone, *shared);
+            delete bakeClone;
+        }
+    }
+
+    variations_.resize(count);
+    std::mutex cloneMutex;
+    ParallelFor(0, count, [&](unsigned index) {
+        TextureVariation& variation = variations_[index];
+        variation.Images = sharedImages;
+        if (varyingOutputs.empty())
+            return;
+
+        // Cloning goes through the context's factories, one at a time
+        Graph* clone = 0x0;
+        {
+            std::lock_guard<std::mutex> lock(cloneMutex);
+            clone = (Graph*)graph->Clone();
+            if (clone)
+            {
+                apply(clone, index);
+                Substitute(clone);
+            }
+        }
+        if (!clone)
+            return;
+
+        for (unsigned outputIndex : varyingOutputs)
+            if (GraphNode* node = clone->GetNodeBySourceID(outputs[outputIndex]->GetSourceID()))
+                variation.Images[outputIndex] = node->GetPreview(outputs[outputIndex]->Width, outputs[outputIndex]->Height);
+
+        std::lock_guard<std::mutex> lock(cloneMutex);
+        delete clone;
+    }, maxWorkers);
+
+    return true;
+}
+
+void TextureVariationRenderer::Bake(Graph* clone, SharedNode& shared) const
+{
+    GraphNode* node = clone->GetNodeBySourceID(shared.sourceID_);
+    if (!node)
+        return;
+
+    const unsigned pixelCount = shared.width_ * shared.height_;
+    for (unsigned i = 0; i < shared.samples_.size(); ++i)
+        if (!shared.consumers_[i].empty())
+            shared.samples_[i].reset(new std::vector<Variant>(pixelCount));
+
+    // Contexts continue from earlier bakes on the same clone so nothing evaluated for another node counts as current
+    static const unsigned ContextBase = 1;
+    unsigned nextContext = ContextBase;
+    for (auto& other : shared_)
+    {
+        if (other.get() == &shared)
+            break;
+        nextContext += other->width_ * other->height_;
+    }
+
+    clone->BeginRenderPass();
+    for (unsigned y = 0; y < shared.height_; ++y)
+    {
+        for (unsigned x = 0; x < shared.width_; ++x)
+        {
+            unsigned ctx = nextContext++;
+            node->ExecuteUpstream(ctx, Vec4(x / (float)shared.width_, y / (float)shared.height_, shared.width_, shared.height_));
+            const unsigned index = y * shared.width_ + x;
+            for (unsigned i = 0; i < shared.samples_.size(); ++i)
+                if (shared.samples_[i])
+                    (*shared.samples_[i])[index] = node->outputSockets[i]->GetValue();
+        }
+    }
+}
+
+void TextureVariationRenderer::Substitute(Graph* clone) const
+{
+    for (auto& shared : shared_)
+    {
+        GraphNode* original = clone->GetNodeBySourceID(shared->sourceID_);
+        if (!original)
+            continue;
+
+        SharedSamplesNode* samples = new SharedSamplesNode(shared->width_, shared->height_, shared->samples_);
+        samples->name = original->name;
+        for (GraphSocket* socket : original->outputSockets)
+            samples->AddOutput(socket->name, socket->typeID);
+        clone->AddNode(samples, false);
+
+        for (unsigned i = 0; i < shared->consumers_.size(); ++i)
+        {
+            for (auto& consumer : shared->consumers_[i])
+            {
+                GraphNode* consumerNode = clone->GetNodeBySourceID(consumer.first);
+                if (consumerNode && consumer.second < consumerNode->inputSockets.size())
+                    clone->Connect(samples->outputSockets[i], consumerNode->inputSockets[consumer.second]);
+            }
+        }
+    }
+}
+
+void TextureVariationRenderer::ApplyPermutations(Graph* graph, unsigned seed, bool weighted)
+{
+    if (!graph)
+        return;
+    for (GraphNode* node : graph->GetNodes())
+    {
+        if (!HasPermutations(node))
+            continue;
+        // Without the ID every node would draw the same sequence
+        const unsigned nodeSeed = seed ^ (node->GetSourceID() * 2654435761u);
+        if (weighted)
+            node->RandomizePermutationsWeighted(nodeSeed);
+        else
+            node->RandomizePermutations(nodeSeed);
+    }
+}
+
+Variant TextureVariationRenderer::InterpolateProperty(const Variant& from, const Variant& to, float t)
+{
+    if (from.getType() != to.getType())
+        return t < 0.5f ? from : to;
+
+    switch (from.getType())
+    {
+    case VT_Float:
+        return SprueLerp(from.getFloat(), to.getFloat(), t);
+    case VT_Int:
+        return (int)roundf(SprueLerp((float)from.getInt(), (float)to.getInt(), t));
+    case VT_UInt:
+        return (unsigned)roundf(SprueLerp((float)from.getUInt(), (float)to.getUInt(), t));
+    case VT_Vec2:
+        return from.getVec2().Lerp(to.getVec2(), t);
+    case VT_Vec3:
+        return from.getVec3().Lerp(to.getVec3(), t);
+    case VT_Vec4:
+        return from.getVec4().Lerp(to.getVec4(), t);
+    case VT_Quat:
+        return from.getQuat().Slerp(to.getQuat(), t);
+    case VT_Color:
+        return SprueLerp(from.getRGBA(), to.getRGBA(), t);
+    }
+    return t < 0.5f ? from : to;
+}
+
+unsigned TextureVariationRenderer::WriteOutputs(const std::string& folder, const std::string& prefix) const
+{
+    unsigned written = 0;
+    for (auto& variation : variations_)
+    {
+        for (unsigned i = 0; i < variation.Images.size(); ++i)
+        {
+            if (!variation.Images[i])
+                continue;
+            const std::string filePath = folder + "/" + prefix + "_" + std::to_string(variation.Seed) + "_" + outputNames_[i] + ".png";
+            BasicImageLoader::SavePNG(variation.Images[i].get(), filePath.c_str());
+            ++written;
+        }
+    }
+    return written;
+}
+
+std::shared_ptr<FilterableBlockMap<RGBA> > TextureVariationRenderer::BuildFlipbook(unsigned outputIndex, unsigned columns) const
+{
+    if (variations_.empty() || outputIndex >= outputNames_.size() || !variations_[0].Images[outputIndex])
+        return std::shared_ptr<FilterableBlockMap<RGBA> >();
+
+    const unsigned frameCount = variations_.size();
+    if (columns == 0)
+        columns = (unsigned)ceilf(sqrtf((float)frameCount));
+    columns = SprueMin(columns, frameCount);
+    const unsigned rows = (frameCount + columns - 1) / columns;
+    const unsigned frameWidth = variations_[0].Images[outputIndex]->getWidth();
+    const unsigned frameHeight = variations_[0].Images[outputIndex]->getHeight();
+
+    std::shared_ptr<FilterableBlockMap<RGBA> > atlas(new FilterableBlockMap<RGBA>(frameWidth * columns, frameHeight * rows));
+    atlas->fill(RGBA(0.0f, 0.0f, 0.0f, 0.0f));
+    ParallelFor(0, frameCount, [&](unsigned frame) {
+        const FilterableBlockMap<RGBA>* image = variations_[frame].Images[outputIndex].get();
+        if (!image)
+            return;
+        const unsigned left = (frame % columns) * frameWidth;
+        const unsigned top = (frame / columns) * frameHeight;
+        const unsigned width = SprueMin(image->getWidth(), frameWidth);
+        const unsigned height = SprueMin(image->getHeight(), frameHeight);
+        for (unsigned y = 0; y < height; ++y)
+            for (unsigned x = 0; x < width; ++x)
+                atlas->set(image->get(x, y), left + x, top + y);
+    });
+    return atlas;
+}
+
+unsigned TextureVariationRenderer::WriteFlipbooks(const std::string& folder, const std::string& prefix, unsigned columns) const
+{
+    unsigned written = 0;
+    for (unsigned i = 0; i < outputNames_.size(); ++i)
+    {
+        if (auto atlas = BuildFlipbook(i, columns))
+        {
+            const std::string filePath = folder + "/" + prefix + "_" + outputNames_[i] + ".png";
+            BasicImageLoader::SavePNG(atlas.get(), filePath.c_str());
+            ++written;
+        }
+    }
+    return written;
+}
+
+unsigned TextureVariationRenderer::WriteTextureArrays(const std::string& folder, const std::string& prefix, bool generateMips) const
+{
+    unsigned written = 0;
+    for (unsigned i = 0; i < outputNames_.size(); ++i)
+    {
+        std::vector<const FilterableBlockMap<RGBA>*> slices;
+        bool anyAlpha = false;
+        for (auto& variation : variations_)
+        {
+            if (!variation.Images[i])
+                break;
+            slices.push_back(variation.Images[i].get());
+            anyAlpha |= BasicImageLoader::AnyAlphaUsed(variation.Images[i].get());
+        }
+        if (slices.empty() || slices.size() != variations_.size())
+            continue;
+
+        const std::string filePath = folder + "/" + prefix + "_" + outputNames_[i] + ".dds";
+        BasicImageLoader::SaveDDSArray(slices, filePath.c_str(), BlockCompressor::SelectFormat(outputTypes_[i], anyAlpha), generateMips, outputTypes_[i] == TGOT_Normal);
+        ++written;
+    }
+    return written;
+}
+
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+#include <SprueEngine/BlockMap.h>
+#include <SprueEngine/Math/Color.h>
+#include <SprueEngine/TextureGen/TextureNode.h>
+#include <SprueEngine/Variant.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SprueEngine
+{
+
+class Graph;
+class GraphNode;
+
+/// Images of a single variation, one per TextureOutputNode in the order of TextureVariationRenderer::GetOutputNames.
+struct SPRUE TextureVariation
+{
+    /// Seed of the variation, or the frame index for sweeps.
+    unsigned Seed = 0;
+    /// Position of the frame in the sweep from 0 to 1, always 0 for seeded variations.
+    float Time = 0.0f;
+    std::vector<std::shared_ptr<FilterableBlockMap<RGBA> > > Images;
+};
+
+/// A property of a node animated from one value to another over a sweep.
+struct SPRUE TextureSweepTrack
+{
+    /// Source ID of the node in the graph given to RenderSweep.
+    unsigned NodeID = 0;
+    std::string Property;
+    Variant From;
+    Variant To;
+};
+
+/// Renders many variations of a texture graph whose nodes have field permutations (see IEditable::SetFieldPermutations).
+/// Nodes without permutations and with nothing permuted upstream give the same result in every variation, they are evaluated once:
+/// outputs that do not vary are rendered a single time and shared, and invariant nodes feeding the varying part are sampled once per pixel
+/// and replaced by the stored samples in each variation's clone. Sharing is exact, so it is limited to nodes only reached through pointwise
+/// nodes, which are evaluated at the output's own pixels, anything sampled elsewhere (blurs, warps, etc) is evaluated per variation.
+/// Variations are rendered in parallel, each on its own clone of the graph.
+/// Sweeps use the same sharing for animation: the animated nodes take the place of the permuted ones and every frame is a variation.
+class SPRUE TextureVariationRenderer
+{
+    NOCOPYDEF(TextureVariationRenderer);
+public:
+    TextureVariationRenderer();
+    ~TextureVariationRenderer();
+
+    /// Renders every TextureOutputNode of the graph once per seed, returns false if the graph has no outputs.
+    bool Render(Graph* graph, const std::vector<unsigned>& seeds, bool weighted = false, unsigned maxWorkers = 0);
+    /// Renders every TextureOutputNode of the graph for frameCount frames with the tracks' properties interpolated over time.
+    /// Looping sweeps stop one step short of the end so that the last frame leads back into the first.
+    /// Returns false if the graph has no outputs or a track names a node or property that does not exist.
+    bool RenderSweep(Graph* graph, const std::vector<TextureSweepTrack>& tracks, unsigned frameCount, bool loop = true, unsigned maxWorkers = 0);
+
+    /// Writes every image as folder/prefix_<seed>_<output>.png, returns the number of files written.
+    unsigned WriteOutputs(const std::string& folder, const std::string& prefix) const;
+    /// Lays the images of one output out as a flipbook atlas, left to right and top to bottom in the order of the variations.
+    /// With columns of 0 the atlas is made as square as possible.
+    std::shared_ptr<FilterableBlockMap<RGBA> > BuildFlipbook(unsigned outputIndex, unsigned columns = 0) const;
+    /// Writes the flipbook of every output as folder/prefix_<output>.png, returns the number of files written.
+    unsigned WriteFlipbooks(const std::string& folder, const std::string& prefix, unsigned columns = 0) const;
+    /// Writes the images of every output as the slices of a block compressed DDS texture array, folder/prefix_<output>.dds.
+    /// The format is chosen from the output's type, returns the number of files written.
+    unsigned WriteTextureArrays(const std::string& folder, const std::string& prefix, bool generateMips = true) const;
+
+    /// Variations of the last Render, in the order of the seeds.
+    const std::vector<TextureVariation>& GetVariations() const { return variations_; }
+    /// Names of the outputs, in the order of TextureVariation::Images.
+    const std::vector<std::string>& GetOutputNames() const { return outputNames_; }
+    /// Number of nodes whose result differs between variations.
+    unsigned GetVaryingNodeCount() const { return varyingNodes_; }
+    /// Number of invariant nodes evaluated once and shared with the varying nodes they feed.
+    unsigned GetSharedNodeCount() const { return sharedNodes_; }
+    /// Number of outputs rendered once for all variations.
+    unsigned GetSharedOutputCount() const { return sharedOutputs_; }
+
+    /// Picks the permutation of every permuted field of every node from the seed, each node combines the seed with its source ID.
+    static void ApplyPermutations(Graph* graph, unsigned seed, bool weighted);
+    /// Interpolates numeric, vector and color values, anything else switches from `from` to `to` halfway.
+    static Variant InterpolateProperty(const Variant& from, const Variant& to, float t);
+
+private:
+    struct SharedNode;
+
+    /// Renders `count` variations of the graph, everything downstream of the roots varies and apply sets up each variation's clone.
+    bool RenderVariations(Graph* graph, const std::vector<GraphNode*>& roots, unsigned count, const std::function<void(Graph*, unsigned)>& apply, unsigned maxWorkers);
+    /// Samples the shared nodes of a clone at every pixel of their output resolution.
+    void Bake(Graph* clone, SharedNode& shared) const;
+    /// Replaces the shared nodes of a variation's clone with their samples.
+    void Substitute(Graph* clone) const;
+
+    std::vector<TextureVariation> variations_;
+    std::vector<std::string> outputNames_;
+    std::vector<TexGenOutputType> outputTypes_;
+    std::vector<std::shared_ptr<SharedNode> > shared_;
+    unsigned varyingNodes_ = 0;
+    unsigned sharedNodes_ = 0;
+    unsigned sharedOutputs_ = 0;
+};
+
+}
@@ -0,0 +1,238 @@
+#include "BakeCache.h"
+
+#include <SprueEngine/GeneralUtility.h>
+#include <SprueEngine/Geometry/MeshData.h>
+#include <SprueEngine/Resource.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace SprueEngine
+{
+
+static const char BakeFileMagic[4] = { 'B', 'A', 'K', 'E' };
+
+BakeCache* BakeCache::GetInstance()
+{
+    static BakeCache instance;
+    return &instance;
+}
+
+void BakeCache::SetDirectory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    directory_ = directory;
+    while (!directory_.empty() && (directory_.back() == '/' || directory_.back() == '\\'))
+        directory_.pop_back();
+}
+
+std::string BakeCache::GetDirectory() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    return directory_;
+}
+
+void BakeCache::SetMemoryBudget(unsigned long long bytes)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    memoryBudget_ = bytes;
+    while (memoryUsed_ > memoryBudget_ && !uses_.empty())
+    {
+        auto found = images_.find(uses_.back());
+        memoryUsed_ -= sizeof(RGBA) * found->second.image_->size();
+        images_.erase(found);
+        uses_.pop_back();
+    }
+}
+
+std::string BakeCache::GetFilePath(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bake", (unsigned long long)key);
+    return directory_ + "/" + name;
+}
+
+std::shared_ptr<FilterableBlockMap<RGBA> > BakeCache::Get(uint64_t key, unsigned width, unsigned height)
+{
+    std::string filePath;
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto found = images_.find(key);
+        if (found != images_.end())
+        {
+            uses_.splice(uses_.begin(), uses_, found->second.use_);
+            if (found->second.image_->getWidth() == width && found->second.image_->getHeight() == height)
+                return found->second.image_;
+            return std::shared_ptr<FilterableBlockMap<RGBA> >();
+        }
+        if (directory_.empty())
+            return std::shared_ptr<FilterableBlockMap<RGBA> >();
+        filePath = GetFilePath(key);
+    }
+
+    // Read without holding the lock, bakes of other nodes can be looked up meanwhile
+    std::shared_ptr<FilterableBlockMap<RGBA> > image = ReadFile(filePath, key, width, height);
+    if (image)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        Insert(key, image);
+    }
+    return image;
+}
+
+void BakeCache::Store(uint64_t key, const std::shared_ptr<FilterableBlockMap<RGBA> >& image)
+{
+    if (!image || image->size() == 0)
+        return;
+
+    std::string filePath;
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        Insert(key, image);
+        if (directory_.empty())
+            return;
+        filePath = GetFilePath(key);
+    }
+    WriteFile(filePath, key, image.get());
+}
+
+void BakeCache::ClearMemory()
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    images_.clear();
+    uses_.clear();
+    memoryUsed_ = 0;
+}
+
+void BakeCache::Insert(uint64_t key, const std::shared_ptr<FilterableBlockMap<RGBA> >& image)
+{
+    auto found = images_.find(key);
+    if (found != images_.end())
+    {
+        memoryUsed_ -= sizeof(RGBA) * found->second.image_->size();
+        found->second.image_ = image;
+        uses_.splice(uses_.begin(), uses_, found->second.use_);
+    }
+    else
+    {
+        uses_.push_front(key);
+        images_[key] = Entry { image, uses_.begin() };
+    }
+    memoryUsed_ += sizeof(RGBA) * image->size();
+
+    // The newest image is kept even if it alone exceeds the budget, it is about to be used
+    while (memoryUsed_ > memoryBudget_ && uses_.size() > 1)
+    {
+        auto oldest = images_.find(uses_.back());
+        memoryUsed_ -= sizeof(RGBA) * oldest->second.image_->size();
+        images_.erase(oldest);
+        uses_.pop_back();
+    }
+}
+
+uint64_t BakeCache::HashMesh(const std::string& fileName, const std::shared_ptr<MeshResource>& mesh)
+{
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto found = meshHashes_.find(mesh.get());
+        if (found != meshHashes_.end())
+        {
+            if (found->second.mesh_.lock() == mesh)
+                return found->second.hash_;
+            meshHashes_.erase(found);
+        }
+    }
+
+    // Hashing the file rather than the path, the same mesh saved elsewhere hashes the same
+    uint64_t hash = 0;
+    std::ifstream file(fileName, std::ios::binary);
+    if (file.is_open())
+    {
+        const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        hash = HashBytes64(contents.data(), contents.size());
+    }
+    else if (mesh)
+    {
+        hash = HashBytes64("geometry", 8);
+        for (const MeshData* data : mesh->GetMeshes())
+        {
+            if (!data)
+                continue;
+            const auto& positions = data->GetPositionBuffer();
+            const auto& normals = data->GetNormalBuffer();
+            const auto& uvs = data->GetUVBuffer();
+            const auto& colors = data->GetColorBuffer();
+            const auto& indices = data->GetIndexBuffer();
+            hash = HashBytes64(positions.data(), positions.size() * sizeof(Vec3), hash);
+            hash = HashBytes64(normals.data(), normals.size() * sizeof(Vec3), hash);
+            hash = HashBytes64(uvs.data(), uvs.size() * sizeof(Vec2), hash);
+            hash = HashBytes64(colors.data(), colors.size() * sizeof(RGBA), hash);
+            hash = HashBytes64(indices.data(), indices.size() * sizeof(unsigned), hash);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(lock_);
+    meshHashes_[mesh.get()] = MeshHash { mesh, hash };
+    return hash;
+}
+
+uint64_t BakeCache::MakeKey(uint64_t meshHash, const char* bakerType, unsigned width, unsigned height, uint64_t propertiesHash)
+{
+    uint64_t key = HashBytes64(&meshHash, sizeof(meshHash));
+    key = HashBytes64(bakerType, strlen(bakerType), key);
+    key = HashBytes64(&width, sizeof(width), key);
+    key = HashBytes64(&height, sizeof(height), key);
+    return HashBytes64(&propertiesHash, sizeof(propertiesHash), key);
+}
+
+std::shared_ptr<FilterableBlockMap<RGBA> > BakeCache::ReadFile(const std::string& filePath, uint64_t key, unsigned width, unsigned height)
+{
+    FILE* file = fopen(filePath.c_str(), "rb");
+    if (!file)
+        return std::shared_ptr<FilterableBlockMap<RGBA> >();
+
+    std::shared_ptr<FilterableBlockMap<RGBA> > ret;
+    BakeCacheHeader header;
+    if (fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.Magic, BakeFileMagic, 4) == 0 && header.Version == FileVersion &&
+        header.Key == key && header.Width == width && header.Height == height && header.PixelSize == sizeof(RGBA))
+    {
+        ret.reset(new FilterableBlockMap<RGBA>(width, height));
+        if (fread(ret->getData(), sizeof(RGBA), ret->size(), file) != ret->size())
+            ret.reset();
+    }
+    fclose(file);
+    return ret;
+}
+
+bool BakeCache::WriteFile(const std::string& filePath, uint64_t key, const FilterableBlockMap<RGBA>* image)
+{
+    BakeCacheHeader header;
+    memcpy(header.Magic, BakeFileMagic, 4);
+    header.Version = FileVersion;
+    header.Key = key;
+    header.Width = image->getWidth();
+    header.Height = image->getHeight();
+    header.PixelSize = sizeof(RGBA);
+    header.Reserved = 0;
+
+    const std::string tempPath = filePath + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file)
+        return false;
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(image->getData(), sizeof(RGBA), image->size(), file) == image->size();
+    success &= fclose(file) == 0;
+
+    // Rename does not replace on every platform, an existing file holds the same bake anyway
+    if (success)
+    {
+        remove(filePath.c_str());
+        success = rename(tempPath.c_str(), filePath.c_str()) == 0;
+    }
+    if (!success)
+        remove(tempPath.c_str());
+    return success;
+}
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+#include <SprueEngine/BlockMap.h>
+#include <SprueEngine/Math/Color.h>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace SprueEngine
+{
+
+class MeshResource;
+
+/// Header of a .bake file. The RGBA floats of the image follow it directly in FilterableBlockMap row order,
+/// the 32 byte header keeps them 16 byte aligned so the file can be read in a single block or memory mapped and used as is.
+struct BakeCacheHeader
+{
+    char Magic[4];
+    uint32_t Version;
+    uint64_t Key;
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t PixelSize;
+    uint32_t Reserved;
+};
+
+/// Content addressed store of baked images, shared by every clone of every graph in memory and kept on disk between sessions.
+/// Keys combine the hash of the mesh file, the baker type, the resolution and the baker's properties, so a bake is found again wherever
+/// the same mesh and settings are used, and anything that would change the result misses rather than returning a stale image.
+/// Images held in memory are dropped least recently used first once the memory budget is exceeded, the disk copies stay until removed.
+class SPRUE BakeCache
+{
+    NOCOPYDEF(BakeCache);
+    BakeCache() { }
+public:
+    static const uint32_t FileVersion = 1;
+
+    static BakeCache* GetInstance();
+
+    /// Folder the .bake files are kept in, which must exist. Empty keeps bakes in memory only.
+    void SetDirectory(const std::string& directory);
+    std::string GetDirectory() const;
+
+    /// Bytes of images kept in memory.
+    void SetMemoryBudget(unsigned long long bytes);
+    unsigned long long GetMemoryBudget() const { return memoryBudget_; }
+    unsigned long long GetMemoryUsed() const { return memoryUsed_; }
+
+    /// Returns the image stored for the key, from memory or else from disk, or null. The image is shared and must not be modified.
+    std::shared_ptr<FilterableBlockMap<RGBA> > Get(uint64_t key, unsigned width, unsigned height);
+    /// Stores the image for the key in memory and on disk.
+    void Store(uint64_t key, const std::shared_ptr<FilterableBlockMap<RGBA> >& image);
+    /// Drops every image held in memory.
+    void ClearMemory();
+
+    /// Hash of the contents of the file the mesh was loaded from, remembered for as long as the mesh stays loaded.
+    /// Falls back to hashing the geometry itself when the file cannot be read.
+    uint64_t HashMesh(const std::string& fileName, const std::shared_ptr<MeshResource>& mesh);
+    /// Combines the parts of a key.
+    static uint64_t MakeKey(uint64_t meshHash, const char* bakerType, unsigned width, unsigned height, uint64_t propertiesHash);
+
+    /// Path of the file the key is stored in.
+    std::string GetFilePath(uint64_t key) const;
+    /// Reads a .bake file, returns null if it is missing, damaged or does not hold the key at the given size.
+    static std::shared_ptr<FilterableBlockMap<RGBA> > ReadFile(const std::string& filePath, uint64_t key, unsigned width, unsigned height);
+    /// Writes a .bake file, through a temporary file so that a reader never sees it half written.
+    static bool WriteFile(const std::string& filePath, uint64_t key, const FilterableBlockMap<RGBA>* image);
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<FilterableBlockMap<RGBA> > image_;
+        std::list<uint64_t>::iterator use_;
+    };
+
+    struct MeshHash
+    {
+        std::weak_ptr<MeshResource> mesh_;
+        uint64_t hash_;
+    };
+
+    /// Holds the image in memory and evicts the least recently used beyond the budget, the lock must be held.
+    void Insert(uint64_t key, const std::shared_ptr<FilterableBlockMap<RGBA> >& image);
+
+    mutable std::mutex lock_;
+    std::string directory_;
+    std::unordered_map<uint64_t, Entry> images_;
+    /// Keys from most to least recently used.
+    std::list<uint64_t> uses_;
+    std::unordered_map<const MeshResource*, MeshHash> meshHashes_;
+    unsigned long long memoryBudget_ = 256 * 1024 * 1024;
+    unsigned long long memoryUsed_ = 0;
+};
+
+}
@@ -0,0 +1,590 @@
+#include "BlockCompression.h"
+
+#include <SprueEngine/ParallelFor.h>
+#include <SprueEngine/Serializer.h>
+
+#include <float.h>
+#include <limits.h>
+#include <string.h>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+    #define SPRUE_BC_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace SprueEngine
+{
+
+// DDS header constants, see https://msdn.microsoft.com/en-us/library/windows/desktop/bb943982(v=vs.85).aspx
+#define DDSD_CAPS           0x1
+#define DDSD_HEIGHT         0x2
+#define DDSD_WIDTH          0x4
+#define DDSD_PIXELFORMAT    0x1000
+#define DDSD_MIPMAPCOUNT    0x20000
+#define DDSD_LINEARSIZE     0x80000
+#define DDPF_FOURCC         0x4
+#define DDSCAPS_COMPLEX     0x8
+#define DDSCAPS_TEXTURE     0x1000
+#define DDSCAPS_MIPMAP      0x400000
+
+#define DXGI_FORMAT_BC1_UNORM 71
+#define DXGI_FORMAT_BC3_UNORM 77
+#define DXGI_FORMAT_BC4_UNORM 80
+#define DXGI_FORMAT_BC5_UNORM 83
+#define DXGI_FORMAT_BC7_UNORM 98
+#define D3D10_RESOURCE_DIMENSION_TEXTURE2D 3
+
+namespace
+{
+    inline unsigned char ToUnorm8(float value) { return (unsigned char)(CLAMP01(value) * 255.0f + 0.5f); }
+
+    inline int ClampByte(int value) { return value < 0 ? 0 : (value > 255 ? 255 : value); }
+
+    /// Reads a 4x4 block as RGBA8, coordinates outside of the image are clamped by BlockMap::get.
+    void GatherBlock(const FilterableBlockMap<RGBA>* image, unsigned blockX, unsigned blockY, unsigned char* block)
+    {
+        for (unsigned y = 0; y < 4; ++y)
+        {
+            for (unsigned x = 0; x < 4; ++x)
+            {
+                const RGBA& color = image->get(blockX * 4 + x, blockY * 4 + y);
+                unsigned char* pixel = block + (y * 4 + x) * 4;
+                pixel[0] = ToUnorm8(color.r);
+                pixel[1] = ToUnorm8(color.g);
+                pixel[2] = ToUnorm8(color.b);
+                pixel[3] = ToUnorm8(color.a);
+            }
+        }
+    }
+
+    /// Block pixels in structure-of-arrays form so that 4 pixels can be processed at once.
+    struct BlockSoA
+    {
+        alignas(16) float channels[4][16];
+        float mean[4];
+
+        BlockSoA(const unsigned char* block, unsigned channelCt)
+        {
+            for (unsigned c = 0; c < 4; ++c)
+            {
+                mean[c] = 0.0f;
+                for (unsigned i = 0; i < 16; ++i)
+                {
+                    channels[c][i] = c < channelCt ? (float)block[i * 4 + c] : 0.0f;
+                    mean[c] += channels[c][i];
+                }
+                mean[c] /= 16.0f;
+            }
+        }
+    };
+
+    /// Projects all 16 pixels (minus the mean) onto an axis, writing the projections and returning the extents.
+    void ProjectBlock(const BlockSoA& block, const float* axis, float* projections, float& minT, float& maxT)
+    {
+#ifdef SPRUE_BC_SSE2
+        const __m128 ax = _mm_set1_ps(axis[0]), ay = _mm_set1_ps(axis[1]), az = _mm_set1_ps(axis[2]), aw = _mm_set1_ps(axis[3]);
+        const __m128 mx = _mm_set1_ps(block.mean[0]), my = _mm_set1_ps(block.mean[1]), mz = _mm_set1_ps(block.mean[2]), mw = _mm_set1_ps(block.mean[3]);
+        __m128 minV = _mm_set1_ps(FLT_MAX);
+        __m128 maxV = _mm_set1_ps(-FLT_MAX);
+        for (unsigned i = 0; i < 16; i += 4)
+        {
+            __m128 t = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(block.channels[0] + i), mx), ax);
+            t = _mm_add_ps(t, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(block.channels[1] + i), my), ay));
+            t = _mm_add_ps(t, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(block.channels[2] + i), mz), az));
+            t = _mm_add_ps(t, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(block.channels[3] + i), mw), aw));
+            _mm_storeu_ps(projections + i, t);
+            minV = _mm_min_ps(minV, t);
+            maxV = _mm_max_ps(maxV, t);
+        }
+        float mins[4], maxs[4];
+        _mm_storeu_ps(mins, minV);
+        _mm_storeu_ps(maxs, maxV);
+        minT = SprueMin(SprueMin(mins[0], mins[1]), SprueMin(mins[2], mins[3]));
+        maxT = SprueMax(SprueMax(maxs[0], maxs[1]), SprueMax(maxs[2], maxs[3]));
+#else
+        minT = FLT_MAX;
+        maxT = -FLT_MAX;
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            float t = 0.0f;
+            for (unsigned c = 0; c < 4; ++c)
+                t += (block.channels[c][i] - block.mean[c]) * axis[c];
+            projections[i] = t;
+            minT = SprueMin(minT, t);
+            maxT = SprueMax(maxT, t);
+        }
+#endif
+    }
+
+    /// Finds the principal axis of the block's color distribution with a few rounds of power iteration on the covariance matrix.
+    void PrincipalAxis(const BlockSoA& block, unsigned channelCt, float* axis)
+    {
+        float covariance[4][4];
+        memset(covariance, 0, sizeof(covariance));
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            float d[4];
+            for (unsigned c = 0; c < 4; ++c)
+                d[c] = block.channels[c][i] - block.mean[c];
+            for (unsigned r = 0; r < channelCt; ++r)
+                for (unsigned c = r; c < channelCt; ++c)
+                    covariance[r][c] += d[r] * d[c];
+        }
+        for (unsigned r = 0; r < 4; ++r)
+            for (unsigned c = 0; c < r; ++c)
+                covariance[r][c] = covariance[c][r];
+
+        // Seed with the luminance-ish diagonal, any non-degenerate start converges
+        float vec[4] = { 1.0f, 1.0f, 1.0f, channelCt > 3 ? 1.0f : 0.0f };
+        for (unsigned iter = 0; iter < 8; ++iter)
+        {
+            float next[4] = { 0, 0, 0, 0 };
+            for (unsigned r = 0; r < channelCt; ++r)
+                for (unsigned c = 0; c < channelCt; ++c)
+                    next[r] += covariance[r][c] * vec[c];
+            float len = 0.0f;
+            for (unsigned c = 0; c < 4; ++c)
+                len = SprueMax(len, fabsf(next[c]));
+            if (len < EPSILON)
+                break;
+            for (unsigned c = 0; c < 4; ++c)
+                vec[c] = next[c] / len;
+        }
+
+        float lenSq = 0.0f;
+        for (unsigned c = 0; c < 4; ++c)
+            lenSq += vec[c] * vec[c];
+        const float invLen = lenSq > EPSILON ? 1.0f / sqrtf(lenSq) : 0.0f;
+        for (unsigned c = 0; c < 4; ++c)
+            axis[c] = vec[c] * invLen;
+    }
+
+    inline unsigned short To565(const int* rgb)
+    {
+        return (unsigned short)((((rgb[0] * 31 + 127) / 255) << 11) | (((rgb[1] * 63 + 127) / 255) << 5) | ((rgb[2] * 31 + 127) / 255));
+    }
+
+    inline void From565(unsigned short color, int* rgb)
+    {
+        const int r = (color >> 11) & 31;
+        const int g = (color >> 5) & 63;
+        const int b = color & 31;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    /// BC1 color block, always uses the 4 color mode so it is also valid as the color half of BC3.
+    void EncodeBC1Color(const unsigned char* block, unsigned char* dest)
+    {
+        BlockSoA soa(block, 3);
+        float axis[4];
+        PrincipalAxis(soa, 3, axis);
+
+        float projections[16];
+        float minT, maxT;
+        ProjectBlock(soa, axis, projections, minT, maxT);
+
+        int endPoints[2][3];
+        for (unsigned c = 0; c < 3; ++c)
+        {
+            endPoints[0][c] = ClampByte((int)(soa.mean[c] + axis[c] * maxT + 0.5f));
+            endPoints[1][c] = ClampByte((int)(soa.mean[c] + axis[c] * minT + 0.5f));
+        }
+
+        unsigned short c0 = To565(endPoints[0]);
+        unsigned short c1 = To565(endPoints[1]);
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        dest[0] = c0 & 0xFF; dest[1] = c0 >> 8;
+        dest[2] = c1 & 0xFF; dest[3] = c1 >> 8;
+        dest[4] = dest[5] = dest[6] = dest[7] = 0;
+        if (c0 == c1)
+            return;
+
+        // Indices come from projecting onto the quantized endpoint line
+        int p0[3], p1[3];
+        From565(c0, p0);
+        From565(c1, p1);
+        float line[4] = { (float)(p1[0] - p0[0]), (float)(p1[1] - p0[1]), (float)(p1[2] - p0[2]), 0.0f };
+        const float lineLenSq = line[0] * line[0] + line[1] * line[1] + line[2] * line[2];
+        if (lineLenSq < EPSILON)
+            return;
+        for (unsigned c = 0; c < 3; ++c)
+            line[c] /= lineLenSq;
+
+        // Reuse the projection routine by offsetting the mean to the first endpoint
+        soa.mean[0] = (float)p0[0]; soa.mean[1] = (float)p0[1]; soa.mean[2] = (float)p0[2]; soa.mean[3] = 0.0f;
+        ProjectBlock(soa, line, projections, minT, maxT);
+
+        static const unsigned remap[4] = { 0, 2, 3, 1 };
+        unsigned indices = 0;
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            const int step = (int)(CLAMP01(projections[i]) * 3.0f + 0.5f);
+            indices |= remap[step] << (i * 2);
+        }
+        dest[4] = indices & 0xFF;
+        dest[5] = (indices >> 8) & 0xFF;
+        dest[6] = (indices >> 16) & 0xFF;
+        dest[7] = (indices >> 24) & 0xFF;
+    }
+
+    /// BC4 block for one channel of an RGBA8 block, uses the 8 value interpolation mode.
+    void EncodeBC4Channel(const unsigned char* block, unsigned channel, unsigned char* dest)
+    {
+        int minV = 255, maxV = 0;
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            minV = SprueMin(minV, (int)block[i * 4 + channel]);
+            maxV = SprueMax(maxV, (int)block[i * 4 + channel]);
+        }
+
+        dest[0] = (unsigned char)maxV;
+        dest[1] = (unsigned char)minV;
+        unsigned long long bits = 0;
+        const int range = maxV - minV;
+        if (range > 0)
+        {
+            for (unsigned i = 0; i < 16; ++i)
+            {
+                const int step = ((block[i * 4 + channel] - minV) * 7 + range / 2) / range;
+                const unsigned index = step == 7 ? 0 : (step == 0 ? 1 : 8 - step);
+                bits |= ((unsigned long long)index) << (i * 3);
+            }
+        }
+        for (unsigned i = 0; i < 6; ++i)
+            dest[2 + i] = (unsigned char)((bits >> (i * 8)) & 0xFF);
+    }
+
+    /// Little endian bit packer for BC7 blocks.
+    struct BitWriter
+    {
+        unsigned char* data_;
+        unsigned position_ = 0;
+
+        BitWriter(unsigned char* data) : data_(data) { memset(data_, 0, 16); }
+
+        void Write(unsigned value, unsigned bitCt)
+        {
+            for (unsigned i = 0; i < bitCt; ++i, ++position_)
+                if ((value >> i) & 1)
+                    data_[position_ >> 3] |= (unsigned char)(1 << (position_ & 7));
+        }
+    };
+
+    /// BC7 mode 6: single subset, 7.7.7.7 RGBA endpoints with a unique p-bit each and 4-bit indices.
+    void EncodeBC7(const unsigned char* block, unsigned char* dest)
+    {
+        static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        BlockSoA soa(block, 4);
+        float axis[4];
+        PrincipalAxis(soa, 4, axis);
+
+        float projections[16];
+        float minT, maxT;
+        ProjectBlock(soa, axis, projections, minT, maxT);
+
+        // Quantize both endpoints, choosing the p-bit that best fits each
+        int quantized[2][4];
+        int pBits[2];
+        int endPoints[2][4];
+        for (unsigned e = 0; e < 2; ++e)
+        {
+            const float t = e == 0 ? minT : maxT;
+            int target[4];
+            for (unsigned c = 0; c < 4; ++c)
+                target[c] = ClampByte((int)(soa.mean[c] + axis[c] * t + 0.5f));
+
+            int bestError = INT_MAX;
+            for (int p = 0; p < 2; ++p)
+            {
+                int error = 0;
+                int q[4];
+                for (unsigned c = 0; c < 4; ++c)
+                {
+                    q[c] = CLAMP((target[c] - p + 1) / 2, 0, 127);
+                    const int diff = ((q[c] << 1) | p) - target[c];
+                    error += diff * diff;
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    pBits[e] = p;
+                    memcpy(quantized[e], q, sizeof(q));
+                }
+            }
+            for (unsigned c = 0; c < 4; ++c)
+                endPoints[e][c] = (quantized[e][c] << 1) | pBits[e];
+        }
+
+        int palette[16][4];
+        for (unsigned i = 0; i < 16; ++i)
+            for (unsigned c = 0; c < 4; ++c)
+                palette[i][c] = ((64 - weights[i]) * endPoints[0][c] + weights[i] * endPoints[1][c] + 32) >> 6;
+
+        unsigned indices[16];
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            int bestError = INT_MAX;
+            for (unsigned p = 0; p < 16; ++p)
+            {
+                int error = 0;
+                for (unsigned c = 0; c < 4; ++c)
+                {
+                    const int diff = palette[p][c] - block[i * 4 + c];
+                    error += diff * diff;
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    indices[i] = p;
+                }
+            }
+        }
+
+        // The anchor index (pixel 0) has an implicit 0 high bit, flip the endpoints if it is set
+        if (indices[0] & 8)
+        {
+            std::swap(quantized[0], quantized[1]);
+            std::swap(pBits[0], pBits[1]);
+            for (unsigned i = 0; i < 16; ++i)
+                indices[i] = 15 - indices[i];
+        }
+
+        BitWriter writer(dest);
+        writer.Write(1 << 6, 7);
+        for (unsigned c = 0; c < 4; ++c)
+        {
+            writer.Write(quantized[0][c], 7);
+            writer.Write(quantized[1][c], 7);
+        }
+        writer.Write(pBits[0], 1);
+        writer.Write(pBits[1], 1);
+        writer.Write(indices[0], 3);
+        for (unsigned i = 1; i < 16; ++i)
+            writer.Write(indices[i], 4);
+    }
+}
+
+BlockCompressionFormat BlockCompressor::SelectFormat(TexGenOutputType outputType, bool hasAlpha)
+{
+    switch (outputType)
+    {
+    case TGOT_Roughness:
+    case TGOT_Glossiness:
+    case TGOT_Metallic:
+    case TGOT_SurfaceThickness:
+    case TGOT_Height:
+        return BCF_BC4;
+    case TGOT_Normal:
+        return BCF_BC5;
+    case TGOT_Albedo:
+    case TGOT_Subsurface:
+        return hasAlpha ? BCF_BC7 : BCF_BC1;
+    case TGOT_Specular:
+        return hasAlpha ? BCF_BC3 : BCF_BC1;
+    case TGOT_Custom:
+        // Nothing is known of the content, compressed as color
+        return hasAlpha ? BCF_BC7 : BCF_BC1;
+    }
+    return hasAlpha ? BCF_BC7 : BCF_BC1;
+}
+
+unsigned BlockCompressor::GetBlockSize(BlockCompressionFormat format)
+{
+    return format == BCF_BC1 || format == BCF_BC4 ? 8 : 16;
+}
+
+unsigned BlockCompressor::CalculateMipCount(unsigned width, unsigned height)
+{
+    unsigned levels = 1;
+    while (width > 1 || height > 1)
+    {
+        width = SprueMax(width / 2, 1u);
+        height = SprueMax(height / 2, 1u);
+        ++levels;
+    }
+    return levels;
+}
+
+std::vector<std::shared_ptr<FilterableBlockMap<RGBA> > > BlockCompressor::BuildMipChain(const FilterableBlockMap<RGBA>* image, bool isNormalMap)
+{
+    std::vector<std::shared_ptr<FilterableBlockMap<RGBA> > > ret;
+    if (!image || image->getWidth() == 0 || image->getHeight() == 0)
+        return ret;
+
+    std::shared_ptr<FilterableBlockMap<RGBA> > topLevel = std::make_shared<FilterableBlockMap<RGBA> >(image->getWidth(), image->getHeight());
+    // Copy through get so that flipped indexing on the source is respected
+    for (unsigned y = 0; y < image->getHeight(); ++y)
+        for (unsigned x = 0; x < image->getWidth(); ++x)
+            topLevel->set(image->get(x, y), x, y);
+    ret.push_back(topLevel);
+
+    while (ret.back()->getWidth() > 1 || ret.back()->getHeight() > 1)
+    {
+        const FilterableBlockMap<RGBA>* src = ret.back().get();
+        const unsigned width = SprueMax(src->getWidth() / 2, 1u);
+        const unsigned height = SprueMax(src->getHeight() / 2, 1u);
+        std::shared_ptr<FilterableBlockMap<RGBA> > level = std::make_shared<FilterableBlockMap<RGBA> >(width, height);
+
+        // 2x2 box filter, BlockMap::get clamps so odd dimensions repeat their last row/column
+        ParallelFor(0, height, [&](unsigned y) {
+            for (unsigned x = 0; x < width; ++x)
+            {
+                RGBA sum = src->get(x * 2, y * 2) + src->get(x * 2 + 1, y * 2) + src->get(x * 2, y * 2 + 1) + src->get(x * 2 + 1, y * 2 + 1);
+                sum *= 0.25f;
+                if (isNormalMap)
+                {
+                    Vec3 normal(sum.r * 2.0f - 1.0f, sum.g * 2.0f - 1.0f, sum.b * 2.0f - 1.0f);
+                    if (normal.LengthSq() > EPSILON)
+                        normal.Normalize();
+                    else
+                        normal = Vec3(0, 0, 1);
+                    sum.r = normal.x * 0.5f + 0.5f;
+                    sum.g = normal.y * 0.5f + 0.5f;
+                    sum.b = normal.z * 0.5f + 0.5f;
+                }
+                level->set(sum, x, y);
+            }
+        });
+        ret.push_back(level);
+    }
+
+    return ret;
+}
+
+void BlockCompressor::EncodeBlock(BlockCompressionFormat format, const unsigned char* rgbaBlock, unsigned char* dest)
+{
+    switch (format)
+    {
+    case BCF_BC1:
+        EncodeBC1Color(rgbaBlock, dest);
+        break;
+    case BCF_BC3:
+        EncodeBC4Channel(rgbaBlock, 3, dest);
+        EncodeBC1Color(rgbaBlock, dest + 8);
+        break;
+    case BCF_BC4:
+        EncodeBC4Channel(rgbaBlock, 0, dest);
+        break;
+    case BCF_BC5:
+        EncodeBC4Channel(rgbaBlock, 0, dest);
+        EncodeBC4Channel(rgbaBlock, 1, dest + 8);
+        break;
+    case BCF_BC7:
+        EncodeBC7(rgbaBlock, dest);
+        break;
+    }
+}
+
+void BlockCompressor::Compress(const FilterableBlockMap<RGBA>* image, BlockCompressionFormat format, CompressedMipLevel& into)
+{
+    into.Width = image->getWidth();
+    into.Height = image->getHeight();
+    const unsigned blocksWide = (into.Width + 3) / 4;
+    const unsigned blocksHigh = (into.Height + 3) / 4;
+    const unsigned blockSize = GetBlockSize(format);
+    into.Data.resize(blocksWide * blocksHigh * blockSize);
+
+    unsigned char* data = into.Data.data();
+    ParallelFor(0, blocksHigh, [=](unsigned blockY) {
+        unsigned char block[64];
+        for (unsigned blockX = 0; blockX < blocksWide; ++blockX)
+        {
+            GatherBlock(image, blockX, blockY, block);
+            EncodeBlock(format, block, data + (blockY * blocksWide + blockX) * blockSize);
+        }
+    });
+}
+
+std::vector<CompressedMipLevel> BlockCompressor::CompressWithMips(const FilterableBlockMap<RGBA>* image, BlockCompressionFormat format, bool generateMips, bool isNormalMap)
+{
+    std::vector<CompressedMipLevel> ret;
+    if (!image || image->getWidth() == 0 || image->getHeight() == 0)
+        return ret;
+
+    if (!generateMips)
+    {
+        ret.resize(1);
+        Compress(image, format, ret[0]);
+        return ret;
+    }
+
+    auto chain = BuildMipChain(image, isNormalMap);
+    ret.resize(chain.size());
+    for (unsigned i = 0; i < chain.size(); ++i)
+        Compress(chain[i].get(), format, ret[i]);
+    return ret;
+}
+
+bool BlockCompressor::WriteDDS(Serializer* dest, const std::vector<CompressedMipLevel>& levels, BlockCompressionFormat format)
+{
+    return WriteDDSArray(dest, std::vector<std::vector<CompressedMipLevel> >(1, levels), format);
+}
+
+bool BlockCompressor::WriteDDSArray(Serializer* dest, const std::vector<std::vector<CompressedMipLevel> >& slices, BlockCompressionFormat format)
+{
+    if (!dest || slices.empty() || slices[0].empty())
+        return false;
+    const std::vector<CompressedMipLevel>& levels = slices[0];
+    for (auto& slice : slices)
+    {
+        if (slice.size() != levels.size() || slice[0].Width != levels[0].Width || slice[0].Height != levels[0].Height)
+            return false;
+    }
+
+    const bool useDX10 = format == BCF_BC4 || format == BCF_BC5 || format == BCF_BC7 || slices.size() > 1;
+    const bool hasMips = levels.size() > 1;
+
+    bool success = dest->WriteFileID("DDS ");
+    success &= dest->WriteUInt(124);
+    success &= dest->WriteUInt(DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE | (hasMips ? DDSD_MIPMAPCOUNT : 0));
+    success &= dest->WriteUInt(levels[0].Height);
+    success &= dest->WriteUInt(levels[0].Width);
+    success &= dest->WriteUInt((unsigned)levels[0].Data.size());
+    success &= dest->WriteUInt(0); // depth
+    success &= dest->WriteUInt((unsigned)levels.size());
+    for (unsigned i = 0; i < 11; ++i)
+        success &= dest->WriteUInt(0);
+
+    // Pixel format
+    success &= dest->WriteUInt(32);
+    success &= dest->WriteUInt(DDPF_FOURCC);
+    success &= dest->WriteFileID(useDX10 ? "DX10" : (format == BCF_BC1 ? "DXT1" : "DXT5"));
+    for (unsigned i = 0; i < 5; ++i)
+        success &= dest->WriteUInt(0);
+
+    success &= dest->WriteUInt(DDSCAPS_TEXTURE | (hasMips ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0));
+    for (unsigned i = 0; i < 4; ++i)
+        success &= dest->WriteUInt(0);
+
+    if (useDX10)
+    {
+        unsigned dxgiFormat = DXGI_FORMAT_BC7_UNORM;
+        if (format == BCF_BC1)
+            dxgiFormat = DXGI_FORMAT_BC1_UNORM;
+        else if (format == BCF_BC3)
+            dxgiFormat = DXGI_FORMAT_BC3_UNORM;
+        else if (format == BCF_BC4)
+            dxgiFormat = DXGI_FORMAT_BC4_UNORM;
+        else if (format == BCF_BC5)
+            dxgiFormat = DXGI_FORMAT_BC5_UNORM;
+        success &= dest->WriteUInt(dxgiFormat);
+        success &= dest->WriteUInt(D3D10_RESOURCE_DIMENSION_TEXTURE2D);
+        success &= dest->WriteUInt(0); // misc flags
+        success &= dest->WriteUInt((unsigned)slices.size()); // array size
+        success &= dest->WriteUInt(0); // misc flags 2
+    }
+
+    // Slices are stored one after another, each with its complete mip chain
+    for (auto& slice : slices)
+        for (auto& level : slice)
+            success &= dest->Write(level.Data.data(), (unsigned)level.Data.size()) == level.Data.size();
+
+    return success;
+}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+#include <SprueEngine/BlockMap.h>
+#include <SprueEngine/TextureGen/TextureNode.h>
+
+#include <memory>
+#include <vector>
+
+namespace SprueEngine
+{
+
+class Serializer;
+
+/// GPU block compression formats that can be written into DDS files.
+enum BlockCompressionFormat
+{
+    BCF_BC1,    // RGB, 1-bit alpha, 8 bytes per block (DXT1)
+    BCF_BC3,    // RGBA, BC1 color + BC4 alpha, 16 bytes per block (DXT5)
+    BCF_BC4,    // Single channel (red), 8 bytes per block - roughness, height, masks
+    BCF_BC5,    // Two channels (red + green), 16 bytes per block - tangent space normals
+    BCF_BC7,    // RGBA, 16 bytes per block, high quality color
+};
+
+/// A single compressed mip level.
+struct SPRUE CompressedMipLevel
+{
+    unsigned Width = 0;
+    unsigned Height = 0;
+    std::vector<unsigned char> Data;
+};
+
+/// Encodes FilterableBlockMap<RGBA> images into BCn blocks with full mip chains.
+/// Work is split by rows of 4x4 blocks across all hardware threads, endpoint search uses SSE2 where available.
+/// Images do not need to be a multiple of 4 pixels in size, edge blocks are padded by clamping.
+class SPRUE BlockCompressor
+{
+public:
+    /// Picks the most appropriate format for the purpose of a texture output.
+    static BlockCompressionFormat SelectFormat(TexGenOutputType outputType, bool hasAlpha);
+    /// Returns the number of bytes in one 4x4 block of the given format.
+    static unsigned GetBlockSize(BlockCompressionFormat format);
+    /// Returns the number of mip levels in a complete chain down to 1x1.
+    static unsigned CalculateMipCount(unsigned width, unsigned height);
+
+    /// Builds the complete mip chain for an image, index 0 is a copy of the source. Normal maps are renormalized at each level.
+    static std::vector<std::shared_ptr<FilterableBlockMap<RGBA> > > BuildMipChain(const FilterableBlockMap<RGBA>* image, bool isNormalMap);
+    /// Compresses a single image (no mips) into the given format.
+    static void Compress(const FilterableBlockMap<RGBA>* image, BlockCompressionFormat format, CompressedMipLevel& into);
+    /// Compresses an image and optionally every level of its mip chain.
+    static std::vector<CompressedMipLevel> CompressWithMips(const FilterableBlockMap<RGBA>* image, BlockCompressionFormat format, bool generateMips, bool isNormalMap);
+
+    /// Writes a complete DDS file (header and all levels). BC4/BC5/BC7 use the DX10 extended header.
+    static bool WriteDDS(Serializer* dest, const std::vector<CompressedMipLevel>& levels, BlockCompressionFormat format);
+    /// Writes a DDS texture array, every slice must have the same size and number of levels. Arrays always use the DX10 extended header.
+    static bool WriteDDSArray(Serializer* dest, const std::vector<std::vector<CompressedMipLevel> >& slices, BlockCompressionFormat format);
+
+    /// Encode a single 4x4 RGBA8 block (64 bytes, row-major) into the destination, which must have GetBlockSize bytes available.
+    static void EncodeBlock(BlockCompressionFormat format, const unsigned char* rgbaBlock, unsigned char* dest);
+};
+
+}
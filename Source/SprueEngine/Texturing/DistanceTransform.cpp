@@ -0,0 +1,127 @@
+#include "DistanceTransform.h"
+
+#include <SprueEngine/ParallelFor.h>
+
+#include <cmath>
+
+namespace SprueEngine
+{
+
+const float DistanceTransform::Infinity = 1e20f;
+
+void DistanceTransform::Transform1D(float* f, unsigned count, unsigned stride, bool tiling, Scratch& scratch)
+{
+    // Tiling repeats the line once either side, the nearest repeat of any feature is always within the padded domain
+    const int offset = tiling ? (int)count : 0;
+    const int domain = tiling ? (int)count * 3 : (int)count;
+
+    scratch.values_.resize(count);
+    scratch.vertices_.resize(domain);
+    scratch.boundaries_.resize(domain + 1);
+    float* values = scratch.values_.data();
+    int* v = scratch.vertices_.data();
+    double* z = scratch.boundaries_.data();
+    for (unsigned i = 0; i < count; ++i)
+        values[i] = f[i * stride];
+
+    // Lower envelope of the parabolas rooted at every feature, samples without one are left out entirely
+    int k = -1;
+    for (int q = 0; q < domain; ++q)
+    {
+        const float fq = values[q % count];
+        if (fq >= Infinity)
+            continue;
+        if (k < 0)
+        {
+            k = 0;
+            v[0] = q;
+            z[0] = -HUGE_VAL;
+            z[1] = HUGE_VAL;
+            continue;
+        }
+
+        // z[0] is -infinity so the search always stops at the first parabola
+        double s = 0.0;
+        for (;;)
+        {
+            const int p = v[k];
+            s = ((fq + (double)q * q) - (values[p % count] + (double)p * p)) / (2.0 * (q - p));
+            if (s > z[k])
+                break;
+            --k;
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = HUGE_VAL;
+    }
+
+    if (k < 0)
+    {
+        for (unsigned i = 0; i < count; ++i)
+            f[i * stride] = Infinity;
+        return;
+    }
+
+    k = 0;
+    for (int q = offset; q < offset + (int)count; ++q)
+    {
+        while (z[k + 1] < q)
+            ++k;
+        const double delta = q - v[k];
+        f[(q - offset) * stride] = (float)(delta * delta + values[v[k] % count]);
+    }
+}
+
+void DistanceTransform::Transform2D(std::vector<float>& field, unsigned width, unsigned height, bool tiling)
+{
+    float* data = field.data();
+    ParallelFor(0, width, [=](unsigned x) {
+        thread_local Scratch scratch;
+        Transform1D(data + x, height, width, tiling, scratch);
+    });
+    ParallelFor(0, height, [=](unsigned y) {
+        thread_local Scratch scratch;
+        Transform1D(data + y * width, width, 1, tiling, scratch);
+    });
+}
+
+void DistanceTransform::SquaredDistance(const std::vector<bool>& features, unsigned width, unsigned height, bool tiling, std::vector<float>& into)
+{
+    into.resize(width * height);
+    for (unsigned i = 0; i < into.size(); ++i)
+        into[i] = features[i] ? 0.0f : Infinity;
+    Transform2D(into, width, height, tiling);
+}
+
+void DistanceTransform::SignedDistance(const std::vector<bool>& inside, unsigned width, unsigned height, bool tiling, std::vector<float>& into)
+{
+    const unsigned pixelCount = width * height;
+    into.resize(pixelCount);
+
+    unsigned insideCount = 0;
+    for (unsigned i = 0; i < pixelCount; ++i)
+        insideCount += inside[i] ? 1 : 0;
+    if (insideCount == 0 || insideCount == pixelCount)
+    {
+        const float limit = (float)(width + height);
+        for (unsigned i = 0; i < pixelCount; ++i)
+            into[i] = insideCount ? limit : -limit;
+        return;
+    }
+
+    // Outside pixels measure to the nearest inside pixel and inside pixels to the nearest outside pixel
+    std::vector<float> toOutside(pixelCount);
+    for (unsigned i = 0; i < pixelCount; ++i)
+    {
+        into[i] = inside[i] ? 0.0f : Infinity;
+        toOutside[i] = inside[i] ? Infinity : 0.0f;
+    }
+    Transform2D(into, width, height, tiling);
+    Transform2D(toOutside, width, height, tiling);
+
+    for (unsigned i = 0; i < pixelCount; ++i)
+        into[i] = inside[i] ? sqrtf(toOutside[i]) - 0.5f : 0.5f - sqrtf(into[i]);
+}
+
+}
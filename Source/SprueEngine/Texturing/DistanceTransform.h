@@ -0,0 +1,43 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+
+#include <vector>
+
+namespace SprueEngine
+{
+
+/// Exact Euclidean distance transforms of binary masks in linear time.
+/// Uses the separable lower envelope of parabolas method of Felzenszwalb and Huttenlocher: a 1D transform down every column
+/// followed by a 1D transform along every row. Columns and rows are independent and are spread across all hardware threads.
+/// With tiling the image is treated as periodic so distances are measured across the edges to the nearest repeat.
+class SPRUE DistanceTransform
+{
+public:
+    /// Value of pixels with no feature to measure to (an empty mask), as a squared distance.
+    static const float Infinity;
+
+    /// Computes the squared distance of every pixel to the nearest pixel for which features is true, row-major width * height.
+    static void SquaredDistance(const std::vector<bool>& features, unsigned width, unsigned height, bool tiling, std::vector<float>& into);
+
+    /// Computes the signed distance, in pixels, of every pixel to the edge of the mask. Positive inside, negative outside.
+    /// The edge is taken to lie halfway between an inside and an outside pixel, so neighbors either side of it are +0.5 and -0.5.
+    /// If the mask is empty or full every pixel is given a distance of -(width + height) or +(width + height) respectively.
+    static void SignedDistance(const std::vector<bool>& inside, unsigned width, unsigned height, bool tiling, std::vector<float>& into);
+
+private:
+    /// Scratch space of the 1D transform, kept per worker thread so it is allocated once per pass rather than once per line.
+    struct Scratch
+    {
+        std::vector<float> values_;
+        std::vector<int> vertices_;
+        std::vector<double> boundaries_;
+    };
+
+    /// 1D squared distance transform of count samples of f spaced stride apart, written back in place.
+    static void Transform1D(float* f, unsigned count, unsigned stride, bool tiling, Scratch& scratch);
+    /// Runs Transform1D down every column and then along every row.
+    static void Transform2D(std::vector<float>& field, unsigned width, unsigned height, bool tiling);
+};
+
+}
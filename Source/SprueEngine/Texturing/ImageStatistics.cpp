@@ -0,0 +1,189 @@
+#include "ImageStatistics.h"
+
+#include <SprueEngine/ParallelFor.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace SprueEngine
+{
+
+ImageStatistics::ImageStatistics() :
+    Min(0, 0, 0, 0),
+    Max(0, 0, 0, 0),
+    Mean(0, 0, 0, 0),
+    Variance(0, 0, 0, 0)
+{
+
+}
+
+void ImageStatistics::Calculate(const FilterableBlockMap<RGBA>* image, unsigned maxWorkers)
+{
+    PixelCount = 0;
+    Min = Max = Mean = Variance = RGBA(0, 0, 0, 0);
+    for (unsigned c = 0; c < 4; ++c)
+    {
+        Histogram[c].assign(HistogramBins, 0);
+        cumulative_[c].assign(HistogramBins + 1, 0);
+    }
+    if (!image || image->getWidth() == 0 || image->getHeight() == 0)
+        return;
+
+    const unsigned width = image->getWidth();
+    const unsigned height = image->getHeight();
+    const RGBA* pixels = image->getData();
+
+    // A few chunks per worker keeps them balanced without a partial result per row
+    const unsigned chunkCount = std::min(height, GetParallelWorkerCount() * 4);
+    const unsigned rowsPerChunk = (height + chunkCount - 1) / chunkCount;
+
+    struct Moments
+    {
+        unsigned count[4];
+        float min[4];
+        float max[4];
+        double sum[4];
+        double sumSquared[4];
+    };
+    std::vector<Moments> moments(chunkCount);
+    ParallelFor(0, chunkCount, [&](unsigned chunk) {
+        Moments& m = moments[chunk];
+        for (unsigned c = 0; c < 4; ++c)
+        {
+            m.count[c] = 0;
+            m.min[c] = FLT_MAX;
+            m.max[c] = -FLT_MAX;
+            m.sum[c] = 0.0;
+            m.sumSquared[c] = 0.0;
+        }
+        const unsigned end = std::min(height, (chunk + 1) * rowsPerChunk);
+        for (unsigned y = chunk * rowsPerChunk; y < end; ++y)
+        {
+            const RGBA* row = pixels + y * width;
+            for (unsigned x = 0; x < width; ++x)
+            {
+                for (unsigned c = 0; c < 4; ++c)
+                {
+                    const float value = Channel(row[x], c);
+                    if (value != value)
+                        continue;
+                    ++m.count[c];
+                    m.min[c] = std::min(m.min[c], value);
+                    m.max[c] = std::max(m.max[c], value);
+                    m.sum[c] += value;
+                    m.sumSquared[c] += (double)value * value;
+                }
+            }
+        }
+    }, maxWorkers);
+
+    unsigned counts[4] = { 0, 0, 0, 0 };
+    float* min = &Min.r;
+    float* max = &Max.r;
+    float* mean = &Mean.r;
+    float* variance = &Variance.r;
+    for (unsigned c = 0; c < 4; ++c)
+    {
+        double sum = 0.0;
+        double sumSquared = 0.0;
+        min[c] = FLT_MAX;
+        max[c] = -FLT_MAX;
+        for (const Moments& m : moments)
+        {
+            counts[c] += m.count[c];
+            min[c] = std::min(min[c], m.min[c]);
+            max[c] = std::max(max[c], m.max[c]);
+            sum += m.sum[c];
+            sumSquared += m.sumSquared[c];
+        }
+        if (counts[c] == 0)
+        {
+            min[c] = max[c] = 0.0f;
+            continue;
+        }
+        const double channelMean = sum / counts[c];
+        mean[c] = (float)channelMean;
+        variance[c] = (float)std::max(sumSquared / counts[c] - channelMean * channelMean, 0.0);
+    }
+    PixelCount = std::max(std::max(counts[0], counts[1]), std::max(counts[2], counts[3]));
+
+    // Second pass bins every channel across its own range
+    float scale[4];
+    for (unsigned c = 0; c < 4; ++c)
+        scale[c] = max[c] > min[c] ? HistogramBins / (max[c] - min[c]) : 0.0f;
+
+    std::vector<std::vector<unsigned> > bins(chunkCount);
+    ParallelFor(0, chunkCount, [&](unsigned chunk) {
+        std::vector<unsigned>& local = bins[chunk];
+        local.assign(HistogramBins * 4, 0);
+        const unsigned end = std::min(height, (chunk + 1) * rowsPerChunk);
+        for (unsigned y = chunk * rowsPerChunk; y < end; ++y)
+        {
+            const RGBA* row = pixels + y * width;
+            for (unsigned x = 0; x < width; ++x)
+            {
+                for (unsigned c = 0; c < 4; ++c)
+                {
+                    const float value = Channel(row[x], c);
+                    if (value != value)
+                        continue;
+                    const unsigned bin = std::min((unsigned)((value - min[c]) * scale[c]), HistogramBins - 1);
+                    ++local[c * HistogramBins + bin];
+                }
+            }
+        }
+    }, maxWorkers);
+
+    for (unsigned c = 0; c < 4; ++c)
+    {
+        for (const std::vector<unsigned>& local : bins)
+            for (unsigned i = 0; i < HistogramBins; ++i)
+                Histogram[c][i] += local[c * HistogramBins + i];
+        for (unsigned i = 0; i < HistogramBins; ++i)
+            cumulative_[c][i + 1] = cumulative_[c][i] + Histogram[c][i];
+    }
+}
+
+float ImageStatistics::GetStandardDeviation(unsigned channel) const
+{
+    return sqrtf(Channel(Variance, channel));
+}
+
+float ImageStatistics::Percentile(unsigned channel, float fraction) const
+{
+    channel &= 3;
+    const float min = Channel(Min, channel);
+    const float max = Channel(Max, channel);
+    const unsigned total = cumulative_[channel].empty() ? 0 : cumulative_[channel].back();
+    if (total == 0 || max <= min)
+        return min;
+
+    const float target = std::max(0.0f, std::min(fraction, 1.0f)) * total;
+    const std::vector<unsigned>& cumulative = cumulative_[channel];
+    // First bin whose running count reaches the target
+    const unsigned bin = std::min((unsigned)(std::lower_bound(cumulative.begin() + 1, cumulative.end(), (unsigned)ceilf(target)) - cumulative.begin()) - 1, HistogramBins - 1);
+    const unsigned inBin = Histogram[channel][bin];
+    const float within = inBin ? (target - cumulative[bin]) / inBin : 0.0f;
+    const float binWidth = (max - min) / HistogramBins;
+    return min + (bin + std::max(0.0f, std::min(within, 1.0f))) * binWidth;
+}
+
+float ImageStatistics::CumulativeFraction(unsigned channel, float value) const
+{
+    channel &= 3;
+    const float min = Channel(Min, channel);
+    const float max = Channel(Max, channel);
+    const unsigned total = cumulative_[channel].empty() ? 0 : cumulative_[channel].back();
+    if (total == 0 || value >= max)
+        return 1.0f;
+    if (value < min)
+        return 0.0f;
+
+    const float position = (value - min) / (max - min) * HistogramBins;
+    const unsigned bin = std::min((unsigned)position, HistogramBins - 1);
+    const float within = position - bin;
+    return (cumulative_[channel][bin] + within * Histogram[channel][bin]) / total;
+}
+
+}
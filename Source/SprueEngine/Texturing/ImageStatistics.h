@@ -0,0 +1,50 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+#include <SprueEngine/BlockMap.h>
+#include <SprueEngine/Math/Color.h>
+
+#include <vector>
+
+namespace SprueEngine
+{
+
+/// Image-wide statistics of every channel of an image: range, mean, variance and a histogram with percentiles.
+/// Calculated by a parallel reduction, rows are split into chunks that are reduced independently and then merged.
+/// A first pass finds the range, mean and variance, a second fills the histogram whose bins evenly divide each channel's range.
+/// NaN values are ignored.
+class SPRUE ImageStatistics
+{
+public:
+    /// Number of histogram bins per channel.
+    static const unsigned HistogramBins = 1024;
+
+    ImageStatistics();
+
+    /// Replaces the statistics with those of the image.
+    void Calculate(const FilterableBlockMap<RGBA>* image, unsigned maxWorkers = 0);
+
+    /// Returns the given channel (0 - 3, r g b a) of a color.
+    static float Channel(const RGBA& value, unsigned channel) { return (&value.r)[channel & 3]; }
+
+    float GetStandardDeviation(unsigned channel) const;
+    /// Returns the value below which the given fraction (0 - 1) of the pixels lie, interpolated within the histogram bin.
+    float Percentile(unsigned channel, float fraction) const;
+    /// Returns the fraction of the pixels lying below the value, the cumulative distribution used for equalization.
+    float CumulativeFraction(unsigned channel, float value) const;
+
+    /// Number of pixels measured.
+    unsigned PixelCount = 0;
+    RGBA Min;
+    RGBA Max;
+    RGBA Mean;
+    RGBA Variance;
+    /// Pixel counts of each bin per channel.
+    std::vector<unsigned> Histogram[4];
+
+private:
+    /// Running pixel counts before each bin per channel, HistogramBins + 1 entries.
+    std::vector<unsigned> cumulative_[4];
+};
+
+}
@@ -0,0 +1,137 @@
+#include "MipPyramid.h"
+
+#include <SprueEngine/Texturing/BlockCompression.h>
+
+#include <cmath>
+
+namespace SprueEngine
+{
+
+void MipPyramid::Build(const std::shared_ptr<FilterableBlockMap<RGBA> >& image, bool mips)
+{
+    if (!mips)
+    {
+        levels_.assign(1, image);
+        return;
+    }
+
+    levels_ = BlockCompressor::BuildMipChain(image.get(), false);
+    // The chain starts with a copy, keep the image itself instead
+    if (!levels_.empty())
+        levels_[0] = image;
+}
+
+unsigned long long MipPyramid::GetMemorySize() const
+{
+    unsigned long long ret = 0;
+    for (auto& level : levels_)
+        ret += sizeof(RGBA) * level->getWidth() * level->getHeight();
+    return ret;
+}
+
+RGBA MipPyramid::SampleLevel(unsigned level, float u, float v) const
+{
+    if (levels_.empty())
+        return RGBA(0, 0, 0, 1);
+
+    const FilterableBlockMap<RGBA>* image = levels_[SprueMin(level, (unsigned)levels_.size() - 1)].get();
+    const int width = (int)image->getWidth();
+    const int height = (int)image->getHeight();
+    const float scaleX = width / (float)levels_[0]->getWidth();
+    const float scaleY = height / (float)levels_[0]->getHeight();
+
+    // Texels of lower levels sit at the center of the top level pixels they average
+    const float x = u * width - 0.5f + 0.5f * scaleX;
+    const float y = v * height - 0.5f + 0.5f * scaleY;
+    const float xFloor = floorf(x);
+    const float yFloor = floorf(y);
+    const float xFrac = x - xFloor;
+    const float yFrac = y - yFloor;
+
+    int x0 = (int)xFloor % width;
+    int y0 = (int)yFloor % height;
+    if (x0 < 0)
+        x0 += width;
+    if (y0 < 0)
+        y0 += height;
+    const int x1 = (x0 + 1) % width;
+    const int y1 = (y0 + 1) % height;
+
+    const RGBA top = SprueLerp(image->get(x0, y0), image->get(x1, y0), xFrac);
+    const RGBA bottom = SprueLerp(image->get(x0, y1), image->get(x1, y1), xFrac);
+    return SprueLerp(top, bottom, yFrac);
+}
+
+RGBA MipPyramid::Sample(float u, float v, float footprint) const
+{
+    if (levels_.size() < 2 || !(footprint > 1.0f))
+        return SampleLevel(0, u, v);
+
+    const float lod = SprueMin(log2f(footprint), (float)(levels_.size() - 1));
+    const unsigned lower = (unsigned)lod;
+    const float blend = lod - lower;
+    if (blend <= 0.0f || lower + 1 >= levels_.size())
+        return SampleLevel(lower, u, v);
+    return SprueLerp(SampleLevel(lower, u, v), SampleLevel(lower + 1, u, v), blend);
+}
+
+RGBA MipPyramid::SampleNearest(float u, float v) const
+{
+    if (levels_.empty())
+        return RGBA(0, 0, 0, 1);
+
+    const FilterableBlockMap<RGBA>* image = levels_[0].get();
+    const int width = (int)image->getWidth();
+    const int height = (int)image->getHeight();
+    int x = (int)floorf(u * width + 0.5f) % width;
+    int y = (int)floorf(v * height + 0.5f) % height;
+    if (x < 0)
+        x += width;
+    if (y < 0)
+        y += height;
+    return image->get(x, y);
+}
+
+static inline float CatmullRom(float p0, float p1, float p2, float p3, float t)
+{
+    return p1 + 0.5f * t * (p2 - p0 + t * (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3 + t * (3.0f * (p1 - p2) + p3 - p0)));
+}
+
+static inline RGBA CatmullRom(const RGBA& p0, const RGBA& p1, const RGBA& p2, const RGBA& p3, float t)
+{
+    return RGBA(CatmullRom(p0.r, p1.r, p2.r, p3.r, t), CatmullRom(p0.g, p1.g, p2.g, p3.g, t), CatmullRom(p0.b, p1.b, p2.b, p3.b, t), CatmullRom(p0.a, p1.a, p2.a, p3.a, t));
+}
+
+RGBA MipPyramid::SampleBicubic(float u, float v) const
+{
+    if (levels_.empty())
+        return RGBA(0, 0, 0, 1);
+
+    const FilterableBlockMap<RGBA>* image = levels_[0].get();
+    const int width = (int)image->getWidth();
+    const int height = (int)image->getHeight();
+    const float x = u * width;
+    const float y = v * height;
+    const float xFloor = floorf(x);
+    const float yFloor = floorf(y);
+    const float xFrac = x - xFloor;
+    const float yFrac = y - yFloor;
+
+    int xs[4], ys[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        xs[i] = ((int)xFloor - 1 + i) % width;
+        ys[i] = ((int)yFloor - 1 + i) % height;
+        if (xs[i] < 0)
+            xs[i] += width;
+        if (ys[i] < 0)
+            ys[i] += height;
+    }
+
+    RGBA rows[4];
+    for (int i = 0; i < 4; ++i)
+        rows[i] = CatmullRom(image->get(xs[0], ys[i]), image->get(xs[1], ys[i]), image->get(xs[2], ys[i]), image->get(xs[3], ys[i]), xFrac);
+    return CatmullRom(rows[0], rows[1], rows[2], rows[3], yFrac);
+}
+
+}
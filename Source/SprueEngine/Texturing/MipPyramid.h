@@ -0,0 +1,44 @@
+#pragma once
+
+#include <SprueEngine/ClassDef.h>
+#include <SprueEngine/BlockMap.h>
+#include <SprueEngine/Math/Color.h>
+
+#include <memory>
+#include <vector>
+
+namespace SprueEngine
+{
+
+/// An image and its box filtered mip chain, sampled with wrapping trilinear filtering.
+/// Pixel x of the top level holds the value at coordinate x / width, the way texture graphs are rendered, so sampling at those
+/// coordinates returns the pixels exactly. Every level is treated as tiling.
+class SPRUE MipPyramid
+{
+public:
+    /// Takes the image as the top level and builds every level below it down to 1x1, or only the top level when mips is false.
+    void Build(const std::shared_ptr<FilterableBlockMap<RGBA> >& image, bool mips = true);
+    /// Releases every level.
+    void Clear() { levels_.clear(); }
+
+    bool IsEmpty() const { return levels_.empty(); }
+    unsigned GetLevelCount() const { return levels_.size(); }
+    unsigned GetWidth() const { return levels_.empty() ? 0 : levels_[0]->getWidth(); }
+    unsigned GetHeight() const { return levels_.empty() ? 0 : levels_[0]->getHeight(); }
+    /// Bytes held by all levels.
+    unsigned long long GetMemorySize() const;
+
+    /// Bilinear sample of a single level.
+    RGBA SampleLevel(unsigned level, float u, float v) const;
+    /// Trilinear sample, footprint is the width in top level pixels of the area the sample stands for. Footprints of 1 or less sample the top level.
+    RGBA Sample(float u, float v, float footprint) const;
+    /// Nearest pixel of the top level.
+    RGBA SampleNearest(float u, float v) const;
+    /// Catmull-Rom sample of the top level, passes through the pixels like bilinear sampling but with a continuous slope.
+    RGBA SampleBicubic(float u, float v) const;
+
+private:
+    std::vector<std::shared_ptr<FilterableBlockMap<RGBA> > > levels_;
+};
+
+}
@@ -5,6 +5,10 @@
 #include <EditorLib/Settings/SettingsPage.h>
 #include <EditorLib/Settings/SettingsValue.h>
 
+#include <SprueEngine/Core/Context.h>
+#include <SprueEngine/ResourceStore.h>
+#include <SprueEngine/Texturing/BakeCache.h>
+
 #include <QApplication>
 #include <QDir>
 #include <QStandardPaths>
@@ -72,6 +76,24 @@ namespace SprueEditor
             page->InitializeSetting(new SettingValue{ ST_VARIANT_TYPE, "Tex coord stretch", "Allowed 'stretching' distortion in generated UV coordinates", 0.5, 0.5, QVariant() });
             page->InitializeSetting(new SettingValue{ ST_VARIANT_TYPE, "Tex coord charts", "Desired number of UV islands, if 0 only stretch is used and the islands are uncapped", 5, 5, QVariant() });
             page->InitializeSetting(new SettingValue{ ST_VARIANT_TYPE, "Tex chart gutter", "Spacing alloted (in pixels) between UV islands", 2.0, 2.0, QVariant() });
+            page->InitializeSetting(new SettingValue{ ST_VARIANT_TYPE, "Texture preview error", "Largest difference from the full resolution result, in 8-bit steps, that texture previews may accept to evaluate low detail branches at a reduced resolution", 1.0, 1.0, QVariant() });
+            page->InitializeSetting(new SettingValue{ ST_VARIANT_TYPE, "Force full resolution previews", "If checked every node of a texture preview is evaluated at the full resolution", QVariant(false), QVariant(false), QVariant() });
+        }
+
+        // Baking settings
+        {
+            SettingsPage* page = settings->CreatePage("Texture Baking", "Storage of baked mesh inputs");
+            QString defaultCache = QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QDir::separator() + "BakeCache");
+            page->InitializeSetting(new SettingValue{ ST_PATH, "Bake cache folder", "Folder baked mesh inputs are kept in between sessions, if empty bakes are only kept until the editor closes", defaultCache, defaultCache, QVariant() });
+            page->InitializeSetting(new SettingValue{ ST_VARIANT_TYPE, "Bake cache memory (MB)", "How much memory baked mesh inputs may hold on to, the least recently used are read back from the folder when needed", QVariant(256), QVariant(256), QVariant() });
+        }
+
+        // Resource cache settings
+        {
+            SettingsPage* page = settings->CreatePage("Resource Cache", "Retention of loaded images and meshes");
+            QString defaultCache = QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QDir::separator() + "ImageCache");
+            page->InitializeSetting(new SettingValue{ ST_VARIANT_TYPE, "Resource memory (MB)", "How much memory images and meshes no longer used by any graph may hold on to before the least recently used are released", QVariant(512), QVariant(512), QVariant() });
+            page->InitializeSetting(new SettingValue{ ST_PATH, "Decoded image cache folder", "Folder large source images are kept in decoded form, which loads much faster than PNG or JPEG, if empty images are always decoded", defaultCache, defaultCache, QVariant() });
         }
 
         // Search settings
@@ -103,6 +125,7 @@ namespace SprueEditor
             page->InitializeSetting(new SettingValue{ ST_VARIANT_TYPE, "Naming Convention", "Determines how to name the files exported", QString("%1_%2"), QString("%1_%2"), QVariant() });
             page->InitializeSetting(new SettingValue{ ST_VARIANT_TYPE, "Use Short Names", "Whether to use short affix names in exported files", false, false, QVariant() });
             page->InitializeSetting(new SettingValue{ ST_VARIANT_TYPE, "Export Format", "Type of format to use for image export", 0, 0, QVariant() });
+            page->InitializeSetting(new SettingValue{ ST_VARIANT_TYPE, "Compression Level", "Speed/size preset used for PNG, TGA and raw export", 2, 2, QVariant() });
         }
 
         // Secret Texture reporting settings
@@ -137,4 +160,41 @@ namespace SprueEditor
         }
     }
 
-}
\ No newline at end of file
+    void TextureGraph_ApplySettings(Settings* settings)
+    {
+        SettingValue* folder = settings->GetValue("Texture Baking/Bake cache folder");
+        SettingValue* memory = settings->GetValue("Texture Baking/Bake cache memory (MB)");
+        auto applyBakeCache = [=](const QVariant&) {
+            QString path = folder ? folder->value_.toString() : QString();
+            if (!path.isEmpty() && !QDir().mkpath(path))
+                path.clear();
+            SprueEngine::BakeCache::GetInstance()->SetDirectory(path.toStdString());
+            if (memory)
+                SprueEngine::BakeCache::GetInstance()->SetMemoryBudget((unsigned long long)qMax(memory->value_.toInt(), 0) * 1024 * 1024);
+        };
+        if (folder)
+            QObject::connect(folder, &SettingValue::Changed, applyBakeCache);
+        if (memory)
+            QObject::connect(memory, &SettingValue::Changed, applyBakeCache);
+        applyBakeCache(QVariant());
+
+        SettingValue* resourceMemory = settings->GetValue("Resource Cache/Resource memory (MB)");
+        SettingValue* imageCache = settings->GetValue("Resource Cache/Decoded image cache folder");
+        auto applyResourceCache = [=](const QVariant&) {
+            SprueEngine::ResourceStore* store = SprueEngine::Context::GetInstance()->GetService<SprueEngine::ResourceStore>();
+            if (!store)
+                return;
+            QString path = imageCache ? imageCache->value_.toString() : QString();
+            if (!path.isEmpty() && !QDir().mkpath(path))
+                path.clear();
+            store->SetDecodedImageCache(path.toStdString());
+            if (resourceMemory)
+                store->SetMemoryBudget((unsigned long long)qMax(resourceMemory->value_.toInt(), 0) * 1024 * 1024);
+        };
+        if (resourceMemory)
+            QObject::connect(resourceMemory, &SettingValue::Changed, applyResourceCache);
+        if (imageCache)
+            QObject::connect(imageCache, &SettingValue::Changed, applyResourceCache);
+        applyResourceCache(QVariant());
+    }
+}
@@ -5,4 +5,6 @@ class Settings;
 namespace SprueEditor
 {
     void TextureGraph_ConstructSettings(Settings* settings);
+    /// Hands restored settings to the engine and keeps them updated as they change.
+    void TextureGraph_ApplySettings(Settings* settings);
 }
\ No newline at end of file
@@ -13,7 +13,7 @@ namespace SprueEditor
     int SaveImageDialog::ImageHeight = 128;
 
     SaveImageDialog::SaveImageDialog() :
-        QFileDialog(0x0, "Save Image", "", "PNG Image (*.png);;TGA Image (*.tga);;HDR Image (*.hdr);;DDS Compressed (*.dds)")
+        QFileDialog(0x0, "Save Image", "", "PNG Image (*.png);;TGA Image (*.tga);;HDR Image (*.hdr);;DDS Compressed (*.dds);;Raw Texture (*.texr)")
     {
         setOption(QFileDialog::Option::DontUseNativeDialog, true);
         setAcceptMode(QFileDialog::AcceptSave);
@@ -5,6 +5,7 @@
 #include "../../Documents/TexGen/TextureDocument.h"
 #include "../../GlobalAccess.h"
 #include "../../Documents/TexGen/Tasks/TextureGenTask.h"
+#include "../../Documents/TexGen/Tasks/TextureProfileTask.h"
 
 #include "../../Data/TexGenData.h"
 
@@ -22,6 +23,7 @@
 
 #include <SprueEngine/Core/Context.h>
 #include <SprueEngine/Loaders/BasicImageLoader.h>
+#include <SprueEngine/Math/MathDef.h>
 
 #include <memory>
 
@@ -129,6 +131,58 @@ namespace SprueEditor
         }
     }
 
+    void TextureGraphControl::ProfileGenerated(TextureProfileTask* task)
+    {
+        if (!task || graph_ == 0x0 || document_ == 0x0)
+            return;
+
+        ClearProfile();
+
+        const auto& profiles = task->GetProfiles();
+        if (profiles.empty())
+            return;
+
+        // Sorted slowest first
+        const double slowestMS = SprueMax(profiles.front().SelfMS(), 0.001);
+        const double totalMS = SprueMax(task->GetTotalMS(), 0.001);
+        for (auto& profile : profiles)
+        {
+            GraphNode* node = graph_->GetNodeByInstanceID(profile.SourceID);
+            if (!node)
+                continue;
+            auto found = document_->GetNodeToBlockTable().find(node);
+            if (found == document_->GetNodeToBlockTable().end())
+                continue;
+
+            const double heat = CLAMP01(profile.SelfMS() / slowestMS);
+            // Blue for cheap nodes through to red for the most expensive one, kept dark enough for the block text
+            found->second->setBackgroundColor(QColor::fromHsvF((1.0 - heat) * 0.66, 0.75, 0.35 + heat * 0.25));
+            found->second->setToolTip(QString("Self: %1 ms (%2%)\nInclusive: %3 ms\nSamples: %4\nCache hits: %5\nMemory: %6 KB")
+                .arg(profile.SelfMS(), 0, 'f', 2)
+                .arg(profile.SelfMS() / totalMS * 100.0, 0, 'f', 1)
+                .arg(profile.InclusiveMS(), 0, 'f', 2)
+                .arg(profile.Samples)
+                .arg(profile.CacheHits)
+                .arg(profile.MemoryAllocated / 1024.0, 0, 'f', 1));
+        }
+        view_->repaint();
+    }
+
+    void TextureGraphControl::ClearProfile()
+    {
+        if (document_ == 0x0)
+            return;
+        for (auto& record : document_->GetNodeToBlockTable())
+        {
+            if (dynamic_cast<TextureOutputNode*>(record.first))
+                record.second->setBackgroundColor(QColor(40, 120, 40));
+            else
+                record.second->setBackgroundColor(QColor(40, 40, 40));
+            record.second->setToolTip(QString());
+        }
+        view_->repaint();
+    }
+
     void TextureGraphControl::AllowConnect(bool& allowed, QNEPort* lhs, QNEPort* rhs)
     {
         BaseGraphControl::AllowConnect(allowed, lhs, rhs);
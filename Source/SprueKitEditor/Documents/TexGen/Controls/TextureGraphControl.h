@@ -9,6 +9,7 @@
 namespace SprueEditor
 {
     class TextureGenTask;
+    class TextureProfileTask;
 
     /// Specialization of the graph control for manipulating texture graphs
     class TextureGraphControl : public BaseGraphControl, public ISignificantControl
@@ -20,6 +21,10 @@ namespace SprueEditor
         virtual ~TextureGraphControl();
 
         void PreviewGenerated(TextureGenTask* task);
+        /// Tints every profiled block from cool to hot by its share of the slowest node's self time.
+        void ProfileGenerated(TextureProfileTask* task);
+        /// Restores the regular block colors after profiling.
+        void ClearProfile();
 
     protected:
         virtual void AllowConnect(bool&, QNEPort*, QNEPort*) override;
@@ -3,7 +3,7 @@
 #include "../../GlobalAccess.h"
 #include "../../Data/SprueDataSources.h"
 
-#include "../../Documents/TexGen/Tasks/TextureInspectorGenTask.h"
+#include "../../Documents/TexGen/Tasks/TextureInspectorTileTask.h"
 
 #include <QApplication>
 #include <QBoxLayout>
@@ -13,10 +13,17 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QScrollbar>
+#include <QTimer>
 #include <qevent.h>
 
 #include <SprueEngine/TextureGen/TextureNode.h>
 
+#include <algorithm>
+#include <cmath>
+
+/// Bytes of rendered tiles kept in memory.
+#define INSPECTOR_TILE_MEMORY (128 * 1024 * 1024)
+
 namespace SprueEditor
 {
 
@@ -67,6 +74,12 @@ namespace SprueEditor
             QGraphicsView::wheelEvent(evt);
         }
 
+        virtual void resizeEvent(QResizeEvent* evt)
+        {
+            QGraphicsView::resizeEvent(evt);
+            inspector_->UpdateTiles();
+        }
+
         void SetZoom(int level)
         {
             const int GraphZoomLevelsCt = 16;
@@ -96,6 +109,7 @@ namespace SprueEditor
             QTransform trans;
             trans.scale(GraphZoomLevels[currentZoom_], GraphZoomLevels[currentZoom_]);
             setTransform(trans, false);
+            inspector_->UpdateTiles();
         }
 
         TextureInspector* inspector_;
@@ -104,13 +118,15 @@ namespace SprueEditor
     };
 
     TextureInspector::TextureInspector(QWidget* parent) :
-        QWidget(parent)
+        QWidget(parent),
+        tiles_(std::make_shared<TextureInspectorTileQueue>()),
+        tileCache_(INSPECTOR_TILE_MEMORY)
     {
         QWidget* barWidget = new QWidget(this);
         QVBoxLayout* layout = new QVBoxLayout(this);
         layout->setMargin(2);
         layout->addWidget(barWidget);
-        
+
         QHBoxLayout* barLayout = new QHBoxLayout(barWidget);
         barLayout->setAlignment(Qt::AlignLeft);
         barLayout->setMargin(2);
@@ -129,15 +145,6 @@ namespace SprueEditor
         view_ = new TextureInspectorGraphicsView(this);
         view_->setScene(scene_);
         layout->addWidget(view_);
-        textureItems_ = new QGraphicsPixmapItem*[4];
-        textureItems_[0] = new QGraphicsPixmapItem();
-        textureItems_[1] = new QGraphicsPixmapItem();
-        textureItems_[2] = new QGraphicsPixmapItem();
-        textureItems_[3] = new QGraphicsPixmapItem();
-        scene_->addItem(textureItems_[0]);
-        scene_->addItem(textureItems_[1]);
-        scene_->addItem(textureItems_[2]);
-        scene_->addItem(textureItems_[3]);
         sizeCombo_->setCurrentIndex(1);
         connect(sizeCombo_, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &TextureInspector::ImageSizeChanged);
 
@@ -158,12 +165,27 @@ namespace SprueEditor
         statusText_->setPos(rect->pos().x() + 5, rect->pos().y() + 7);
         statusItem_ = rect;
         statusItem_->setVisible(false);
+        statusItem_->setZValue(1000);
         scene_->addItem(rect);
+
+        // Scrolling is the most common way the view moves
+        connect(view_->horizontalScrollBar(), &QScrollBar::valueChanged, [=](int) { UpdateTiles(); });
+        connect(view_->verticalScrollBar(), &QScrollBar::valueChanged, [=](int) { UpdateTiles(); });
+
+        timer_ = new QTimer(this);
+        timer_->start(50);
+        connect(timer_, &QTimer::timeout, [=]() {
+            CollectTiles();
+            StartTasks();
+        });
     }
 
     TextureInspector::~TextureInspector()
     {
-
+        // Tasks still running see the generation change and stop after their current tile
+        std::lock_guard<std::mutex> lock(tiles_->lock_);
+        ++tiles_->generation_;
+        tiles_->requests_.clear();
     }
 
     void TextureInspector::showEvent(QShowEvent* event)
@@ -171,38 +193,197 @@ namespace SprueEditor
         SelectionChanged(0x0, GetSelectron());
     }
 
-    void TextureInspector::SetImage(QImage* image)
+    int TextureInspector::GetImageSize() const
     {
-        if (image)
+        return TextureInspectorImageSizes[sizeCombo_->currentIndex()];
+    }
+
+    SprueEngine::TextureNode* TextureInspector::GetInspectedNode() const
+    {
+        if (!GetSelectron())
+            return 0x0;
+        if (auto graphNode = GetSelectron()->GetMostRecentSelected<GraphNodeDataSource>())
         {
-            statusItem_->setVisible(false);
-            QPixmap& pix = QPixmap::fromImage(*image);
-            textureItems_[0]->setPixmap(pix);
-            textureItems_[1]->setX(textureItems_[0]->x() + textureItems_[0]->boundingRect().width());
+            auto textureNode = dynamic_cast<SprueEngine::TextureNode*>(graphNode->GetNode());
+            if (textureNode && textureNode->CanPreview())
+                return textureNode;
+        }
+        return 0x0;
+    }
+
+    void TextureInspector::ResetTiles()
+    {
+        {
+            std::lock_guard<std::mutex> lock(tiles_->lock_);
+            ++tiles_->generation_;
+            tiles_->requests_.clear();
+            tiles_->finished_.clear();
+        }
+        tileCache_.clear();
+        for (QGraphicsPixmapItem* item : tileItems_)
+        {
+            scene_->removeItem(item);
+            delete item;
+        }
+        tileItems_.clear();
+    }
+
+    void TextureInspector::UpdateTiles()
+    {
+        if (!view_ || !isVisible() || !GetInspectedNode())
+            return;
 
-            textureItems_[2]->setY(textureItems_[0]->y() + textureItems_[0]->boundingRect().height());
+        const int size = GetImageSize();
+        const int copies = tileMode_->isChecked() ? 2 : 1;
+        scene_->setSceneRect(0, 0, size * copies, size * copies);
+
+        // The coarsest level fits in a single tile, the finest needed has about a pixel per screen pixel
+        const int TileSize = TextureInspectorTileTask::TileSize;
+        int coarsestLevel = 0;
+        while ((size >> coarsestLevel) > TileSize)
+            ++coarsestLevel;
+        const qreal scale = view_->transform().m11();
+        const int viewLevel = std::min(std::max((int)std::floor(std::log2(1.0 / scale)), 0), coarsestLevel);
+
+        const QRectF visible = view_->mapToScene(view_->viewport()->rect()).boundingRect();
+        const QPointF center = visible.center();
+
+        std::vector<TextureInspectorTile> wanted;
+        std::vector<qreal> distances;
+        QMap<QString, QGraphicsPixmapItem*> shown;
+        unsigned generation = 0;
+        {
+            std::lock_guard<std::mutex> lock(tiles_->lock_);
+            generation = tiles_->generation_;
+        }
 
-            textureItems_[3]->setX(textureItems_[0]->x() + textureItems_[0]->boundingRect().width());
-            textureItems_[3]->setY(textureItems_[0]->y() + textureItems_[0]->boundingRect().height());
-            if (tileMode_->isChecked())
+        // From coarse to fine, what is already rendered of the levels in between covers the gaps of the finer one
+        for (int level = coarsestLevel; level >= viewLevel; --level)
+        {
+            const int levelSize = std::max(size >> level, 1);
+            const int tileCt = (levelSize + TileSize - 1) / TileSize;
+            const qreal tileScene = (qreal)TileSize * size / levelSize;
+            for (int copyY = 0; copyY < copies; ++copyY)
             {
-                textureItems_[1]->setPixmap(QPixmap::fromImage(*image));
-                textureItems_[2]->setPixmap(QPixmap::fromImage(*image));
-                textureItems_[3]->setPixmap(QPixmap::fromImage(*image));
+                for (int copyX = 0; copyX < copies; ++copyX)
+                {
+                    for (int y = 0; y < tileCt; ++y)
+                    {
+                        for (int x = 0; x < tileCt; ++x)
+                        {
+                            const QRectF tileRect(copyX * size + x * tileScene, copyY * size + y * tileScene, tileScene, tileScene);
+                            if (!tileRect.intersects(visible))
+                                continue;
+
+                            const QString tileKey = QString("%1/%2/%3").arg(level).arg(x).arg(y);
+                            if (QPixmap* pixmap = tileCache_.object(tileKey))
+                            {
+                                const QString itemKey = QString("%1/%2/%3").arg(copyX).arg(copyY).arg(tileKey);
+                                QGraphicsPixmapItem* item = tileItems_.take(itemKey);
+                                if (!item)
+                                {
+                                    item = new QGraphicsPixmapItem(*pixmap);
+                                    item->setPos(tileRect.topLeft());
+                                    item->setScale((qreal)size / levelSize);
+                                    item->setZValue(coarsestLevel - level);
+                                    item->setTransformationMode(Qt::FastTransformation);
+                                    scene_->addItem(item);
+                                }
+                                shown[itemKey] = item;
+                            }
+                            else if (level == coarsestLevel || level == viewLevel)
+                            {
+                                const bool requested = std::find_if(wanted.begin(), wanted.end(), [&](const TextureInspectorTile& tile) {
+                                    return tile.level_ == level && tile.x_ == x && tile.y_ == y;
+                                }) != wanted.end();
+                                if (requested)
+                                    continue;
+                                // The placeholder goes before everything, then outward from the center of the view
+                                const QPointF offset = tileRect.center() - center;
+                                wanted.push_back(TextureInspectorTile{ generation, level, x, y, QImage() });
+                                distances.push_back(level == coarsestLevel ? -1.0 : offset.x() * offset.x() + offset.y() * offset.y());
+                            }
+                        }
+                    }
+                }
             }
-            else
+        }
+
+        // Whatever is left is out of view or no longer the right level
+        for (QGraphicsPixmapItem* item : tileItems_)
+        {
+            scene_->removeItem(item);
+            delete item;
+        }
+        tileItems_ = shown;
+
+        std::vector<unsigned> order(wanted.size());
+        for (unsigned i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&](unsigned lhs, unsigned rhs) { return distances[lhs] < distances[rhs]; });
+        {
+            std::lock_guard<std::mutex> lock(tiles_->lock_);
+            tiles_->requests_.clear();
+            for (unsigned index : order)
+                tiles_->requests_.push_back(wanted[index]);
+        }
+        StartTasks();
+    }
+
+    void TextureInspector::CollectTiles()
+    {
+        std::vector<TextureInspectorTile> finished;
+        unsigned generation = 0;
+        {
+            std::lock_guard<std::mutex> lock(tiles_->lock_);
+            finished.swap(tiles_->finished_);
+            generation = tiles_->generation_;
+        }
+
+        // Pixmaps may only be made on the main thread
+        bool added = false;
+        for (const TextureInspectorTile& tile : finished)
+        {
+            if (tile.generation_ != generation)
+                continue;
+            QPixmap* pixmap = new QPixmap(QPixmap::fromImage(tile.image_));
+            tileCache_.insert(QString("%1/%2/%3").arg(tile.level_).arg(tile.x_).arg(tile.y_), pixmap, pixmap->width() * pixmap->height() * 4);
+            added = true;
+        }
+
+        if (added)
+        {
+            statusItem_->setVisible(false);
+            UpdateTiles();
+        }
+    }
+
+    void TextureInspector::StartTasks()
+    {
+        SprueEngine::TextureNode* node = GetInspectedNode();
+        auto taskMan = Global_SecondaryTaskProcessor();
+        if (!node || !taskMan)
+            return;
+
+        // Requests are ordered coarse first, tasks are started in that order as well
+        std::vector<int> levels;
+        {
+            std::lock_guard<std::mutex> lock(tiles_->lock_);
+            for (const TextureInspectorTile& request : tiles_->requests_)
             {
-                textureItems_[1]->setPixmap(QPixmap());
-                textureItems_[2]->setPixmap(QPixmap());
-                textureItems_[3]->setPixmap(QPixmap());
+                if (tiles_->running_.find(request.level_) == tiles_->running_.end() && std::find(levels.begin(), levels.end(), request.level_) == levels.end())
+                    levels.push_back(request.level_);
             }
         }
+
+        for (int level : levels)
+            taskMan->AddTask(std::make_shared<TextureInspectorTileTask>(node->graph, node, GetImageSize(), level, tiles_));
     }
 
     void TextureInspector::ResetView()
     {
         ((TextureInspectorGraphicsView*)view_)->SetZoom(3);
-        view_->centerOn(textureItems_[0]);
+        view_->centerOn(GetImageSize() * 0.5, GetImageSize() * 0.5);
     }
 
     void TextureInspector::ImageSizeChanged(int index)
@@ -220,41 +401,28 @@ namespace SprueEditor
     {
         if (!isVisible())
             return;
-        if (auto graphNode = sel->GetMostRecentSelected<GraphNodeDataSource>())
+
+        ResetTiles();
+        SprueEngine::TextureNode* node = GetInspectedNode();
+        if (node)
         {
-            if (auto textureNode = dynamic_cast<SprueEngine::TextureNode*>(graphNode->GetNode()))
-            {
-                if (textureNode->CanPreview())
-                {
-                    if (auto taskMan = Global_SecondaryTaskProcessor())
-                    {
-                        statusText_->setPlainText("Generating preview...");
-                        statusItem_->setVisible(true);
-                        std::shared_ptr<Task> task = std::make_shared<TextureInspectorGenTask>(textureNode->graph, textureNode, TextureInspectorImageSizes[sizeCombo_->currentIndex()], TextureInspectorImageSizes[sizeCombo_->currentIndex()]);
-                        taskMan->AddTask(task);
-                    }
-                }
-                else
-                {
-                    statusText_->setPlainText("Nothing to preview");
-                    statusItem_->setVisible(true);
-                    textureItems_[0]->setPixmap(QPixmap());
-                    textureItems_[1]->setPixmap(QPixmap());
-                    textureItems_[2]->setPixmap(QPixmap());
-                    textureItems_[3]->setPixmap(QPixmap());
-                }
-            }
+            statusText_->setPlainText("Generating preview...");
+            statusItem_->setVisible(true);
         }
         else
         {
             statusText_->setPlainText("Nothing to preview");
             statusItem_->setVisible(true);
-            textureItems_[0]->setPixmap(QPixmap());
-            textureItems_[1]->setPixmap(QPixmap());
-            textureItems_[2]->setPixmap(QPixmap());
-            textureItems_[3]->setPixmap(QPixmap());
         }
-        ResetView();
+
+        // Editing the node keeps the view where it is, inspecting another one starts over
+        const unsigned nodeID = node ? node->GetInstanceID() : 0;
+        if (nodeID != nodeID_ || !src)
+        {
+            nodeID_ = nodeID;
+            ResetView();
+        }
+        UpdateTiles();
     }
 
     void TextureInspector::SelectionDataChanged(void* source, Selectron* sel, unsigned hash)
@@ -264,17 +432,6 @@ namespace SprueEditor
 
     void TextureInspector::TileModeChanged(int state)
     {
-        if (tileMode_->isChecked())
-        {
-            textureItems_[1]->setPixmap(textureItems_[0]->pixmap());
-            textureItems_[2]->setPixmap(textureItems_[0]->pixmap());
-            textureItems_[3]->setPixmap(textureItems_[0]->pixmap());
-        }
-        else
-        {
-            textureItems_[1]->setPixmap(QPixmap());
-            textureItems_[2]->setPixmap(QPixmap());
-            textureItems_[3]->setPixmap(QPixmap());
-        }
+        UpdateTiles();
     }
-}
\ No newline at end of file
+}
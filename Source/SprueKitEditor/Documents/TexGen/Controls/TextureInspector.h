@@ -4,20 +4,35 @@
 #include <EditorLib/Selectron.h>
 
 #include <QWidget>
+#include <QCache>
 #include <QCheckbox>
 #include <QComboBox>
 #include <QImage>
+#include <QMap>
 #include <QPixmap>
 
+#include <memory>
+
 class QGraphicsItem;
 class QGraphicsTextItem;
 class QGraphicsView;
 class QGraphicsScene;
 class QGraphicsPixmapItem;
+class QTimer;
+
+namespace SprueEngine
+{
+    class TextureNode;
+}
 
 namespace SprueEditor
 {
 
+struct TextureInspectorTileQueue;
+
+/// Shows the selected node's output like a map viewer, rendering only the tiles in view at the level of detail the zoom calls for.
+/// A single tile of the whole image is rendered first and stays underneath as a placeholder while the finer tiles arrive, nearest to the center of the view first.
+
 class TextureInspector : public QWidget, public SelectronLinked, public ISignificantControl
 {
     Q_OBJECT;
@@ -29,7 +44,8 @@ public:
 
     void showEvent(QShowEvent* event) Q_DECL_OVERRIDE;
 
-    void SetImage(QImage* image);
+    /// Shows the rendered tiles that are in view and requests those missing, called whenever the view moves.
+    void UpdateTiles();
 
 public slots:
     void ResetView();
@@ -43,9 +59,27 @@ private:
     QComboBox* sizeCombo_;
     QGraphicsScene* scene_ = 0x0;
     QGraphicsView* view_ = 0x0;
-    QGraphicsPixmapItem** textureItems_ = 0x0;
     QGraphicsItem* statusItem_ = 0x0;
     QGraphicsTextItem* statusText_ = 0x0;
+
+    /// Returns the selected node if it can be previewed.
+    SprueEngine::TextureNode* GetInspectedNode() const;
+    /// Forgets every tile, those of the previous generation still being rendered are dropped.
+    void ResetTiles();
+    /// Takes the tiles the tasks have finished.
+    void CollectTiles();
+    /// Starts a task for each level with requested tiles that has none.
+    void StartTasks();
+    int GetImageSize() const;
+
+    std::shared_ptr<TextureInspectorTileQueue> tiles_;
+    /// Rendered tiles of the current generation by level/x/y.
+    QCache<QString, QPixmap> tileCache_;
+    /// Items in the scene by copy/level/x/y.
+    QMap<QString, QGraphicsPixmapItem*> tileItems_;
+    QTimer* timer_ = 0x0;
+    /// Instance ID of the inspected node, the view is only reset when it changes.
+    unsigned nodeID_ = 0;
 };
 
 }
\ No newline at end of file
@@ -11,8 +11,11 @@
 #include <EditorLib/Controls/ISignificantControl.h>
 #include <EditorLib/LogFile.h>
 #include <EditorLib/Platform/Thumbnails.h>
+#include <EditorLib/Settings/Settings.h>
+#include <EditorLib/Settings/SettingsValue.h>
 
 #include <SprueEngine/FString.h>
+#include <SprueEngine/TextureGen/TextureGraphOptimizer.h>
 #include <SprueEngine/TextureGen/TextureNode.h>
 
 #include <Urho3D/Graphics/Texture2D.h>
@@ -42,6 +45,12 @@ namespace SprueEditor
             clone_->SetUserData(source_->GetUserData()); // We need to make sure we have the right user data
             node_ = clone_->GetNodeBySourceID(nodeID_);
         }
+
+        // Settings are read here as well, ExecuteTask runs in the worker thread
+        if (auto setting = Settings::GetInstance()->GetValue("Graphics/Texture preview error"))
+            planner_.MaxError = qMax(setting->value_.toFloat(), 0.0f) / 255.0f;
+        if (auto setting = Settings::GetInstance()->GetValue("Graphics/Force full resolution previews"))
+            planner_.ForceFullResolution = setting->value_.toBool();
     }
 
     TextureGenTask::~TextureGenTask()
@@ -64,10 +73,27 @@ namespace SprueEditor
         QElapsedTimer timer;
         timer.start();
 
+        // The clone only exists to produce this preview, so anything that does not contribute to it can go
+        TextureGraphOptimizer optimizer;
+        GraphOptimizationStats stats = optimizer.Optimize(clone_, { node_ });
+        if (stats.NodesAfter != stats.NodesBefore)
+            LOGDEBUG(QString("Optimized graph for '%1': %2").arg(node_->name.c_str(), stats.ToString().c_str()));
+
+        unsigned width = width_ != 0 ? width_ : 128;
+        unsigned height = height_ != 0 ? height_ : 128;
         if (TextureOutputNode* node = dynamic_cast<TextureOutputNode*>(node_))
-            image_ = node_->GetPreview(width_ != 0 ? width_ : node->Width, height_ != 0 ? height_ : node->Height);
-        else
-            image_ = node_->GetPreview(width_ != 0 ? width_ : 128, height_ != 0 ? height_ : 128);
+        {
+            width = width_ != 0 ? width_ : node->Width;
+            height = height_ != 0 ? height_ : node->Height;
+        }
+
+        // Branches with little detail are evaluated on coarser grids, exports render the document's graph and stay at full resolution
+        ResolutionPlanner planner(planner_);
+        ResolutionPlannerStats planStats = planner.Plan(clone_, { node_ }, width, height);
+        if (planStats.NodesInserted > 0)
+            LOGDEBUG(QString("Reduced resolution for '%1': %2").arg(node_->name.c_str(), planStats.ToString().c_str()));
+
+        image_ = node_->GetPreview(width, height);
         if (image_)
         {            
             generatedImage_.reset(new QImage(image_->getWidth(), image_->getHeight(), QImage::Format::Format_RGBA8888));
@@ -2,6 +2,7 @@
 
 #include <EditorLib/TaskProcessor.h>
 
+#include <SprueEngine/TextureGen/ResolutionPlanner.h>
 #include <SprueEngine/TextureGen/TextureNode.h>
 #include <SprueEngine/FString.h>
 
@@ -42,6 +43,7 @@ protected:
     SprueEngine::Graph* source_ = 0x0;
     unsigned width_ = 0;
     unsigned height_ = 0;
+    SprueEngine::ResolutionPlannerSettings planner_;
 };
 
 }
\ No newline at end of file
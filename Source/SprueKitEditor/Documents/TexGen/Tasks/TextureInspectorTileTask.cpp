@@ -0,0 +1,92 @@
+#include "TextureInspectorTileTask.h"
+
+#include <SprueEngine/TextureGen/TextureGraphOptimizer.h>
+
+#include <algorithm>
+
+using namespace SprueEngine;
+
+namespace SprueEditor
+{
+
+    TextureInspectorTileTask::TextureInspectorTileTask(SprueEngine::Graph* graph, SprueEngine::GraphNode* node, unsigned size, int level, std::shared_ptr<TextureInspectorTileQueue> queue) :
+        TextureGenTask(graph, node, 0x0),
+        queue_(queue),
+        level_(level),
+        size_(size)
+    {
+        std::lock_guard<std::mutex> lock(queue_->lock_);
+        generation_ = queue_->generation_;
+        queue_->running_.insert(level_);
+    }
+
+    TextureInspectorTileTask::~TextureInspectorTileTask()
+    {
+        // Also reached when superceded before running, the inspector then starts another
+        std::lock_guard<std::mutex> lock(queue_->lock_);
+        queue_->running_.erase(level_);
+    }
+
+    static QImage TileToImage(const FilterableBlockMap<RGBA>& tile)
+    {
+        QImage ret(tile.getWidth(), tile.getHeight(), QImage::Format_RGBA8888);
+        for (unsigned y = 0; y < tile.getHeight(); ++y)
+        {
+            uchar* line = ret.scanLine(y);
+            for (unsigned x = 0; x < tile.getWidth(); ++x)
+            {
+                RGBA color = tile.get(x, y);
+                color.Clip();
+                *line++ = (uchar)(color.r * 255.0f + 0.5f);
+                *line++ = (uchar)(color.g * 255.0f + 0.5f);
+                *line++ = (uchar)(color.b * 255.0f + 0.5f);
+                *line++ = (uchar)(color.a * 255.0f + 0.5f);
+            }
+        }
+        return ret;
+    }
+
+    bool TextureInspectorTileTask::ExecuteTask()
+    {
+        if (clone_ == 0x0 || node_ == 0x0)
+            return true;
+
+        TextureGraphOptimizer optimizer;
+        optimizer.Optimize(clone_, { node_ });
+
+        // Planned for the resolution of the level, coarse levels make more branches coarser still
+        const unsigned levelSize = std::max(size_ >> level_, 1u);
+        ResolutionPlanner planner(planner_);
+        planner.Plan(clone_, { node_ }, levelSize, levelSize);
+
+        for (;;)
+        {
+            TextureInspectorTile tile;
+            {
+                std::lock_guard<std::mutex> lock(queue_->lock_);
+                if (queue_->generation_ != generation_)
+                    return true;
+                auto found = std::find_if(queue_->requests_.begin(), queue_->requests_.end(), [this](const TextureInspectorTile& request) { return request.level_ == level_; });
+                if (found == queue_->requests_.end())
+                    return true;
+                tile = *found;
+                queue_->requests_.erase(found);
+            }
+
+            const unsigned left = tile.x_ * TileSize;
+            const unsigned top = tile.y_ * TileSize;
+            if (left >= levelSize || top >= levelSize)
+                continue;
+            auto region = node_->GetPreviewRegion(levelSize, levelSize, left, top, std::min<unsigned>(TileSize, levelSize - left), std::min<unsigned>(TileSize, levelSize - top));
+            if (!region)
+                continue;
+            tile.image_ = TileToImage(*region);
+
+            std::lock_guard<std::mutex> lock(queue_->lock_);
+            if (queue_->generation_ != generation_)
+                return true;
+            queue_->finished_.push_back(tile);
+        }
+    }
+
+}
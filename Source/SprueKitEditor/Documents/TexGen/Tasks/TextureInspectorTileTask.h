@@ -0,0 +1,61 @@
+#pragma once
+
+#include "TextureGenTask.h"
+
+#include <QImage>
+
+#include <deque>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace SprueEditor
+{
+
+    /// A square of the inspected image. Level 0 is the image at its chosen size and each level after it is half the size of the one before.
+    struct TextureInspectorTile
+    {
+        unsigned generation_;
+        int level_;
+        int x_;
+        int y_;
+        QImage image_;
+    };
+
+    /// Shared by the inspector and the tasks rendering tiles for it.
+    struct TextureInspectorTileQueue
+    {
+        std::mutex lock_;
+        /// Changes whenever what is inspected changes, tiles of any other generation are not wanted.
+        unsigned generation_ = 0;
+        /// Tiles in the order they are wanted, rewritten by the inspector as the view moves.
+        std::deque<TextureInspectorTile> requests_;
+        /// Rendered tiles waiting for the inspector.
+        std::vector<TextureInspectorTile> finished_;
+        /// Levels a task exists for.
+        std::set<int> running_;
+    };
+
+    /// Renders the requested tiles of one level of the inspected image until none are left, evaluating only the pixels of each tile.
+    class TextureInspectorTileTask : public TextureGenTask
+    {
+    public:
+        /// Width and height of a tile in pixels.
+        static const int TileSize = 256;
+
+        TextureInspectorTileTask(SprueEngine::Graph* graph, SprueEngine::GraphNode* node, unsigned size, int level, std::shared_ptr<TextureInspectorTileQueue> queue);
+        virtual ~TextureInspectorTileTask();
+
+        virtual QString GetName() const override { return QString("Inspecting %1").arg(nodeName_.c_str()); }
+        virtual bool ExecuteTask() override;
+        virtual void FinishTask() override { }
+        virtual bool Supercedes(Task* other) override { return false; }
+
+    private:
+        std::shared_ptr<TextureInspectorTileQueue> queue_;
+        unsigned generation_;
+        int level_;
+        unsigned size_;
+    };
+
+}
@@ -0,0 +1,67 @@
+#include "TextureProfileTask.h"
+
+#include "Documents/TexGen/Controls/TextureGraphControl.h"
+
+#include <EditorLib/Controls/ISignificantControl.h>
+#include <EditorLib/LogFile.h>
+
+#include <SprueEngine/Graph/Graph.h>
+
+using namespace SprueEngine;
+
+namespace SprueEditor
+{
+    TextureProfileTask::TextureProfileTask(SprueEngine::Graph* graph, DocumentBase* doc) :
+        Task(doc)
+    {
+        if (graph == 0x0)
+            LOGERROR("Attempted to start Texture profiling task without a graph");
+        source_ = graph;
+
+        // This has to be done here, because PrepareTask occurs in the thread.
+        clone_ = source_ ? (Graph*)source_->Clone() : 0x0;
+        if (clone_)
+            clone_->SetUserData(source_->GetUserData());
+    }
+
+    TextureProfileTask::~TextureProfileTask()
+    {
+        if (clone_)
+            delete clone_;
+    }
+
+    void TextureProfileTask::PrepareTask()
+    {
+
+    }
+
+    bool TextureProfileTask::ExecuteTask()
+    {
+        if (clone_ == 0x0)
+            return true;
+
+        GraphProfiler profiler;
+        profiler.Activate();
+        for (auto node : clone_->GetEntryNodes())
+        {
+            if (TextureOutputNode* output = dynamic_cast<TextureOutputNode*>(node))
+                output->GetPreview(output->Width, output->Height);
+        }
+        profiler.Deactivate();
+
+        profiles_ = profiler.GetSortedProfiles();
+        totalMS_ = Clock::TicksToMillisecondsD(profiler.GetTotalTicks());
+        return true;
+    }
+
+    void TextureProfileTask::FinishTask()
+    {
+        LOGINFO(QString("Texture graph profile: %1 ms for all outputs").arg(totalMS_));
+        // Only the heaviest few are worth calling out in the log, the graph shows the rest
+        for (unsigned i = 0; i < profiles_.size() && i < 5; ++i)
+            LOGINFO(QString("    %1 (%2): %3 ms self, %4 ms inclusive").arg(profiles_[i].Name.c_str()).arg(profiles_[i].TypeName.c_str()).arg(profiles_[i].SelfMS()).arg(profiles_[i].InclusiveMS()));
+
+        if (TextureGraphControl* panel = ISignificantControl::GetControl<TextureGraphControl>())
+            panel->ProfileGenerated(this);
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <EditorLib/TaskProcessor.h>
+
+#include <SprueEngine/Graph/GraphProfiler.h>
+#include <SprueEngine/TextureGen/TextureNode.h>
+
+#include <vector>
+
+namespace SprueEditor
+{
+
+/// Renders every output of a texture graph with a GraphProfiler active and hands the timings to the TextureGraphControl.
+class TextureProfileTask : public Task
+{
+public:
+    TextureProfileTask(SprueEngine::Graph* graph, DocumentBase* doc);
+    virtual ~TextureProfileTask();
+
+    virtual QString GetName() const override { return "Profiling texture graph"; }
+    virtual void PrepareTask() override;
+    virtual bool ExecuteTask() override;
+    virtual void FinishTask() override;
+    virtual bool Supercedes(Task* other) { return dynamic_cast<TextureProfileTask*>(other) != 0x0; }
+
+    /// Node records ordered by self time, the IDs refer to the source graph through NodeProfile::SourceID.
+    const std::vector<SprueEngine::NodeProfile>& GetProfiles() const { return profiles_; }
+    /// Time spent evaluating all outputs.
+    double GetTotalMS() const { return totalMS_; }
+
+protected:
+    std::vector<SprueEngine::NodeProfile> profiles_;
+    SprueEngine::Graph* clone_ = 0x0;
+    SprueEngine::Graph* source_ = 0x0;
+    double totalMS_ = 0.0;
+};
+
+}
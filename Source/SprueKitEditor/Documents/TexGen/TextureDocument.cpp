@@ -14,6 +14,8 @@
 #include "Documents/Sprue/Dialogs/IEditablePathFixupItem.h"
 
 #include "Tasks/TextureGenTask.h"
+#include "Tasks/TextureProfileTask.h"
+#include "Controls/TextureGraphControl.h"
 
 #include "../../ThirdParty/NodeEditor/QNEBlock.h"
 #include "../../ThirdParty/NodeEditor/QNEConnection.h"
@@ -27,11 +29,13 @@
 #include <SprueEngine/FileBuffer.h>
 #include <SprueEngine/Graph/Graph.h>
 #include <SprueEngine/TextureGen/TextureNode.h>
+#include <SprueEngine/VectorBuffer.h>
 
 #include <Urho3D/Resource/ResourceCache.h>
 
 #include <QAction>
 #include <QDialog>
+#include <QFile>
 #include <QIcon>
 #include <QGraphicsScene>
 #include <QMenu>
@@ -210,7 +214,8 @@ DocumentBase* TextureDocumentHandler::OpenDocument(const QString& path)
     else
     {
         FileBuffer buffer(path.toStdString().c_str(), true, true);
-        if (buffer.ReadFileID().compare("TEXG") == 0)
+        const std::string fileID = buffer.ReadFileID();
+        if (fileID.compare("TEXG") == 0)
         {
             // Read the string hash, had to write the hash in order to work with Clone() correctly.
             buffer.ReadStringHash();
@@ -219,6 +224,24 @@ DocumentBase* TextureDocumentHandler::OpenDocument(const QString& path)
             IEditablePathFixupItem::DoDialog(ctx);
             return new TextureDocument(this, graph, path);
         }
+        else if (fileID.compare("TEXZ") == 0)
+        {
+            // Automatic backup, the same as TEXG but compressed after the file ID
+            QFile file(path);
+            if (file.open(QIODevice::ReadOnly))
+            {
+                const QByteArray data = qUncompress(file.readAll().mid(4));
+                if (!data.isEmpty())
+                {
+                    VectorBuffer unpacked(data.constData(), data.size());
+                    unpacked.ReadStringHash();
+                    graph->Deserialize(&unpacked, ctx);
+
+                    IEditablePathFixupItem::DoDialog(ctx);
+                    return new TextureDocument(this, graph, path);
+                }
+            }
+        }
     }
     return 0x0;
 }
@@ -345,6 +368,24 @@ bool TextureDocument::DoBackup(const QString& backupDir)
     return true;
 }
 
+bool TextureDocument::SnapshotBackup(DocumentBackup& backup)
+{
+    // The hash of the full path keeps documents of the same name in different folders from overwriting each other's backups
+    if (filePath_.isEmpty())
+        backup.fileName_ = QString("Unnamed_Graph_%1.texg").arg(QString::number((uint64_t)graph_));
+    else
+        backup.fileName_ = QString("%1_%2.texg").arg(QFileInfo(filePath_).completeBaseName()).arg(qHash(QFileInfo(filePath_).absoluteFilePath()), 8, 16, QChar('0'));
+
+    // Binary into memory is the cheapest consistent copy, no relative path so that resources are found from the backup directory
+    SprueEngine::SerializationContext ctx;
+    SprueEngine::VectorBuffer buffer;
+    if (!graph_->Serialize(&buffer, ctx))
+        return false;
+    backup.header_ = QByteArray("TEXZ", 4);
+    backup.data_ = QByteArray((const char*)buffer.GetData(), buffer.GetSize());
+    return true;
+}
+
 void TextureDocument::BeginExport()
 {
     TextureGraphExportDialog dialog;
@@ -456,14 +497,14 @@ QMenu* TextureDocument::GetContextMenu(QGraphicsView* view, QGraphicsItem* item,
                         {
                             if (!fileName.endsWith(".dds"))
                                 fileName.append(".dds");
-                            if (image->getWidth() % 4 || image->getHeight() % 4)
-                            {
-                                //TODO! show error dialog
-                                Global_ShowErrorMessage(Localizer::Translate("Unable to generate DDS image"), Localizer::Translate("DDS textures must have dimensions that are a multiple of 4 pixels in size."));
-                                return;
-                            }
                             BasicImageLoader::SaveDDS(image.get(), fileName.toStdString().c_str());
                         }
+                        else if (selectedType == 4)
+                        {
+                            if (!fileName.endsWith(".texr"))
+                                fileName.append(".texr");
+                            BasicImageLoader::SaveRaw(image.get(), fileName.toStdString().c_str(), false);
+                        }
                         else
                         {
                             // Just fall back on spitting out a PNG
@@ -533,6 +574,24 @@ QMenu* TextureDocument::GetContextMenu(QGraphicsView* view, QGraphicsItem* item,
         AddOutputMenu(outputs, "Surface Thickness", pt, TexGenOutputFormat::TGOF_Alpha, TexGenOutputType::TGOT_SurfaceThickness);
         AddOutputMenu(outputs, "Subsurface Color", pt, TexGenOutputFormat::TGOF_RGBA, TexGenOutputType::TGOT_Subsurface);
         AddOutputMenu(outputs, "Custom", pt, TexGenOutputFormat::TGOF_RGBA, TexGenOutputType::TGOT_Custom);
+
+        menu->addSeparator();
+        QAction* profileAction = new QAction("Profile Graph");
+        connect(profileAction, &QAction::triggered, [=](bool) {
+            if (!graph_)
+                return;
+            std::shared_ptr<Task> task = std::make_shared<TextureProfileTask>(graph_, this);
+            AddDependentTask(task);
+            SprueKitEditor::GetInstance()->GetTaskProcessor()->AddTask(task);
+        });
+        menu->addAction(profileAction);
+
+        QAction* clearProfileAction = new QAction("Clear Profiling");
+        connect(clearProfileAction, &QAction::triggered, [=](bool) {
+            if (TextureGraphControl* panel = ISignificantControl::GetControl<TextureGraphControl>())
+                panel->ClearProfile();
+        });
+        menu->addAction(clearProfileAction);
     }
     return menu;
 }
@@ -651,7 +710,7 @@ int TextureDocument::GetExportWorkCount() const
     return graph_->GetEntryNodes().size();
 }
 
-bool TextureDocument::WriteTextures(const QString& path, const QString& namingConvention, int index, int format)
+bool TextureDocument::WriteTextures(const QString& path, const QString& namingConvention, int index, int format, int compressionLevel)
 {
     if (!graph_)
         return false;
@@ -686,7 +745,8 @@ bool TextureDocument::WriteTextures(const QString& path, const QString& namingCo
         ".png",
         ".tga",
         ".hdr",
-        ".dds"
+        ".dds",
+        ".texr"
     };
 
     auto entryNodes = graph_->GetEntryNodes();
@@ -697,21 +757,21 @@ bool TextureDocument::WriteTextures(const QString& path, const QString& namingCo
             auto texture = outputNode->GetPreview(outputNode->Width, outputNode->Height);
             QDir dir(path);
             QString filePath = dir.filePath(namingConvention.arg(outputNode->name.c_str(), OutputNames[outputNode->OutputType]) + formatExt[format]);
+            const auto level = (SprueEngine::ImageCompressionLevel)compressionLevel;
             if (format == 0)
-                SprueEngine::BasicImageLoader::SavePNG(texture.get(), filePath.toStdString().c_str());
+                SprueEngine::BasicImageLoader::SavePNG(texture.get(), filePath.toStdString().c_str(), level);
             else if (format == 1)
-                SprueEngine::BasicImageLoader::SaveTGA(texture.get(), filePath.toStdString().c_str());
+                SprueEngine::BasicImageLoader::SaveTGA(texture.get(), filePath.toStdString().c_str(), level);
             else if (format == 2)
                 SprueEngine::BasicImageLoader::SaveHDR(texture.get(), filePath.toStdString().c_str());
             else if (format == 3)
             {
-                if (texture->getWidth() % 4 || texture->getHeight() % 4)
-                {
-                    Global_ShowErrorMessage(Localizer::Translate("Unable to generate DDS image"), Localizer::Translate("DDS textures must have dimensions that are a multiple of 4 pixels in size."));
-                    return false;
-                }
-                SprueEngine::BasicImageLoader::SaveDDS(texture.get(), filePath.toStdString().c_str());
+                // Pick the block format by the purpose of the output, ie. BC5 for normals and BC4 for single channel maps
+                const auto ddsFormat = SprueEngine::BlockCompressor::SelectFormat(outputNode->OutputType, SprueEngine::BasicImageLoader::AnyAlphaUsed(texture.get()));
+                SprueEngine::BasicImageLoader::SaveDDS(texture.get(), filePath.toStdString().c_str(), ddsFormat, true, outputNode->OutputType == TexGenOutputType::TGOT_Normal);
             }
+            else if (format == 4)
+                SprueEngine::BasicImageLoader::SaveRaw(texture.get(), filePath.toStdString().c_str(), level != SprueEngine::ICL_Store);
             else
                 SprueEngine::BasicImageLoader::SavePNG(texture.get(), filePath.toStdString().c_str());
         }
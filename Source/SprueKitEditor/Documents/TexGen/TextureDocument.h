@@ -3,6 +3,7 @@
 #include "../../GuiBuilder/GraphDocument.h"
 #include "../../Controls/BaseGraphControl.h"
 
+#include <SprueEngine/Loaders/ImageEncoder.h>
 #include <SprueEngine/TextureGen/TextureNode.h>
 
 #include <Urho3D/Graphics/Material.h>
@@ -38,6 +39,7 @@ namespace SprueEditor
 
         virtual bool Save() override;
         virtual bool DoBackup(const QString& backupDir) override;
+        virtual bool SnapshotBackup(DocumentBackup& backup) override;
         virtual bool HasExport() const override { return true; }
         virtual void BeginExport() override;
         virtual bool HasReports() const override;
@@ -58,7 +60,7 @@ namespace SprueEditor
         virtual std::vector<QAction*> CreateNodeActions(QGraphicsView* view) override;
 
         int GetExportWorkCount() const;
-        bool WriteTextures(const QString& path, const QString& namingConvention, int index, int format);
+        bool WriteTextures(const QString& path, const QString& namingConvention, int index, int format, int compressionLevel = SprueEngine::ICL_Default);
 
         typedef std::pair<Urho3D::SharedPtr<Urho3D::Material>, Urho3D::SharedPtr<Urho3D::Material>> PreviewMaterial;
 
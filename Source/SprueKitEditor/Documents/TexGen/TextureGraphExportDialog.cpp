@@ -63,13 +63,27 @@ namespace SprueEditor
         format->addItem("PNG");
         format->addItem("TGA");
         format->addItem("HDR");
-        format->addItem("DDS Compressed (DXT1 or DXT5)");
+        format->addItem("DDS Compressed (BC1-BC7 by output type)");
+        format->addItem("Raw (lossless float, for pipeline intermediates)");
         masterLayout->addWidget(format);
         if (auto setting = Settings::GetInstance()->GetValue("Texture Graph Export/Export Format"))
             format->setCurrentIndex(setting->value_.toInt());
         else
             format->setCurrentIndex(0);
 
+    // Compression level, for PNG/TGA/Raw
+        masterLayout->addWidget(new LocalizedLabel("Compression"));
+        QComboBox* compression = new QComboBox();
+        compression->addItem("None (fastest write)");
+        compression->addItem("Fast");
+        compression->addItem("Default");
+        compression->addItem("Best (smallest files)");
+        masterLayout->addWidget(compression);
+        if (auto setting = Settings::GetInstance()->GetValue("Texture Graph Export/Compression Level"))
+            compression->setCurrentIndex(setting->value_.toInt());
+        else
+            compression->setCurrentIndex(SprueEngine::ICL_Default);
+
     // Button box
         QDialogButtonBox* buttons = new QDialogButtonBox();
         QPushButton* exportButton = new QPushButton("Export");
@@ -105,7 +119,7 @@ namespace SprueEditor
                     progress.show();
                     for (int i = 0;; ++i)
                     {
-                        if (!textureDocument->WriteTextures(exportPath, convention, i, format->currentIndex()))
+                        if (!textureDocument->WriteTextures(exportPath, convention, i, format->currentIndex(), compression->currentIndex()))
                             break;
                         if (progress.wasCanceled())
                             break;
@@ -117,6 +131,8 @@ namespace SprueEditor
                         setting->value_ = QString(exportDir->GetPath().c_str());
                     if (auto setting = Settings::GetInstance()->GetValue("Texture Graph Export/Export Format"))
                         setting->value_ = format->currentIndex();
+                    if (auto setting = Settings::GetInstance()->GetValue("Texture Graph Export/Compression Level"))
+                        setting->value_ = compression->currentIndex();
                 }
                 else
                 {
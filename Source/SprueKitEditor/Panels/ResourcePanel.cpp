@@ -1,7 +1,12 @@
 #include "ResourcePanel.h"
 
 #include <EditorLib/Controls/FlippableSplitter.h>
-#include <EditorLib/Platform/Thumbnails.h>
+#include <EditorLib/Platform/ThumbnailService.h>
+
+#include <SprueEngine/Geometry/MeshData.h>
+#include <SprueEngine/Loaders/FBXLoader.h>
+#include <SprueEngine/Loaders/OBJLoader.h>
+#include <SprueEngine/Resource.h>
 
 #include <qevent.h>
 #include <QFont>
@@ -11,65 +16,151 @@
 #include <QListView>
 #include <QFileSystemModel>
 #include <qheaderview.h>
-#include <qitemdelegate.h>
-#include <qpainter.h>
+#include <QStandardPaths>
+#include <QStyledItemDelegate>
 #include <qtooltip.h>
 
+#include <cfloat>
+#include <mutex>
+
 #include "../QtHelpers.h"
 
 namespace SprueEditor
 {
 
-    class ResourceItemDelegate : public QItemDelegate
+    /// Flat shaded render of a mesh file turned and tilted so that three sides show, the thumbnail of OBJ and FBX files.
+    static QImage RenderMeshThumbnail(const QString& filePath, int size)
     {
-    public:
-        Thumbnails* thumbs_;
+        using namespace SprueEngine;
 
-        ResourceItemDelegate(QFileSystemModel* view) :
-            thumbs_(new Thumbnails())
+        std::shared_ptr<Resource> resource;
+        const std::string path = filePath.toStdString();
+        if (filePath.endsWith(".fbx", Qt::CaseInsensitive))
         {
-            view_ = view;
-            
+            // The FBX SDK must not be used from several threads at once
+            static std::mutex fbxLock;
+            std::lock_guard<std::mutex> lock(fbxLock);
+            resource = FBXLoader().LoadResource(path.c_str());
         }
-        virtual ~ResourceItemDelegate() 
+        else
+            resource = OBJLoader().LoadResource(path.c_str());
+        std::shared_ptr<MeshResource> mesh = std::dynamic_pointer_cast<MeshResource>(resource);
+        if (!mesh || mesh->IsEmpty())
+            return QImage();
+
+        const float yawSin = sinf(0.6f), yawCos = cosf(0.6f);
+        const float pitchSin = sinf(0.45f), pitchCos = cosf(0.45f);
+        auto toView = [=](const Vec3& p) {
+            const float z = p.x * yawSin + p.z * yawCos;
+            return Vec3(p.x * yawCos - p.z * yawSin, p.y * pitchCos - z * pitchSin, p.y * pitchSin + z * pitchCos);
+        };
+
+        std::vector<Vec3> points;
+        std::vector<unsigned> indices;
+        Vec3 minPt(FLT_MAX, FLT_MAX, FLT_MAX);
+        Vec3 maxPt(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (unsigned m = 0; m < mesh->GetMeshCount(); ++m)
         {
-            delete thumbs_;
+            const MeshData* data = mesh->GetMesh(m);
+            const unsigned base = points.size();
+            for (const Vec3& position : data->GetPositionBuffer())
+            {
+                points.push_back(toView(position));
+                minPt = minPt.Min(points.back());
+                maxPt = maxPt.Max(points.back());
+            }
+            for (unsigned index : data->GetIndexBuffer())
+                indices.push_back(base + index);
         }
-        
-        //virtual QSize sizeHint(const QStyleOptionViewItem & option, const QModelIndex & index) const
-        //{
-        //    QMap<int, QVariant> data = view_->itemData(index);
-        //
-        //    QString label = data[0].toString();
-        //    int height = 64;
-        //    QRect rect = metrics.boundingRect(0, 0, 128, INT_MAX, Qt::TextWordWrap, label);
-        //    
-        //    height += rect.height();
-        //
-        //    return QSize(150, height += 8);
-        //}
-
-        virtual void paint(QPainter* painter, const QStyleOptionViewItem& opts, const QModelIndex& index) const
+        const float extent = SprueMax(maxPt.x - minPt.x, maxPt.y - minPt.y);
+        if (points.empty() || extent <= 0.0f)
+            return QImage();
+
+        const float scale = (size - 4) / extent;
+        const float centerX = (minPt.x + maxPt.x) * 0.5f;
+        const float centerY = (minPt.y + maxPt.y) * 0.5f;
+        for (Vec3& point : points)
+            point = Vec3((point.x - centerX) * scale + size * 0.5f, size * 0.5f - (point.y - centerY) * scale, point.z);
+
+        QImage image(size, size, QImage::Format_ARGB32);
+        image.fill(Qt::transparent);
+        std::vector<float> depth(size * size, FLT_MAX);
+        const Vec3 light = Vec3(-0.4f, 0.7f, -0.6f).Normalized();
+        for (unsigned i = 0; i + 2 < indices.size(); i += 3)
         {
-            if (index.column() == 1)
+            if (indices[i] >= points.size() || indices[i + 1] >= points.size() || indices[i + 2] >= points.size())
+                continue;
+            const Vec3& a = points[indices[i]];
+            const Vec3& b = points[indices[i + 1]];
+            const Vec3& c = points[indices[i + 2]];
+            const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            if (fabsf(area) < 1e-8f)
+                continue;
+
+            // Screen space flips y, the normal is unflipped before lighting. Winding is not trusted, both sides are lit
+            Vec3 normal = (b - a).Cross(c - a);
+            normal.y = -normal.y;
+            const float lambert = fabsf(normal.Normalized().Dot(light));
+            const int shade = (int)(255.0f * (0.25f + 0.75f * lambert));
+            const QRgb color = qRgba(shade * 200 / 255, shade * 210 / 255, shade, 255);
+
+            const int minX = SprueMax((int)floorf(SprueMin(a.x, SprueMin(b.x, c.x))), 0);
+            const int maxX = SprueMin((int)ceilf(SprueMax(a.x, SprueMax(b.x, c.x))), size - 1);
+            const int minY = SprueMax((int)floorf(SprueMin(a.y, SprueMin(b.y, c.y))), 0);
+            const int maxY = SprueMin((int)ceilf(SprueMax(a.y, SprueMax(b.y, c.y))), size - 1);
+            for (int y = minY; y <= maxY; ++y)
             {
-                return QItemDelegate::paint(painter, opts, index);
+                QRgb* line = (QRgb*)image.scanLine(y);
+                for (int x = minX; x <= maxX; ++x)
+                {
+                    const float px = x + 0.5f;
+                    const float py = y + 0.5f;
+                    const float w0 = ((b.x - px) * (c.y - py) - (b.y - py) * (c.x - px)) / area;
+                    const float w1 = ((c.x - px) * (a.y - py) - (c.y - py) * (a.x - px)) / area;
+                    const float w2 = 1.0f - w0 - w1;
+                    if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                        continue;
+                    const float z = w0 * a.z + w1 * b.z + w2 * c.z;
+                    if (z < depth[y * size + x])
+                    {
+                        depth[y * size + x] = z;
+                        line[x] = color;
+                    }
+                }
             }
+        }
+        return image;
+    }
 
-            QStyleOptionViewItem viewOpt(opts);
-            QColor foreColor = index.data(Qt::ForegroundRole).value<QColor>();
+    /// Shows the thumbnail of each file once ThumbnailService has it, the file type icon stands in until then.
+    class ResourceItemDelegate : public QStyledItemDelegate
+    {
+    public:
+        ResourceItemDelegate(QFileSystemModel* model, ThumbnailService* thumbnails, QObject* parent) :
+            QStyledItemDelegate(parent),
+            model_(model),
+            thumbnails_(thumbnails)
+        {
+        }
 
-            QString name = index.data(Qt::ItemDataRole::DisplayRole).value<QString>();
-            auto dataMap = view_->itemData(index);
-            QRectF rectF = painter->boundingRect(viewOpt.rect, Qt::AlignLeft, name);
-            //painter->drawText(rectF, name);
+    protected:
+        virtual void initStyleOption(QStyleOptionViewItem* option, const QModelIndex& index) const override
+        {
+            QStyledItemDelegate::initStyleOption(option, index);
+            if (index.column() != 0)
+                return;
 
-            QPixmap map = thumbs_->GetPixmap(name);
-            painter->drawPixmap(QPoint(0, 0), map);
+            QPixmap thumbnail = thumbnails_->GetPixmap(model_->fileInfo(index));
+            if (!thumbnail.isNull())
+            {
+                option->icon = QIcon(thumbnail);
+                option->features |= QStyleOptionViewItem::HasDecoration;
+            }
         }
 
-        QFontMetrics metrics = QFontMetrics(QFont("Arial", 12));
-        QFileSystemModel* view_;
+    private:
+        QFileSystemModel* model_;
+        ThumbnailService* thumbnails_;
     };
 
     //class ListView : public QListView
@@ -111,7 +202,10 @@ ResourcePanel::ResourcePanel()
     listModel_ = new QFileSystemModel();
     listModel_->setFilter(QDir::NoDotAndDotDot | QDir::Files);
     listModel_->setRootPath("C:\\");
-    listModel_->setIconProvider(new Thumbnails());
+
+    thumbnails_ = new ThumbnailService(64);
+    thumbnails_->SetCacheDirectory(QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QDir::separator() + "Thumbnails"));
+    thumbnails_->AddGenerator(QStringList({ "obj", "fbx" }), RenderMeshThumbnail);
 
     tree_ = new QTreeView();
     tree_->setModel(treeModel_);
@@ -122,10 +216,10 @@ ResourcePanel::ResourcePanel()
     tree_->setColumnHidden(3, true);
     tree_->setColumnHidden(4, true);
 
-    //ResourceItemDelegate* del = new ResourceItemDelegate(listModel_);
-
     list_ = new QListView();
     list_->setModel(listModel_);
+    list_->setItemDelegate(new ResourceItemDelegate(listModel_, thumbnails_, list_));
+    thumbnails_->SetReadyCallback([=](const QString&) { list_->viewport()->update(); });
     list_->setSelectionMode(QAbstractItemView::SingleSelection);
     list_->setIconSize(QSize(64, 64));
     list_->setResizeMode(QListView::Adjust);
@@ -153,6 +247,7 @@ ResourcePanel::ResourcePanel()
 
     connect(tree_, &QAbstractItemView::clicked, [=](const QModelIndex &index) {
         QString path = treeModel_->fileInfo(index).absoluteFilePath();
+        thumbnails_->CancelPending();
         list_->setRootIndex(listModel_->setRootPath(path));
     });
 
@@ -165,6 +260,7 @@ ResourcePanel::ResourcePanel()
             if (!selected.first().indexes().isEmpty())
             {
                 QString path = treeModel_->fileInfo(selected.first().indexes()[0]).absoluteFilePath();
+                thumbnails_->CancelPending();
                 list_->setRootIndex(listModel_->setRootPath(path));
             }
         }
@@ -173,7 +269,7 @@ ResourcePanel::ResourcePanel()
 
 ResourcePanel::~ResourcePanel()
 {
-
+    delete thumbnails_;
 }
 
 void ResourcePanel::mouseMoveEvent(QMouseEvent* event)
@@ -7,6 +7,7 @@
 class QFileSystemModel;
 class QListView;
 class QTreeView;
+class ThumbnailService;
 
 namespace SprueEditor
 {
@@ -25,6 +26,8 @@ private:
     QListView* list_;
     QFileSystemModel* treeModel_;
     QFileSystemModel* listModel_;
+    /// Thumbnails of the files in the list.
+    ThumbnailService* thumbnails_;
 };
 
 }
\ No newline at end of file
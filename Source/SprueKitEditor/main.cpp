@@ -171,6 +171,9 @@ int main(int argc, char *argv[])
 #endif
 
     settings->RestoreSettings();
+#if defined(SPRUE_TEXGEN) || !(defined(SPRUE_SCULPT) || defined(URHO_EDITOR) || defined(SPRUEKIT))
+    TextureGraph_ApplySettings(settings);
+#endif
 
     //QApplication::setAttribute(Qt::AA_Use96Dpi, true);
     qputenv("QT_SCALE_FACTOR", QByteArray(QVariant::fromValue(1.0f).toString().toStdString().c_str()));
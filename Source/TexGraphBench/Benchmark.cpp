@@ -0,0 +1,650 @@
+#include "Benchmark.h"
+#include "Corpus.h"
+#include "ExportSample.h"
+
+#include <SprueEngine/Compute/CPU/CPUComputeBuffer.h>
+#include <SprueEngine/Compute/CPU/CPUComputeDevice.h>
+#include <SprueEngine/Compute/CPU/CPUComputeShader.h>
+#include <SprueEngine/Compute/ComputeKernel.h>
+#include <SprueEngine/Core/Context.h>
+#include <SprueEngine/GeneralUtility.h>
+#include <SprueEngine/Graph/Graph.h>
+#include <SprueEngine/MathGeoLib/Time/Clock.h>
+#include <SprueEngine/Reports/TextureGraphReport.h>
+#include <SprueEngine/Resource.h>
+#include <SprueEngine/TextureGen/BakerNodes.h>
+#include <SprueEngine/TextureGen/TextureCodeGenerator.h>
+#include <SprueEngine/TextureGen/TextureGraphOptimizer.h>
+#include <SprueEngine/TextureGen/TextureNode.h>
+#include <SprueEngine/TextureGen/TextureProgram.h>
+#include <SprueEngine/TextureGen/TextureRuntime.h>
+#include <SprueEngine/TextureGen/TextureVariationRenderer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+using namespace SprueEngine;
+
+namespace TexGraphBench
+{
+
+    void BenchmarkResult::Finalize()
+    {
+        if (SamplesMS.empty())
+            return;
+
+        std::vector<double> sorted = SamplesMS;
+        std::sort(sorted.begin(), sorted.end());
+        const size_t count = sorted.size();
+        MinMS = sorted.front();
+        MedianMS = (count % 2) ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) * 0.5;
+        // Nearest rank
+        const size_t p95Rank = (size_t)std::ceil(0.95 * count);
+        P95MS = sorted[std::min(count - 1, p95Rank > 0 ? p95Rank - 1 : 0)];
+        MegapixelsPerSecond = MedianMS > 0.0 ? ((double)Width * Height / 1000000.0) / (MedianMS / 1000.0) : 0.0;
+    }
+
+    BenchmarkRunner::BenchmarkRunner(const BenchmarkSettings& settings) :
+        settings_(settings)
+    {
+        if (settings_.Iterations == 0)
+            settings_.Iterations = 1;
+    }
+
+    void BenchmarkRunner::RunNodeBenchmarks()
+    {
+        Context* context = Context::GetInstance();
+        if (GetTextureNodeTypeNames().empty())
+            RegisterTextureNodes(context);
+
+        for (const std::string& typeName : GetTextureNodeTypeNames())
+        {
+            if (!settings_.NodeFilter.empty() && typeName.find(settings_.NodeFilter) == std::string::npos)
+                continue;
+
+            for (unsigned resolution : settings_.Resolutions)
+            {
+                Graph graph;
+                GraphNode* node = context->Create<GraphNode>(StringHash(typeName));
+                if (!node)
+                    continue;
+                node->Construct();
+                graph.AddNode(node, false);
+
+                if (!node->CanPreview())
+                    break;
+
+                if (dynamic_cast<TextureBakerNode*>(node))
+                {
+                    // Bakers do nothing without a mesh, timing them would only measure an empty loop
+                    if (settings_.MeshPath.empty())
+                        break;
+                    node->SetProperty(StringHash("Mesh"), ResourceHandle("Mesh", settings_.MeshPath));
+                }
+
+                Measure(&graph, { node->GetInstanceID() }, { "node/" + typeName }, { resolution }, { resolution }, std::string());
+            }
+        }
+    }
+
+    bool BenchmarkRunner::RunGraphBenchmark(const std::string& filePath)
+    {
+        Graph* graph = TextureGraphReport::GraphFromFile(filePath);
+        if (!graph)
+        {
+            std::cerr << "Unable to load graph: " << filePath << std::endl;
+            return false;
+        }
+
+        const std::string prefix = "graph/" + FileName(filePath) + "/";
+        std::vector<unsigned> outputs;
+        std::vector<std::string> names;
+        std::vector<unsigned> widths;
+        std::vector<unsigned> heights;
+        for (GraphNode* node : graph->GetEntryNodes())
+        {
+            if (TextureOutputNode* output = dynamic_cast<TextureOutputNode*>(node))
+            {
+                // Clones carry the source ID, for a loaded graph that is the one stored in the file rather than the instance ID
+                outputs.push_back(output->GetSourceID());
+                names.push_back(prefix + (output->name.empty() ? std::to_string(outputs.size()) : output->name));
+                widths.push_back(output->Width);
+                heights.push_back(output->Height);
+            }
+        }
+
+        if (!outputs.empty())
+            Measure(graph, outputs, names, widths, heights, prefix + "total");
+        delete graph;
+        return true;
+    }
+
+    /// Kernel declarations and a DensityFunc as OpenCLDensityShaderBuilder writes it: a sphere with a box carved out and a torus added.
+    static const char* ComputeBenchmarkSource =
+        "kernel void GenerateDefaultField(const int4 offset, const int defaultMaterialIndex, global float* densities, global const float* transforms, global const float* shapeData);\r\n"
+        "kernel void FindEdgeIntersections(global char* density, global const float* paramData, global const float* transformData, global struct EdgeData* edgeValues);\r\n"
+        "kernel void ScanVoxels(global const char* densities, global int* voxelIndices);\r\n"
+        "float DensityFunc(float3 pos, const global float* shapeData, const global float4* transformData) {\r\nint paramIndex = 0; int transformIndex = 0;\r\n"
+        "float density = SphereDensity(pos, shapeData, transformData, &paramIndex, &transformIndex);\r\n"
+        "density = CSGSubtract(density, BoxDensity(pos, shapeData, transformData, &paramIndex, &transformIndex));\r\n"
+        "density = CSGAdd(density, TorusDensity(pos, shapeData, transformData, &paramIndex, &transformIndex));\r\n"
+        "\r\nreturn density;\r\n}\r\n";
+
+    bool BenchmarkRunner::RunComputeBenchmarks()
+    {
+        CPUComputeDevice device;
+        device.Initialize();
+        std::unique_ptr<ComputeShader> shader(device.CreateShader("DensityBenchmark"));
+        if (!shader->CompileShader(ComputeBenchmarkSource))
+        {
+            std::cerr << "Unable to compile the compute benchmark shader" << std::endl;
+            return false;
+        }
+
+        const unsigned densityCells = CPU_DENSITY_EDGE * CPU_DENSITY_EDGE * CPU_DENSITY_EDGE;
+        const unsigned voxelCells = CPU_VOXEL_EDGE * CPU_VOXEL_EDGE * CPU_VOXEL_EDGE;
+
+        // Sphere radius, box half extents, torus radii
+        float shapeData[] = { 24.0f, 10.0f, 10.0f, 40.0f, 22.0f, 4.0f };
+        // Inverse transforms moving the center of the block to the origin
+        float transforms[36] = { };
+        for (unsigned shape = 0; shape < 3; ++shape)
+            for (unsigned row = 0; row < 3; ++row)
+            {
+                transforms[shape * 12 + row * 4 + row] = 1.0f;
+                transforms[shape * 12 + row * 4 + 3] = -32.0f;
+            }
+
+        std::unique_ptr<ComputeBuffer> shapeBuffer(device.CreateBuffer("ShapeData", sizeof(shapeData), CBS_Read));
+        std::unique_ptr<ComputeBuffer> transformBuffer(device.CreateBuffer("Transforms", sizeof(transforms), CBS_Read));
+        std::unique_ptr<ComputeBuffer> densityBuffer(device.CreateBuffer("Densities", densityCells * sizeof(float), CBS_Read | CBS_Write));
+        std::unique_ptr<ComputeBuffer> signBuffer(device.CreateBuffer("Signs", densityCells, CBS_Read | CBS_Write));
+        std::unique_ptr<ComputeBuffer> edgeBuffer(device.CreateBuffer("Edges", densityCells * 3 * sizeof(CPUEdgeData), CBS_Write));
+        std::unique_ptr<ComputeBuffer> voxelBuffer(device.CreateBuffer("Voxels", voxelCells * sizeof(int), CBS_Write));
+        shapeBuffer->SetData(shapeData, 0, sizeof(shapeData));
+        transformBuffer->SetData(transforms, 0, sizeof(transforms));
+
+        std::unique_ptr<ComputeKernel> generate(shader->GetKernel("GenerateDefaultField"));
+        std::unique_ptr<ComputeKernel> edges(shader->GetKernel("FindEdgeIntersections"));
+        std::unique_ptr<ComputeKernel> scan(shader->GetKernel("ScanVoxels"));
+        if (!generate || !edges || !scan)
+            return false;
+
+        int offset[4] = { 0, 0, 0, 0 };
+        int defaultMaterial = 0;
+        generate->SetArg(0, offset, sizeof(offset));
+        generate->SetArg(1, &defaultMaterial, sizeof(defaultMaterial));
+        generate->Bind(densityBuffer.get(), 2);
+        generate->Bind(transformBuffer.get(), 3);
+        generate->Bind(shapeBuffer.get(), 4);
+
+        edges->Bind(signBuffer.get(), 0);
+        edges->Bind(shapeBuffer.get(), 1);
+        edges->Bind(transformBuffer.get(), 2);
+        edges->Bind(edgeBuffer.get(), 3);
+
+        scan->Bind(signBuffer.get(), 0);
+        scan->Bind(voxelBuffer.get(), 1);
+
+        // Throughput is reported in cells, as a square of edge^2 by edge
+        auto measure = [&](ComputeKernel* kernel, unsigned edge) {
+            BenchmarkResult result;
+            result.Name = "compute/cpu/" + kernel->GetName();
+            result.Width = edge * edge;
+            result.Height = edge;
+            for (unsigned run = 0; run < settings_.Warmup + settings_.Iterations; ++run)
+            {
+                const math::tick_t start = Clock::Tick();
+                kernel->Execute(edge, edge, edge);
+                device.Finish();
+                const double elapsed = Clock::TicksToMillisecondsD(Clock::TicksInBetween(Clock::Tick(), start));
+                if (run >= settings_.Warmup)
+                    result.SamplesMS.push_back(elapsed);
+            }
+            result.Finalize();
+            std::cout << std::left << std::setw(56) << result.Name << " " << edge << "^3 x" << device.GetThreadCount() << "  " << std::fixed << std::setprecision(3) << result.MedianMS << " ms" << std::endl;
+            results_.push_back(result);
+        };
+
+        // ScanVoxels classifies the signs FindEdgeIntersections writes
+        measure(generate.get(), CPU_DENSITY_EDGE);
+        measure(edges.get(), CPU_DENSITY_EDGE);
+        measure(scan.get(), CPU_VOXEL_EDGE);
+        return true;
+    }
+
+    bool BenchmarkRunner::RunVariationBenchmark(const std::string& filePath, unsigned count, const std::string& folder)
+    {
+        Graph* graph = TextureGraphReport::GraphFromFile(filePath);
+        if (!graph)
+        {
+            std::cerr << "Unable to load graph: " << filePath << std::endl;
+            return false;
+        }
+
+        std::vector<unsigned> seeds;
+        for (unsigned i = 0; i < count; ++i)
+            seeds.push_back(i + 1);
+
+        BenchmarkResult result;
+        result.Name = "variations/" + FileName(filePath);
+        result.Height = 1;
+        for (TextureOutputNode* output : graph->GetNodesByType<TextureOutputNode>())
+            result.Width += output->Width * output->Height * count;
+
+        TextureVariationRenderer renderer;
+        for (unsigned run = 0; run < settings_.Warmup + settings_.Iterations; ++run)
+        {
+            const math::tick_t start = Clock::Tick();
+            const bool rendered = renderer.Render(graph, seeds);
+            const double elapsed = Clock::TicksToMillisecondsD(Clock::TicksInBetween(Clock::Tick(), start));
+            if (!rendered)
+            {
+                delete graph;
+                return false;
+            }
+            if (run >= settings_.Warmup)
+                result.SamplesMS.push_back(elapsed);
+        }
+        result.Finalize();
+        std::cout << std::left << std::setw(56) << result.Name << " x" << count << "  " << std::fixed << std::setprecision(3) << result.MedianMS << " ms"
+            << "  (" << renderer.GetVaryingNodeCount() << " varying, " << renderer.GetSharedNodeCount() << " shared nodes, " << renderer.GetSharedOutputCount() << " shared outputs)" << std::endl;
+        results_.push_back(result);
+
+        if (!folder.empty())
+            renderer.WriteOutputs(folder, FileName(filePath));
+        delete graph;
+        return true;
+    }
+
+    bool BenchmarkRunner::RunSweepBenchmark(const std::string& filePath, const std::vector<std::string>& sweeps, unsigned frames, const std::string& folder, bool asArray)
+    {
+        Graph* graph = TextureGraphReport::GraphFromFile(filePath);
+        if (!graph)
+        {
+            std::cerr << "Unable to load graph: " << filePath << std::endl;
+            return false;
+        }
+
+        std::vector<TextureSweepTrack> tracks;
+        for (const std::string& sweep : sweeps)
+        {
+            const size_t dot = sweep.find('.');
+            const size_t equals = sweep.find('=', dot);
+            const size_t colon = sweep.find(':', equals);
+            if (dot == std::string::npos || equals == std::string::npos || colon == std::string::npos)
+            {
+                std::cerr << "Sweep must be written <node>.<property>=<from>:<to>: " << sweep << std::endl;
+                delete graph;
+                return false;
+            }
+
+            const std::string nodeName = sweep.substr(0, dot);
+            GraphNode* found = 0x0;
+            for (GraphNode* node : graph->GetNodes())
+            {
+                if (node->name == nodeName || nodeName == node->GetTypeName())
+                {
+                    found = node;
+                    break;
+                }
+            }
+            if (!found)
+            {
+                std::cerr << "No node named " << nodeName << " in " << filePath << std::endl;
+                delete graph;
+                return false;
+            }
+
+            TextureSweepTrack track;
+            track.NodeID = found->GetSourceID();
+            track.Property = sweep.substr(dot + 1, equals - dot - 1);
+            const VariantType type = found->GetPropertyType(StringHash(track.Property));
+            track.From.FromString(type, sweep.substr(equals + 1, colon - equals - 1));
+            track.To.FromString(type, sweep.substr(colon + 1));
+            tracks.push_back(track);
+        }
+
+        BenchmarkResult result;
+        result.Name = "sweep/" + FileName(filePath);
+        result.Height = 1;
+        for (TextureOutputNode* output : graph->GetNodesByType<TextureOutputNode>())
+            result.Width += output->Width * output->Height * frames;
+
+        TextureVariationRenderer renderer;
+        for (unsigned run = 0; run < settings_.Warmup + settings_.Iterations; ++run)
+        {
+            const math::tick_t start = Clock::Tick();
+            const bool rendered = renderer.RenderSweep(graph, tracks, frames);
+            const double elapsed = Clock::TicksToMillisecondsD(Clock::TicksInBetween(Clock::Tick(), start));
+            if (!rendered)
+            {
+                delete graph;
+                return false;
+            }
+            if (run >= settings_.Warmup)
+                result.SamplesMS.push_back(elapsed);
+        }
+        result.Finalize();
+        std::cout << std::left << std::setw(56) << result.Name << " x" << frames << "  " << std::fixed << std::setprecision(3) << result.MedianMS << " ms"
+            << "  (" << renderer.GetVaryingNodeCount() << " animated, " << renderer.GetSharedNodeCount() << " shared nodes, " << renderer.GetSharedOutputCount() << " shared outputs)" << std::endl;
+        results_.push_back(result);
+
+        if (!folder.empty())
+        {
+            if (asArray)
+                renderer.WriteTextureArrays(folder, FileName(filePath));
+            else
+                renderer.WriteFlipbooks(folder, FileName(filePath));
+        }
+        delete graph;
+        return true;
+    }
+
+    void BenchmarkRunner::Measure(Graph* graph, const std::vector<unsigned>& outputs, const std::vector<std::string>& names, const std::vector<unsigned>& widths, const std::vector<unsigned>& heights, const std::string& totalName)
+    {
+        std::vector<BenchmarkResult> cases(outputs.size());
+        BenchmarkResult total;
+        total.Name = totalName;
+        for (unsigned i = 0; i < outputs.size(); ++i)
+        {
+            cases[i].Name = names[i];
+            cases[i].Width = widths[i];
+            cases[i].Height = heights[i];
+            // Report the total as the area of all outputs, so throughput stays comparable
+            total.Width += widths[i] * heights[i];
+        }
+        total.Height = 1;
+
+        for (unsigned run = 0; run < settings_.Warmup + settings_.Iterations; ++run)
+        {
+            Graph* clone = (Graph*)graph->Clone();
+            if (!clone)
+                return;
+
+            if (settings_.Optimize)
+            {
+                std::vector<GraphNode*> roots;
+                for (unsigned output : outputs)
+                    if (GraphNode* node = clone->GetNodeBySourceID(output))
+                        roots.push_back(node);
+                TextureGraphOptimizer().Optimize(clone, roots);
+            }
+
+            double runTotal = 0.0;
+            for (unsigned i = 0; i < outputs.size(); ++i)
+            {
+                GraphNode* node = clone->GetNodeBySourceID(outputs[i]);
+                if (!node)
+                    continue;
+                const math::tick_t start = Clock::Tick();
+                node->GetPreview(widths[i], heights[i]);
+                const double elapsed = Clock::TicksToMillisecondsD(Clock::TicksInBetween(Clock::Tick(), start));
+                runTotal += elapsed;
+                if (run >= settings_.Warmup)
+                    cases[i].SamplesMS.push_back(elapsed);
+            }
+            if (run >= settings_.Warmup)
+                total.SamplesMS.push_back(runTotal);
+            delete clone;
+        }
+
+        for (auto& result : cases)
+        {
+            result.Finalize();
+            std::cout << std::left << std::setw(56) << result.Name << " " << result.Width << "x" << result.Height << "  " << std::fixed << std::setprecision(3) << result.MedianMS << " ms" << std::endl;
+            results_.push_back(result);
+        }
+        if (!totalName.empty())
+        {
+            total.Finalize();
+            results_.push_back(total);
+        }
+    }
+
+    bool BenchmarkRunner::ExportGraph(const std::string& filePath, const std::string& folder, std::ostream& out) const
+    {
+        Graph* graph = TextureGraphReport::GraphFromFile(filePath);
+        if (!graph)
+        {
+            out << "Unable to load graph: " << filePath << std::endl;
+            return false;
+        }
+
+        const std::string name = TextureCodeGenerator::MakeIdentifier(FileName(filePath), "TextureGraph");
+        TextureCodeGenerator generator;
+        const bool generated = generator.Generate(graph, name);
+        delete graph;
+
+        for (const std::string& error : generator.GetErrors())
+            out << "    skipped " << error << std::endl;
+        if (!generated)
+        {
+            out << "Nothing to export from " << filePath << std::endl;
+            return false;
+        }
+
+        const std::string outputPath = folder + "/" + name + ".h";
+        if (!generator.WriteFile(outputPath))
+        {
+            out << "Unable to write " << outputPath << std::endl;
+            return false;
+        }
+        out << "Exported " << generator.GetGeneratedCount() << " output(s) to " << outputPath << std::endl;
+        return true;
+    }
+
+    /// Evaluates an output one pixel at a time through the nodes, as TextureOutputNode::GetPreview does when nothing can be compiled.
+    static void InterpretOutput(TextureOutputNode* node, unsigned width, unsigned height, std::vector<TextureRuntime::Color>& into)
+    {
+        into.resize(width * height);
+        node->graph->BeginRenderPass();
+        unsigned ctx = 1;
+        for (unsigned y = 0; y < height; ++y)
+        {
+            for (unsigned x = 0; x < width; ++x, ++ctx)
+            {
+                unsigned pixelContext = ctx;
+                node->ExecuteUpstream(pixelContext, Vec4(x / (float)width, y / (float)height, width, height));
+                ctx = pixelContext;
+                const RGBA value = node->GetOutputSocket(0)->GetValue().getColorSafe(true);
+                into[y * width + x] = TextureRuntime::Output(TextureRuntime::Make(value.r, value.g, value.b, value.a), node->Format);
+            }
+        }
+    }
+
+    unsigned BenchmarkRunner::VerifyCompiled(const std::string& filePath, float tolerance, std::ostream& out) const
+    {
+        Graph* graph = TextureGraphReport::GraphFromFile(filePath);
+        if (!graph)
+        {
+            out << "Unable to load graph: " << filePath << std::endl;
+            return 0;
+        }
+
+        unsigned failures = 0;
+        for (GraphNode* entry : graph->GetEntryNodes())
+        {
+            TextureOutputNode* output = dynamic_cast<TextureOutputNode*>(entry);
+            if (!output)
+                continue;
+            const std::string name = FileName(filePath) + "/" + (output->name.empty() ? std::to_string(output->GetInstanceID()) : output->name);
+
+            // Separate clones, so that neither run sees values stored by the other
+            Graph* compiledClone = (Graph*)graph->Clone();
+            Graph* interpretedClone = (Graph*)graph->Clone();
+            TextureOutputNode* compiledNode = compiledClone ? dynamic_cast<TextureOutputNode*>(compiledClone->GetNodeBySourceID(output->GetSourceID())) : 0x0;
+            TextureOutputNode* interpretedNode = interpretedClone ? dynamic_cast<TextureOutputNode*>(interpretedClone->GetNodeBySourceID(output->GetSourceID())) : 0x0;
+
+            TextureProgram program;
+            if (compiledNode && interpretedNode && program.Build(compiledNode))
+            {
+                const unsigned width = output->Width;
+                const unsigned height = output->Height;
+                FilterableBlockMap<RGBA> compiled(width, height);
+                program.Execute(&compiled);
+
+                std::vector<TextureRuntime::Color> interpreted;
+                InterpretOutput(interpretedNode, width, height, interpreted);
+
+                float maxError = 0.0f;
+                for (unsigned y = 0; y < height; ++y)
+                {
+                    for (unsigned x = 0; x < width; ++x)
+                    {
+                        const RGBA& value = compiled.get(x, y);
+                        const TextureRuntime::Color lhs = TextureRuntime::Output(TextureRuntime::Make(value.r, value.g, value.b, value.a), output->Format);
+                        const TextureRuntime::Color& rhs = interpreted[y * width + x];
+                        maxError = std::max(maxError, std::max(std::max(fabsf(lhs.r - rhs.r), fabsf(lhs.g - rhs.g)), std::max(fabsf(lhs.b - rhs.b), fabsf(lhs.a - rhs.a))));
+                    }
+                }
+
+                const bool passed = maxError <= tolerance;
+                out << std::left << std::setw(56) << name << " " << program.GetCompiledNodeCount() << " compiled, " << program.GetExternalCount() << " interpreted, max error "
+                    << std::scientific << std::setprecision(2) << maxError << std::fixed << (passed ? "" : "  MISMATCH") << std::endl;
+                if (!passed)
+                    ++failures;
+            }
+            else
+                out << std::left << std::setw(56) << name << " not compiled" << std::endl;
+
+            delete compiledClone;
+            delete interpretedClone;
+        }
+
+        delete graph;
+        return failures;
+    }
+
+    /// Largest per channel difference between two images of the same size.
+    static float MaxDifference(const std::vector<TextureRuntime::Color>& lhs, const std::vector<TextureRuntime::Color>& rhs)
+    {
+        float maxError = 0.0f;
+        for (unsigned i = 0; i < lhs.size() && i < rhs.size(); ++i)
+            maxError = std::max(maxError, std::max(std::max(fabsf(lhs[i].r - rhs[i].r), fabsf(lhs[i].g - rhs[i].g)), std::max(fabsf(lhs[i].b - rhs[i].b), fabsf(lhs[i].a - rhs[i].a))));
+        return maxError;
+    }
+
+    unsigned BenchmarkRunner::VerifyExported(float tolerance, std::ostream& out) const
+    {
+        const std::string name = "ExportSample.h/Albedo";
+        Graph graph;
+        TextureOutputNode* output = 0x0;
+        if (BuiltinCorpus::BuildExportSample(&graph))
+        {
+            std::vector<TextureOutputNode*> outputs = graph.GetNodesByType<TextureOutputNode>();
+            output = outputs.size() == 1 && outputs[0]->name == "Albedo" ? outputs[0] : 0x0;
+        }
+        if (!output)
+        {
+            out << std::left << std::setw(56) << name << " sample graph could not be built  MISMATCH" << std::endl;
+            return 1;
+        }
+
+        // The header's own size and format, a graph that no longer matches them is as stale as one that renders differently
+        const unsigned width = ExportSample::Albedo::Width;
+        const unsigned height = ExportSample::Albedo::Height;
+        bool passed = output->Width == width && output->Height == height && (int)output->Format == ExportSample::Albedo::Format;
+
+        std::vector<TextureRuntime::Color> exported(width * height);
+        ExportSample::Albedo::Render(exported.data());
+        std::vector<TextureRuntime::Color> interpreted;
+        InterpretOutput(output, width, height, interpreted);
+
+        const float maxError = MaxDifference(exported, interpreted);
+        passed &= maxError <= tolerance;
+        out << std::left << std::setw(56) << name << " exported C++, max error " << std::scientific << std::setprecision(2) << maxError << std::fixed << (passed ? "" : "  MISMATCH") << std::endl;
+        return passed ? 0 : 1;
+    }
+
+    void BenchmarkRunner::PrintResults(std::ostream& out) const
+    {
+        out << std::left << std::setw(56) << "Case" << std::right << std::setw(12) << "Size" << std::setw(12) << "Median ms" << std::setw(12) << "P95 ms" << std::setw(12) << "Min ms" << std::setw(10) << "MP/s" << std::endl;
+        for (const auto& result : results_)
+        {
+            std::stringstream size;
+            size << result.Width << "x" << result.Height;
+            out << std::left << std::setw(56) << result.Name << std::right << std::setw(12) << size.str() << std::fixed << std::setprecision(3)
+                << std::setw(12) << result.MedianMS << std::setw(12) << result.P95MS << std::setw(12) << result.MinMS << std::setprecision(2) << std::setw(10) << result.MegapixelsPerSecond << std::endl;
+        }
+    }
+
+    bool BenchmarkRunner::WriteCSV(const std::string& filePath) const
+    {
+        std::ofstream file(filePath);
+        if (!file.is_open())
+            return false;
+
+        file << "name,width,height,samples,median_ms,p95_ms,min_ms,mpps" << std::endl;
+        file << std::setprecision(6);
+        for (const auto& result : results_)
+        {
+            // Commas would break the columns, file and node names are free text
+            file << ReplaceString(result.Name, ",", ";") << "," << result.Width << "," << result.Height << "," << result.SamplesMS.size() << ","
+                << result.MedianMS << "," << result.P95MS << "," << result.MinMS << "," << result.MegapixelsPerSecond << std::endl;
+        }
+        return file.good();
+    }
+
+    bool BenchmarkRunner::ReadCSV(const std::string& filePath, std::vector<BenchmarkResult>& into)
+    {
+        std::ifstream file(filePath);
+        if (!file.is_open())
+            return false;
+
+        std::string line;
+        std::getline(file, line); // header
+        while (std::getline(file, line))
+        {
+            line = Trim(line);
+            std::vector<std::string> columns = Split(line, ',');
+            if (columns.size() < 8)
+                continue;
+            BenchmarkResult result;
+            result.Name = columns[0];
+            result.Width = (unsigned)std::stoul(columns[1]);
+            result.Height = (unsigned)std::stoul(columns[2]);
+            result.MedianMS = std::stod(columns[4]);
+            result.P95MS = std::stod(columns[5]);
+            result.MinMS = std::stod(columns[6]);
+            result.MegapixelsPerSecond = std::stod(columns[7]);
+            into.push_back(result);
+        }
+        return true;
+    }
+
+    unsigned BenchmarkRunner::CompareAgainst(const std::vector<BenchmarkResult>& baseline, double thresholdPercent, std::ostream& out) const
+    {
+        unsigned regressions = 0;
+        out << std::left << std::setw(56) << "Case" << std::right << std::setw(12) << "Size" << std::setw(12) << "Base ms" << std::setw(12) << "Now ms" << std::setw(10) << "Change" << std::endl;
+        for (const auto& result : results_)
+        {
+            std::stringstream size;
+            size << result.Width << "x" << result.Height;
+            out << std::left << std::setw(56) << result.Name << std::right << std::setw(12) << size.str();
+
+            auto found = std::find_if(baseline.begin(), baseline.end(), [&result](const BenchmarkResult& rhs) { return result.SameCase(rhs); });
+            if (found == baseline.end() || found->MedianMS <= 0.0)
+            {
+                out << std::setw(12) << "-" << std::fixed << std::setprecision(3) << std::setw(12) << result.MedianMS << std::setw(10) << "new" << std::endl;
+                continue;
+            }
+
+            const double change = (result.MedianMS - found->MedianMS) / found->MedianMS * 100.0;
+            out << std::fixed << std::setprecision(3) << std::setw(12) << found->MedianMS << std::setw(12) << result.MedianMS << std::setprecision(1) << std::setw(9) << std::showpos << change << std::noshowpos << "%";
+            if (change > thresholdPercent)
+            {
+                out << "  REGRESSION";
+                ++regressions;
+            }
+            out << std::endl;
+        }
+        return regressions;
+    }
+
+}
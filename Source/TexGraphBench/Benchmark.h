@@ -0,0 +1,100 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace SprueEngine
+{
+    class Graph;
+}
+
+namespace TexGraphBench
+{
+    /// Timings of a single benchmark case at a single resolution.
+    struct BenchmarkResult
+    {
+        /// "node/<TypeName>" for microbenchmarks, "graph/<file>/<output>" and "graph/<file>/total" for graph files.
+        std::string Name;
+        unsigned Width = 0;
+        unsigned Height = 0;
+        std::vector<double> SamplesMS;
+        double MedianMS = 0.0;
+        double P95MS = 0.0;
+        double MinMS = 0.0;
+        /// Output pixels per second based on the median, in millions.
+        double MegapixelsPerSecond = 0.0;
+
+        /// Computes the statistics from SamplesMS.
+        void Finalize();
+        /// Returns true if this is the same case as rhs (name and resolution).
+        bool SameCase(const BenchmarkResult& rhs) const { return Name == rhs.Name && Width == rhs.Width && Height == rhs.Height; }
+    };
+
+    struct BenchmarkSettings
+    {
+        /// Square resolutions used for node microbenchmarks.
+        std::vector<unsigned> Resolutions = { 64, 256, 1024 };
+        /// Measured runs per case, the median and p95 are taken over these.
+        unsigned Iterations = 7;
+        /// Unmeasured runs per case before measuring.
+        unsigned Warmup = 1;
+        /// Only node types containing this text are measured, empty for all.
+        std::string NodeFilter;
+        /// Mesh assigned to baker nodes, bakers are skipped without one.
+        std::string MeshPath;
+        /// Run the TextureGraphOptimizer on each clone before measuring, the optimization itself is not timed.
+        bool Optimize = false;
+    };
+
+    /// Runs node and graph benchmarks headless. Every measured run evaluates a fresh clone of the graph, just as the editor does for
+    /// each preview task, so that node caches from earlier runs do not flatter the results.
+    class BenchmarkRunner
+    {
+    public:
+        BenchmarkRunner(const BenchmarkSettings& settings);
+
+        /// Measures every node type registered by RegisterTextureNodes at every configured resolution.
+        void RunNodeBenchmarks();
+        /// Measures every TextureOutputNode of a graph file at its own size, plus the total for all outputs.
+        bool RunGraphBenchmark(const std::string& filePath);
+        /// Measures the density kernels on the CPU compute device over one 65^3 block of a fixed CSG model, as "compute/cpu/<Kernel>".
+        bool RunComputeBenchmarks();
+        /// Measures rendering every output of a graph file for `count` permutation seeds with the TextureVariationRenderer, as "variations/<file>".
+        /// When folder is not empty the images of the last run are written into it.
+        bool RunVariationBenchmark(const std::string& filePath, unsigned count, const std::string& folder);
+        /// Measures rendering `frames` frames of a sweep over a graph file, as "sweep/<file>". Each sweep is written "<node>.<property>=<from>:<to>",
+        /// naming the node by its name or type. When folder is not empty the frames of the last run are written into it as flipbooks,
+        /// or as DDS texture arrays with asArray.
+        bool RunSweepBenchmark(const std::string& filePath, const std::vector<std::string>& sweeps, unsigned frames, const std::string& folder, bool asArray);
+
+        const std::vector<BenchmarkResult>& GetResults() const { return results_; }
+
+        /// Writes the graph's outputs as C++ through the TextureCodeGenerator into folder, named after the graph file.
+        bool ExportGraph(const std::string& filePath, const std::string& folder, std::ostream& out) const;
+        /// Renders every output of a graph file through the compiled TextureProgram and through per-node interpretation and compares them.
+        /// Only the bytecode is checked, the C++ written by ExportGraph is covered by VerifyExported.
+        /// Returns the number of outputs that differ by more than tolerance in any channel.
+        unsigned VerifyCompiled(const std::string& filePath, float tolerance, std::ostream& out) const;
+        /// Renders ExportSample.h, the C++ ExportGraph wrote for BuiltinCorpus::BuildExportSample and built into this program, and compares
+        /// it against per-node interpretation of the same graph. A header left stale by changes to the nodes or the generator fails here.
+        /// Returns the number of outputs that differ by more than tolerance in any channel.
+        unsigned VerifyExported(float tolerance, std::ostream& out) const;
+
+        /// Prints a human readable table of the results.
+        void PrintResults(std::ostream& out) const;
+        /// Writes the results as CSV, the same file can be given as a baseline later.
+        bool WriteCSV(const std::string& filePath) const;
+        /// Reads results previously written with WriteCSV.
+        static bool ReadCSV(const std::string& filePath, std::vector<BenchmarkResult>& into);
+        /// Prints the change of every case against a baseline and returns the number of cases whose median became slower by more than thresholdPercent.
+        unsigned CompareAgainst(const std::vector<BenchmarkResult>& baseline, double thresholdPercent, std::ostream& out) const;
+
+    private:
+        /// Times `outputs` (source IDs of nodes in graph) on fresh clones of graph, one result per output and an optional total.
+        void Measure(SprueEngine::Graph* graph, const std::vector<unsigned>& outputs, const std::vector<std::string>& names, const std::vector<unsigned>& widths, const std::vector<unsigned>& heights, const std::string& totalName);
+
+        BenchmarkSettings settings_;
+        std::vector<BenchmarkResult> results_;
+    };
+}
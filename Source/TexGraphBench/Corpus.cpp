@@ -0,0 +1,224 @@
+#include "Corpus.h"
+
+#include <SprueEngine/Core/Context.h>
+#include <SprueEngine/FileBuffer.h>
+#include <SprueEngine/GeneralUtility.h>
+#include <SprueEngine/Graph/Graph.h>
+#include <SprueEngine/SerializationContext.h>
+#include <SprueEngine/TextureGen/BakerNodes.h>
+#include <SprueEngine/TextureGen/GeneralNodes.h>
+#include <SprueEngine/TextureGen/TexGenImpl.h>
+#include <SprueEngine/TextureGen/TextureNode.h>
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+#ifdef WIN32
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+using namespace SprueEngine;
+
+namespace TexGraphBench
+{
+
+    const char* BuiltinCorpus::MeshName = "bake_sphere.obj";
+    const char* BuiltinCorpus::ListName = "corpus.txt";
+
+    const std::vector<std::string>& BuiltinCorpus::GetGraphNames()
+    {
+        static const std::vector<std::string> names = { "material.texg", "patterns.texg", "filters.texg", "bake.texg", "export_sample.texg" };
+        return names;
+    }
+
+    static GraphNode* AddNode(Graph* graph, const char* typeName)
+    {
+        GraphNode* node = Context::GetInstance()->Create<GraphNode>(StringHash(typeName));
+        if (!node)
+        {
+            std::cerr << "Corpus node type is not registered: " << typeName << std::endl;
+            return 0x0;
+        }
+        node->Construct();
+        graph->AddNode(node, false);
+        return node;
+    }
+
+    static TextureOutputNode* AddOutput(Graph* graph, const char* name, TexGenOutputType type, TexGenOutputFormat format, unsigned size)
+    {
+        TextureOutputNode* output = new TextureOutputNode();
+        output->Construct();
+        output->name = name;
+        output->OutputType = type;
+        output->Format = format;
+        output->Width = size;
+        output->Height = size;
+        graph->AddNode(output, true);
+        return output;
+    }
+
+    static bool Link(Graph* graph, GraphNode* from, unsigned outputIndex, GraphNode* to, unsigned inputIndex)
+    {
+        if (!from || !to)
+            return false;
+        return graph->Connect(from->GetOutputSocket(outputIndex), to->GetInputSocket(inputIndex));
+    }
+
+    /// One noise feeding albedo, roughness and normal outputs, the shared upstream every material graph has.
+    static bool BuildMaterial(Graph* graph)
+    {
+        GraphNode* noise = AddNode(graph, "FBMGenerator");
+        GraphNode* ramp = AddNode(graph, "GradientRampTextureModifier");
+        GraphNode* contrast = AddNode(graph, "ContrastNode");
+        GraphNode* normal = AddNode(graph, "NormalMapTextureModifier");
+        return Link(graph, noise, 0, ramp, 0) && Link(graph, ramp, 0, AddOutput(graph, "Albedo", TGOT_Albedo, TGOF_RGB, 1024), 0)
+            && Link(graph, noise, 0, contrast, 0) && Link(graph, contrast, 0, AddOutput(graph, "Roughness", TGOT_Roughness, TGOF_Alpha, 1024), 0)
+            && Link(graph, noise, 0, normal, 0) && Link(graph, normal, 0, AddOutput(graph, "Normal", TGOT_Normal, TGOF_RGB, 1024), 0);
+    }
+
+    /// Pattern generators blended by cellular noise and warped by perlin noise, evaluating the blend away from the pixel being written.
+    static bool BuildPatterns(Graph* graph)
+    {
+        GraphNode* brick = AddNode(graph, "BrickGenerator");
+        GraphNode* checker = AddNode(graph, "CheckerGenerator");
+        GraphNode* cells = AddNode(graph, "VoronoiGenerator");
+        GraphNode* perturb = AddNode(graph, "PerlinNoiseGenerator");
+        GraphNode* blend = AddNode(graph, "BlendNode");
+        GraphNode* warp = AddNode(graph, "WarpModifier");
+        return Link(graph, brick, 0, blend, 0) && Link(graph, checker, 0, blend, 1) && Link(graph, cells, 0, blend, 2)
+            && Link(graph, blend, 0, warp, 0) && Link(graph, perturb, 0, warp, 1) && Link(graph, perturb, 0, warp, 2)
+            && Link(graph, warp, 0, AddOutput(graph, "Albedo", TGOT_Albedo, TGOF_RGB, 1024), 0);
+    }
+
+    /// A blur and a normal map of the blur, neighborhood filters stacked on each other.
+    static bool BuildFilters(Graph* graph)
+    {
+        GraphNode* noise = AddNode(graph, "PerlinNoiseGenerator");
+        GraphNode* blur = AddNode(graph, "BlurModifier");
+        GraphNode* normal = AddNode(graph, "NormalMapTextureModifier");
+        return Link(graph, noise, 0, blur, 0)
+            && Link(graph, blur, 0, AddOutput(graph, "Height", TGOT_Height, TGOF_Alpha, 512), 0)
+            && Link(graph, blur, 1, normal, 0) && Link(graph, normal, 0, AddOutput(graph, "Normal", TGOT_Normal, TGOF_RGB, 512), 0);
+    }
+
+    /// Ambient occlusion and curvature of the corpus mesh, blended with noise by the concavity.
+    static bool BuildBake(Graph* graph)
+    {
+        GraphNode* occlusion = AddNode(graph, "AmbientOcclusionBakerNode");
+        GraphNode* curvature = AddNode(graph, "CurvatureBakerNode");
+        GraphNode* noise = AddNode(graph, "FBMGenerator");
+        GraphNode* blend = AddNode(graph, "BlendNode");
+        // Only the handle is set, a name relative to the graph file is resolved against its folder when loaded
+        for (GraphNode* node : { occlusion, curvature })
+            if (TextureBakerNode* baker = dynamic_cast<TextureBakerNode*>(node))
+                baker->SetMeshResourceHandle(ResourceHandle("Mesh", BuiltinCorpus::MeshName));
+        return Link(graph, occlusion, 0, blend, 0) && Link(graph, noise, 0, blend, 1) && Link(graph, curvature, 1, blend, 2)
+            && Link(graph, blend, 0, AddOutput(graph, "Albedo", TGOT_Albedo, TGOF_RGB, 1024), 0);
+    }
+
+    bool BuiltinCorpus::BuildExportSample(Graph* graph)
+    {
+        // Properties are pinned rather than left to their defaults, the header has them baked in
+        CheckerGenerator* checker = dynamic_cast<CheckerGenerator*>(AddNode(graph, "CheckerGenerator"));
+        ContrastNode* contrast = dynamic_cast<ContrastNode*>(AddNode(graph, "ContrastNode"));
+        if (!checker || !contrast)
+            return false;
+        checker->ColorA = RGBA(1.0f, 1.0f, 1.0f, 1.0f);
+        checker->ColorB = RGBA(0.0f, 0.0f, 0.0f, 1.0f);
+        checker->TileCount = IntVec2(4, 4);
+        contrast->Power = 1.5f;
+        return Link(graph, checker, 0, contrast, 0) && Link(graph, contrast, 0, AddOutput(graph, "Albedo", TGOT_Albedo, TGOF_RGB, 256), 0);
+    }
+
+    static bool SaveGraph(Graph* graph, const std::string& filePath)
+    {
+        SerializationContext ctx;
+        ctx.relativePath_ = FolderOf(filePath);
+        FileBuffer buffer(filePath.c_str(), false, true);
+        buffer.WriteFileID("TEXG");
+        return graph->Serialize(&buffer, ctx);
+    }
+
+    /// A UV sphere with a seam column so every vertex has a single position, normal and coordinate, faces index all three alike.
+    static bool WriteSphere(const std::string& filePath)
+    {
+        const unsigned Rings = 32;
+        const unsigned Segments = 64;
+        const float Pi = 3.14159265f;
+
+        std::ofstream file(filePath, std::ios::out | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        file << "# TexGraphBench corpus bake mesh" << std::endl << "o sphere" << std::endl;
+        for (unsigned ring = 0; ring <= Rings; ++ring)
+        {
+            const float v = (float)ring / Rings;
+            for (unsigned segment = 0; segment <= Segments; ++segment)
+            {
+                const float u = (float)segment / Segments;
+                const float x = std::sin(v * Pi) * std::cos(u * 2.0f * Pi);
+                const float y = std::cos(v * Pi);
+                const float z = std::sin(v * Pi) * std::sin(u * 2.0f * Pi);
+                file << "v " << x << " " << y << " " << z << std::endl
+                    << "vt " << u << " " << (1.0f - v) << std::endl
+                    << "vn " << x << " " << y << " " << z << std::endl;
+            }
+        }
+
+        const unsigned stride = Segments + 1;
+        for (unsigned ring = 0; ring < Rings; ++ring)
+        {
+            for (unsigned segment = 0; segment < Segments; ++segment)
+            {
+                // OBJ indices start at 1
+                const unsigned a = ring * stride + segment + 1;
+                const unsigned b = a + stride;
+                file << "f " << a << "/" << a << "/" << a << " " << (a + 1) << "/" << (a + 1) << "/" << (a + 1) << " " << b << "/" << b << "/" << b << std::endl;
+                file << "f " << (a + 1) << "/" << (a + 1) << "/" << (a + 1) << " " << (b + 1) << "/" << (b + 1) << "/" << (b + 1) << " " << b << "/" << b << "/" << b << std::endl;
+            }
+        }
+        return file.good();
+    }
+
+    bool BuiltinCorpus::Write(const std::string& folder)
+    {
+        // Fails when it already exists, writing the files reports anything else
+#ifdef WIN32
+        _mkdir(folder.c_str());
+#else
+        mkdir(folder.c_str(), 0755);
+#endif
+
+        if (GetTextureNodeTypeNames().empty())
+            RegisterTextureNodes(Context::GetInstance());
+
+        bool (*builders[])(Graph*) = { BuildMaterial, BuildPatterns, BuildFilters, BuildBake, BuiltinCorpus::BuildExportSample };
+        const std::vector<std::string>& names = GetGraphNames();
+
+        bool success = WriteSphere(folder + "/" + MeshName);
+        if (!success)
+            std::cerr << "Unable to write corpus mesh: " << folder << "/" << MeshName << std::endl;
+
+        std::ofstream list(folder + "/" + ListName, std::ios::out | std::ios::trunc);
+        list << "# Built-in TexGraphBench corpus, rewritten on every run that uses it" << std::endl;
+        for (unsigned i = 0; i < names.size(); ++i)
+        {
+            std::unique_ptr<Graph> graph(new Graph());
+            const std::string filePath = folder + "/" + names[i];
+            if (!builders[i](graph.get()) || !SaveGraph(graph.get(), filePath))
+            {
+                std::cerr << "Unable to write corpus graph: " << filePath << std::endl;
+                success = false;
+                continue;
+            }
+            list << names[i] << std::endl;
+        }
+        return success && list.good();
+    }
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace SprueEngine
+{
+    class Graph;
+}
+
+namespace TexGraphBench
+{
+    /// The graphs measured when none are given on the command line, built in code so the benchmark always has something representative to run.
+    /// Together they cover shared pointwise chains, pattern generators blended and warped, neighborhood filters, mesh bakers
+    /// and the fully compilable graph ExportSample.h was generated from.
+    struct BuiltinCorpus
+    {
+        /// File written for each graph, in the order they are listed.
+        static const std::vector<std::string>& GetGraphNames();
+        /// OBJ file written for the baker graph, a UV mapped sphere.
+        static const char* MeshName;
+        /// Corpus list naming every graph file, readable with --corpus.
+        static const char* ListName;
+
+        /// Writes the graphs, the bake mesh and the corpus list into folder, creating it if needed. Files already there are replaced so that
+        /// the corpus always matches the nodes of this build. Returns false if anything could not be written.
+        static bool Write(const std::string& folder);
+
+        /// Builds the graph of ExportSample.h, a checker through a contrast node into an "Albedo" output. Regenerate the header with
+        /// --export-cpp from export_sample.texg whenever the graph or the TextureCodeGenerator changes.
+        static bool BuildExportSample(SprueEngine::Graph* graph);
+    };
+}
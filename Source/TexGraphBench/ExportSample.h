@@ -0,0 +1,47 @@
+// Generated by TextureCodeGenerator, regenerate from the texture graph rather than editing.
+#pragma once
+
+#include "SprueEngine/TextureGen/TextureRuntime.h"
+
+namespace ExportSample
+{
+
+/// Albedo
+namespace Albedo
+{
+    using namespace SprueEngine::TextureRuntime;
+
+    constexpr unsigned Width = 256;
+    constexpr unsigned Height = 256;
+    constexpr int Format = 0;
+
+    inline Color Evaluate(float u, float v, float width, float height)
+    {
+        constexpr Color k0 = { 0.0f, 0.0f, 0.0f, 0.0f };
+        constexpr Color k1 = { 0.0f, 0.0f, 0.0f, 0.0f };
+        constexpr Color k3 = { 1.0f, 1.0f, 1.0f, 1.0f };
+        constexpr Color k4 = { 0.0f, 0.0f, 0.0f, 1.0f };
+        constexpr Color k7 = { -0.5f, -0.5f, -0.5f, 0.0f };
+        constexpr Color k8 = { 1.5f, 1.5f, 1.5f, 1.5f };
+        constexpr Color k9 = { 0.5f, 0.5f, 0.5f, 0.0f };
+        Color r2, r5, r6;
+        r5 = Make(u, v, width, height);
+        r6 = Splat(Checker(r5.r + k0.r, r5.g + k1.r, 4.0f, 4.0f) ? 1.0f : 0.0f);
+        r2 = Select(r6, k4, k3);
+        r5 = Add(r2, k7);
+        r5 = Mul(r5, k8);
+        r6 = Add(r5, k9);
+        r2 = r6;
+        return r2;
+    }
+
+    /// Fills width * height pixels, row by row, the way TextureOutputNode would present them.
+    inline void Render(Color* pixels, unsigned width = Width, unsigned height = Height)
+    {
+        for (unsigned y = 0; y < height; ++y)
+            for (unsigned x = 0; x < width; ++x)
+                pixels[y * width + x] = Output(Evaluate(x / (float)width, y / (float)height, (float)width, (float)height), Format);
+    }
+}
+
+}
@@ -0,0 +1,225 @@
+#include "Benchmark.h"
+#include "Corpus.h"
+
+#include <SprueEngine/GeneralUtility.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace TexGraphBench;
+
+static void PrintUsage()
+{
+    std::cout << "TexGraphBench [options] [graph.texg ...]" << std::endl
+        << "Without graph files or --corpus the built-in corpus is written to --corpus-dir and measured: four graphs covering" << std::endl
+        << "pointwise chains, patterns, filters and bakers, plus the sphere the bakers use when no --mesh is given." << std::endl
+        << "    --no-nodes            skip the per-node microbenchmarks" << std::endl
+        << "    --filter <text>       only benchmark node types containing <text>" << std::endl
+        << "    --sizes <a,b,...>     microbenchmark resolutions (default 64,256,1024)" << std::endl
+        << "    --iterations <n>      measured runs per case (default 7)" << std::endl
+        << "    --warmup <n>          unmeasured runs per case (default 1)" << std::endl
+        << "    --mesh <path>         mesh for baker nodes, bakers are skipped without one" << std::endl
+        << "    --optimize            run the graph optimizer on each clone before measuring" << std::endl
+        << "    --compute             also measure the density kernels on the CPU compute device" << std::endl
+        << "    --variations <n>      also measure rendering each graph for <n> permutation seeds" << std::endl
+        << "    --variations-out <dir> write the images of --variations into <dir>" << std::endl
+        << "    --sweep <spec>        also measure an animated sweep, <node>.<property>=<from>:<to>, repeat to animate several" << std::endl
+        << "    --frames <n>          frames per sweep (default 16)" << std::endl
+        << "    --sweep-out <dir>     write each sweep as flipbook atlases into <dir>" << std::endl
+        << "    --sweep-array         write sweeps as DDS texture arrays instead of flipbooks" << std::endl
+        << "    --corpus <file>       text file listing graph files, one per line" << std::endl
+        << "    --corpus-dir <dir>    folder the built-in corpus is written to (default texgraphbench_corpus)" << std::endl
+        << "    --no-corpus           measure only the given graphs, or only the node microbenchmarks if none are given" << std::endl
+        << "    --out <file.csv>      write the results" << std::endl
+        << "    --baseline <file.csv> compare against earlier results" << std::endl
+        << "    --threshold <pct>     slowdown of the median that counts as a regression (default 10)" << std::endl
+        << "    --export-cpp <dir>    write each graph's outputs as C++ source into <dir>" << std::endl
+        << "    --verify              compare compiled evaluation of each graph against the interpreter, and the built-in" << std::endl
+        << "                          exported C++ (ExportSample.h) against the interpreter" << std::endl
+        << "    --tolerance <value>   largest per channel difference --verify accepts (default 1e-5)" << std::endl
+        << "Exits with 1 if any case regressed against the baseline or failed verification, 2 on bad arguments." << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkSettings settings;
+    std::vector<std::string> graphFiles;
+    std::string outputPath;
+    std::string baselinePath;
+    std::string exportFolder;
+    double threshold = 10.0;
+    float tolerance = 1e-5f;
+    bool runNodes = true;
+    bool verify = false;
+    bool runCompute = false;
+    unsigned variationCount = 0;
+    std::string variationFolder;
+    std::vector<std::string> sweeps;
+    unsigned sweepFrames = 16;
+    std::string sweepFolder;
+    bool sweepArray = false;
+    std::string corpusFolder = "texgraphbench_corpus";
+    bool useBuiltinCorpus = true;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--help" || arg == "-h")
+        {
+            PrintUsage();
+            return 0;
+        }
+        else if (arg == "--no-nodes")
+            runNodes = false;
+        else if (arg == "--optimize")
+            settings.Optimize = true;
+        else if (arg == "--compute")
+            runCompute = true;
+        else if (arg == "--variations" && hasValue)
+            variationCount = (unsigned)std::strtoul(argv[++i], 0x0, 10);
+        else if (arg == "--variations-out" && hasValue)
+            variationFolder = argv[++i];
+        else if (arg == "--sweep" && hasValue)
+            sweeps.push_back(argv[++i]);
+        else if (arg == "--frames" && hasValue)
+            sweepFrames = (unsigned)std::strtoul(argv[++i], 0x0, 10);
+        else if (arg == "--sweep-out" && hasValue)
+            sweepFolder = argv[++i];
+        else if (arg == "--sweep-array")
+            sweepArray = true;
+        else if (arg == "--filter" && hasValue)
+            settings.NodeFilter = argv[++i];
+        else if (arg == "--sizes" && hasValue)
+        {
+            settings.Resolutions.clear();
+            for (const std::string& size : SprueEngine::Split(argv[++i], ','))
+                if (unsigned value = (unsigned)std::strtoul(size.c_str(), 0x0, 10))
+                    settings.Resolutions.push_back(value);
+        }
+        else if (arg == "--iterations" && hasValue)
+            settings.Iterations = (unsigned)std::strtoul(argv[++i], 0x0, 10);
+        else if (arg == "--warmup" && hasValue)
+            settings.Warmup = (unsigned)std::strtoul(argv[++i], 0x0, 10);
+        else if (arg == "--mesh" && hasValue)
+            settings.MeshPath = argv[++i];
+        else if (arg == "--corpus-dir" && hasValue)
+            corpusFolder = argv[++i];
+        else if (arg == "--no-corpus")
+            useBuiltinCorpus = false;
+        else if (arg == "--corpus" && hasValue)
+        {
+            useBuiltinCorpus = false;
+            std::ifstream corpus(argv[++i]);
+            if (!corpus.is_open())
+            {
+                std::cerr << "Unable to open corpus list: " << argv[i] << std::endl;
+                return 2;
+            }
+            // Paths in the list are relative to the list itself
+            const std::string corpusFolder = SprueEngine::FolderOf(argv[i]);
+            std::string line;
+            while (std::getline(corpus, line))
+            {
+                line = SprueEngine::Trim(line);
+                if (line.empty() || line[0] == '#')
+                    continue;
+                graphFiles.push_back(SprueEngine::IsPathRooted(line) ? line : SprueEngine::MakeAbsolutePath(line, corpusFolder));
+            }
+        }
+        else if (arg == "--out" && hasValue)
+            outputPath = argv[++i];
+        else if (arg == "--baseline" && hasValue)
+            baselinePath = argv[++i];
+        else if (arg == "--threshold" && hasValue)
+            threshold = std::strtod(argv[++i], 0x0);
+        else if (arg == "--export-cpp" && hasValue)
+            exportFolder = argv[++i];
+        else if (arg == "--verify")
+            verify = true;
+        else if (arg == "--tolerance" && hasValue)
+            tolerance = std::strtof(argv[++i], 0x0);
+        else if (arg.size() > 1 && arg[0] == '-')
+        {
+            std::cerr << "Unknown or incomplete option: " << arg << std::endl;
+            PrintUsage();
+            return 2;
+        }
+        else
+        {
+            useBuiltinCorpus = false;
+            graphFiles.push_back(arg);
+        }
+    }
+
+    if (useBuiltinCorpus)
+    {
+        if (!BuiltinCorpus::Write(corpusFolder))
+        {
+            std::cerr << "Unable to write the built-in corpus into: " << corpusFolder << std::endl;
+            return 2;
+        }
+        for (const std::string& name : BuiltinCorpus::GetGraphNames())
+            graphFiles.push_back(corpusFolder + "/" + name);
+        if (settings.MeshPath.empty())
+            settings.MeshPath = corpusFolder + "/" + BuiltinCorpus::MeshName;
+    }
+
+    BenchmarkRunner runner(settings);
+
+    unsigned mismatches = verify ? runner.VerifyExported(tolerance, std::cout) : 0;
+    for (const std::string& file : graphFiles)
+    {
+        if (!exportFolder.empty())
+            runner.ExportGraph(file, exportFolder, std::cout);
+        if (verify)
+            mismatches += runner.VerifyCompiled(file, tolerance, std::cout);
+    }
+    if (mismatches > 0)
+    {
+        std::cout << std::endl << mismatches << " output(s) differ between compiled or exported and interpreted evaluation" << std::endl;
+        return 1;
+    }
+
+    if (runNodes)
+        runner.RunNodeBenchmarks();
+    for (const std::string& file : graphFiles)
+    {
+        runner.RunGraphBenchmark(file);
+        if (variationCount > 0)
+            runner.RunVariationBenchmark(file, variationCount, variationFolder);
+        if (!sweeps.empty() && sweepFrames > 0)
+            runner.RunSweepBenchmark(file, sweeps, sweepFrames, sweepFolder, sweepArray);
+    }
+    if (runCompute)
+        runner.RunComputeBenchmarks();
+
+    std::cout << std::endl;
+    runner.PrintResults(std::cout);
+
+    if (!outputPath.empty() && !runner.WriteCSV(outputPath))
+        std::cerr << "Unable to write results: " << outputPath << std::endl;
+
+    if (!baselinePath.empty())
+    {
+        std::vector<BenchmarkResult> baseline;
+        if (!BenchmarkRunner::ReadCSV(baselinePath, baseline))
+        {
+            std::cerr << "Unable to read baseline: " << baselinePath << std::endl;
+            return 2;
+        }
+
+        std::cout << std::endl;
+        const unsigned regressions = runner.CompareAgainst(baseline, threshold, std::cout);
+        if (regressions > 0)
+        {
+            std::cout << std::endl << regressions << " case(s) regressed by more than " << threshold << "%" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,301 @@
+#include "LocalChannel.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+namespace TexGraphService
+{
+    /// Largest message either end accepts, a 8192^2 RGBA8 image and change.
+    static const uint32_t MaxMessageSize = 1u << 28;
+
+#ifdef _WIN32
+    /// Bytes the pipe buffers in each direction.
+    static const DWORD PipeBufferSize = 1 << 16;
+
+    LocalConnection::LocalConnection(void* handle, bool serverEnd) :
+        handle_(handle),
+        serverEnd_(serverEnd)
+    {
+
+    }
+
+    LocalConnection::~LocalConnection()
+    {
+        if (serverEnd_)
+        {
+            FlushFileBuffers(handle_);
+            DisconnectNamedPipe(handle_);
+        }
+        CloseHandle(handle_);
+    }
+
+    LocalConnection* LocalConnection::Connect(const std::string& name)
+    {
+        const std::string address = LocalServer::GetAddress(name);
+        for (;;)
+        {
+            HANDLE handle = CreateFileA(address.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+            if (handle != INVALID_HANDLE_VALUE)
+                return new LocalConnection(handle, false);
+            // Every instance is busy until the service opens the next one
+            if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeA(address.c_str(), 5000))
+                return 0x0;
+        }
+    }
+
+    void LocalConnection::Interrupt()
+    {
+        CancelIoEx(handle_, NULL);
+        if (serverEnd_)
+            DisconnectNamedPipe(handle_);
+    }
+
+    bool LocalConnection::WriteAll(const void* data, size_t size)
+    {
+        const char* bytes = (const char*)data;
+        while (size > 0)
+        {
+            DWORD written = 0;
+            if (!WriteFile(handle_, bytes, (DWORD)(size < PipeBufferSize ? size : PipeBufferSize), &written, NULL))
+                return false;
+            bytes += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    bool LocalConnection::ReadAll(void* data, size_t size)
+    {
+        char* bytes = (char*)data;
+        while (size > 0)
+        {
+            DWORD read = 0;
+            if (!ReadFile(handle_, bytes, (DWORD)(size < PipeBufferSize ? size : PipeBufferSize), &read, NULL) || read == 0)
+                return false;
+            bytes += read;
+            size -= read;
+        }
+        return true;
+    }
+#else
+    LocalConnection::LocalConnection(int socket) :
+        socket_(socket)
+    {
+
+    }
+
+    LocalConnection::~LocalConnection()
+    {
+        close(socket_);
+    }
+
+    LocalConnection* LocalConnection::Connect(const std::string& name)
+    {
+        const std::string address = LocalServer::GetAddress(name);
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        if (address.size() >= sizeof(addr.sun_path))
+            return 0x0;
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, address.c_str());
+
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            return 0x0;
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0)
+        {
+            close(fd);
+            return 0x0;
+        }
+        return new LocalConnection(fd);
+    }
+
+    void LocalConnection::Interrupt()
+    {
+        shutdown(socket_, SHUT_RDWR);
+    }
+
+    bool LocalConnection::WriteAll(const void* data, size_t size)
+    {
+#ifdef MSG_NOSIGNAL
+        const int flags = MSG_NOSIGNAL;
+#else
+        const int flags = 0;
+#endif
+        const char* bytes = (const char*)data;
+        while (size > 0)
+        {
+            const ssize_t written = send(socket_, bytes, size, flags);
+            if (written <= 0)
+                return false;
+            bytes += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    bool LocalConnection::ReadAll(void* data, size_t size)
+    {
+        char* bytes = (char*)data;
+        while (size > 0)
+        {
+            const ssize_t read = recv(socket_, bytes, size, 0);
+            if (read <= 0)
+                return false;
+            bytes += read;
+            size -= read;
+        }
+        return true;
+    }
+#endif
+
+    bool LocalConnection::Send(const void* data, size_t size)
+    {
+        if (size > MaxMessageSize)
+            return false;
+        // Little endian length prefix, both ends always run on the same machine
+        const uint32_t length = (uint32_t)size;
+        return WriteAll(&length, sizeof(length)) && WriteAll(data, size);
+    }
+
+    bool LocalConnection::Receive(std::string& message)
+    {
+        uint32_t length = 0;
+        if (!ReadAll(&length, sizeof(length)) || length > MaxMessageSize)
+            return false;
+        message.resize(length);
+        return length == 0 || ReadAll(&message[0], length);
+    }
+
+    LocalServer::LocalServer() :
+        closed_(false)
+    {
+
+    }
+
+    LocalServer::~LocalServer()
+    {
+        Close();
+#ifndef _WIN32
+        if (socket_ >= 0)
+        {
+            close(socket_);
+            unlink(address_.c_str());
+        }
+#endif
+    }
+
+    std::string LocalServer::GetAddress(const std::string& name)
+    {
+#ifdef _WIN32
+        return "\\\\.\\pipe\\" + name;
+#else
+        if (name.find('/') != std::string::npos)
+            return name;
+        return "/tmp/" + name + ".sock";
+#endif
+    }
+
+#ifdef _WIN32
+    bool LocalServer::Listen(const std::string& name)
+    {
+        address_ = GetAddress(name);
+        // Nothing listens until the first Accept opens an instance of the pipe, fail now if another service already owns the name
+        HANDLE probe = CreateNamedPipeA(address_.c_str(), PIPE_ACCESS_DUPLEX | FILE_FLAG_FIRST_PIPE_INSTANCE, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT, PIPE_UNLIMITED_INSTANCES, PipeBufferSize, PipeBufferSize, 0, NULL);
+        if (probe == INVALID_HANDLE_VALUE)
+            return false;
+        CloseHandle(probe);
+        return true;
+    }
+
+    LocalConnection* LocalServer::Accept()
+    {
+        while (!closed_)
+        {
+            HANDLE handle = CreateNamedPipeA(address_.c_str(), PIPE_ACCESS_DUPLEX, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT, PIPE_UNLIMITED_INSTANCES, PipeBufferSize, PipeBufferSize, 0, NULL);
+            if (handle == INVALID_HANDLE_VALUE)
+                return 0x0;
+            const bool connected = ConnectNamedPipe(handle, NULL) || GetLastError() == ERROR_PIPE_CONNECTED;
+            if (connected && !closed_)
+                return new LocalConnection(handle, true);
+            CloseHandle(handle);
+        }
+        return 0x0;
+    }
+
+    void LocalServer::Close()
+    {
+        if (closed_.exchange(true))
+            return;
+        // ConnectNamedPipe only returns once somebody connects
+        HANDLE wake = CreateFileA(address_.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+        if (wake != INVALID_HANDLE_VALUE)
+            CloseHandle(wake);
+    }
+#else
+    bool LocalServer::Listen(const std::string& name)
+    {
+        address_ = GetAddress(name);
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        if (address_.size() >= sizeof(addr.sun_path))
+            return false;
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, address_.c_str());
+
+        // A socket file left behind by a service that did not exit cleanly would fail the bind
+        if (LocalConnection* existing = LocalConnection::Connect(name))
+        {
+            delete existing;
+            return false;
+        }
+        unlink(address_.c_str());
+
+        socket_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (socket_ < 0)
+            return false;
+        if (bind(socket_, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(socket_, 8) != 0)
+        {
+            close(socket_);
+            socket_ = -1;
+            return false;
+        }
+        return true;
+    }
+
+    LocalConnection* LocalServer::Accept()
+    {
+        while (!closed_ && socket_ >= 0)
+        {
+            const int fd = accept(socket_, 0x0, 0x0);
+            if (fd >= 0)
+            {
+                if (!closed_)
+                    return new LocalConnection(fd);
+                close(fd);
+            }
+            else if (errno != EINTR)
+                return 0x0;
+        }
+        return 0x0;
+    }
+
+    void LocalServer::Close()
+    {
+        if (closed_.exchange(true))
+            return;
+        // Ends an accept blocked in another thread
+        if (socket_ >= 0)
+            shutdown(socket_, SHUT_RDWR);
+    }
+#endif
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+namespace TexGraphService
+{
+    /// One end of a connection between the render service and a client on the same machine, a named pipe on Windows and a Unix domain socket elsewhere.
+    /// Every message is framed with its length, so text commands and binary images can share the connection.
+    class LocalConnection
+    {
+        friend class LocalServer;
+    public:
+        ~LocalConnection();
+
+        /// Connects to the service listening under name, returns null if nothing is listening.
+        static LocalConnection* Connect(const std::string& name);
+
+        bool Send(const std::string& message) { return Send(message.data(), message.size()); }
+        bool Send(const void* data, size_t size);
+        /// Blocks until a whole message has arrived, returns false once the connection is closed or interrupted.
+        bool Receive(std::string& message);
+        /// Makes a Receive blocked in another thread return false, the connection cannot be used afterwards.
+        void Interrupt();
+
+    private:
+#ifdef _WIN32
+        LocalConnection(void* handle, bool serverEnd);
+        void* handle_;
+        bool serverEnd_;
+#else
+        LocalConnection(int socket);
+        int socket_;
+#endif
+        bool WriteAll(const void* data, size_t size);
+        bool ReadAll(void* data, size_t size);
+    };
+
+    /// Accepts LocalConnections under a name.
+    class LocalServer
+    {
+    public:
+        LocalServer();
+        ~LocalServer();
+
+        /// Starts listening, returns false if the name cannot be used.
+        bool Listen(const std::string& name);
+        /// Blocks until a client connects, returns null once the server has been closed.
+        LocalConnection* Accept();
+        /// Stops listening, may be called from another thread to end a blocked Accept.
+        void Close();
+
+        /// The pipe or socket path a name refers to. Names containing a path separator are used as the path of the socket.
+        static std::string GetAddress(const std::string& name);
+
+    private:
+        std::string address_;
+        std::atomic<bool> closed_;
+#ifndef _WIN32
+        int socket_ = -1;
+#endif
+    };
+}
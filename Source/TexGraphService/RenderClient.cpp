@@ -0,0 +1,90 @@
+#include "RenderClient.h"
+
+#include "LocalChannel.h"
+#include "RenderService.h"
+
+#include <SprueEngine/BlockMap.h>
+#include <SprueEngine/Loaders/BasicImageLoader.h>
+#include <SprueEngine/Math/Color.h>
+#include <SprueEngine/MathGeoLib/Time/Clock.h>
+
+#include <cstdlib>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+using namespace SprueEngine;
+
+namespace TexGraphService
+{
+    RenderClient::RenderClient()
+    {
+
+    }
+
+    RenderClient::~RenderClient()
+    {
+
+    }
+
+    bool RenderClient::Connect(const std::string& name)
+    {
+        connection_.reset(LocalConnection::Connect(name));
+        return connection_.get() != 0x0;
+    }
+
+    bool RenderClient::Run(const std::string& command, const std::string& folder, std::ostream& out)
+    {
+        if (!connection_ || !connection_->Send(command))
+        {
+            out << "Not connected to the service" << std::endl;
+            return false;
+        }
+
+        const math::tick_t start = Clock::Tick();
+        std::string reply;
+        while (connection_->Receive(reply))
+        {
+            const double elapsed = Clock::TicksToMillisecondsD(Clock::TicksInBetween(Clock::Tick(), start));
+            const std::vector<std::string> arguments = RenderService::Tokenize(reply);
+            if (arguments.empty())
+                continue;
+
+            if (arguments[0] == "image" && arguments.size() == 5)
+            {
+                std::string pixels;
+                if (!connection_->Receive(pixels))
+                    break;
+                const unsigned width = (unsigned)std::strtoul(arguments[2].c_str(), 0x0, 10);
+                const unsigned height = (unsigned)std::strtoul(arguments[3].c_str(), 0x0, 10);
+                if (pixels.size() != (size_t)width * height * 4)
+                {
+                    out << "Image " << arguments[1] << " has " << pixels.size() << " bytes rather than " << width << "x" << height << " RGBA8 pixels" << std::endl;
+                    return false;
+                }
+                out << reply << "  " << std::fixed << std::setprecision(3) << elapsed << " ms" << std::endl;
+
+                if (!folder.empty())
+                {
+                    FilterableBlockMap<RGBA> image(width, height);
+                    RGBA* data = image.getData();
+                    const unsigned char* bytes = (const unsigned char*)pixels.data();
+                    for (unsigned i = 0; i < width * height; ++i)
+                        data[i] = RGBA(bytes[i * 4] / 255.0f, bytes[i * 4 + 1] / 255.0f, bytes[i * 4 + 2] / 255.0f, bytes[i * 4 + 3] / 255.0f);
+                    const std::string filePath = folder + "/" + arguments[1] + ".png";
+                    BasicImageLoader::SavePNG(&image, filePath.c_str());
+                }
+                continue;
+            }
+
+            out << reply << std::endl;
+            if (arguments[0] == "ok" || arguments[0] == "done")
+                return true;
+            if (arguments[0] == "error")
+                return false;
+        }
+
+        out << "Lost the connection to the service" << std::endl;
+        return false;
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+
+namespace TexGraphService
+{
+    class LocalConnection;
+
+    /// Reference client of the RenderService, for trying the service out and for testing it without the editor or a game.
+    class RenderClient
+    {
+    public:
+        RenderClient();
+        ~RenderClient();
+
+        /// Connects to the service listening under name.
+        bool Connect(const std::string& name);
+        /// Sends a command and prints the replies to out until the service has answered it. Images are written into folder as <output>.png
+        /// unless folder is empty. Returns false if the service answered with an error or the connection was lost.
+        bool Run(const std::string& command, const std::string& folder, std::ostream& out);
+
+    private:
+        std::unique_ptr<LocalConnection> connection_;
+    };
+}
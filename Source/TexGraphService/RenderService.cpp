@@ -0,0 +1,421 @@
+#include "RenderService.h"
+
+#include "LocalChannel.h"
+
+#include <SprueEngine/Core/Context.h>
+#include <SprueEngine/GeneralUtility.h>
+#include <SprueEngine/Graph/Graph.h>
+#include <SprueEngine/Graph/GraphOptimizer.h>
+#include <SprueEngine/Loaders/TextureGraphLoader.h>
+#include <SprueEngine/Resource.h>
+#include <SprueEngine/TextureGen/TextureGraphOptimizer.h>
+#include <SprueEngine/TextureGen/TextureNode.h>
+
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace SprueEngine;
+
+namespace TexGraphService
+{
+    /// Outputs are addressed by name, unnamed ones by their position among the graph's outputs starting from 1.
+    static std::string OutputName(TextureOutputNode* output, unsigned index)
+    {
+        return output->name.empty() ? std::to_string(index) : output->name;
+    }
+
+    RenderService::RenderService()
+    {
+
+    }
+
+    RenderService::~RenderService()
+    {
+
+    }
+
+    bool RenderService::Serve(LocalConnection* connection)
+    {
+        {
+            std::lock_guard<std::mutex> lock(connectionMutex_);
+            if (stopping_)
+                return true;
+            connections_.insert(connection);
+        }
+
+        bool running = true;
+        std::string message;
+        while (running && connection->Receive(message))
+            running = Execute(Tokenize(message), connection);
+
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        connections_.erase(connection);
+        return running;
+    }
+
+    void RenderService::Interrupt()
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        stopping_ = true;
+        for (LocalConnection* connection : connections_)
+            connection->Interrupt();
+    }
+
+    bool RenderService::Execute(const std::vector<std::string>& command, LocalConnection* connection)
+    {
+        if (command.empty())
+        {
+            connection->Send("error empty command");
+            return true;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++commands_;
+        const std::string& verb = command[0];
+        std::string error;
+        if (verb == "load" && command.size() == 2)
+        {
+            if (LoadedGraph* entry = Acquire(command[1], error))
+            {
+                std::string reply = "ok";
+                unsigned index = 0;
+                for (TextureOutputNode* output : entry->Graph->GetNodesByType<TextureOutputNode>())
+                    reply += " " + Quote(OutputName(output, ++index));
+                connection->Send(reply);
+                return true;
+            }
+        }
+        else if (verb == "set" && command.size() == 5)
+        {
+            if (LoadedGraph* entry = Acquire(command[1], error))
+            {
+                Override value;
+                value.Node = command[2];
+                value.Property = command[3];
+                value.Value = command[4];
+                if (ApplyOverride(entry->Graph.get(), value, error))
+                {
+                    // The kept images stay, outputs the property does not reach still hash the same
+                    auto existing = std::find_if(entry->Overrides.begin(), entry->Overrides.end(), [&value](const Override& rhs) { return rhs.Node == value.Node && rhs.Property == value.Property; });
+                    if (existing != entry->Overrides.end())
+                        *existing = value;
+                    else
+                        entry->Overrides.push_back(value);
+                    connection->Send("ok");
+                    return true;
+                }
+            }
+        }
+        else if (verb == "reset" && command.size() == 2)
+        {
+            auto found = graphs_.find(command[1]);
+            if (found == graphs_.end())
+                error = "graph is not loaded: " + command[1];
+            else
+            {
+                found->second->Overrides.clear();
+                if (Reload(*found->second, error))
+                {
+                    connection->Send("ok");
+                    return true;
+                }
+            }
+        }
+        else if (verb == "render" && command.size() >= 2)
+        {
+            if (LoadedGraph* entry = Acquire(command[1], error))
+            {
+                Render(*entry, std::vector<std::string>(command.begin() + 2, command.end()), connection);
+                return true;
+            }
+        }
+        else if (verb == "unload" && command.size() == 2)
+        {
+            if (graphs_.erase(command[1]) > 0)
+            {
+                connection->Send("ok");
+                return true;
+            }
+            error = "graph is not loaded: " + command[1];
+        }
+        else if (verb == "stats" && command.size() == 1)
+        {
+            connection->Send("ok graphs " + std::to_string(graphs_.size()) + " commands " + std::to_string(commands_) + " reloads " + std::to_string(reloads_)
+                + " rendered " + std::to_string(rendered_) + " cached " + std::to_string(cached_));
+            return true;
+        }
+        else if (verb == "shutdown" && command.size() == 1)
+        {
+            connection->Send("ok");
+            return false;
+        }
+        else
+            error = "unknown command or wrong number of arguments: " + verb;
+
+        connection->Send("error " + error);
+        return true;
+    }
+
+    RenderService::LoadedGraph* RenderService::Acquire(const std::string& path, std::string& error)
+    {
+        auto found = graphs_.find(path);
+        if (found == graphs_.end())
+        {
+            std::unique_ptr<LoadedGraph> entry(new LoadedGraph());
+            entry->Path = path;
+            if (!Reload(*entry, error))
+                return 0x0;
+            LoadedGraph* ret = entry.get();
+            graphs_[path] = std::move(entry);
+            return ret;
+        }
+
+        LoadedGraph* entry = found->second.get();
+        const bool resourcesChanged = entry->Graph && GetResourceStamp(entry->Graph.get(), FolderOf(path)) != entry->ResourceStamp;
+        if (!entry->Graph || resourcesChanged || GetModifiedTime(path) != entry->Modified)
+        {
+            // The kept clones hold the resources as well, and what they materialized from a changed file hashes no differently
+            if (resourcesChanged)
+            {
+                for (auto& output : entry->Outputs)
+                    output.second.Clone.reset();
+            }
+            if (!Reload(*entry, error))
+                return 0x0;
+        }
+        return entry;
+    }
+
+    bool RenderService::Reload(LoadedGraph& entry, std::string& error)
+    {
+        // Released first so that resources which changed on disk are not still held, the ResourceStore reloads those nothing uses when their files change
+        entry.Graph.reset();
+        // Taken before reading so that a write during the load is noticed by the next command
+        entry.Modified = GetModifiedTime(entry.Path);
+        entry.Graph.reset(TextureGraphLoader::LoadGraph(entry.Path));
+        if (!entry.Graph)
+        {
+            error = "unable to load graph: " + entry.Path;
+            return false;
+        }
+        entry.ResourceStamp = GetResourceStamp(entry.Graph.get(), FolderOf(entry.Path));
+        ++reloads_;
+
+        for (const Override& value : entry.Overrides)
+        {
+            std::string ignored;
+            if (!ApplyOverride(entry.Graph.get(), value, ignored))
+                std::cerr << entry.Path << ": " << ignored << std::endl;
+        }
+        return true;
+    }
+
+    bool RenderService::ApplyOverride(Graph* graph, const Override& value, std::string& error) const
+    {
+        for (GraphNode* node : graph->GetNodes())
+        {
+            if (node->name != value.Node && value.Node != node->GetTypeName())
+                continue;
+
+            const StringHash property(value.Property);
+            const VariantType type = node->GetPropertyType(property);
+            Variant parsed;
+            if (type == VT_None || !parsed.FromString(type, value.Value))
+            {
+                error = "cannot set " + value.Node + "." + value.Property + " to " + value.Value;
+                return false;
+            }
+            node->SetProperty(property, parsed);
+            return true;
+        }
+        error = "no node named " + value.Node;
+        return false;
+    }
+
+    void RenderService::Render(LoadedGraph& entry, const std::vector<std::string>& outputs, LocalConnection* connection)
+    {
+        unsigned rendered = 0;
+        unsigned cached = 0;
+        std::vector<std::string> missing = outputs;
+        unsigned index = 0;
+        for (TextureOutputNode* output : entry.Graph->GetNodesByType<TextureOutputNode>())
+        {
+            const std::string name = OutputName(output, ++index);
+            if (!outputs.empty() && std::find(outputs.begin(), outputs.end(), name) == outputs.end())
+                continue;
+            missing.erase(std::remove(missing.begin(), missing.end(), name), missing.end());
+
+            // Referenced files can change without anything in the graph changing
+            uint64_t key = 0;
+            const bool keyed = GraphOptimizer::HashSubgraph(entry.Graph.get(), output, key);
+            key = HashBytes64(&entry.ResourceStamp, sizeof(entry.ResourceStamp), key);
+
+            CachedOutput& image = entry.Outputs[name];
+            const bool fromCache = keyed && image.Key == key && !image.Pixels.empty();
+            if (!fromCache)
+            {
+                // Rendered on a clone as the editor does, the optimizer rewrites the graph it is given.
+                // Clones carry the source ID of the loaded node, which is not its instance ID
+                image.Pixels.clear();
+                std::unique_ptr<Graph> clone((Graph*)entry.Graph->Clone());
+                GraphNode* node = clone ? clone->GetNodeBySourceID(output->GetSourceID()) : 0x0;
+                std::shared_ptr<FilterableBlockMap<RGBA> > result;
+                if (node)
+                {
+                    TextureGraphOptimizer optimizer;
+                    optimizer.Optimize(clone.get(), { node });
+                    if (image.Clone)
+                        AdoptCaches(clone.get(), image.Clone.get());
+                    result = node->GetPreview(output->Width, output->Height);
+                }
+                image.Clone = std::move(clone);
+                if (!result)
+                {
+                    connection->Send("failed " + Quote(name));
+                    continue;
+                }
+
+                image.Key = keyed ? key : 0;
+                image.Width = result->getWidth();
+                image.Height = result->getHeight();
+                image.Pixels.resize(image.Width * image.Height * 4);
+                const RGBA* source = result->getData();
+                for (unsigned i = 0; i < image.Width * image.Height; ++i)
+                {
+                    RGBA color = source[i];
+                    color.Clip();
+                    image.Pixels[i * 4] = (unsigned char)(color.r * 255.0f + 0.5f);
+                    image.Pixels[i * 4 + 1] = (unsigned char)(color.g * 255.0f + 0.5f);
+                    image.Pixels[i * 4 + 2] = (unsigned char)(color.b * 255.0f + 0.5f);
+                    image.Pixels[i * 4 + 3] = (unsigned char)(color.a * 255.0f + 0.5f);
+                }
+            }
+            if (fromCache)
+                ++cached;
+            else
+                ++rendered;
+
+            // Each output goes out as soon as it is ready rather than once the whole graph is done
+            connection->Send("image " + Quote(name) + " " + std::to_string(image.Width) + " " + std::to_string(image.Height) + (fromCache ? " cached" : " rendered"));
+            connection->Send(image.Pixels.data(), image.Pixels.size());
+        }
+
+        for (const std::string& name : missing)
+            connection->Send("failed " + Quote(name));
+        rendered_ += rendered;
+        cached_ += cached;
+        connection->Send("done " + std::to_string(rendered) + " " + std::to_string(cached));
+    }
+
+    std::vector<std::string> RenderService::Tokenize(const std::string& line)
+    {
+        std::vector<std::string> ret;
+        std::string current;
+        bool inArgument = false;
+        bool quoted = false;
+        for (size_t i = 0; i < line.size(); ++i)
+        {
+            const char c = line[i];
+            if (quoted)
+            {
+                // Only quotes and backslashes are escaped, so quoted Windows paths keep their separators
+                if (c == '\\' && i + 1 < line.size() && (line[i + 1] == '"' || line[i + 1] == '\\'))
+                    current += line[++i];
+                else if (c == '"')
+                    quoted = false;
+                else
+                    current += c;
+            }
+            else if (c == '"')
+            {
+                quoted = true;
+                inArgument = true;
+            }
+            else if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+            {
+                if (inArgument)
+                    ret.push_back(current);
+                current.clear();
+                inArgument = false;
+            }
+            else
+            {
+                current += c;
+                inArgument = true;
+            }
+        }
+        if (inArgument)
+            ret.push_back(current);
+        return ret;
+    }
+
+    std::string RenderService::Quote(const std::string& argument)
+    {
+        if (!argument.empty() && argument.find_first_of(" \t\r\n\"") == std::string::npos)
+            return argument;
+
+        std::string ret = "\"";
+        for (char c : argument)
+        {
+            if (c == '"' || c == '\\')
+                ret += '\\';
+            ret += c;
+        }
+        return ret + "\"";
+    }
+
+    void RenderService::AdoptCaches(Graph* clone, Graph* previous)
+    {
+        std::unordered_map<unsigned, GraphNode*> bySource;
+        for (GraphNode* node : previous->GetNodes())
+            bySource[node->GetSourceID()] = node;
+
+        // Nodes the optimizer created have source IDs of their own and find nothing, each node checks what it takes over
+        for (GraphNode* node : clone->GetNodes())
+        {
+            auto found = bySource.find(node->GetSourceID());
+            if (found == bySource.end() || found->second->GetTypeHash() != node->GetTypeHash())
+                continue;
+            TextureNode* textureNode = dynamic_cast<TextureNode*>(node);
+            TextureNode* previousNode = dynamic_cast<TextureNode*>(found->second);
+            if (textureNode && previousNode)
+                textureNode->AdoptCaches(previousNode);
+        }
+    }
+
+    time_t RenderService::GetModifiedTime(const std::string& path)
+    {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+            return 0;
+        return info.st_mtime;
+    }
+
+    uint64_t RenderService::GetResourceStamp(Graph* graph, const std::string& folder)
+    {
+        uint64_t stamp = HashBytes64(0x0, 0);
+        const auto& table = Context::GetInstance()->GetPropertyTable();
+        for (GraphNode* node : graph->GetNodes())
+        {
+            auto properties = table.find(node->GetTypeHash());
+            if (properties == table.end())
+                continue;
+            for (auto& property : properties->second)
+            {
+                const Variant value = property->Get(node);
+                if (value.getType() != VT_ResourceHandle)
+                    continue;
+                const std::string name = value.getResourceHandle().Name;
+                if (name.empty())
+                    continue;
+                const time_t modified = GetModifiedTime(IsPathRooted(name) ? name : MakeAbsolutePath(name, folder));
+                stamp = HashBytes64(name.data(), name.size(), stamp);
+                stamp = HashBytes64(&modified, sizeof(modified), stamp);
+            }
+        }
+        return stamp;
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace SprueEngine
+{
+    class Graph;
+}
+
+namespace TexGraphService
+{
+    class LocalConnection;
+
+    /// Keeps texture graphs loaded between requests and renders their outputs for clients connected through a LocalServer.
+    /// Graphs stay resident with the resources their nodes hold, mesh bakes stay in the BakeCache, and the last image of every output
+    /// is kept with the hash of the subgraph that produced it (GraphOptimizer::HashSubgraph). Editing the graph file, a file it references
+    /// or a property through `set` only re-renders the outputs whose subgraph changed, the rest are answered from the kept images.
+    /// The optimized clone each output was rendered from stays resident as well. When the output is rendered again its replacement takes
+    /// over what the clone's nodes materialized (TextureNode::AdoptCaches), so remapped inputs, reductions, distance fields and sample
+    /// grids upstream of an edit are not rendered again. Those clones are dropped when a referenced file changes.
+    ///
+    /// Every request is one text command, arguments containing spaces are double quoted:
+    ///     load <graph>                                loads or refreshes a graph, replies with its output names
+    ///     set <graph> <node> <property> <value>       overrides a property of the node with that name or type, kept across reloads
+    ///     reset <graph>                               drops every override of the graph
+    ///     render <graph> [output ...]                 renders the named outputs, or all of them
+    ///     unload <graph>                              forgets a graph
+    ///     stats                                       replies with counters since the service started
+    ///     shutdown                                    stops the service
+    /// Commands are answered with "ok ..." or "error <reason>". A render instead answers each output with "image <output> <width> <height>
+    /// <rendered|cached>" followed by a message of width * height RGBA8 pixels as soon as that output is ready, or with "failed <output>",
+    /// and ends with "done <rendered> <cached>".
+    class RenderService
+    {
+    public:
+        RenderService();
+        ~RenderService();
+
+        /// Answers the commands of a client until it disconnects. Returns false if the client asked the service to shut down.
+        bool Serve(LocalConnection* connection);
+        /// Runs a single command, sending every reply to the connection. Returns false if the service should shut down.
+        bool Execute(const std::vector<std::string>& command, LocalConnection* connection);
+        /// Disconnects every client still being served, for shutting down.
+        void Interrupt();
+
+        /// Splits a command into its arguments, honoring double quotes and backslash escapes inside them.
+        static std::vector<std::string> Tokenize(const std::string& line);
+        /// Quotes an argument if Tokenize would otherwise split it.
+        static std::string Quote(const std::string& argument);
+
+    private:
+        /// A property set through the `set` command.
+        struct Override
+        {
+            std::string Node;
+            std::string Property;
+            std::string Value;
+        };
+
+        /// The last image rendered for an output.
+        struct CachedOutput
+        {
+            uint64_t Key = 0;
+            unsigned Width = 0;
+            unsigned Height = 0;
+            std::vector<unsigned char> Pixels;
+            /// Optimized clone the image was rendered from, its nodes still hold what they materialized.
+            std::unique_ptr<SprueEngine::Graph> Clone;
+        };
+
+        struct LoadedGraph
+        {
+            std::string Path;
+            time_t Modified = 0;
+            /// Hash of the modification times of every file the graph's nodes reference.
+            uint64_t ResourceStamp = 0;
+            std::unique_ptr<SprueEngine::Graph> Graph;
+            std::vector<Override> Overrides;
+            std::map<std::string, CachedOutput> Outputs;
+        };
+
+        /// Returns the graph loaded from path, loading it or reloading it if it or a file it references changed on disk.
+        LoadedGraph* Acquire(const std::string& path, std::string& error);
+        /// Reads the graph file and applies the overrides.
+        bool Reload(LoadedGraph& entry, std::string& error);
+        bool ApplyOverride(SprueEngine::Graph* graph, const Override& value, std::string& error) const;
+        void Render(LoadedGraph& entry, const std::vector<std::string>& outputs, LocalConnection* connection);
+
+        /// Hands what the nodes of previous materialized to the nodes of clone made from the same source nodes.
+        static void AdoptCaches(SprueEngine::Graph* clone, SprueEngine::Graph* previous);
+        static time_t GetModifiedTime(const std::string& path);
+        static uint64_t GetResourceStamp(SprueEngine::Graph* graph, const std::string& folder);
+
+        /// Held for the whole of every command, commands of different clients are run one at a time.
+        std::mutex mutex_;
+        std::map<std::string, std::unique_ptr<LoadedGraph> > graphs_;
+        std::mutex connectionMutex_;
+        std::set<LocalConnection*> connections_;
+        bool stopping_ = false;
+        unsigned commands_ = 0;
+        unsigned reloads_ = 0;
+        unsigned rendered_ = 0;
+        unsigned cached_ = 0;
+    };
+}
@@ -0,0 +1,141 @@
+#include "LocalChannel.h"
+#include "RenderClient.h"
+#include "RenderService.h"
+
+#include <SprueEngine/Core/Context.h>
+#include <SprueEngine/TextureGen/TextureNode.h>
+#include <SprueEngine/Texturing/BakeCache.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace TexGraphService;
+
+static void PrintUsage()
+{
+    std::cout << "TexGraphService [options]" << std::endl
+        << "    --name <name>         channel the service listens on (default TexGraphService)" << std::endl
+        << "    --bake-cache <dir>    keep mesh bakes in <dir> between runs" << std::endl
+        << "    --bake-memory <mb>    memory kept for mesh bakes (default 256)" << std::endl
+        << "    --client <command>    send a command to the running service instead of serving, repeat to send several in order" << std::endl
+        << "    --out <dir>           folder --client writes rendered images into" << std::endl
+        << "Commands:" << std::endl
+        << "    load <graph>" << std::endl
+        << "    set <graph> <node> <property> <value>" << std::endl
+        << "    reset <graph>" << std::endl
+        << "    render <graph> [output ...]" << std::endl
+        << "    unload <graph>" << std::endl
+        << "    stats" << std::endl
+        << "    shutdown" << std::endl
+        << "Graph paths are opened by the service, give them in full. The client exits with 1 if any command failed, 2 on bad arguments." << std::endl;
+}
+
+/// A connection being served and whether it has finished, so that finished threads can be joined while the service runs.
+struct ServedConnection
+{
+    std::thread Thread;
+    std::shared_ptr<std::atomic<bool> > Finished;
+};
+
+int main(int argc, char** argv)
+{
+    std::string name = "TexGraphService";
+    std::string bakeFolder;
+    unsigned bakeMemory = 256;
+    std::vector<std::string> commands;
+    std::string outputFolder;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--help" || arg == "-h")
+        {
+            PrintUsage();
+            return 0;
+        }
+        else if (arg == "--name" && hasValue)
+            name = argv[++i];
+        else if (arg == "--bake-cache" && hasValue)
+            bakeFolder = argv[++i];
+        else if (arg == "--bake-memory" && hasValue)
+            bakeMemory = (unsigned)std::strtoul(argv[++i], 0x0, 10);
+        else if (arg == "--client" && hasValue)
+            commands.push_back(argv[++i]);
+        else if (arg == "--out" && hasValue)
+            outputFolder = argv[++i];
+        else
+        {
+            std::cerr << "Unknown or incomplete option: " << arg << std::endl;
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    if (!commands.empty())
+    {
+        RenderClient client;
+        if (!client.Connect(name))
+        {
+            std::cerr << "No service is listening on " << LocalServer::GetAddress(name) << std::endl;
+            return 1;
+        }
+        bool succeeded = true;
+        for (const std::string& command : commands)
+            succeeded &= client.Run(command, outputFolder, std::cout);
+        return succeeded ? 0 : 1;
+    }
+
+    SprueEngine::Context* context = SprueEngine::Context::GetInstance();
+    if (SprueEngine::GetTextureNodeTypeNames().empty())
+        SprueEngine::RegisterTextureNodes(context);
+    SprueEngine::BakeCache::GetInstance()->SetDirectory(bakeFolder);
+    SprueEngine::BakeCache::GetInstance()->SetMemoryBudget((unsigned long long)bakeMemory * 1024 * 1024);
+
+    LocalServer server;
+    if (!server.Listen(name))
+    {
+        std::cerr << "Unable to listen on " << LocalServer::GetAddress(name) << ", is another service running?" << std::endl;
+        return 1;
+    }
+    std::cout << "Listening on " << LocalServer::GetAddress(name) << std::endl;
+
+    RenderService service;
+    std::vector<ServedConnection> served;
+    while (LocalConnection* connection = server.Accept())
+    {
+        for (auto it = served.begin(); it != served.end();)
+        {
+            if (*it->Finished)
+            {
+                it->Thread.join();
+                it = served.erase(it);
+            }
+            else
+                ++it;
+        }
+
+        ServedConnection entry;
+        entry.Finished = std::make_shared<std::atomic<bool> >(false);
+        std::shared_ptr<std::atomic<bool> > finished = entry.Finished;
+        entry.Thread = std::thread([&service, &server, connection, finished]() {
+            if (!service.Serve(connection))
+                server.Close();
+            delete connection;
+            *finished = true;
+        });
+        served.push_back(std::move(entry));
+    }
+
+    // Clients that are still connected would otherwise keep their threads waiting for commands
+    service.Interrupt();
+    for (auto& entry : served)
+        entry.Thread.join();
+    std::cout << "Service stopped" << std::endl;
+    return 0;
+}